@@ -0,0 +1,243 @@
+# ITKTools Benchmark Script
+#
+# This script times the key tools on synthetic volumes, generated with
+# pxcreaterandomimage and pxcreatesphere, and compares the results with
+# stored baselines. It is run by the "benchmark" target of the testing
+# tree, or directly with a command line of the form
+#
+#   cmake -DEXE_DIR=/.../bin -DWORK_DIR=/.../Benchmark
+#     -P /.../Testing/Benchmark/pxBenchmark.cmake
+#
+# The following variables may be set to configure it:
+#
+#   EXE_DIR           = directory of the px executables (required)
+#   WORK_DIR          = directory for the inputs, outputs and results (required)
+#   SIZE              = the inputs are SIZE^3 voxels (default: 256)
+#   RESULTS_FILE      = results file (default: WORK_DIR/pxBenchmarkResults_SIZE.json)
+#   BASELINE_FILE     = baseline file (default: pxBenchmarkBaseline_SIZE.json
+#                       next to this script)
+#   TOLERANCE         = allowed regression in percent (default: 25)
+#   UPDATE_BASELINE   = True to copy the results to the baseline file
+#
+# Every tool is run with "-timing json", see src/common/ITKToolsTiming.h.
+# From its report the wall time and the peak resident set size are taken.
+# The results file contains one line per benchmark:
+#
+#   { "name": "gaussian", "voxels": 16777216, "wall_time": 1.234,
+#     "voxels_per_second": 13595799, "peak_rss": 201326592 }
+#
+# The baseline file has the same format. A benchmark regresses when its
+# voxels per second drops, or its peak memory grows, by more than
+# TOLERANCE percent with respect to the baseline. Benchmarks without a
+# baseline are only reported. Baselines depend on the machine, so
+# record them with UPDATE_BASELINE on the machine that runs the
+# benchmark, and compare only results of the same SIZE.
+#
+
+cmake_minimum_required( VERSION 2.8.3 )
+
+# Check the arguments
+if( NOT DEFINED EXE_DIR OR NOT DEFINED WORK_DIR )
+  message( FATAL_ERROR "EXE_DIR and WORK_DIR should be set." )
+endif()
+if( NOT DEFINED SIZE )
+  set( SIZE 256 )
+endif()
+if( NOT DEFINED TOLERANCE )
+  set( TOLERANCE 25 )
+endif()
+if( NOT DEFINED RESULTS_FILE )
+  set( RESULTS_FILE ${WORK_DIR}/pxBenchmarkResults_${SIZE}.json )
+endif()
+if( NOT DEFINED BASELINE_FILE )
+  get_filename_component( scriptDir ${CMAKE_CURRENT_LIST_FILE} PATH )
+  set( BASELINE_FILE ${scriptDir}/pxBenchmarkBaseline_${SIZE}.json )
+endif()
+
+file( MAKE_DIRECTORY ${WORK_DIR} )
+math( EXPR voxels "${SIZE} * ${SIZE} * ${SIZE}" )
+math( EXPR center "${SIZE} / 2" )
+math( EXPR radius "${SIZE} / 3" )
+math( EXPR radius1 "${radius} - 2" )
+math( EXPR radius2 "${radius} + 2" )
+
+
+#---------------------------------------------------------------------
+# Convert a decimal number of seconds, as printed by the timing
+# report, to an integer number of microseconds.
+function( px_to_microseconds _seconds _result )
+  if( "${_seconds}" MATCHES "e" )
+    # Printed in scientific notation: far below a millisecond
+    set( ${_result} 1 PARENT_SCOPE )
+    return()
+  endif()
+  string( REGEX MATCH "^[0-9]+" whole "${_seconds}" )
+  set( fraction "" )
+  if( "${_seconds}" MATCHES "\\.([0-9]+)" )
+    set( fraction ${CMAKE_MATCH_1} )
+  endif()
+  set( fraction "${fraction}000000" )
+  string( SUBSTRING "${fraction}" 0 6 fraction )
+  # Strip leading zeros, math( EXPR ) reads them as octal
+  string( REGEX REPLACE "^0+([0-9])" "\\1" fraction "${fraction}" )
+  if( "${whole}" STREQUAL "" )
+    set( whole 0 )
+  endif()
+  math( EXPR us "${whole} * 1000000 + ${fraction}" )
+  if( us LESS 1 )
+    set( us 1 )
+  endif()
+  set( ${_result} ${us} PARENT_SCOPE )
+endfunction()
+
+
+#---------------------------------------------------------------------
+# Run a tool with timing enabled. Fails on a non-zero exit value.
+#  _name: benchmark name, or "" for input generation that is not timed
+#  _tool: executable name without the px prefix
+#  ARGN:  command line arguments
+function( px_run_tool _name _tool )
+  set( timingFile ${WORK_DIR}/${_tool}_timing.json )
+  file( REMOVE ${timingFile} )
+  execute_process(
+    COMMAND ${EXE_DIR}/px${_tool} ${ARGN} -timing json ${timingFile}
+    WORKING_DIRECTORY ${WORK_DIR}
+    RESULT_VARIABLE result
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE output )
+  if( NOT result EQUAL 0 )
+    message( FATAL_ERROR "px${_tool} failed:\n${output}" )
+  endif()
+  if( "${_name}" STREQUAL "" )
+    return()
+  endif()
+
+  file( READ ${timingFile} report )
+  string( REGEX MATCH "\"wall_time\": ([0-9.e+-]+)" match "${report}" )
+  set( wallTime ${CMAKE_MATCH_1} )
+  string( REGEX MATCH "\"peak_rss\": ([0-9]+)" match "${report}" )
+  set( peakRSS ${CMAKE_MATCH_1} )
+  px_to_microseconds( ${wallTime} us )
+  math( EXPR voxelsPerSecond "${voxels} * 1000000 / ${us}" )
+
+  message( "${_name}: ${wallTime} s, ${voxelsPerSecond} voxels/s, peak ${peakRSS} bytes" )
+  file( APPEND ${RESULTS_FILE} "{ \"name\": \"${_name}\", \"voxels\": ${voxels}, "
+    "\"wall_time\": ${wallTime}, \"voxels_per_second\": ${voxelsPerSecond}, "
+    "\"peak_rss\": ${peakRSS} }\n" )
+endfunction()
+
+
+#---------------------------------------------------------------------
+# Generate the inputs
+
+message( "Generating ${SIZE}^3 inputs in ${WORK_DIR}" )
+set( random ${WORK_DIR}/random.mha )
+set( randomFloat ${WORK_DIR}/random_float.mha )
+set( sphere ${WORK_DIR}/sphere.mha )
+set( sphere1 ${WORK_DIR}/sphere1.mha )
+set( sphere2 ${WORK_DIR}/sphere2.mha )
+
+px_run_tool( "" createrandomimage -out ${random} -pt short -id 3
+  -d0 ${SIZE} -d1 ${SIZE} -d2 ${SIZE} -min 0 -max 1000 -seed 1 )
+px_run_tool( "" createrandomimage -out ${randomFloat} -pt float -id 3
+  -d0 ${SIZE} -d1 ${SIZE} -d2 ${SIZE} -min 0 -max 1 -seed 2 )
+px_run_tool( "" createsphere -out ${sphere} -sz ${SIZE} ${SIZE} ${SIZE}
+  -c ${center} ${center} ${center} -r ${radius} -opct unsigned_char )
+px_run_tool( "" createsphere -out ${sphere1} -sz ${SIZE} ${SIZE} ${SIZE}
+  -c ${center} ${center} ${center} -r ${radius1} -opct unsigned_char )
+px_run_tool( "" createsphere -out ${sphere2} -sz ${SIZE} ${SIZE} ${SIZE}
+  -c ${center} ${center} ${center} -r ${radius2} -opct unsigned_char )
+
+# Check that the inputs have the requested size
+foreach( input ${random} ${randomFloat} ${sphere} ${sphere1} ${sphere2} )
+  execute_process(
+    COMMAND ${EXE_DIR}/pxgetimageinformation -in ${input} -sz
+    RESULT_VARIABLE result
+    OUTPUT_VARIABLE inputSize
+    OUTPUT_STRIP_TRAILING_WHITESPACE )
+  if( NOT result EQUAL 0 OR NOT "${inputSize}" STREQUAL "${SIZE} ${SIZE} ${SIZE}" )
+    message( FATAL_ERROR "${input} has size \"${inputSize}\", "
+      "expected \"${SIZE} ${SIZE} ${SIZE}\"." )
+  endif()
+endforeach()
+
+
+#---------------------------------------------------------------------
+# Run the benchmarks
+
+file( WRITE ${RESULTS_FILE} "" )
+
+px_run_tool( unaryimageoperator unaryimageoperator
+  -in ${random} -ops TIMES -arg 2 -out ${WORK_DIR}/unary.mha )
+px_run_tool( binaryimageoperator binaryimageoperator
+  -in ${random} ${random} -ops ADDITION -out ${WORK_DIR}/binary.mha )
+px_run_tool( gaussian gaussianimagefilter
+  -in ${random} -std 2.0 -out ${WORK_DIR}/gaussian.mha )
+px_run_tool( enhancement enhancement
+  -in ${randomFloat} -std 1.0 -m FrangiVesselness -out ${WORK_DIR}/enhancement.mha )
+px_run_tool( morphology morphology
+  -in ${random} -op dilation -type grayscale -r 2 -out ${WORK_DIR}/morphology.mha )
+px_run_tool( distancetransform distancetransform
+  -in ${sphere} -m Maurer -out ${WORK_DIR}/distance.mha )
+px_run_tool( staple combinesegmentations
+  -m STAPLE -in ${sphere} ${sphere1} ${sphere2} -outh ${WORK_DIR}/staple.mha )
+px_run_tool( texture texture
+  -in ${random} -r 1 -b 32 -noo 1 -out ${WORK_DIR} )
+px_run_tool( statistics statisticsonimage
+  -in ${random} -s arithmetic )
+
+
+#---------------------------------------------------------------------
+# Compare with the baselines
+
+if( UPDATE_BASELINE )
+  configure_file( ${RESULTS_FILE} ${BASELINE_FILE} COPYONLY )
+  message( "Baseline written to ${BASELINE_FILE}" )
+  return()
+endif()
+
+if( NOT EXISTS ${BASELINE_FILE} )
+  message( "No baseline ${BASELINE_FILE}, results are not compared." )
+  return()
+endif()
+
+file( STRINGS ${RESULTS_FILE} results )
+file( STRINGS ${BASELINE_FILE} baselines )
+set( regressions "" )
+foreach( result ${results} )
+  string( REGEX MATCH "\"name\": \"([^\"]*)\"" match "${result}" )
+  set( name ${CMAKE_MATCH_1} )
+  string( REGEX MATCH "\"voxels_per_second\": ([0-9]+)" match "${result}" )
+  set( speed ${CMAKE_MATCH_1} )
+  string( REGEX MATCH "\"peak_rss\": ([0-9]+)" match "${result}" )
+  set( memory ${CMAKE_MATCH_1} )
+
+  set( found FALSE )
+  foreach( baseline ${baselines} )
+    if( "${baseline}" MATCHES "\"name\": \"${name}\"" )
+      set( found TRUE )
+      string( REGEX MATCH "\"voxels_per_second\": ([0-9]+)" match "${baseline}" )
+      set( baseSpeed ${CMAKE_MATCH_1} )
+      string( REGEX MATCH "\"peak_rss\": ([0-9]+)" match "${baseline}" )
+      set( baseMemory ${CMAKE_MATCH_1} )
+    endif()
+  endforeach()
+
+  if( found )
+    math( EXPR minSpeed "${baseSpeed} / 100 * (100 - ${TOLERANCE})" )
+    math( EXPR maxMemory "${baseMemory} / 100 * (100 + ${TOLERANCE})" )
+    if( speed LESS minSpeed )
+      set( regressions "${regressions}  ${name}: ${speed} voxels/s, baseline ${baseSpeed}\n" )
+    endif()
+    if( memory GREATER maxMemory )
+      set( regressions "${regressions}  ${name}: peak ${memory} bytes, baseline ${baseMemory}\n" )
+    endif()
+  else()
+    message( "${name}: no baseline" )
+  endif()
+endforeach()
+
+if( NOT "${regressions}" STREQUAL "" )
+  message( FATAL_ERROR "Regressions of more than ${TOLERANCE}%:\n${regressions}" )
+endif()
+message( "All benchmarks within ${TOLERANCE}% of the baseline." )
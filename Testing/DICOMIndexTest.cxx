@@ -0,0 +1,109 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+/** \file
+ \brief Test the DICOM index against itk::GDCMSeriesFileNames.
+
+ The series identifiers and the ordered file names of every series in a
+ directory must be the same as those of itk::GDCMSeriesFileNames with
+ SetUseSeriesDetails( true ). This is checked twice: the first time the
+ directory is scanned, the second time the stored index is used.
+ Restrictions can be passed after the directory.
+ */
+
+#include "ITKToolsDICOMIndex.h"
+#include "itkGDCMSeriesFileNames.h"
+#include <itksys/SystemTools.hxx>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+/** Compare two lists of names, printing the differences. */
+bool CompareNames( const std::string & what,
+  const std::vector<std::string> & expected, const std::vector<std::string> & names )
+{
+  bool ok = expected.size() == names.size();
+  for( std::size_t i = 0; ok && i < names.size(); ++i )
+  {
+    ok = itksys::SystemTools::CollapseFullPath( expected[ i ].c_str() )
+      == itksys::SystemTools::CollapseFullPath( names[ i ].c_str() );
+  }
+  if( !ok )
+  {
+    std::cerr << "ERROR: the " << what << " differ.\n  GDCMSeriesFileNames:";
+    for( std::size_t i = 0; i < expected.size(); ++i ) std::cerr << "\n    " << expected[ i ];
+    std::cerr << "\n  DICOM index:";
+    for( std::size_t i = 0; i < names.size(); ++i ) std::cerr << "\n    " << names[ i ];
+    std::cerr << std::endl;
+  }
+  return ok;
+
+} // end CompareNames()
+
+
+//-------------------------------------------------------------------------------------
+
+int main( int argc, char ** argv )
+{
+  if( argc < 2 )
+  {
+    std::cerr << "Usage: " << argv[ 0 ] << " directory [restriction ...]" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string directoryName = argv[ 1 ];
+  const std::vector<std::string> restrictions( argv + 2, argv + argc );
+
+  /** The series and files according to GDCM. */
+  itk::GDCMSeriesFileNames::Pointer nameGenerator = itk::GDCMSeriesFileNames::New();
+  nameGenerator->SetUseSeriesDetails( true );
+  for( std::size_t i = 0; i < restrictions.size(); ++i )
+  {
+    nameGenerator->AddSeriesRestriction( restrictions[ i ] );
+  }
+  nameGenerator->SetDirectory( directoryName );
+  const std::vector<std::string> expectedUIDs = nameGenerator->GetSeriesUIDs();
+  if( expectedUIDs.empty() )
+  {
+    std::cerr << "ERROR: no DICOM series in " << directoryName << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  bool ok = true;
+  for( unsigned int pass = 0; pass < 2; ++pass )
+  {
+    std::cout << ( pass == 0 ? "scanning" : "using the stored index" ) << std::endl;
+
+    std::vector<std::string> seriesUIDs;
+    ok &= itktools::GetDICOMSeriesUIDs( directoryName, restrictions, seriesUIDs );
+    ok &= CompareNames( "series", expectedUIDs, seriesUIDs );
+
+    for( std::size_t s = 0; s < expectedUIDs.size(); ++s )
+    {
+      std::vector<std::string> fileNames;
+      itktools::GetDICOMSeriesFileNames( directoryName, restrictions,
+        expectedUIDs[ s ], fileNames );
+      ok &= CompareNames( "files of series " + expectedUIDs[ s ],
+        nameGenerator->GetFileNames( expectedUIDs[ s ] ), fileNames );
+    }
+  }
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+
+} // end main
@@ -0,0 +1,253 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+/** \file
+ \brief Test the KernelTransformDisplacementFieldSource against itk::KernelTransform.
+
+ A kernel transform is fitted to random landmarks, and its field is
+ generated by the displacement field source of pxdeformationfieldgenerator.
+ Every voxel must equal TransformPoint( x ) - x of the fitted transform,
+ which is how the field used to be generated: up to rounding for the
+ exact field, and within the maximum error, in every component, when the
+ far field is approximated. There are more landmarks than fit in one
+ landmark block or one leaf of the tree, and the grid is rotated.
+ */
+
+#include "itkKernelTransformDisplacementFieldSource.h"
+#include "itkThinPlateSplineKernelTransform.h"
+#include "itkThinPlateR2LogRSplineKernelTransform.h"
+#include "itkVolumeSplineKernelTransform.h"
+#include "itkElasticBodySplineKernelTransform.h"
+#include "itkElasticBodyReciprocalSplineKernelTransform.h"
+#include "itkImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+
+const unsigned int Dimension = 3;
+
+typedef itk::Vector< double, Dimension >                          VectorType;
+typedef itk::Image< VectorType, Dimension >                       FieldType;
+typedef itk::KernelTransformDisplacementFieldSource< FieldType >  FieldSourceType;
+typedef itk::KernelTransform< double, Dimension >                 KernelTransformType;
+typedef KernelTransformType::PointSetType                         PointSetType;
+typedef KernelTransformType::InputPointType                       PointType;
+
+typedef itk::KernelTransformWithCoefficients<
+  itk::ThinPlateSplineKernelTransform< double, Dimension > >            TPSTransformType;
+typedef itk::KernelTransformWithCoefficients<
+  itk::ThinPlateR2LogRSplineKernelTransform< double, Dimension > >      TPSR2LOGRTransformType;
+typedef itk::KernelTransformWithCoefficients<
+  itk::VolumeSplineKernelTransform< double, Dimension > >               VSTransformType;
+typedef itk::KernelTransformWithCoefficients<
+  itk::ElasticBodySplineKernelTransform< double, Dimension > >          EBSTransformType;
+typedef itk::KernelTransformWithCoefficients<
+  itk::ElasticBodyReciprocalSplineKernelTransform< double, Dimension > > EBSRTransformType;
+
+
+/** Fit a kernel transform to the landmarks, and pass its coefficients to the field source. */
+template< class TKernelTransform >
+void FitKernelTransform( TKernelTransform * kernelTransform,
+  PointSetType * sourceLandmarks, PointSetType * targetLandmarks, FieldSourceType * fieldSource )
+{
+  kernelTransform->SetStiffness( 0.0 );
+  kernelTransform->SetSourceLandmarks( sourceLandmarks );
+  kernelTransform->SetTargetLandmarks( targetLandmarks );
+  kernelTransform->ComputeWMatrix();
+
+  fieldSource->SetCoefficients( sourceLandmarks, kernelTransform->GetDMatrix(),
+    kernelTransform->GetAMatrix(), kernelTransform->GetBVector() );
+
+} // end FitKernelTransform()
+
+
+/** The largest difference of a component of the field with
+ * TransformPoint( x ) - x, and the largest component of the latter.
+ */
+void CompareWithTransformPoint( const FieldType * field, const KernelTransformType * transform,
+  double & maximumDifference, double & maximumDisplacement )
+{
+  maximumDifference = 0.0;
+  maximumDisplacement = 0.0;
+  itk::ImageRegionConstIteratorWithIndex< FieldType > it(
+    field, field->GetLargestPossibleRegion() );
+  PointType point;
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+  {
+    field->TransformIndexToPhysicalPoint( it.GetIndex(), point );
+    const PointType transformed = transform->TransformPoint( point );
+    const VectorType value = it.Get();
+    for( unsigned int d = 0; d < Dimension; ++d )
+    {
+      const double displacement = transformed[ d ] - point[ d ];
+      maximumDifference = std::max( maximumDifference, std::abs( value[ d ] - displacement ) );
+      maximumDisplacement = std::max( maximumDisplacement, std::abs( displacement ) );
+    }
+  }
+
+} // end CompareWithTransformPoint()
+
+
+//-------------------------------------------------------------------------------------
+
+int main( int argc, char ** argv )
+{
+  if( argc < 2 )
+  {
+    std::cerr << "Usage: " << argv[ 0 ]
+      << " {TPS, TPSR2LOGR, VS, EBS, EBSR} [maximumError]" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string kernelName = argv[ 1 ];
+  const double maximumError = argc > 2 ? std::atof( argv[ 2 ] ) : 0.0;
+
+  /** Random landmarks in a cube of 40 mm, moved by a smooth displacement and noise. */
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomType;
+  RandomType::Pointer random = RandomType::New();
+  random->SetSeed( 43 );
+
+  const unsigned int numberOfLandmarks = 300;
+  PointSetType::Pointer sourceLandmarks = PointSetType::New();
+  PointSetType::Pointer targetLandmarks = PointSetType::New();
+  for( unsigned int j = 0; j < numberOfLandmarks; ++j )
+  {
+    PointType source, target;
+    for( unsigned int d = 0; d < Dimension; ++d )
+    {
+      source[ d ] = random->GetUniformVariate( 0.0, 40.0 );
+    }
+    for( unsigned int d = 0; d < Dimension; ++d )
+    {
+      target[ d ] = source[ d ] + 2.0 * std::sin( source[ ( d + 1 ) % Dimension ] / 10.0 )
+        + random->GetUniformVariate( -0.5, 0.5 );
+    }
+    sourceLandmarks->SetPoint( j, source );
+    targetLandmarks->SetPoint( j, target );
+  }
+
+  /** Fit the transform. */
+  FieldSourceType::Pointer fieldSource = FieldSourceType::New();
+  KernelTransformType::Pointer transform;
+  if( kernelName == "TPS" )
+  {
+    TPSTransformType::Pointer kernelTransform = TPSTransformType::New();
+    FitKernelTransform( kernelTransform.GetPointer(),
+      sourceLandmarks.GetPointer(), targetLandmarks.GetPointer(), fieldSource.GetPointer() );
+    fieldSource->SetKernel( FieldSourceType::ThinPlateSpline );
+    transform = kernelTransform.GetPointer();
+  }
+  else if( kernelName == "TPSR2LOGR" )
+  {
+    TPSR2LOGRTransformType::Pointer kernelTransform = TPSR2LOGRTransformType::New();
+    FitKernelTransform( kernelTransform.GetPointer(),
+      sourceLandmarks.GetPointer(), targetLandmarks.GetPointer(), fieldSource.GetPointer() );
+    fieldSource->SetKernel( FieldSourceType::ThinPlateR2LogRSpline );
+    transform = kernelTransform.GetPointer();
+  }
+  else if( kernelName == "VS" )
+  {
+    VSTransformType::Pointer kernelTransform = VSTransformType::New();
+    FitKernelTransform( kernelTransform.GetPointer(),
+      sourceLandmarks.GetPointer(), targetLandmarks.GetPointer(), fieldSource.GetPointer() );
+    fieldSource->SetKernel( FieldSourceType::VolumeSpline );
+    transform = kernelTransform.GetPointer();
+  }
+  else if( kernelName == "EBS" )
+  {
+    EBSTransformType::Pointer kernelTransform = EBSTransformType::New();
+    FitKernelTransform( kernelTransform.GetPointer(),
+      sourceLandmarks.GetPointer(), targetLandmarks.GetPointer(), fieldSource.GetPointer() );
+    fieldSource->SetKernel( FieldSourceType::ElasticBodySpline );
+    fieldSource->SetAlpha( kernelTransform->GetAlpha() );
+    transform = kernelTransform.GetPointer();
+  }
+  else if( kernelName == "EBSR" )
+  {
+    EBSRTransformType::Pointer kernelTransform = EBSRTransformType::New();
+    FitKernelTransform( kernelTransform.GetPointer(),
+      sourceLandmarks.GetPointer(), targetLandmarks.GetPointer(), fieldSource.GetPointer() );
+    fieldSource->SetKernel( FieldSourceType::ElasticBodyReciprocalSpline );
+    fieldSource->SetAlpha( kernelTransform->GetAlpha() );
+    transform = kernelTransform.GetPointer();
+  }
+  else
+  {
+    std::cerr << "ERROR: unknown kernel " << kernelName << "." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /** A grid around the landmarks, rotated about the z axis. */
+  FieldType::SizeType size;
+  size[ 0 ] = 24; size[ 1 ] = 20; size[ 2 ] = 16;
+  FieldType::RegionType region;
+  region.SetSize( size );
+  FieldType::SpacingType spacing;
+  spacing[ 0 ] = 2.5; spacing[ 1 ] = 2.0; spacing[ 2 ] = 3.0;
+  FieldType::PointType origin;
+  origin[ 0 ] = -5.0; origin[ 1 ] = -10.0; origin[ 2 ] = -4.0;
+  FieldType::DirectionType direction;
+  direction.SetIdentity();
+  const double angle = 0.5;
+  direction[ 0 ][ 0 ] = std::cos( angle ); direction[ 0 ][ 1 ] = -std::sin( angle );
+  direction[ 1 ][ 0 ] = std::sin( angle ); direction[ 1 ][ 1 ] = std::cos( angle );
+
+  fieldSource->SetOutputRegion( region );
+  fieldSource->SetOutputSpacing( spacing );
+  fieldSource->SetOutputOrigin( origin );
+  fieldSource->SetOutputDirection( direction );
+  fieldSource->SetMaximumError( maximumError );
+  fieldSource->SetNumberOfThreads( 3 );
+
+  try
+  {
+    fieldSource->Update();
+  }
+  catch( itk::ExceptionObject & e )
+  {
+    std::cerr << "Caught ITK exception: " << e << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /** Compare. The exact field may only differ by rounding. */
+  double maximumDifference = 0.0;
+  double maximumDisplacement = 0.0;
+  CompareWithTransformPoint( fieldSource->GetOutput(), transform,
+    maximumDifference, maximumDisplacement );
+  const bool isApproximated = maximumError > 0.0
+    && kernelName != "EBS" && kernelName != "EBSR";
+  const double tolerance = ( isApproximated ? maximumError : 0.0 )
+    + 1e-7 * std::max( 1.0, maximumDisplacement );
+
+  std::cout << kernelName << ", maximum error " << maximumError
+    << ": largest difference with TransformPoint " << maximumDifference
+    << ", largest displacement " << maximumDisplacement << std::endl;
+  if( maximumDifference > tolerance )
+  {
+    std::cerr << "ERROR: the field differs " << maximumDifference
+      << " from TransformPoint, more than " << tolerance << "." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+
+} // end main()
@@ -0,0 +1,239 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+/** \file
+ \brief Test the tile encoder of the MevisDicomTiff writer.
+
+ Tiled tiffs are written twice: serially with TIFFWriteEncodedTile, as
+ the writer did before, and with itk::MevisEncodeTile and
+ TIFFWriteRawTile, as the writer does now. The raw tiles of both files
+ must be equal, and both must decode to the image. This is checked for
+ uncompressed, LZW and deflate tiles, with and without the predictor,
+ for 8 and 16 bits, with partial tiles at the borders.
+ */
+
+#include "itkMevisTiffTileEncoder.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+/** Write a tiled tiff, serially with libtiff or with the tile encoder. */
+bool WriteTiff( const std::string & fileName, const itk::MevisTiffTileFormat & format,
+  const std::vector<unsigned char> & image, unsigned int width, unsigned int length,
+  bool useEncoder )
+{
+  TIFF * tif = TIFFOpen( fileName.c_str(), "w" );
+  if( tif == NULL ) return false;
+  TIFFSetField( tif, TIFFTAG_IMAGEWIDTH, width );
+  TIFFSetField( tif, TIFFTAG_IMAGELENGTH, length );
+  TIFFSetField( tif, TIFFTAG_TILEWIDTH, format.TileWidth );
+  TIFFSetField( tif, TIFFTAG_TILELENGTH, format.TileLength );
+  TIFFSetField( tif, TIFFTAG_BITSPERSAMPLE, format.BitsPerSample );
+  TIFFSetField( tif, TIFFTAG_SAMPLESPERPIXEL, 1 );
+  TIFFSetField( tif, TIFFTAG_SAMPLEFORMAT, format.SampleFormat );
+  TIFFSetField( tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG );
+  TIFFSetField( tif, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_MINISBLACK );
+  TIFFSetField( tif, TIFFTAG_COMPRESSION, format.Compression );
+  if( format.Compression == COMPRESSION_ADOBE_DEFLATE )
+  {
+    TIFFSetField( tif, TIFFTAG_ZIPQUALITY, format.CompressionLevel );
+  }
+  if( format.Predictor != PREDICTOR_NONE )
+  {
+    TIFFSetField( tif, TIFFTAG_PREDICTOR, format.Predictor );
+  }
+
+  const unsigned int bps = format.BitsPerSample / 8;
+  const unsigned int tilesX = ( width + format.TileWidth - 1 ) / format.TileWidth;
+  const unsigned int tilesY = ( length + format.TileLength - 1 ) / format.TileLength;
+  const tsize_t tilesize = format.TileWidth * format.TileLength * bps;
+  std::vector<unsigned char> tile( tilesize );
+  bool ok = true;
+  for( unsigned int t = 0; ok && t < tilesX * tilesY; ++t )
+  {
+    /** Fill the tile, zero padded at the borders. */
+    const unsigned int x0 = ( t % tilesX ) * format.TileWidth;
+    const unsigned int y0 = ( t / tilesX ) * format.TileLength;
+    std::fill( tile.begin(), tile.end(), 0 );
+    for( unsigned int y = y0; y < y0 + format.TileLength && y < length; ++y )
+    {
+      const unsigned int lenx = std::min( format.TileWidth, width - x0 );
+      memcpy( &tile[ ( y - y0 ) * format.TileWidth * bps ],
+        &image[ ( y * width + x0 ) * bps ], lenx * bps );
+    }
+
+    if( !useEncoder )
+    {
+      ok = TIFFWriteEncodedTile( tif, t, &tile[ 0 ], tilesize ) >= 0;
+    }
+    else
+    {
+      std::vector<unsigned char> data;
+      if( format.Compression == COMPRESSION_NONE )
+      {
+        data = tile;
+      }
+      else
+      {
+        ok = itk::MevisEncodeTile( format, &tile[ 0 ], tilesize, data );
+      }
+      ok = ok && TIFFWriteRawTile( tif, t, &data[ 0 ], data.size() ) >= 0;
+    }
+  }
+  TIFFClose( tif );
+  return ok;
+
+} // end WriteTiff()
+
+
+/** Compare the raw and decoded tiles of two tiffs with the image. */
+bool CompareTiffs( const std::string & fileName1, const std::string & fileName2,
+  const std::vector<unsigned char> & image, unsigned int width, unsigned int length,
+  unsigned int bps )
+{
+  TIFF * tif1 = TIFFOpen( fileName1.c_str(), "r" );
+  TIFF * tif2 = TIFFOpen( fileName2.c_str(), "r" );
+  if( tif1 == NULL || tif2 == NULL )
+  {
+    std::cerr << "  cannot open the tiffs" << std::endl;
+    if( tif1 ) TIFFClose( tif1 );
+    if( tif2 ) TIFFClose( tif2 );
+    return false;
+  }
+
+  bool ok = TIFFNumberOfTiles( tif1 ) == TIFFNumberOfTiles( tif2 );
+  if( !ok ) std::cerr << "  the numbers of tiles differ" << std::endl;
+  uint32 tileWidth = 0, tileLength = 0;
+  TIFFGetField( tif1, TIFFTAG_TILEWIDTH, &tileWidth );
+  TIFFGetField( tif1, TIFFTAG_TILELENGTH, &tileLength );
+  const tsize_t tilesize = TIFFTileSize( tif1 );
+  const unsigned int tilesX = ( width + tileWidth - 1 ) / tileWidth;
+  std::vector<unsigned char> raw1( 2 * tilesize + 1024 ), raw2( 2 * tilesize + 1024 );
+  std::vector<unsigned char> tile1( tilesize ), tile2( tilesize );
+  for( ttile_t t = 0; ok && t < TIFFNumberOfTiles( tif1 ); ++t )
+  {
+    const tsize_t n1 = TIFFReadRawTile( tif1, t, &raw1[ 0 ], raw1.size() );
+    const tsize_t n2 = TIFFReadRawTile( tif2, t, &raw2[ 0 ], raw2.size() );
+    if( n1 < 0 || n1 != n2 || memcmp( &raw1[ 0 ], &raw2[ 0 ], n1 ) != 0 )
+    {
+      std::cerr << "  raw tile " << t << " differs" << std::endl;
+      ok = false;
+      break;
+    }
+
+    if( TIFFReadEncodedTile( tif1, t, &tile1[ 0 ], tilesize ) < 0
+      || TIFFReadEncodedTile( tif2, t, &tile2[ 0 ], tilesize ) < 0
+      || memcmp( &tile1[ 0 ], &tile2[ 0 ], tilesize ) != 0 )
+    {
+      std::cerr << "  decoded tile " << t << " differs" << std::endl;
+      ok = false;
+      break;
+    }
+
+    /** Check the decoded tile against the image. */
+    const unsigned int x0 = ( t % tilesX ) * tileWidth;
+    const unsigned int y0 = ( t / tilesX ) * tileLength;
+    for( unsigned int y = y0; ok && y < y0 + tileLength && y < length; ++y )
+    {
+      const unsigned int lenx = std::min<unsigned int>( tileWidth, width - x0 );
+      ok = memcmp( &tile1[ ( y - y0 ) * tileWidth * bps ],
+        &image[ ( y * width + x0 ) * bps ], lenx * bps ) == 0;
+    }
+    if( !ok ) std::cerr << "  tile " << t << " does not decode to the image" << std::endl;
+  }
+
+  TIFFClose( tif1 );
+  TIFFClose( tif2 );
+  return ok;
+
+} // end CompareTiffs()
+
+
+//-------------------------------------------------------------------------------------
+
+int main( int argc, char ** argv )
+{
+  const std::string outputDirectory = argc > 1 ? argv[ 1 ] : ".";
+
+  /** An image with smooth and noisy parts, and partial border tiles. */
+  const unsigned int width = 100;
+  const unsigned int length = 70;
+  const unsigned short compressions[] = {
+    COMPRESSION_NONE, COMPRESSION_LZW, COMPRESSION_ADOBE_DEFLATE };
+  const char * compressionNames[] = { "none", "lzw", "deflate" };
+
+  unsigned int failures = 0;
+  for( unsigned int bits = 8; bits <= 16; bits += 8 )
+  {
+    const unsigned int bps = bits / 8;
+    std::vector<unsigned char> image( width * length * bps );
+    unsigned int seed = 12345;
+    for( unsigned int i = 0; i < width * length; ++i )
+    {
+      seed = seed * 1103515245 + 12345;
+      const unsigned int value = i < width * length / 2
+        ? ( i % width ) * 3 : ( seed >> 16 );
+      for( unsigned int b = 0; b < bps; ++b )
+      {
+        image[ i * bps + b ] = static_cast<unsigned char>( value >> ( 8 * b ) );
+      }
+    }
+
+    for( unsigned int c = 0; c < 3; ++c )
+    {
+      for( unsigned int p = 0; p < 2; ++p )
+      {
+        if( compressions[ c ] == COMPRESSION_NONE && p == 1 ) continue;
+
+        itk::MevisTiffTileFormat format;
+        format.TileWidth = 32;
+        format.TileLength = 16;
+        format.BitsPerSample = bits;
+        format.SampleFormat = SAMPLEFORMAT_UINT;
+        format.Compression = compressions[ c ];
+        format.CompressionLevel = 6;
+        format.Predictor = p ? PREDICTOR_HORIZONTAL : PREDICTOR_NONE;
+
+        std::ostringstream name;
+        name << outputDirectory << "/MevisTiffTileEncoder_" << compressionNames[ c ]
+          << ( p ? "_predictor_" : "_" ) << bits;
+        const std::string serialName = name.str() + "_serial.tif";
+        const std::string encodedName = name.str() + "_encoded.tif";
+
+        std::cout << compressionNames[ c ] << ( p ? ", predictor" : "" )
+          << ", " << bits << " bits" << std::endl;
+        const bool ok = WriteTiff( serialName, format, image, width, length, false )
+          && WriteTiff( encodedName, format, image, width, length, true )
+          && CompareTiffs( serialName, encodedName, image, width, length, bps );
+        if( !ok )
+        {
+          std::cerr << "  FAILED" << std::endl;
+          ++failures;
+        }
+      }
+    }
+  }
+
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+} // end main
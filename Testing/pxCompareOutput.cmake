@@ -0,0 +1,47 @@
+# ITKTools Output Comparison Script
+#
+# This script runs a tool that prints its result, instead of writing an
+# image, and compares what it prints with a baseline text file. It is
+# used by the tests, with a command line of the form
+#
+#   cmake -DEXECUTABLE=/.../bin/pxcountnonzerovoxels -DINPUT=/.../image.mhd
+#     -DOPTIONS="-labels -format json" -DBASELINE=/.../baseline.txt
+#     -DOUTPUT=/.../output.txt -P /.../Testing/pxCompareOutput.cmake
+#
+# The following variables may be set to configure it:
+#
+#   EXECUTABLE        = the tool to run (required)
+#   INPUT             = the file passed with -in (required)
+#   OPTIONS           = further options, separated by spaces (default: none)
+#   BASELINE          = the expected output (required)
+#   OUTPUT            = file to store the output in (required)
+#
+# The test fails when the tool fails, or when its output differs from
+# the baseline. Line endings are ignored.
+#
+
+cmake_minimum_required( VERSION 2.8.3 )
+
+# Check the arguments
+if( NOT DEFINED EXECUTABLE OR NOT DEFINED INPUT
+    OR NOT DEFINED BASELINE OR NOT DEFINED OUTPUT )
+  message( FATAL_ERROR "EXECUTABLE, INPUT, BASELINE and OUTPUT should be set." )
+endif()
+separate_arguments( options UNIX_COMMAND "${OPTIONS}" )
+
+# Run the tool
+execute_process( COMMAND ${EXECUTABLE} -in ${INPUT} ${options}
+  OUTPUT_VARIABLE output
+  RESULT_VARIABLE result )
+file( WRITE ${OUTPUT} "${output}" )
+if( NOT result EQUAL 0 )
+  message( FATAL_ERROR "${EXECUTABLE} failed: ${result}" )
+endif()
+
+# Compare with the baseline
+file( READ ${BASELINE} baseline )
+string( REPLACE "\r\n" "\n" output "${output}" )
+string( REPLACE "\r\n" "\n" baseline "${baseline}" )
+if( NOT output STREQUAL baseline )
+  message( FATAL_ERROR "The output ${OUTPUT} differs from the baseline ${BASELINE}." )
+endif()
@@ -20,6 +20,7 @@
 
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
@@ -102,6 +103,7 @@ public:
     /** Setup the pipeline */
     typename ReaderType::Pointer reader = ReaderType::New();
     reader->SetFileName( this->m_InputFileName );
+    itktools::ReuseImageIO( reader, this->m_InputFileName );
 
     typename FilterType::Pointer filter = FilterType::New();
     filter->SetInput( reader->GetOutput() );
@@ -109,6 +111,7 @@ public:
     typename WriterType::Pointer writer = WriterType::New();
     writer->SetFileName( this->m_OutputFileName );
     writer->SetInput( filter->GetOutput() );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
@@ -0,0 +1,634 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+/** \file
+ \brief Run a script of px commands, in parallel where possible.
+
+ \verbinclude batch.help
+ */
+
+#include "itkCommandLineArgumentParser.h"
+#include "ITKToolsHelpers.h"
+#include "itkMultiThreader.h"
+
+#include <itksys/SystemTools.hxx>
+#include <itksys/Process.h>
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+
+#if defined( _WIN32 )
+#include <direct.h>
+#include <io.h>
+#else
+#include <stdlib.h>
+#endif
+
+
+/**
+ * ******************* GetHelpString *******************
+ */
+
+std::string GetHelpString( void )
+{
+  std::stringstream ss;
+  ss << "ITKTools v" << itktools::GetITKToolsVersion() << "\n"
+    << "Runs a script of px commands, one command per line.\n"
+    << "Every command runs as a separate process, the px tools are looked up\n"
+    << "next to pxbatch first, then in the PATH. The commands are not run\n"
+    << "inside pxbatch, so each tool still reads its inputs itself; the\n"
+    << "intermediates are passed on as files, not as images in memory.\n"
+    << "Commands that do not depend on each other are run in parallel.\n"
+    << "A command depends on an earlier one when it reads or writes a file\n"
+    << "that the earlier one writes, or writes a file that it reads.\n"
+    << "Intermediate results, files that are written by one command (-out)\n"
+    << "and read by later commands, are stored in the cache directory, which\n"
+    << "is memory backed by default, and removed when they are no longer needed.\n"
+    << "Each run of pxbatch uses its own new directory inside the cache directory.\n"
+    << "Commands before the one that writes an intermediate read it from disk.\n"
+    << "Lines starting with # are comments.\n"
+    << "Usage:\n"
+    << "pxbatch\n"
+    << "  -in      script file name\n"
+    << "  [-j]     maximum number of commands run in parallel,\n"
+    << "           default the number of threads\n"
+    << "  [-keep]  intermediate files that should be written to disk anyway\n"
+    << "  [-cache] cache directory, default /dev/shm if it exists,\n"
+    << "           otherwise the temporary directory\n"
+    << "  [-v]     print the commands when they are started\n"
+    << "The -threads of pxbatch are divided over the running commands.";
+
+  return ss.str();
+
+} // end GetHelpString()
+
+
+/** A command of the script. */
+struct BatchCommand
+{
+  BatchCommand() : Line( 0 ), State( WAITING ), Process( NULL ) {}
+
+  enum StateType { WAITING, RUNNING, DONE, FAILED, SKIPPED };
+
+  unsigned int              Line;
+  std::vector<std::string>  Arguments;
+  std::set<std::string>     Reads;
+  std::set<std::string>     Writes;
+  std::vector<unsigned int> Dependencies;
+  StateType                 State;
+  itksysProcess *           Process;
+};
+
+/** An intermediate file, the line of the command that writes it, and
+ * the number of later commands that still need it.
+ */
+struct BatchIntermediate
+{
+  BatchIntermediate() : Producer( 0 ), NumberOfReaders( 0 ) {}
+  std::string   Directory;
+  unsigned int  Producer;
+  unsigned int  NumberOfReaders;
+};
+
+
+/**
+ * ******************* IsOptionName *******************
+ *
+ * Tells options, like -out, from values, like -1 or -.5.
+ */
+
+bool IsOptionName( const std::string & arg )
+{
+  return arg.size() > 1 && arg[ 0 ] == '-' && !isdigit( arg[ 1 ] ) && arg[ 1 ] != '.';
+
+} // end IsOptionName()
+
+
+/**
+ * ******************* SplitCommandLine *******************
+ *
+ * Splits at white space, double quotes group words.
+ */
+
+std::vector<std::string> SplitCommandLine( const std::string & line )
+{
+  std::vector<std::string> words;
+  std::string word;
+  bool inWord = false;
+  bool inQuotes = false;
+  for( std::string::size_type i = 0; i < line.size(); ++i )
+  {
+    const char c = line[ i ];
+    if( c == '"' )
+    {
+      inQuotes = !inQuotes;
+      inWord = true;
+    }
+    else if( !inQuotes && ( c == ' ' || c == '\t' || c == '\r' ) )
+    {
+      if( inWord ) words.push_back( word );
+      word = "";
+      inWord = false;
+    }
+    else
+    {
+      word += c;
+      inWord = true;
+    }
+  }
+  if( inWord ) words.push_back( word );
+
+  return words;
+
+} // end SplitCommandLine()
+
+
+/**
+ * ******************* ReadBatchScript *******************
+ */
+
+bool ReadBatchScript( const std::string & fileName, std::vector<BatchCommand> & commands )
+{
+  std::ifstream script( fileName.c_str() );
+  if( !script.is_open() )
+  {
+    std::cerr << "ERROR: could not open " << fileName << "." << std::endl;
+    return false;
+  }
+
+  std::string line;
+  unsigned int lineNumber = 0;
+  while( std::getline( script, line ) )
+  {
+    ++lineNumber;
+    BatchCommand command;
+    command.Line = lineNumber;
+    command.Arguments = SplitCommandLine( line );
+    if( command.Arguments.empty() || command.Arguments[ 0 ][ 0 ] == '#' ) continue;
+
+    /** The values of -out are written, all other values are (possibly) read. */
+    bool isOutput = false;
+    for( unsigned int i = 1; i < command.Arguments.size(); ++i )
+    {
+      const std::string & arg = command.Arguments[ i ];
+      if( IsOptionName( arg ) )
+      {
+        isOutput = arg == "-out";
+        continue;
+      }
+      if( arg.empty() ) continue;
+      if( isOutput ) command.Writes.insert( arg );
+      else command.Reads.insert( arg );
+    }
+    commands.push_back( command );
+  }
+
+  return true;
+
+} // end ReadBatchScript()
+
+
+/**
+ * ******************* Intersects *******************
+ */
+
+bool Intersects( const std::set<std::string> & a, const std::set<std::string> & b )
+{
+  for( std::set<std::string>::const_iterator it = a.begin(); it != a.end(); ++it )
+  {
+    if( b.count( *it ) ) return true;
+  }
+  return false;
+
+} // end Intersects()
+
+
+/**
+ * ******************* ComputeDependencies *******************
+ */
+
+void ComputeDependencies( std::vector<BatchCommand> & commands )
+{
+  for( unsigned int j = 0; j < commands.size(); ++j )
+  {
+    for( unsigned int i = 0; i < j; ++i )
+    {
+      if( Intersects( commands[ i ].Writes, commands[ j ].Reads )
+        || Intersects( commands[ i ].Writes, commands[ j ].Writes )
+        || Intersects( commands[ i ].Reads, commands[ j ].Writes ) )
+      {
+        commands[ j ].Dependencies.push_back( i );
+      }
+    }
+  }
+
+} // end ComputeDependencies()
+
+
+/**
+ * ******************* MakeUniqueDirectory *******************
+ *
+ * Creates a new directory in parent, with a name no other process
+ * uses, and returns it, or an empty string when that fails.
+ */
+
+std::string MakeUniqueDirectory( const std::string & parent )
+{
+  const std::string name = parent + "/pxbatch-XXXXXX";
+  std::vector<char> buffer( name.begin(), name.end() );
+  buffer.push_back( '\0' );
+#if defined( _WIN32 )
+  if( _mktemp_s( &buffer[ 0 ], buffer.size() ) != 0 || _mkdir( &buffer[ 0 ] ) != 0 )
+  {
+    return "";
+  }
+#else
+  if( mkdtemp( &buffer[ 0 ] ) == NULL ) return "";
+#endif
+  return std::string( &buffer[ 0 ] );
+
+} // end MakeUniqueDirectory()
+
+
+/**
+ * ******************* SetupIntermediates *******************
+ *
+ * Redirects files that are written once and read later to the cache.
+ * Each gets its own directory, so that files that belong to it,
+ * like the .raw of an .mhd, are removed with it. Only the -out of the
+ * producing command and the arguments of the commands after it are
+ * redirected: commands before it read the file on disk, and so does
+ * the producer when it overwrites its own input.
+ * The directories are made in batchDirectory, a new directory in the
+ * cache directory that is only created when there are intermediates.
+ */
+
+bool SetupIntermediates( std::vector<BatchCommand> & commands,
+  const std::set<std::string> & keep, const std::string & cacheDirectory,
+  std::map<std::string, BatchIntermediate> & intermediates,
+  std::string & batchDirectory )
+{
+  std::map<std::string, unsigned int> numberOfWriters;
+  for( unsigned int i = 0; i < commands.size(); ++i )
+  {
+    for( std::set<std::string>::const_iterator it = commands[ i ].Writes.begin();
+      it != commands[ i ].Writes.end(); ++it )
+    {
+      ++numberOfWriters[ *it ];
+    }
+  }
+
+  batchDirectory = "";
+  for( unsigned int i = 0; i < commands.size(); ++i )
+  {
+    for( std::set<std::string>::const_iterator it = commands[ i ].Writes.begin();
+      it != commands[ i ].Writes.end(); ++it )
+    {
+      if( keep.count( *it ) || numberOfWriters[ *it ] != 1 ) continue;
+
+      BatchIntermediate intermediate;
+      for( unsigned int j = i + 1; j < commands.size(); ++j )
+      {
+        if( commands[ j ].Reads.count( *it ) ) ++intermediate.NumberOfReaders;
+      }
+      if( intermediate.NumberOfReaders == 0 ) continue;
+
+      if( batchDirectory == "" )
+      {
+        batchDirectory = MakeUniqueDirectory( cacheDirectory );
+        if( batchDirectory == "" )
+        {
+          std::cerr << "ERROR: could not create a directory in the cache directory \""
+            << cacheDirectory << "\"." << std::endl;
+          return false;
+        }
+      }
+
+      std::ostringstream directory;
+      directory << batchDirectory << "/" << intermediates.size();
+      intermediate.Directory = directory.str();
+      intermediate.Producer = commands[ i ].Line;
+      intermediates[ *it ] = intermediate;
+    }
+  }
+
+  /** Replace the file names in the command lines. */
+  for( unsigned int i = 0; i < commands.size(); ++i )
+  {
+    bool isOutput = false;
+    for( unsigned int a = 1; a < commands[ i ].Arguments.size(); ++a )
+    {
+      std::string & arg = commands[ i ].Arguments[ a ];
+      if( IsOptionName( arg ) )
+      {
+        isOutput = arg == "-out";
+        continue;
+      }
+      std::map<std::string, BatchIntermediate>::const_iterator it
+        = intermediates.find( arg );
+      if( it == intermediates.end() ) continue;
+      const unsigned int line = commands[ i ].Line;
+      if( line > it->second.Producer || ( line == it->second.Producer && isOutput ) )
+      {
+        arg = it->second.Directory + "/" + itksys::SystemTools::GetFilenameName( it->first );
+      }
+    }
+  }
+
+  return true;
+
+} // end SetupIntermediates()
+
+
+/**
+ * ******************* ReleaseIntermediates *******************
+ */
+
+void ReleaseIntermediates( const BatchCommand & command,
+  std::map<std::string, BatchIntermediate> & intermediates )
+{
+  for( std::set<std::string>::const_iterator it = command.Reads.begin();
+    it != command.Reads.end(); ++it )
+  {
+    std::map<std::string, BatchIntermediate>::iterator intermediate
+      = intermediates.find( *it );
+    if( intermediate == intermediates.end()
+      || command.Line <= intermediate->second.Producer ) continue;
+    if( --intermediate->second.NumberOfReaders == 0 )
+    {
+      itksys::SystemTools::RemoveADirectory( intermediate->second.Directory.c_str() );
+    }
+  }
+
+} // end ReleaseIntermediates()
+
+
+/**
+ * ******************* StartCommand *******************
+ */
+
+bool StartCommand( BatchCommand & command, const std::string & toolDirectory,
+  const std::map<std::string, BatchIntermediate> & intermediates,
+  const unsigned int numberOfThreads, const bool verbose )
+{
+  std::vector<std::string> arguments = command.Arguments;
+
+  /** Prefer the tools next to pxbatch. */
+  const std::string local = toolDirectory + "/" + arguments[ 0 ];
+  if( itksys::SystemTools::FileExists( local.c_str(), true )
+    || itksys::SystemTools::FileExists( ( local + ".exe" ).c_str(), true ) )
+  {
+    arguments[ 0 ] = local;
+  }
+
+  /** Share the threads. */
+  if( std::find( arguments.begin(), arguments.end(), "-threads" ) == arguments.end() )
+  {
+    std::ostringstream threads;
+    threads << numberOfThreads;
+    arguments.push_back( "-threads" );
+    arguments.push_back( threads.str() );
+  }
+
+  /** Create the cache directories of the outputs. */
+  for( std::set<std::string>::const_iterator it = command.Writes.begin();
+    it != command.Writes.end(); ++it )
+  {
+    std::map<std::string, BatchIntermediate>::const_iterator intermediate
+      = intermediates.find( *it );
+    if( intermediate != intermediates.end() )
+    {
+      itksys::SystemTools::MakeDirectory( intermediate->second.Directory.c_str() );
+    }
+  }
+
+  if( verbose )
+  {
+    std::cout << "[" << command.Line << "]";
+    for( unsigned int i = 0; i < arguments.size(); ++i )
+    {
+      std::cout << " " << arguments[ i ];
+    }
+    std::cout << std::endl;
+  }
+
+  std::vector<const char *> argv;
+  for( unsigned int i = 0; i < arguments.size(); ++i )
+  {
+    argv.push_back( arguments[ i ].c_str() );
+  }
+  argv.push_back( NULL );
+
+  command.Process = itksysProcess_New();
+  itksysProcess_SetCommand( command.Process, &argv[ 0 ] );
+  itksysProcess_SetPipeShared( command.Process, itksysProcess_Pipe_STDOUT, 1 );
+  itksysProcess_SetPipeShared( command.Process, itksysProcess_Pipe_STDERR, 1 );
+  itksysProcess_Execute( command.Process );
+
+  if( itksysProcess_GetState( command.Process ) != itksysProcess_State_Executing )
+  {
+    std::cerr << "ERROR: could not start line " << command.Line << ": "
+      << arguments[ 0 ] << std::endl;
+    itksysProcess_Delete( command.Process );
+    command.Process = NULL;
+    return false;
+  }
+
+  return true;
+
+} // end StartCommand()
+
+
+/**
+ * ******************* FinishCommand *******************
+ */
+
+bool FinishCommand( BatchCommand & command )
+{
+  const bool success
+    = itksysProcess_GetState( command.Process ) == itksysProcess_State_Exited
+    && itksysProcess_GetExitValue( command.Process ) == 0;
+  itksysProcess_Delete( command.Process );
+  command.Process = NULL;
+
+  if( !success )
+  {
+    std::cerr << "ERROR: line " << command.Line << " ("
+      << command.Arguments[ 0 ] << ") failed." << std::endl;
+  }
+
+  return success;
+
+} // end FinishCommand()
+
+//-------------------------------------------------------------------------------------
+
+int main( int argc, char **argv )
+{
+  /** Create a command line argument parser. */
+  itk::CommandLineArgumentParser::Pointer parser = itk::CommandLineArgumentParser::New();
+  parser->SetCommandLineArguments( argc, argv );
+  parser->SetProgramHelpText( GetHelpString() );
+
+  parser->MarkArgumentAsRequired( "-in", "The script file name." );
+
+  itk::CommandLineArgumentParser::ReturnValue validateArguments = parser->CheckForRequiredArguments();
+
+  if( validateArguments == itk::CommandLineArgumentParser::FAILED )
+  {
+    return EXIT_FAILURE;
+  }
+  else if( validateArguments == itk::CommandLineArgumentParser::HELPREQUESTED )
+  {
+    return EXIT_SUCCESS;
+  }
+
+  /** Get arguments. */
+  std::string scriptFileName = "";
+  parser->GetCommandLineArgument( "-in", scriptFileName );
+
+  const unsigned int totalNumberOfThreads
+    = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+  unsigned int maximumNumberOfJobs = totalNumberOfThreads;
+  parser->GetCommandLineArgument( "-j", maximumNumberOfJobs );
+  if( maximumNumberOfJobs == 0 ) maximumNumberOfJobs = 1;
+
+  std::vector<std::string> keepList;
+  parser->GetCommandLineArgument( "-keep", keepList );
+  std::set<std::string> keep( keepList.begin(), keepList.end() );
+
+  std::string cacheDirectory = "/dev/shm";
+  if( !itksys::SystemTools::FileIsDirectory( cacheDirectory.c_str() ) )
+  {
+    const char * tmp = itksys::SystemTools::GetEnv( "TMPDIR" );
+    if( tmp == NULL ) tmp = itksys::SystemTools::GetEnv( "TEMP" );
+    cacheDirectory = tmp != NULL ? tmp : "/tmp";
+  }
+  parser->GetCommandLineArgument( "-cache", cacheDirectory );
+
+  const bool verbose = parser->ArgumentExists( "-v" );
+
+  /** The directory of pxbatch, where the other tools are expected. */
+  std::string errorMessage;
+  std::string toolPath, toolDirectory;
+  itksys::SystemTools::FindProgramPath( argv[ 0 ], toolPath, errorMessage );
+  toolDirectory = itksys::SystemTools::GetFilenamePath( toolPath );
+
+  /** Read the script and analyse it. */
+  std::vector<BatchCommand> commands;
+  if( !ReadBatchScript( scriptFileName, commands ) ) return EXIT_FAILURE;
+  ComputeDependencies( commands );
+  std::map<std::string, BatchIntermediate> intermediates;
+  std::string batchDirectory;
+  if( !SetupIntermediates( commands, keep, cacheDirectory, intermediates, batchDirectory ) )
+  {
+    return EXIT_FAILURE;
+  }
+
+  /** Run. Start all commands whose dependencies are done, up to the
+   * maximum number of jobs, and poll for the running ones to finish.
+   */
+  unsigned int numberOfFinished = 0;
+  unsigned int numberOfRunning = 0;
+  bool allSucceeded = true;
+  while( numberOfFinished < commands.size() )
+  {
+    /** Find the commands that can be started, skip those that depend on failures. */
+    std::vector<unsigned int> ready;
+    for( unsigned int i = 0; i < commands.size(); ++i )
+    {
+      if( commands[ i ].State != BatchCommand::WAITING ) continue;
+      bool isReady = true;
+      bool skip = false;
+      for( unsigned int d = 0; d < commands[ i ].Dependencies.size(); ++d )
+      {
+        const BatchCommand::StateType state = commands[ commands[ i ].Dependencies[ d ] ].State;
+        if( state == BatchCommand::FAILED || state == BatchCommand::SKIPPED ) skip = true;
+        else if( state != BatchCommand::DONE ) isReady = false;
+      }
+      if( skip )
+      {
+        std::cerr << "ERROR: line " << commands[ i ].Line
+          << " is skipped, because a command it depends on failed." << std::endl;
+        commands[ i ].State = BatchCommand::SKIPPED;
+        ReleaseIntermediates( commands[ i ], intermediates );
+        ++numberOfFinished;
+        allSucceeded = false;
+      }
+      else if( isReady )
+      {
+        ready.push_back( i );
+      }
+    }
+
+    /** Start them, dividing the threads over the commands that can run. */
+    const unsigned int numberOfJobs = std::max( 1u, std::min( maximumNumberOfJobs,
+      static_cast<unsigned int>( ready.size() ) + numberOfRunning ) );
+    const unsigned int numberOfThreads = std::max( 1u, totalNumberOfThreads / numberOfJobs );
+    for( unsigned int r = 0; r < ready.size() && numberOfRunning < maximumNumberOfJobs; ++r )
+    {
+      BatchCommand & command = commands[ ready[ r ] ];
+      if( StartCommand( command, toolDirectory, intermediates, numberOfThreads, verbose ) )
+      {
+        command.State = BatchCommand::RUNNING;
+        ++numberOfRunning;
+      }
+      else
+      {
+        command.State = BatchCommand::FAILED;
+        ReleaseIntermediates( command, intermediates );
+        ++numberOfFinished;
+        allSucceeded = false;
+      }
+    }
+
+    /** Wait for a running command to finish. */
+    bool finished = false;
+    while( numberOfRunning > 0 && !finished )
+    {
+      for( unsigned int i = 0; i < commands.size(); ++i )
+      {
+        if( commands[ i ].State != BatchCommand::RUNNING ) continue;
+        double timeout = 0.01;
+        if( itksysProcess_WaitForExit( commands[ i ].Process, &timeout ) == 0 ) continue;
+
+        const bool success = FinishCommand( commands[ i ] );
+        commands[ i ].State = success ? BatchCommand::DONE : BatchCommand::FAILED;
+        allSucceeded &= success;
+        ReleaseIntermediates( commands[ i ], intermediates );
+        --numberOfRunning;
+        ++numberOfFinished;
+        finished = true;
+      }
+    }
+  }
+
+  /** Remove what is left in the cache, e.g. outputs of failed commands. */
+  if( batchDirectory != "" )
+  {
+    itksys::SystemTools::RemoveADirectory( batchDirectory.c_str() );
+  }
+
+  /** End program. */
+  return allSucceeded ? EXIT_SUCCESS : EXIT_FAILURE;
+
+} // end main
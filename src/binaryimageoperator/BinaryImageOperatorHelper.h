@@ -18,6 +18,8 @@
 #ifndef __BinaryImageOperatorHelper_h_
 #define __BinaryImageOperatorHelper_h_
 
+#include "ITKToolsTiming.h"
+
 #include "itkImage.h"
 #include "itkBinaryFunctors.h"
 #include "itkBinaryFunctorImageFilter.h"
@@ -235,6 +237,7 @@ public:
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetInput( binaryFilter->GetOutput() );
     writer->SetUseCompression( this->m_UseCompression );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
@@ -242,4 +245,45 @@ public:
 }; // end ITKToolsBinaryImageOperator
 
 
+/** \class ITKToolsBinaryImageOperatorByOutputType
+ *
+ * Adapter for itktools::ToolDispatch: the inputs are read as long for
+ * integer outputs and as double for floating point outputs.
+ */
+
+template< class TOutputComponentType >
+struct BinaryImageOperatorInputType
+{
+  typedef long Type;
+};
+
+template<>
+struct BinaryImageOperatorInputType< float >
+{
+  typedef double Type;
+};
+
+template<>
+struct BinaryImageOperatorInputType< double >
+{
+  typedef double Type;
+};
+
+template< unsigned int VDimension, class TOutputComponentType >
+struct ITKToolsBinaryImageOperatorByOutputType
+{
+  typedef typename BinaryImageOperatorInputType< TOutputComponentType >::Type InputComponentType;
+  typedef ITKToolsBinaryImageOperator< VDimension,
+    InputComponentType, InputComponentType, TOutputComponentType > ToolType;
+
+  static ITKToolsBinaryImageOperatorBase * New( unsigned int dim,
+    itk::ImageIOBase::IOComponentType inputComponentType1,
+    itk::ImageIOBase::IOComponentType inputComponentType2,
+    itk::ImageIOBase::IOComponentType outputComponentType )
+  {
+    return ToolType::New( dim, inputComponentType1, inputComponentType2, outputComponentType );
+  }
+};
+
+
 #endif //#ifndef __BinaryImageOperatorHelper_h_
@@ -166,30 +166,12 @@ int main( int argc, char **argv )
 
   try
   {
-    // now call all possible template combinations.
-    if( !filter ) filter = ITKToolsBinaryImageOperator< 2, long, long, char >::New( dim, inCType1, inCType2, outCType );
-    if( !filter ) filter = ITKToolsBinaryImageOperator< 2, long, long, unsigned char >::New( dim, inCType1, inCType2, outCType );
-    if( !filter ) filter = ITKToolsBinaryImageOperator< 2, long, long, short >::New( dim, inCType1, inCType2, outCType );
-    if( !filter ) filter = ITKToolsBinaryImageOperator< 2, long, long, unsigned short >::New( dim, inCType1, inCType2, outCType );
-    if( !filter ) filter = ITKToolsBinaryImageOperator< 2, long, long, int >::New( dim, inCType1, inCType2, outCType );
-    if( !filter ) filter = ITKToolsBinaryImageOperator< 2, long, long, unsigned int >::New( dim, inCType1, inCType2, outCType );
-    if( !filter ) filter = ITKToolsBinaryImageOperator< 2, long, long, long >::New( dim, inCType1, inCType2, outCType );
-    if( !filter ) filter = ITKToolsBinaryImageOperator< 2, long, long, unsigned long >::New( dim, inCType1, inCType2, outCType );
-    if( !filter ) filter = ITKToolsBinaryImageOperator< 2, double, double, float >::New( dim, inCType1, inCType2, outCType );
-    if( !filter ) filter = ITKToolsBinaryImageOperator< 2, double, double, double >::New( dim, inCType1, inCType2, outCType );
-
-#ifdef ITKTOOLS_3D_SUPPORT
-    if( !filter ) filter = ITKToolsBinaryImageOperator< 3, long, long, char >::New( dim, inCType1, inCType2, outCType );
-    if( !filter ) filter = ITKToolsBinaryImageOperator< 3, long, long, unsigned char >::New( dim, inCType1, inCType2, outCType );
-    if( !filter ) filter = ITKToolsBinaryImageOperator< 3, long, long, short >::New( dim, inCType1, inCType2, outCType );
-    if( !filter ) filter = ITKToolsBinaryImageOperator< 3, long, long, unsigned short >::New( dim, inCType1, inCType2, outCType );
-    if( !filter ) filter = ITKToolsBinaryImageOperator< 3, long, long, int >::New( dim, inCType1, inCType2, outCType );
-    if( !filter ) filter = ITKToolsBinaryImageOperator< 3, long, long, unsigned int >::New( dim, inCType1, inCType2, outCType );
-    if( !filter ) filter = ITKToolsBinaryImageOperator< 3, long, long, long >::New( dim, inCType1, inCType2, outCType );
-    if( !filter ) filter = ITKToolsBinaryImageOperator< 3, long, long, unsigned long >::New( dim, inCType1, inCType2, outCType );
-    if( !filter ) filter = ITKToolsBinaryImageOperator< 3, double, double, float >::New( dim, inCType1, inCType2, outCType );
-    if( !filter ) filter = ITKToolsBinaryImageOperator< 3, double, double, double >::New( dim, inCType1, inCType2, outCType );
-#endif
+    /** Create the filter for all dimensions and output types. */
+    filter = itktools::ToolDispatch< ITKToolsBinaryImageOperatorBase,
+      ITKToolsBinaryImageOperatorByOutputType,
+      itktools::SupportedDimensions, itktools::ScalarComponentTypes >
+      ::New( dim, inCType1, inCType2, outCType );
+
     /** Check if filter was instantiated. */
     bool supported = itktools::IsFilterSupportedCheck( filter, dim, inCType1, inCType2, outCType );
     if( !supported ) return EXIT_FAILURE;
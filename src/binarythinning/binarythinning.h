@@ -19,6 +19,7 @@
 #define __binarythinning_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImageFileReader.h"
 #include "itkBinaryThinningImageFilter.h"
@@ -80,6 +81,7 @@ public:
     /** Read in the input images. */
     typename ReaderType::Pointer reader = ReaderType::New();
     reader->SetFileName( this->m_InputFileName );
+    itktools::ReuseImageIO( reader, this->m_InputFileName );
 
     /** Thin the image. */
     typename FilterType::Pointer filter = FilterType::New();
@@ -89,6 +91,7 @@ public:
     typename WriterType::Pointer writer = WriterType::New();
     writer->SetFileName( this->m_OutputFileName );
     writer->SetInput( filter->GetOutput() );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
@@ -29,17 +29,7 @@
 #include "ITKToolsBase.h"
 
 #include "itkImageFileReader.h"
-#include "itkBinaryThresholdImageFilter.h"
-#include "itkImageRegionIteratorWithIndex.h"
-#include "itkDisplacementFieldJacobianDeterminantFilter.h"
-#include "itkDeformationFieldBendingEnergyFilter.h"
-#include "itkLabelStatisticsImageFilter.h"
-#include "itkStatisticsImageFilter.h"
-#include "itkUnaryFunctorImageFilter.h"
-#include "itkCropImageFilter.h"
-#include "itkRegionOfInterestImageFilter.h"
-#include "itkIntensityWindowingImageFilter.h"
-#include "itkLogImageFilter.h"
+#include "itkDeformationFieldLabelStatisticsFilter.h"
 #include "vnl/vnl_math.h"
 #include <fstream>
 
@@ -169,57 +159,6 @@ int main( int argc, char ** argv )
 
 //------------------------------------------------------------------
 
-/* Function that does (x-b)^2 */
-namespace itk
-{
-  namespace Function {
-
-  template< class TInput, class TOutput = TInput>
-  class SubtractSquare
-  {
-  public:
-    typedef typename NumericTraits<TInput>::RealType RealType;
-
-    SubtractSquare()
-    {
-      this->m_ScalarToSubtract = itk::NumericTraits<RealType>::Zero;
-    }
-    ~SubtractSquare() {}
-
-    bool operator!=( const SubtractSquare & ) const
-    {
-      return false;
-    }
-
-    bool operator==( const SubtractSquare & other ) const
-    {
-      return !(*this != other);
-    }
-
-    void SetScalarToSubtract( RealType scalar )
-    {
-      this->m_ScalarToSubtract = scalar;
-    }
-    RealType GetScalarToSubtract( void )
-    {
-      return this->m_ScalarToSubtract;
-    }
-
-    inline TOutput operator()( const TInput & A )
-    {
-      const RealType ra = static_cast<RealType>( A ) - this->m_ScalarToSubtract;
-      return static_cast<TOutput>( ra * ra );
-    }
-  protected:
-    RealType m_ScalarToSubtract;
-
-  }; // end class
-
-  } // end Function namespace
-} // end itk namespace
-
-//---------------------------------------------------------------------
-
 /* write a vector of doubles to an ostream */
 std::ostream& operator<<(std::ostream& os, std::vector<double>& vec)
 {
@@ -245,156 +184,46 @@ void ComputeBrainDistance(
   const unsigned int Dimension = 3;
   typedef itk::Vector<InputComponentType, Dimension>      InputPixelType;
   typedef unsigned char                                   MaskPixelType;
-  typedef float                                           InternalPixelType;
 
   typedef itk::Image< InputPixelType, Dimension >         InputImageType;
   typedef itk::Image< MaskPixelType, Dimension >          MaskImageType;
-  typedef itk::Image< InternalPixelType, Dimension >      InternalImageType;
 
   typedef itk::ImageFileReader< InputImageType >          InputReaderType;
   typedef itk::ImageFileReader< MaskImageType >           MaskReaderType;
 
-  typedef itk::ImageRegionIteratorWithIndex<
-    InputImageType >                                      IteratorType;
-  typedef InputImageType::IndexType                       IndexType;
-  typedef InputImageType::PointType                       PointType;
-  typedef InputImageType::RegionType                      RegionType;
-  typedef RegionType::SizeType                            SizeType;
-
-  typedef itk::DisplacementFieldJacobianDeterminantFilter<
-    InputImageType, InternalPixelType, InternalImageType> JacobianFilterType;
-  typedef itk::DeformationFieldBendingEnergyFilter<
-    InputImageType, InternalPixelType, InternalImageType> BendingEnergyFilterType;
-
-  typedef itk::BinaryThresholdImageFilter<
-    MaskImageType, MaskImageType >                        ThresholderType;
-  typedef itk::LabelStatisticsImageFilter<
-    InternalImageType, MaskImageType >                    StatFilterType;
-  typedef itk::StatisticsImageFilter< MaskImageType >     MaximumComputerType;
-
-  typedef itk::RegionOfInterestImageFilter<
-    InternalImageType, InternalImageType >                JacobianCropFilterType;
-  typedef itk::RegionOfInterestImageFilter<
-    MaskImageType, MaskImageType >                        MaskCropFilterType;
-
-  typedef itk::Function::SubtractSquare<
-    InternalPixelType >                                   SubtractSquareFunctionType;
-  typedef itk::UnaryFunctorImageFilter<
-    InternalImageType, InternalImageType,
-     SubtractSquareFunctionType >                         SubtractSquareFilterType;
-
-  typedef itk::IntensityWindowingImageFilter<
-    InternalImageType, InternalImageType >                WindowFilterType;
-  typedef itk::LogImageFilter<
-    InternalImageType, InternalImageType >                LogFilterType;
+  typedef itk::DeformationFieldLabelStatisticsFilter<
+    InputImageType, MaskImageType >                       StatFilterType;
 
   /** Instantiate main variables */
   InputReaderType::Pointer inputReader = InputReaderType::New();
-  InputImageType::Pointer inputImage = 0;
   MaskReaderType::Pointer maskReader = MaskReaderType::New();
-  MaskCropFilterType::Pointer maskCropFilter = MaskCropFilterType::New();
-  MaskImageType::Pointer labelMask = 0;
-  MaskImageType::Pointer brainMask = 0;
-  InternalImageType::Pointer jacobian = 0;
-  JacobianCropFilterType::Pointer jacobianCropFilter = JacobianCropFilterType::New();
-  ThresholderType::Pointer thresholder = ThresholderType::New();
-  StatFilterType::Pointer statFilterBrainMask = StatFilterType::New();
-  StatFilterType::Pointer statFilterLabels = StatFilterType::New();
-  StatFilterType::Pointer statFilterLabelsSpecial = StatFilterType::New();
-  MaximumComputerType::Pointer maximumComputer  = MaximumComputerType::New();
-  SubtractSquareFilterType::Pointer subsqFilter = SubtractSquareFilterType::New();
-  WindowFilterType::Pointer windowFilter = WindowFilterType::New();
-  LogFilterType::Pointer logFilter = LogFilterType::New();
-
-  /** method 0 or 1 */
-  JacobianFilterType::Pointer jacobianFilter = 0;
-  if( method==0 || method ==2 )
-  {
-    jacobianFilter = JacobianFilterType::New();
-  }
-  else
-  {
-    jacobianFilter = BendingEnergyFilterType::New();
-  }
+  StatFilterType::Pointer statFilter = StatFilterType::New();
 
-  /** Read image. */
-  std::cout << "Reading input image..." << std::endl;
+  /** Setup the readers. */
   inputReader->SetFileName( inputFileName );
-  inputImage = inputReader->GetOutput();
-  inputImage->Update();
-
-  /** Compute the 'jacobian' (or bending energy) and crop */
-  std::cout << "Computing jacobian image..." << std::endl;
-  jacobianFilter->SetUseImageSpacingOn();
-  jacobianFilter->SetInput( inputImage );
-  jacobianFilter->UpdateLargestPossibleRegion();
-  RegionType oldregion = jacobianFilter->GetOutput()->GetLargestPossibleRegion();
-  SizeType oldsize = oldregion.GetSize();
-  IndexType oldindex = oldregion.GetIndex();
-  RegionType newregion;
-  SizeType newsize;
-  IndexType newindex;
-  for( unsigned int d = 0; d < Dimension; ++d)
-  {
-    newsize[d] = oldsize[d] - 2;
-    newindex[d] = oldindex[d] + 1;
-  }
-  newregion.SetIndex( newindex);
-  newregion.SetSize( newsize );
-  jacobianCropFilter->SetRegionOfInterest( newregion );
-  jacobianCropFilter->SetInput( jacobianFilter->GetOutput() );
-  jacobianCropFilter->Update();
-
-  const double maxJac = 3.0;
-  if( method ==2 )
-  {
-    /** Clamp and take log */
-    windowFilter->SetInput( jacobianCropFilter->GetOutput() );
-    windowFilter->SetOutputMinimum( 1.0 / maxJac );
-    windowFilter->SetWindowMinimum( 1.0 / maxJac );
-    windowFilter->SetOutputMaximum( maxJac );
-    windowFilter->SetWindowMaximum( maxJac );
-    logFilter->SetInput( windowFilter->GetOutput() );
-    logFilter->Update();
-    jacobian = logFilter->GetOutput();
-  }
-  else
-  {
-    /** Do nothing */
-    jacobian = jacobianCropFilter->GetOutput();
-  }
-
-  /** Read the label mask and crop */
-  std::cout << "Reading label mask image..." << std::endl;
   maskReader->SetFileName( maskFileName );
-  maskReader->Update();
-  maskCropFilter->SetRegionOfInterest( newregion );
-  maskCropFilter->SetInput( maskReader->GetOutput() );
-  labelMask = maskCropFilter->GetOutput();
-  labelMask->Update();
-
-  /** Generate brain mask by thresholding at 0 (assumes Hammer atlas) */
-  std::cout << "Thresholding label image..." << std::endl;
-  thresholder->SetLowerThreshold( itk::NumericTraits<MaskPixelType>::Zero );
-  thresholder->SetUpperThreshold( itk::NumericTraits<MaskPixelType>::Zero );
-  thresholder->SetInsideValue( itk::NumericTraits<MaskPixelType>::Zero );
-  thresholder->SetOutsideValue( itk::NumericTraits<MaskPixelType>::One );
-  thresholder->SetInput( labelMask );
-  brainMask = thresholder->GetOutput();
-  brainMask->Update();
-
-  /** Compute mu_tot and sigma_tot over brain mask */
-  std::cout << "Compute mu_tot and sigma_tot over entire brain..."  << std::endl;
-  statFilterBrainMask->SetInput( jacobian );
-  statFilterBrainMask->SetLabelInput( brainMask );
-  statFilterBrainMask->UseHistogramsOff();
-  statFilterBrainMask->Update();
+
+  /** Compute the 'jacobian' (or bending energy, or log(jacobian))
+   * and accumulate its moments for all labels in a single pass. The
+   * border voxels of the field are excluded from the statistics.
+   */
+  std::cout << "Computing jacobian statistics per label..." << std::endl;
+  statFilter->SetInput( inputReader->GetOutput() );
+  statFilter->SetLabelInput( maskReader->GetOutput() );
+  statFilter->SetUseImageSpacing( true );
+  statFilter->SetMeasure( method );
+  statFilter->SetMaximumJacobian( 3.0 );
+  statFilter->Update();
+
+  /** Compute mu_tot and sigma_tot over brain mask, which consists of
+   * all nonzero labels (assumes Hammer atlas).
+   */
   double mu_tot = 0.0;
   double sigma_tot = 0.0;
-  if( statFilterBrainMask->HasLabel( 1 ) )
+  if( statFilter->GetForegroundCount() > 0 )
   {
-    mu_tot = statFilterBrainMask->GetMean(1);
-    sigma_tot = statFilterBrainMask->GetSigma(1);
+    mu_tot = statFilter->GetForegroundMean();
+    sigma_tot = statFilter->GetForegroundSigma();
   }
   else
   {
@@ -402,59 +231,27 @@ void ComputeBrainDistance(
       << "does not contain any 1's" );
   }
 
-  /** Compute maximum label nr */
-  std::cout << "Compute maximum label nr..." << std::endl;
-  maximumComputer->SetInput( labelMask );
-  maximumComputer->Update();
-  MaskPixelType maxLabelNr = maximumComputer->GetMaximum();
-
-  /** Compute mean_i and sigma_i for each segment_i */
-  std::cout << "Compute mu_i and sigma_i for each brain segment_i in the "
-    << "label image..."  << std::endl;
-  statFilterLabels->SetInput( jacobian );
-  statFilterLabels->SetLabelInput( labelMask );
-  statFilterLabels->UseHistogramsOff();
-  statFilterLabels->Update();
+  /** Compute mu_i, sigma_i and sigma_i,tot = sqrt[ mean[ ( jacobian - mu_tot )^2 ] ]
+   * for each segment_i.
+   */
+  const MaskPixelType maxLabelNr = statFilter->GetMaximumLabel();
   std::vector<double> mu_i( maxLabelNr + 1, 0.0);
   std::vector<double> sigma_i( maxLabelNr + 1, 0.0);
-  for ( MaskPixelType i = 0; i <= maxLabelNr; ++i )
+  std::vector<double> sigma_itot( maxLabelNr + 1, 0.0);
+  for( unsigned int i = 0; i <= maxLabelNr; ++i )
   {
-    if( statFilterLabels->HasLabel( i ) )
+    const MaskPixelType label = static_cast<MaskPixelType>( i );
+    if( statFilter->HasLabel( label ) )
     {
-      mu_i[ i ] = statFilterLabels->GetMean( i );
-      sigma_i[ i ] = statFilterLabels->GetSigma( i );
+      mu_i[ i ] = statFilter->GetMean( label );
+      sigma_i[ i ] = statFilter->GetSigma( label );
+      sigma_itot[ i ] = statFilter->GetRootMeanSquaredDeviation( label, mu_tot );
     }
     else
     {
       /** Some bogus value which will never occur */
       mu_i[ i ] = -1000.0;
       sigma_i[ i ] = -1000.0;
-    }
-  }
-
-  /** Compute (Jac - mu_tot)^2 image */
-  std::cout << "Compute ( jacobian - mu_tot )^2... " << std::endl;
-  subsqFilter->GetFunctor().SetScalarToSubtract( mu_tot );
-  subsqFilter->SetInput( jacobian );
-  subsqFilter->Update();
-
-  /** Compute sigma_i,tot for each segment_i */
-  std::cout << "Compute sigma_i,tot = sqrt[ mean[ ( jacobian - mu_tot )^2 ] ] "
-    << "per segment_i... " << std::endl;
-  statFilterLabelsSpecial->SetInput( subsqFilter->GetOutput() );
-  statFilterLabelsSpecial->SetLabelInput( labelMask );
-  statFilterLabelsSpecial->UseHistogramsOff();
-  statFilterLabelsSpecial->Update();
-  std::vector<double> sigma_itot( maxLabelNr + 1, 0.0);
-  for ( MaskPixelType i = 0; i <= maxLabelNr; ++i )
-  {
-    if( statFilterLabelsSpecial->HasLabel( i ) )
-    {
-      sigma_itot[ i ] = vcl_sqrt( statFilterLabelsSpecial->GetMean( i ) );
-    }
-    else
-    {
-      /** Some bogus value which will never occur */
       sigma_itot[ i ] = -1000.0;
     }
   }
@@ -0,0 +1,186 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkDeformationFieldLabelStatisticsFilter_h_
+#define __itkDeformationFieldLabelStatisticsFilter_h_
+
+#include "itkImageToImageFilter.h"
+#include "itkImage.h"
+#include "itkVector.h"
+#include <vector>
+
+namespace itk
+{
+/** \class DeformationFieldLabelStatisticsFilter
+ *
+ * \brief Computes per-label statistics of a scalar measure derived from
+ * a deformation field, in a single multi-threaded pass.
+ *
+ * For every voxel of the field that is not on the image border the
+ * measure is evaluated directly from the neighbouring field vectors:
+ * - JACOBIAN: the determinant of the spatial Jacobian of the transformation;
+ * - BENDINGENERGY: the sum of all squared second order derivatives,
+ *   identical to DeformationFieldBendingEnergyFilter;
+ * - LOGJACOBIAN: the log of the Jacobian determinant, clamped to
+ *   [ 1 / MaximumJacobian, MaximumJacobian ] before taking the log.
+ *
+ * The measure is not stored. Instead, count, sum and sum of squares are
+ * accumulated for each label of the label input (input 1) in one table
+ * per thread, which are merged after the threads have finished. Labels
+ * are therefore required to be of a non-negative integral type.
+ * The foreground statistics are the statistics over all nonzero labels.
+ *
+ * The border voxels are skipped, which is equal to the crop that was
+ * previously applied to the full Jacobian image, so that all neighbours
+ * can be addressed with fixed buffer offsets.
+ *
+ * Like StatisticsImageFilter this filter passes its input through to
+ * its output.
+ *
+ * \sa DisplacementFieldJacobianDeterminantFilter
+ * \sa DeformationFieldBendingEnergyFilter
+ * \sa LabelStatisticsImageFilter
+ */
+template < typename TInputImage, typename TLabelImage >
+class ITK_EXPORT DeformationFieldLabelStatisticsFilter :
+  public ImageToImageFilter< TInputImage, TInputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef DeformationFieldLabelStatisticsFilter       Self;
+  typedef ImageToImageFilter< TInputImage, TInputImage > Superclass;
+  typedef SmartPointer<Self>                          Pointer;
+  typedef SmartPointer<const Self>                    ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods) */
+  itkTypeMacro( DeformationFieldLabelStatisticsFilter, ImageToImageFilter );
+
+  /** Image typedef support */
+  typedef TInputImage                               InputImageType;
+  typedef typename InputImageType::PixelType        InputPixelType;
+  typedef typename InputImageType::RegionType       RegionType;
+  typedef typename InputImageType::SizeType         SizeType;
+  typedef typename InputImageType::IndexType        IndexType;
+  typedef typename InputImageType::OffsetValueType  OffsetValueType;
+  typedef TLabelImage                               LabelImageType;
+  typedef typename LabelImageType::PixelType        LabelPixelType;
+
+  /** The dimensionality of the input image. */
+  itkStaticConstMacro( ImageDimension, unsigned int,
+    TInputImage::ImageDimension );
+
+  /** The measures that can be computed. */
+  enum MeasureType { JACOBIAN = 0, BENDINGENERGY = 1, LOGJACOBIAN = 2 };
+
+  /** The moments accumulated per label. */
+  struct LabelMomentsType
+  {
+    LabelMomentsType() : m_Count( 0 ), m_Sum( 0.0 ), m_SumOfSquares( 0.0 ) {}
+    SizeValueType m_Count;
+    double        m_Sum;
+    double        m_SumOfSquares;
+  };
+  typedef std::vector< LabelMomentsType >           LabelMomentsContainerType;
+
+  /** Set/Get the label input image. */
+  void SetLabelInput( const LabelImageType * input );
+  const LabelImageType * GetLabelInput( void ) const;
+
+  /** Set/Get the measure to compute. Default JACOBIAN. */
+  itkSetMacro( Measure, unsigned int );
+  itkGetConstMacro( Measure, unsigned int );
+
+  /** Set/Get the clamp value of the LOGJACOBIAN measure. Default 3.0. */
+  itkSetMacro( MaximumJacobian, double );
+  itkGetConstMacro( MaximumJacobian, double );
+
+  /** Set/Get whether the image spacing is used in the derivatives. Default on. */
+  itkSetMacro( UseImageSpacing, bool );
+  itkGetConstMacro( UseImageSpacing, bool );
+  itkBooleanMacro( UseImageSpacing );
+
+  /** Get the largest label encountered. */
+  itkGetConstMacro( MaximumLabel, LabelPixelType );
+
+  /** Does the label occur in the evaluated region. */
+  bool HasLabel( LabelPixelType label ) const;
+
+  /** Get the statistics of one label. */
+  SizeValueType GetCount( LabelPixelType label ) const;
+  double GetMean( LabelPixelType label ) const;
+  double GetSigma( LabelPixelType label ) const;
+
+  /** Get sqrt( mean( ( measure - reference )^2 ) ) within one label,
+   * computed from the accumulated moments.
+   */
+  double GetRootMeanSquaredDeviation(
+    LabelPixelType label, double reference ) const;
+
+  /** Get the statistics over all nonzero labels. */
+  SizeValueType GetForegroundCount( void ) const;
+  double GetForegroundMean( void ) const;
+  double GetForegroundSigma( void ) const;
+
+protected:
+  DeformationFieldLabelStatisticsFilter();
+  virtual ~DeformationFieldLabelStatisticsFilter() {}
+
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Pass the input through to the output. */
+  virtual void AllocateOutputs( void );
+
+  /** Both inputs are needed completely. */
+  virtual void GenerateInputRequestedRegion( void );
+  virtual void EnlargeOutputRequestedRegion( DataObject * data );
+
+  /** Multi-threaded accumulation. */
+  virtual void BeforeThreadedGenerateData( void );
+  virtual void ThreadedGenerateData(
+    const RegionType & outputRegionForThread, ThreadIdType threadId );
+  virtual void AfterThreadedGenerateData( void );
+
+  /** Compute mean and sigma from a set of moments. */
+  static double ComputeMean( const LabelMomentsType & moments );
+  static double ComputeSigma( const LabelMomentsType & moments );
+
+private:
+  DeformationFieldLabelStatisticsFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );                        // purposely not implemented
+
+  unsigned int    m_Measure;
+  double          m_MaximumJacobian;
+  bool            m_UseImageSpacing;
+  LabelPixelType  m_MaximumLabel;
+
+  /** One table per thread, merged into m_LabelMoments. */
+  std::vector< LabelMomentsContainerType >  m_ThreadLabelMoments;
+  LabelMomentsContainerType                 m_LabelMoments;
+  LabelMomentsType                          m_ForegroundMoments;
+
+}; // end class DeformationFieldLabelStatisticsFilter
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkDeformationFieldLabelStatisticsFilter.txx"
+#endif
+
+#endif // end #ifndef __itkDeformationFieldLabelStatisticsFilter_h_
@@ -0,0 +1,521 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkDeformationFieldLabelStatisticsFilter_txx_
+#define __itkDeformationFieldLabelStatisticsFilter_txx_
+
+#include "itkDeformationFieldLabelStatisticsFilter.h"
+
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include "vnl/vnl_math.h"
+#include "vnl/vnl_det.h"
+#include "vnl/vnl_matrix_fixed.h"
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template < typename TInputImage, typename TLabelImage >
+DeformationFieldLabelStatisticsFilter< TInputImage, TLabelImage >
+::DeformationFieldLabelStatisticsFilter()
+{
+  this->SetNumberOfRequiredInputs( 2 );
+  this->m_Measure = JACOBIAN;
+  this->m_MaximumJacobian = 3.0;
+  this->m_UseImageSpacing = true;
+  this->m_MaximumLabel = NumericTraits<LabelPixelType>::Zero;
+
+} // end Constructor
+
+
+/**
+ * ******************* SetLabelInput *******************
+ */
+
+template < typename TInputImage, typename TLabelImage >
+void
+DeformationFieldLabelStatisticsFilter< TInputImage, TLabelImage >
+::SetLabelInput( const LabelImageType * input )
+{
+  this->SetNthInput( 1, const_cast< LabelImageType * >( input ) );
+
+} // end SetLabelInput()
+
+
+/**
+ * ******************* GetLabelInput *******************
+ */
+
+template < typename TInputImage, typename TLabelImage >
+const typename DeformationFieldLabelStatisticsFilter< TInputImage, TLabelImage >::LabelImageType *
+DeformationFieldLabelStatisticsFilter< TInputImage, TLabelImage >
+::GetLabelInput( void ) const
+{
+  return static_cast< const LabelImageType * >( this->ProcessObject::GetInput( 1 ) );
+
+} // end GetLabelInput()
+
+
+/**
+ * ******************* AllocateOutputs *******************
+ */
+
+template < typename TInputImage, typename TLabelImage >
+void
+DeformationFieldLabelStatisticsFilter< TInputImage, TLabelImage >
+::AllocateOutputs( void )
+{
+  /** Pass the input through as the output. */
+  typename InputImageType::Pointer image
+    = const_cast< InputImageType * >( this->GetInput() );
+  this->GraftOutput( image );
+
+} // end AllocateOutputs()
+
+
+/**
+ * ******************* GenerateInputRequestedRegion *******************
+ */
+
+template < typename TInputImage, typename TLabelImage >
+void
+DeformationFieldLabelStatisticsFilter< TInputImage, TLabelImage >
+::GenerateInputRequestedRegion( void )
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType * input = const_cast< InputImageType * >( this->GetInput() );
+  if( input )
+  {
+    input->SetRequestedRegionToLargestPossibleRegion();
+  }
+  LabelImageType * labels = const_cast< LabelImageType * >( this->GetLabelInput() );
+  if( labels )
+  {
+    labels->SetRequestedRegionToLargestPossibleRegion();
+  }
+
+} // end GenerateInputRequestedRegion()
+
+
+/**
+ * ******************* EnlargeOutputRequestedRegion *******************
+ */
+
+template < typename TInputImage, typename TLabelImage >
+void
+DeformationFieldLabelStatisticsFilter< TInputImage, TLabelImage >
+::EnlargeOutputRequestedRegion( DataObject * data )
+{
+  Superclass::EnlargeOutputRequestedRegion( data );
+  data->SetRequestedRegionToLargestPossibleRegion();
+
+} // end EnlargeOutputRequestedRegion()
+
+
+/**
+ * ******************* BeforeThreadedGenerateData *******************
+ */
+
+template < typename TInputImage, typename TLabelImage >
+void
+DeformationFieldLabelStatisticsFilter< TInputImage, TLabelImage >
+::BeforeThreadedGenerateData( void )
+{
+  const InputImageType * input = this->GetInput();
+  const LabelImageType * labels = this->GetLabelInput();
+
+  /** The label image is addressed with the offsets of the field. */
+  if( input->GetBufferedRegion() != labels->GetBufferedRegion() )
+  {
+    itkExceptionMacro( << "ERROR: the label image and the deformation field "
+      << "should have the same size." );
+  }
+
+  /** Every thread gets its own label table. */
+  const ThreadIdType numberOfThreads = this->GetNumberOfThreads();
+  this->m_ThreadLabelMoments.clear();
+  this->m_ThreadLabelMoments.resize( numberOfThreads );
+  this->m_LabelMoments.clear();
+  this->m_ForegroundMoments = LabelMomentsType();
+  this->m_MaximumLabel = NumericTraits<LabelPixelType>::Zero;
+
+} // end BeforeThreadedGenerateData()
+
+
+/**
+ * ******************* ThreadedGenerateData *******************
+ */
+
+template < typename TInputImage, typename TLabelImage >
+void
+DeformationFieldLabelStatisticsFilter< TInputImage, TLabelImage >
+::ThreadedGenerateData( const RegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  const unsigned int Dimension = ImageDimension;
+  const unsigned int VectorDimension = InputPixelType::Dimension;
+  typedef vnl_matrix_fixed< double, VectorDimension, Dimension > JacobianType;
+
+  const InputImageType * input = this->GetInput();
+  const LabelImageType * labels = this->GetLabelInput();
+  LabelMomentsContainerType & table = this->m_ThreadLabelMoments[ threadId ];
+
+  /** Skip the border voxels, so that all neighbours are inside the buffer. */
+  const RegionType & largestRegion = input->GetLargestPossibleRegion();
+  RegionType innerRegion = largestRegion;
+  for( unsigned int i = 0; i < Dimension; ++i )
+  {
+    if( largestRegion.GetSize( i ) < 3 ) return;
+    innerRegion.SetIndex( i, largestRegion.GetIndex( i ) + 1 );
+    innerRegion.SetSize( i, largestRegion.GetSize( i ) - 2 );
+  }
+  RegionType region = outputRegionForThread;
+  if( !region.Crop( innerRegion ) ) return;
+
+  /** Derivative weights and buffer strides. */
+  double halfWeights[ Dimension ];
+  OffsetValueType strides[ Dimension ];
+  const OffsetValueType * offsetTable = input->GetOffsetTable();
+  for( unsigned int i = 0; i < Dimension; ++i )
+  {
+    halfWeights[ i ] = 0.5;
+    if( this->m_UseImageSpacing )
+    {
+      halfWeights[ i ] /= input->GetSpacing()[ i ];
+    }
+    strides[ i ] = offsetTable[ i ];
+  }
+
+  const double minJac = 1.0 / this->m_MaximumJacobian;
+  const double maxJac = this->m_MaximumJacobian;
+  const SizeValueType lineLength = region.GetSize( 0 );
+  const InputPixelType * inputBuffer = input->GetBufferPointer();
+  const LabelPixelType * labelBuffer = labels->GetBufferPointer();
+
+  /** Walk the region line by line; within a line use raw pointers. */
+  typedef ImageLinearConstIteratorWithIndex< LabelImageType > LineIteratorType;
+  LineIteratorType lineIt( labels, region );
+  lineIt.SetDirection( 0 );
+  lineIt.GoToBegin();
+  while( !lineIt.IsAtEnd() )
+  {
+    const OffsetValueType lineOffset = input->ComputeOffset( lineIt.GetIndex() );
+    const InputPixelType * p = inputBuffer + lineOffset;
+    const LabelPixelType * l = labelBuffer + lineOffset;
+
+    for( SizeValueType x = 0; x < lineLength; ++x, ++p, ++l )
+    {
+      double value = 0.0;
+      if( this->m_Measure == BENDINGENERGY )
+      {
+        /** Same discretisation as DeformationFieldBendingEnergyFilter. */
+        for( unsigned int i = 0; i < Dimension; ++i )
+        {
+          const InputPixelType & next = *( p + strides[ i ] );
+          const InputPixelType & prev = *( p - strides[ i ] );
+          double sq = 0.0;
+          for( unsigned int k = 0; k < VectorDimension; ++k )
+          {
+            const double d = static_cast<double>( next[ k ] )
+              + static_cast<double>( prev[ k ] ) - 2.0 * static_cast<double>( (*p)[ k ] );
+            sq += d * d;
+          }
+          value += sq * vcl_pow( halfWeights[ i ], static_cast<int>( 4 ) );
+        }
+        for( unsigned int i = 0; i < Dimension; ++i )
+        {
+          for( unsigned int j = i + 1; j < Dimension; ++j )
+          {
+            const InputPixelType & pp = *( p + strides[ i ] + strides[ j ] );
+            const InputPixelType & qq = *( p - strides[ i ] - strides[ j ] );
+            const InputPixelType & rr = *( p + strides[ i ] - strides[ j ] );
+            const InputPixelType & ss = *( p - strides[ i ] + strides[ j ] );
+            double sq = 0.0;
+            for( unsigned int k = 0; k < VectorDimension; ++k )
+            {
+              const double d = static_cast<double>( pp[ k ] ) + static_cast<double>( qq[ k ] )
+                - static_cast<double>( rr[ k ] ) - static_cast<double>( ss[ k ] );
+              sq += d * d;
+            }
+            value += 2.0 * sq * vnl_math_sqr( halfWeights[ i ] * halfWeights[ j ] );
+          }
+        }
+      }
+      else
+      {
+        /** Jacobian of the transformation x + u(x), central differences. */
+        JacobianType jac;
+        for( unsigned int i = 0; i < Dimension; ++i )
+        {
+          const InputPixelType & next = *( p + strides[ i ] );
+          const InputPixelType & prev = *( p - strides[ i ] );
+          for( unsigned int k = 0; k < VectorDimension; ++k )
+          {
+            jac( k, i ) = halfWeights[ i ] * ( static_cast<double>( next[ k ] )
+              - static_cast<double>( prev[ k ] ) );
+          }
+          if( i < VectorDimension ) jac( i, i ) += 1.0;
+        }
+        value = vnl_det( jac );
+
+        if( this->m_Measure == LOGJACOBIAN )
+        {
+          value = vcl_log( vnl_math_min( vnl_math_max( value, minJac ), maxJac ) );
+        }
+      }
+
+      /** Accumulate in the table of this thread. */
+      const std::size_t label = static_cast<std::size_t>( *l );
+      if( label >= table.size() ) table.resize( label + 1 );
+      LabelMomentsType & moments = table[ label ];
+      ++moments.m_Count;
+      moments.m_Sum += value;
+      moments.m_SumOfSquares += value * value;
+    }
+
+    lineIt.NextLine();
+  }
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * ******************* AfterThreadedGenerateData *******************
+ */
+
+template < typename TInputImage, typename TLabelImage >
+void
+DeformationFieldLabelStatisticsFilter< TInputImage, TLabelImage >
+::AfterThreadedGenerateData( void )
+{
+  /** Merge the thread tables. */
+  for( std::size_t t = 0; t < this->m_ThreadLabelMoments.size(); ++t )
+  {
+    const LabelMomentsContainerType & table = this->m_ThreadLabelMoments[ t ];
+    if( table.size() > this->m_LabelMoments.size() )
+    {
+      this->m_LabelMoments.resize( table.size() );
+    }
+    for( std::size_t label = 0; label < table.size(); ++label )
+    {
+      this->m_LabelMoments[ label ].m_Count += table[ label ].m_Count;
+      this->m_LabelMoments[ label ].m_Sum += table[ label ].m_Sum;
+      this->m_LabelMoments[ label ].m_SumOfSquares += table[ label ].m_SumOfSquares;
+    }
+  }
+  this->m_ThreadLabelMoments.clear();
+
+  /** Foreground moments and the largest label present. */
+  for( std::size_t label = 0; label < this->m_LabelMoments.size(); ++label )
+  {
+    const LabelMomentsType & moments = this->m_LabelMoments[ label ];
+    if( moments.m_Count == 0 ) continue;
+    this->m_MaximumLabel = static_cast<LabelPixelType>( label );
+    if( label == 0 ) continue;
+    this->m_ForegroundMoments.m_Count += moments.m_Count;
+    this->m_ForegroundMoments.m_Sum += moments.m_Sum;
+    this->m_ForegroundMoments.m_SumOfSquares += moments.m_SumOfSquares;
+  }
+
+} // end AfterThreadedGenerateData()
+
+
+/**
+ * ******************* HasLabel *******************
+ */
+
+template < typename TInputImage, typename TLabelImage >
+bool
+DeformationFieldLabelStatisticsFilter< TInputImage, TLabelImage >
+::HasLabel( LabelPixelType label ) const
+{
+  return this->GetCount( label ) > 0;
+
+} // end HasLabel()
+
+
+/**
+ * ******************* GetCount *******************
+ */
+
+template < typename TInputImage, typename TLabelImage >
+SizeValueType
+DeformationFieldLabelStatisticsFilter< TInputImage, TLabelImage >
+::GetCount( LabelPixelType label ) const
+{
+  const std::size_t l = static_cast<std::size_t>( label );
+  if( l >= this->m_LabelMoments.size() ) return 0;
+  return this->m_LabelMoments[ l ].m_Count;
+
+} // end GetCount()
+
+
+/**
+ * ******************* GetMean *******************
+ */
+
+template < typename TInputImage, typename TLabelImage >
+double
+DeformationFieldLabelStatisticsFilter< TInputImage, TLabelImage >
+::GetMean( LabelPixelType label ) const
+{
+  if( !this->HasLabel( label ) ) return 0.0;
+  return ComputeMean( this->m_LabelMoments[ static_cast<std::size_t>( label ) ] );
+
+} // end GetMean()
+
+
+/**
+ * ******************* GetSigma *******************
+ */
+
+template < typename TInputImage, typename TLabelImage >
+double
+DeformationFieldLabelStatisticsFilter< TInputImage, TLabelImage >
+::GetSigma( LabelPixelType label ) const
+{
+  if( !this->HasLabel( label ) ) return 0.0;
+  return ComputeSigma( this->m_LabelMoments[ static_cast<std::size_t>( label ) ] );
+
+} // end GetSigma()
+
+
+/**
+ * ******************* GetRootMeanSquaredDeviation *******************
+ */
+
+template < typename TInputImage, typename TLabelImage >
+double
+DeformationFieldLabelStatisticsFilter< TInputImage, TLabelImage >
+::GetRootMeanSquaredDeviation( LabelPixelType label, double reference ) const
+{
+  if( !this->HasLabel( label ) ) return 0.0;
+  const LabelMomentsType & moments
+    = this->m_LabelMoments[ static_cast<std::size_t>( label ) ];
+
+  /** mean( (v-r)^2 ) = mean( v^2 ) - 2 r mean( v ) + r^2 */
+  const double n = static_cast<double>( moments.m_Count );
+  const double msd = moments.m_SumOfSquares / n
+    - 2.0 * reference * moments.m_Sum / n + reference * reference;
+  return vcl_sqrt( vnl_math_max( msd, 0.0 ) );
+
+} // end GetRootMeanSquaredDeviation()
+
+
+/**
+ * ******************* GetForegroundCount *******************
+ */
+
+template < typename TInputImage, typename TLabelImage >
+SizeValueType
+DeformationFieldLabelStatisticsFilter< TInputImage, TLabelImage >
+::GetForegroundCount( void ) const
+{
+  return this->m_ForegroundMoments.m_Count;
+
+} // end GetForegroundCount()
+
+
+/**
+ * ******************* GetForegroundMean *******************
+ */
+
+template < typename TInputImage, typename TLabelImage >
+double
+DeformationFieldLabelStatisticsFilter< TInputImage, TLabelImage >
+::GetForegroundMean( void ) const
+{
+  return ComputeMean( this->m_ForegroundMoments );
+
+} // end GetForegroundMean()
+
+
+/**
+ * ******************* GetForegroundSigma *******************
+ */
+
+template < typename TInputImage, typename TLabelImage >
+double
+DeformationFieldLabelStatisticsFilter< TInputImage, TLabelImage >
+::GetForegroundSigma( void ) const
+{
+  return ComputeSigma( this->m_ForegroundMoments );
+
+} // end GetForegroundSigma()
+
+
+/**
+ * ******************* ComputeMean *******************
+ */
+
+template < typename TInputImage, typename TLabelImage >
+double
+DeformationFieldLabelStatisticsFilter< TInputImage, TLabelImage >
+::ComputeMean( const LabelMomentsType & moments )
+{
+  if( moments.m_Count == 0 ) return 0.0;
+  return moments.m_Sum / static_cast<double>( moments.m_Count );
+
+} // end ComputeMean()
+
+
+/**
+ * ******************* ComputeSigma *******************
+ */
+
+template < typename TInputImage, typename TLabelImage >
+double
+DeformationFieldLabelStatisticsFilter< TInputImage, TLabelImage >
+::ComputeSigma( const LabelMomentsType & moments )
+{
+  /** Unbiased estimate, as in LabelStatisticsImageFilter. */
+  if( moments.m_Count < 2 ) return 0.0;
+  const double n = static_cast<double>( moments.m_Count );
+  const double variance
+    = ( moments.m_SumOfSquares - moments.m_Sum * moments.m_Sum / n ) / ( n - 1.0 );
+  return vcl_sqrt( vnl_math_max( variance, 0.0 ) );
+
+} // end ComputeSigma()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template < typename TInputImage, typename TLabelImage >
+void
+DeformationFieldLabelStatisticsFilter< TInputImage, TLabelImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Measure: " << this->m_Measure << std::endl;
+  os << indent << "MaximumJacobian: " << this->m_MaximumJacobian << std::endl;
+  os << indent << "UseImageSpacing: " << this->m_UseImageSpacing << std::endl;
+  os << indent << "MaximumLabel: "
+    << static_cast< typename NumericTraits<LabelPixelType>::PrintType >(
+      this->m_MaximumLabel ) << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef __itkDeformationFieldLabelStatisticsFilter_txx_
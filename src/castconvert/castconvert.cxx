@@ -198,6 +198,7 @@ int main( int argc, char **argv )
   /** Get image information. */
   std::string inputFileName = "";
   std::string inputDirectoryName = "";
+  std::vector<std::string> dicomFileNames;
   unsigned int dim = 0;
   if( !isDICOM )
   {
@@ -211,7 +212,7 @@ int main( int argc, char **argv )
     std::string fileNameOfFirstDICOMImage = "";
     std::string errorMessage = "";
     bool allOK = GetFileNameFromDICOMDirectory(
-      inputDirectoryName, fileNameOfFirstDICOMImage,
+      inputDirectoryName, fileNameOfFirstDICOMImage, dicomFileNames,
       seriesUID, restrictions, errorMessage );
     if( !allOK )
     {
@@ -266,6 +267,7 @@ int main( int argc, char **argv )
     castConvert->m_InputDirectoryName = inputDirectoryName;
     castConvert->m_DICOMSeriesUID = seriesUID;
     castConvert->m_DICOMSeriesRestrictions = restrictions;
+    castConvert->m_DICOMFileNames = dicomFileNames;
 
     castConvert->Run();
 
@@ -20,6 +20,8 @@
 
 #include "ITKToolsBase.h"
 #include "ITKToolsHelpers.h"
+#include "ITKToolsDICOMIndex.h"
+#include "ITKToolsTiming.h"
 #include <iostream>
 
 /** Basic Image support. */
@@ -34,7 +36,6 @@
 
 /** DICOM headers. */
 #include "itkGDCMImageIO.h"
-#include "itkGDCMSeriesFileNames.h"
 
 /** One of these is used to cast the image. */
 #include "itkCastImageFilter.h"
@@ -76,6 +77,8 @@ public:
   std::string m_InputDirectoryName;
   std::string m_DICOMSeriesUID;
   std::vector<std::string> m_DICOMSeriesRestrictions;
+  /** The ordered files of the series, when already known. */
+  std::vector<std::string> m_DICOMFileNames;
 
 }; // end class ITKToolsCastConvertBase
 
@@ -110,6 +113,7 @@ public:
     /** Create and setup the reader. */
     typename ImageReaderType::Pointer reader = ImageReaderType::New();
     reader->SetFileName( this->m_InputFileName.c_str() );
+    itktools::ReuseImageIO( reader, this->m_InputFileName );
     reader->Update();
 
     // Create the disassembler
@@ -134,6 +138,7 @@ public:
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetUseCompression( this->m_UseCompression );
     writer->SetInput( castImageFilter->GetOutput() );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
@@ -172,21 +177,20 @@ public:
 
     /** Typedef DICOM stuff. */
     typedef itk::GDCMImageIO                  GDCMImageIOType;
-    typedef itk::GDCMSeriesFileNames          GDCMNamesGeneratorType;
     typedef std::vector< std::string >        FileNamesContainerType;
 
     /** Create the DICOM ImageIO. */
     typename GDCMImageIOType::Pointer dicomIO = GDCMImageIOType::New();
 
-    /** Get a list of the filenames of the 2D input DICOM images. */
-    GDCMNamesGeneratorType::Pointer nameGenerator = GDCMNamesGeneratorType::New();
-    nameGenerator->SetUseSeriesDetails( true );
-    for( unsigned int i = 0; i < this->m_DICOMSeriesRestrictions.size(); ++i )
+    /** Get a list of the filenames of the 2D input DICOM images,
+     * unless main already did.
+     */
+    FileNamesContainerType fileNames = this->m_DICOMFileNames;
+    if( fileNames.empty() )
     {
-      nameGenerator->AddSeriesRestriction( this->m_DICOMSeriesRestrictions[ i ] );
+      itktools::GetDICOMSeriesFileNames( this->m_InputDirectoryName,
+        this->m_DICOMSeriesRestrictions, this->m_DICOMSeriesUID, fileNames );
     }
-    nameGenerator->SetInputDirectory( this->m_InputDirectoryName.c_str() );
-    FileNamesContainerType fileNames = nameGenerator->GetFileNames( this->m_DICOMSeriesUID );
 
     /** Create and setup the seriesReader. */
     typename SeriesReaderType::Pointer seriesReader = SeriesReaderType::New();
@@ -204,6 +208,7 @@ public:
     writer->SetInput(  caster->GetOutput()  );
 
     /**  Do the actual  conversion.  */
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
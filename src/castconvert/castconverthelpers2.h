@@ -19,7 +19,7 @@
 #define __castconverthelpers2_h_
 
 #include <itksys/SystemTools.hxx>
-#include "itkGDCMSeriesFileNames.h"
+#include "ITKToolsDICOMIndex.h"
 
 
 // NOTE that these functions can not be moved to castconverthelpers.h,
@@ -62,49 +62,24 @@ bool IsDICOM( std::string & input, bool & isDICOM )
 bool GetFileNameFromDICOMDirectory(
   const std::string & inputDirectoryName,
   std::string & fileName,
+  std::vector<std::string> & fileNames,
   const std::string & seriesUID,
   const std::vector<std::string> & restrictions,
   std::string & errorMessage )
 {
-  typedef itk::GDCMSeriesFileNames                GDCMNamesGeneratorType;
   typedef std::vector< std::string >              FileNamesContainerType;
 
-  /** Create vector of filenames from the DICOM directory. */
-  GDCMNamesGeneratorType::Pointer nameGenerator = GDCMNamesGeneratorType::New();
-  nameGenerator->SetUseSeriesDetails( true );
-  for( unsigned int i = 0; i < restrictions.size(); ++i )
-  {
-    nameGenerator->AddSeriesRestriction( restrictions[ i ] );
-  }
-  nameGenerator->SetInputDirectory( inputDirectoryName.c_str() );
-
-  /** The short and fast way. */
-  FileNamesContainerType fileNames;
-  if( seriesUID == "" )
-  {
-    fileNames = nameGenerator->GetInputFileNames();
-    if( fileNames.size() != 0 )
-    {
-      fileName = fileNames[ 0 ];
-      return true;
-    }
-    else
-    {
-      std::cerr << "ERROR: No files found in this directory." << std::endl;
-      return false;
-    }
-  }
-
-  /** Get all series in this directory. */
-  FileNamesContainerType seriesNames = nameGenerator->GetSeriesUIDs();
+  /** Get the files of the series and all series in this directory,
+   * with a single scan of the directory.
+   */
+  FileNamesContainerType seriesNames;
+  itktools::GetDICOMSeriesFileNames(
+    inputDirectoryName, restrictions, seriesUID, fileNames, seriesNames );
   if( !seriesNames.size() )
   {
     errorMessage = "ERROR: no DICOM series in directory " + inputDirectoryName + ".";
     return false;
   }
-
-  /** Get a list of files in series. */
-  fileNames = nameGenerator->GetFileNames( seriesUID );
   if( !fileNames.size() )
   {
     errorMessage = "ERROR: no DICOM series " + seriesUID
@@ -19,6 +19,7 @@
 #define __changeimageinformation_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImageFileReader.h"
 #include "itkChangeInformationImageFilter.h"
@@ -89,6 +90,7 @@ public:
 
     /** Setup and update readers. */
     readerIn->SetFileName( this->m_InputFileName );
+    itktools::ReuseImageIO( readerIn, this->m_InputFileName );
     readerRef->SetFileName( this->m_ReferenceFileName );
     readerIn->Update();
     readerRef->Update();
@@ -102,6 +104,7 @@ public:
     /** Set up writer. */
     writer->SetFileName( this->m_OutputFileName );
     writer->SetInput( changeFilter->GetOutput() );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
@@ -19,6 +19,7 @@
 #define __combinesegmentations_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include <string>
 #include <vector>
@@ -208,6 +209,7 @@ public:
       typename LabelImageReaderType::Pointer labelImageReader =
         LabelImageReaderType::New();
       labelImageReader->SetFileName( this->m_InputSegmentationFileNames[ i ].c_str() );
+      itktools::AddTimingObservers( labelImageReader );
       labelImageReader->Update();
 
       /** Check size. */
@@ -230,6 +232,7 @@ public:
           LabelPixelType labout = static_cast<LabelPixelType>( this->m_OutValues[lab] );
           relabeler->SetChange( labin, labout );
         }
+        itktools::AddTimingObservers( relabeler );
         relabeler->Update();
         labelImageArray[ i ] = relabeler->GetOutput();
       } // end relabel
@@ -249,6 +252,7 @@ public:
         typename ProbImageReaderType::Pointer probImageReader =
           ProbImageReaderType::New();
         probImageReader->SetFileName( this->m_PriorProbImageFileNames[ i ].c_str() );
+        itktools::AddTimingObservers( probImageReader );
         probImageReader->Update();
         priorProbImageArray[ i ] = probImageReader->GetOutput();
       }
@@ -283,6 +287,7 @@ public:
         staple->SetConfidenceWeight( this->m_PriorProbs[1] );
       }
       std::cout << "Performing STAPLE algorithm..." << std::endl;
+      itktools::AddTimingObservers( staple );
       staple->Update();
       std::cout << "Done performing STAPLE algorithm." << std::endl;
       std::cout << "NumberOfIterations = " << staple->GetElapsedIterations() << std::endl;
@@ -296,6 +301,7 @@ public:
       inverter->SetMaximum( itk::NumericTraits<ProbPixelType>::One );
       inverter->SetInput( softSegmentationArray[1] );
       std::cout << "Generating soft segmentation for class 0..." << std::endl;
+      itktools::AddTimingObservers( inverter );
       inverter->Update();
       std::cout << "Done generating soft segmentation for class 0..." << std::endl;
       softSegmentationArray[0] = inverter->GetOutput();
@@ -313,6 +319,7 @@ public:
         thresholder->SetOutsideValue( itk::NumericTraits<LabelPixelType>::Zero );
         thresholder->SetInput( softSegmentationArray[0] );
         std::cout << "Generating hard segmentation..." << std::endl;
+        itktools::AddTimingObservers( thresholder );
         thresholder->Update();
         std::cout << "Done generating hard segmentation." << std::endl;
         hardSegmentation = thresholder->GetOutput();
@@ -364,6 +371,7 @@ public:
       std::cout << "TerminationUpdateThreshold = " << this->m_TerminationThreshold << std::endl;
       multistaple->SetTerminationUpdateThreshold( this->m_TerminationThreshold );
       std::cout << "Performing MULTISTAPLE algorithm..." << std::endl;
+      itktools::AddTimingObservers( multistaple );
       multistaple->Update();
       std::cout << "Done performing MULTISTAPLE algorithm." << std::endl;
       std::cout
@@ -429,6 +437,7 @@ public:
         dilater->SetBackgroundValue( itk::NumericTraits<MaskPixelType>::Zero );
         dilater->SetInput( maskGenerator->GetOutput() );
         std::cout << "Creating mask (this->m_MaskDilationRadius = " << this->m_MaskDilationRadius << ")..." << std::endl;
+        itktools::AddTimingObservers( dilater );
         dilater->Update();
         multistaple2->SetMaskImage( dilater->GetOutput() );
         std::cout << "Done creating mask." << std::endl;
@@ -489,6 +498,7 @@ public:
 
       /** Run!! */
       std::cout << "Performing " << this->m_CombinationMethod << " algorithm..." << std::endl;
+      itktools::AddTimingObservers( multistaple2 );
       multistaple2->Update();
       std::cout << "Done performing " << this->m_CombinationMethod << " algorithm." << std::endl;
       if( this->m_PriorProbImageFileNames.size() != this->m_NumberOfClasses )
@@ -576,6 +586,7 @@ public:
         dilater->SetInput( maskGenerator->GetOutput() );
         std::cout << "Creating mask (this->m_MaskDilationRadius = "
           << this->m_MaskDilationRadius << ")..." << std::endl;
+        itktools::AddTimingObservers( dilater );
         dilater->Update();
         voting->SetMaskImage( dilater->GetOutput() );
         std::cout << "Done creating mask." << std::endl;
@@ -612,6 +623,7 @@ public:
 
       /** Run!! */
       std::cout << "Performing VOTE algorithm..." << std::endl;
+      itktools::AddTimingObservers( voting );
       voting->Update();
       std::cout << "Done performing VOTE algorithm." << std::endl;
 
@@ -681,6 +693,7 @@ public:
         {
           softWriter->SetInput( softSegmentationArray[ i ] );
           softWriter->SetUseCompression( this->m_UseCompression );
+          itktools::AddTimingObservers( softWriter );
           softWriter->Update();
         }
       }
@@ -698,6 +711,7 @@ public:
         hardWriter->SetInput( hardSegmentation );
         hardWriter->SetUseCompression( this->m_UseCompression );
         std::cout << "Writing hard segmentation..." << std::endl;
+        itktools::AddTimingObservers( hardWriter );
         hardWriter->Update();
         std::cout << "Done writing hard segmentation." << std::endl;
       }
@@ -714,6 +728,7 @@ public:
         confusionWriter->SetInput( confusionMatrixImage );
         confusionWriter->SetUseCompression( this->m_UseCompression );
         std::cout << "Writing confusion matrix image..." << std::endl;
+        itktools::AddTimingObservers( confusionWriter );
         confusionWriter->Update();
         std::cout << "Done writing confusion matrix image..." << std::endl;
       }
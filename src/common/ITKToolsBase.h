@@ -18,6 +18,9 @@
 #ifndef __ITKToolsBase_h_
 #define __ITKToolsBase_h_
 
+#include "itkImageIOBase.h"
+#include <limits>
+
 
 namespace itktools
 {
@@ -87,6 +90,296 @@ public:
 
 }; // end class ITKToolsBase()
 
+
+/** Compile-time type lists, used to generate the dispatch from the
+ * run-time dimension and component types to a template instantiation,
+ * instead of writing out every combination in main().
+ */
+struct NullType {};
+
+template< class THead, class TTail = NullType >
+struct TypeList
+{
+  typedef THead Head;
+  typedef TTail Tail;
+};
+
+/** Remove a type from a type list, to prune rarely used combinations. */
+template< class TList, class TRemove >
+struct TypeListRemove
+{
+  typedef TypeList< typename TList::Head,
+    typename TypeListRemove< typename TList::Tail, TRemove >::Type > Type;
+};
+
+template< class TTail, class TRemove >
+struct TypeListRemove< TypeList< TRemove, TTail >, TRemove >
+{
+  typedef typename TypeListRemove< TTail, TRemove >::Type Type;
+};
+
+template< class TRemove >
+struct TypeListRemove< NullType, TRemove >
+{
+  typedef NullType Type;
+};
+
+/** A dimension as a type, to put it in a type list. */
+template< unsigned int VDimension >
+struct Dimension
+{
+  itkStaticConstMacro( Value, unsigned int, VDimension );
+};
+
+/** The dimensions that are compiled in. */
+#if defined( ITKTOOLS_3D_SUPPORT ) && defined( ITKTOOLS_4D_SUPPORT )
+typedef TypeList< Dimension<2>, TypeList< Dimension<3>, TypeList< Dimension<4> > > > SupportedDimensions;
+#elif defined( ITKTOOLS_3D_SUPPORT )
+typedef TypeList< Dimension<2>, TypeList< Dimension<3> > >                           SupportedDimensions;
+#elif defined( ITKTOOLS_4D_SUPPORT )
+typedef TypeList< Dimension<2>, TypeList< Dimension<4> > >                           SupportedDimensions;
+#else
+typedef TypeList< Dimension<2> >                                                     SupportedDimensions;
+#endif
+
+/** Common lists of component types. */
+typedef TypeList< char, TypeList< unsigned char, TypeList< short, TypeList< unsigned short,
+  TypeList< int, TypeList< unsigned int, TypeList< long, TypeList< unsigned long > > > > > > > >
+                                                      IntegerComponentTypes;
+typedef TypeList< float, TypeList< double > >        RealComponentTypes;
+typedef TypeList< char, TypeList< unsigned char, TypeList< short, TypeList< unsigned short,
+  TypeList< int, TypeList< unsigned int, TypeList< long, TypeList< unsigned long,
+  TypeList< float, TypeList< double > > > > > > > > > >  ScalarComponentTypes;
+
+
+/** \class ToolDispatch
+ *
+ * Creates the tool for the run-time dimension and component types,
+ * trying TTool< D, T >::New() for all D in TDimensions and all T in
+ * TComponentTypes. TTool is the tool class, or a small adapter for
+ * tools with more template arguments, and should have a static New()
+ * that returns NULL for a non-matching combination, as defined by the
+ * itktools*TypeNewMacro's. Only the New() overload that is used gets
+ * instantiated. Typical use:
+ *
+ *   filter = itktools::ToolDispatch< ITKToolsFooBase, ITKToolsFoo,
+ *     itktools::SupportedDimensions, itktools::ScalarComponentTypes >
+ *     ::New( dim, componentType );
+ */
+template< class TBase, template< unsigned int, class > class TTool,
+  class TDimensions, class TComponentTypes, class TAllComponentTypes = TComponentTypes >
+struct ToolDispatch
+{
+  itkStaticConstMacro( ImageDimension, unsigned int, TDimensions::Head::Value );
+  typedef TTool< ImageDimension, typename TComponentTypes::Head > CurrentTool;
+  typedef ToolDispatch< TBase, TTool, TDimensions,
+    typename TComponentTypes::Tail, TAllComponentTypes >      NextType;
+  typedef ToolDispatch< TBase, TTool, typename TDimensions::Tail,
+    TAllComponentTypes, TAllComponentTypes >                  NextDimension;
+
+  static TBase * New( unsigned int dim,
+    itk::ImageIOBase::IOComponentType componentType )
+  {
+    if( dim != ImageDimension ) return NextDimension::New( dim, componentType );
+    TBase * tool = CurrentTool::New( dim, componentType );
+    return tool ? tool : NextType::New( dim, componentType );
+  }
+
+  static TBase * New( unsigned int dim,
+    itk::ImageIOBase::IOComponentType componentType1,
+    itk::ImageIOBase::IOComponentType componentType2 )
+  {
+    if( dim != ImageDimension ) return NextDimension::New( dim, componentType1, componentType2 );
+    TBase * tool = CurrentTool::New( dim, componentType1, componentType2 );
+    return tool ? tool : NextType::New( dim, componentType1, componentType2 );
+  }
+
+  static TBase * New( unsigned int dim,
+    itk::ImageIOBase::IOComponentType componentType1,
+    itk::ImageIOBase::IOComponentType componentType2,
+    itk::ImageIOBase::IOComponentType componentType3 )
+  {
+    if( dim != ImageDimension ) return NextDimension::New( dim, componentType1, componentType2, componentType3 );
+    TBase * tool = CurrentTool::New( dim, componentType1, componentType2, componentType3 );
+    return tool ? tool : NextType::New( dim, componentType1, componentType2, componentType3 );
+  }
+};
+
+/** End of the component types of a dimension: continue with the next dimension. */
+template< class TBase, template< unsigned int, class > class TTool,
+  class TDimensions, class TAllComponentTypes >
+struct ToolDispatch< TBase, TTool, TDimensions, NullType, TAllComponentTypes >
+{
+  typedef ToolDispatch< TBase, TTool, typename TDimensions::Tail,
+    TAllComponentTypes, TAllComponentTypes >                  NextDimension;
+
+  static TBase * New( unsigned int dim, itk::ImageIOBase::IOComponentType ct )
+  {
+    return NextDimension::New( dim, ct );
+  }
+  static TBase * New( unsigned int dim, itk::ImageIOBase::IOComponentType ct1,
+    itk::ImageIOBase::IOComponentType ct2 )
+  {
+    return NextDimension::New( dim, ct1, ct2 );
+  }
+  static TBase * New( unsigned int dim, itk::ImageIOBase::IOComponentType ct1,
+    itk::ImageIOBase::IOComponentType ct2, itk::ImageIOBase::IOComponentType ct3 )
+  {
+    return NextDimension::New( dim, ct1, ct2, ct3 );
+  }
+};
+
+/** End of the dimensions: the combination is not supported. */
+template< class TBase, template< unsigned int, class > class TTool,
+  class TComponentTypes, class TAllComponentTypes >
+struct ToolDispatch< TBase, TTool, NullType, TComponentTypes, TAllComponentTypes >
+{
+  static TBase * New( unsigned int, itk::ImageIOBase::IOComponentType )
+  {
+    return 0;
+  }
+  static TBase * New( unsigned int, itk::ImageIOBase::IOComponentType,
+    itk::ImageIOBase::IOComponentType )
+  {
+    return 0;
+  }
+  static TBase * New( unsigned int, itk::ImageIOBase::IOComponentType,
+    itk::ImageIOBase::IOComponentType, itk::ImageIOBase::IOComponentType )
+  {
+    return 0;
+  }
+};
+
+/** Resolves the ambiguity of the two specializations above. */
+template< class TBase, template< unsigned int, class > class TTool, class TAllComponentTypes >
+struct ToolDispatch< TBase, TTool, NullType, NullType, TAllComponentTypes >
+{
+  static TBase * New( unsigned int, itk::ImageIOBase::IOComponentType )
+  {
+    return 0;
+  }
+  static TBase * New( unsigned int, itk::ImageIOBase::IOComponentType,
+    itk::ImageIOBase::IOComponentType )
+  {
+    return 0;
+  }
+  static TBase * New( unsigned int, itk::ImageIOBase::IOComponentType,
+    itk::ImageIOBase::IOComponentType, itk::ImageIOBase::IOComponentType )
+  {
+    return 0;
+  }
+};
+
+/** Can all values of TFrom be represented by TTo. */
+template< class TFrom, class TTo >
+bool ValuesFitIn( void )
+{
+  typedef std::numeric_limits<TFrom> FromLimits;
+  typedef std::numeric_limits<TTo>   ToLimits;
+  if( !FromLimits::is_integer )
+  {
+    return !ToLimits::is_integer && FromLimits::digits <= ToLimits::digits
+      && FromLimits::max_exponent <= ToLimits::max_exponent;
+  }
+  if( !ToLimits::is_integer )
+  {
+    return FromLimits::digits <= ToLimits::digits;
+  }
+  return ( !FromLimits::is_signed || ToLimits::is_signed )
+    && FromLimits::digits <= ToLimits::digits;
+
+} // end ValuesFitIn()
+
+
+/** Can all values of the run-time component type be represented by T. */
+template< class T >
+bool ComponentTypeFitsIn( itk::ImageIOBase::IOComponentType componentType )
+{
+  switch( componentType )
+  {
+  case itk::ImageIOBase::UCHAR:  return ValuesFitIn< unsigned char, T >();
+  case itk::ImageIOBase::CHAR:   return ValuesFitIn< char, T >();
+  case itk::ImageIOBase::USHORT: return ValuesFitIn< unsigned short, T >();
+  case itk::ImageIOBase::SHORT:  return ValuesFitIn< short, T >();
+  case itk::ImageIOBase::UINT:   return ValuesFitIn< unsigned int, T >();
+  case itk::ImageIOBase::INT:    return ValuesFitIn< int, T >();
+  case itk::ImageIOBase::ULONG:  return ValuesFitIn< unsigned long, T >();
+  case itk::ImageIOBase::LONG:   return ValuesFitIn< long, T >();
+  case itk::ImageIOBase::FLOAT:  return ValuesFitIn< float, T >();
+  case itk::ImageIOBase::DOUBLE: return ValuesFitIn< double, T >();
+  default: return false;
+  }
+
+} // end ComponentTypeFitsIn()
+
+
+/** \class ReadComponentType
+ *
+ * Read-time casting, to prune the instantiations of a tool: the tool is
+ * only instantiated for a short list of component types, and a file of
+ * another component type is read as the first type in the list that
+ * holds all of its values, e.g. unsigned char as short. The reader
+ * casts while reading. Order the list from small to large types.
+ * Get() returns the component type itself when it is in the list, and
+ * when no type in the list can hold it, so that the dispatch reports it
+ * as not supported. Typical use:
+ *
+ *   typedef TypeList< short, TypeList< int > > ReadTypes;
+ *   componentType = itktools::ReadComponentType< ReadTypes >::Get( componentType );
+ *   filter = itktools::ToolDispatch< ITKToolsFooBase, ITKToolsFoo,
+ *     itktools::SupportedDimensions, ReadTypes >::New( dim, componentType );
+ */
+template< class TComponentTypes >
+struct ReadComponentType
+{
+  typedef typename TComponentTypes::Head                Head;
+  typedef ReadComponentType< typename TComponentTypes::Tail > Next;
+
+  static bool Contains( itk::ImageIOBase::IOComponentType componentType )
+  {
+    return componentType == itk::ImageIOBase::MapPixelType< Head >::CType
+      || Next::Contains( componentType );
+  }
+
+  static itk::ImageIOBase::IOComponentType FirstFit(
+    itk::ImageIOBase::IOComponentType componentType )
+  {
+    if( ComponentTypeFitsIn< Head >( componentType ) )
+    {
+      return itk::ImageIOBase::MapPixelType< Head >::CType;
+    }
+    return Next::FirstFit( componentType );
+  }
+
+  static itk::ImageIOBase::IOComponentType Get(
+    itk::ImageIOBase::IOComponentType componentType )
+  {
+    if( Contains( componentType ) ) return componentType;
+    const itk::ImageIOBase::IOComponentType fit = FirstFit( componentType );
+    return fit != itk::ImageIOBase::UNKNOWNCOMPONENTTYPE ? fit : componentType;
+  }
+};
+
+/** End of the list. */
+template<>
+struct ReadComponentType< NullType >
+{
+  static bool Contains( itk::ImageIOBase::IOComponentType )
+  {
+    return false;
+  }
+  static itk::ImageIOBase::IOComponentType FirstFit( itk::ImageIOBase::IOComponentType )
+  {
+    return itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
+  }
+};
+
+/** The component types of label images, for tools that read labels
+ * with casting: 16 bit types for small labels, 32 bit types otherwise.
+ */
+typedef TypeList< short, TypeList< unsigned short,
+  TypeList< int, TypeList< unsigned int > > > >      LabelComponentTypes;
+
 } // end namespace itktools
 
 #endif //__ITKToolsBase_h_
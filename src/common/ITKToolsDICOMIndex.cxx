@@ -0,0 +1,736 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#include "ITKToolsDICOMIndex.h"
+
+#include "itkMultiThreader.h"
+#include "gdcmScanner.h"
+#include "gdcmTag.h"
+#include <itksys/SystemTools.hxx>
+#include <itksys/Directory.hxx>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#if defined( _WIN32 )
+#include <process.h>
+#define itktoolsGetPID _getpid
+#else
+#include <unistd.h>
+#define itktoolsGetPID getpid
+#endif
+
+
+namespace itktools
+{
+
+namespace
+{
+
+/** The first line of an index file; change the version when the layout changes. */
+const char * const DICOMIndexHeader = "# ITKTools DICOM index 2";
+
+/** The tags that are always stored, in this order.
+ * The first six make up the series identifier, see CreateSeriesIdentifier().
+ */
+const unsigned int NumberOfDefaultTags = 9;
+const unsigned short DefaultTags[ NumberOfDefaultTags ][ 2 ] = {
+  { 0x0020, 0x000e },   // series instance UID
+  { 0x0020, 0x0011 },   // series number
+  { 0x0018, 0x0024 },   // sequence name
+  { 0x0018, 0x0050 },   // slice thickness
+  { 0x0028, 0x0010 },   // rows
+  { 0x0028, 0x0011 },   // columns
+  { 0x0020, 0x0032 },   // image position patient
+  { 0x0020, 0x0037 },   // image orientation patient
+  { 0x0020, 0x0013 } }; // instance number
+
+enum { SeriesUIDTag = 0, RowsTag = 4, ColumnsTag = 5,
+  PositionTag = 6, OrientationTag = 7, InstanceNumberTag = 8 };
+
+/** The information stored for one file. */
+struct DICOMIndexEntry
+{
+  DICOMIndexEntry() : ModifiedTime( 0 ), FileSize( 0 ), IsDICOM( false ) {}
+  long                      ModifiedTime;
+  unsigned long             FileSize;
+  bool                      IsDICOM;
+  std::vector<std::string>  Values; // one per index tag
+};
+
+/** File name (without directory) to entry. */
+typedef std::map< std::string, DICOMIndexEntry >  DICOMIndexType;
+typedef std::vector< gdcm::Tag >                  TagListType;
+
+
+/**
+ * ******************* TagToString *******************
+ */
+
+std::string TagToString( const gdcm::Tag & tag )
+{
+  char buffer[ 16 ];
+  sprintf( buffer, "%04x|%04x", tag.GetGroup(), tag.GetElement() );
+  return buffer;
+
+} // end TagToString()
+
+
+/**
+ * ******************* StringToTag *******************
+ */
+
+bool StringToTag( const std::string & arg, gdcm::Tag & tag )
+{
+  unsigned int group = 0, element = 0;
+  if( sscanf( arg.c_str(), "%x|%x", &group, &element ) != 2 ) return false;
+  tag = gdcm::Tag( static_cast<uint16_t>( group ), static_cast<uint16_t>( element ) );
+  return true;
+
+} // end StringToTag()
+
+
+/**
+ * ******************* CleanValue *******************
+ */
+
+std::string CleanValue( const char * value )
+{
+  if( value == NULL ) return "";
+
+  /** Strip DICOM padding and characters that would break the index layout. */
+  std::string cleaned( value );
+  std::string::size_type end = cleaned.find_last_not_of( std::string( " \0", 2 ) );
+  cleaned.erase( end == std::string::npos ? 0 : end + 1 );
+  std::replace( cleaned.begin(), cleaned.end(), '\t', ' ' );
+  std::replace( cleaned.begin(), cleaned.end(), '\n', ' ' );
+  std::replace( cleaned.begin(), cleaned.end(), '\r', ' ' );
+  return cleaned;
+
+} // end CleanValue()
+
+
+/**
+ * ******************* StringToNumbers *******************
+ */
+
+std::vector<double> StringToNumbers( const std::string & value )
+{
+  std::string copy( value );
+  std::replace( copy.begin(), copy.end(), '\\', ' ' );
+  std::istringstream iss( copy );
+  std::vector<double> numbers;
+  double number;
+  while( iss >> number ) numbers.push_back( number );
+  return numbers;
+
+} // end StringToNumbers()
+
+
+/**
+ * ******************* ReadDICOMIndex *******************
+ */
+
+bool ReadDICOMIndex( const std::string & indexFileName,
+  const std::string & directoryName, TagListType & tags, DICOMIndexType & index )
+{
+  std::ifstream file( indexFileName.c_str() );
+  if( !file.is_open() ) return false;
+
+  std::string line;
+  if( !std::getline( file, line ) || line != DICOMIndexHeader ) return false;
+
+  /** The directory, since different directories may share an index file name. */
+  if( !std::getline( file, line ) || line != "directory " + directoryName ) return false;
+
+  /** The tag list. */
+  if( !std::getline( file, line ) ) return false;
+  std::istringstream tagStream( line );
+  std::string word;
+  tagStream >> word;
+  if( word != "tags" ) return false;
+  tags.clear();
+  while( tagStream >> word )
+  {
+    gdcm::Tag tag;
+    if( !StringToTag( word, tag ) ) return false;
+    tags.push_back( tag );
+  }
+
+  /** The entries: name, time, size, isdicom, values, tab separated. */
+  index.clear();
+  while( std::getline( file, line ) )
+  {
+    std::vector<std::string> fields;
+    std::string::size_type begin = 0;
+    std::string::size_type pos = 0;
+    while( ( pos = line.find( '\t', begin ) ) != std::string::npos )
+    {
+      fields.push_back( line.substr( begin, pos - begin ) );
+      begin = pos + 1;
+    }
+    fields.push_back( line.substr( begin ) );
+    if( fields.size() != 4 + tags.size() ) return false;
+
+    DICOMIndexEntry & entry = index[ fields[ 0 ] ];
+    entry.ModifiedTime = atol( fields[ 1 ].c_str() );
+    entry.FileSize = strtoul( fields[ 2 ].c_str(), NULL, 10 );
+    entry.IsDICOM = fields[ 3 ] == "1";
+    entry.Values.assign( fields.begin() + 4, fields.end() );
+  }
+
+  return true;
+
+} // end ReadDICOMIndex()
+
+
+/**
+ * ******************* WriteDICOMIndex *******************
+ */
+
+bool WriteDICOMIndex( const std::string & indexFileName,
+  const std::string & directoryName, const TagListType & tags, const DICOMIndexType & index )
+{
+  /** Write to a temporary file and move it in place, so that
+   * concurrent readers never see a partial index. The process id
+   * makes the name unique between processes, the counter between
+   * calls within a process.
+   */
+  static unsigned long counter = 0;
+  std::ostringstream tmpName;
+  tmpName << indexFileName << "." << itktoolsGetPID() << "." << counter++ << ".tmp";
+  std::ofstream file( tmpName.str().c_str(), std::ios::out | std::ios::trunc );
+  if( !file.is_open() ) return false;
+
+  file << DICOMIndexHeader << "\n" << "directory " << directoryName << "\n" << "tags";
+  for( unsigned int i = 0; i < tags.size(); ++i )
+  {
+    file << " " << TagToString( tags[ i ] );
+  }
+  file << "\n";
+
+  for( DICOMIndexType::const_iterator it = index.begin(); it != index.end(); ++it )
+  {
+    const DICOMIndexEntry & entry = it->second;
+    file << it->first << "\t" << entry.ModifiedTime << "\t" << entry.FileSize
+      << "\t" << ( entry.IsDICOM ? 1 : 0 );
+    for( unsigned int i = 0; i < tags.size(); ++i )
+    {
+      file << "\t" << ( i < entry.Values.size() ? entry.Values[ i ] : "" );
+    }
+    file << "\n";
+  }
+  file.close();
+  if( file.fail() )
+  {
+    std::remove( tmpName.str().c_str() );
+    return false;
+  }
+
+  if( std::rename( tmpName.str().c_str(), indexFileName.c_str() ) != 0 )
+  {
+    /** Some platforms do not replace an existing file. */
+    std::remove( indexFileName.c_str() );
+    if( std::rename( tmpName.str().c_str(), indexFileName.c_str() ) != 0 )
+    {
+      std::remove( tmpName.str().c_str() );
+      return false;
+    }
+  }
+
+  return true;
+
+} // end WriteDICOMIndex()
+
+
+/** Shared state of the threads that scan the headers. */
+struct DICOMScanStruct
+{
+  std::string                       DirectoryName;
+  TagListType                       Tags;
+  std::vector<std::string>          FileNames;
+  std::vector<DICOMIndexEntry *>    Entries;
+};
+
+
+/**
+ * ******************* DICOMScanThreaderCallback *******************
+ */
+
+ITK_THREAD_RETURN_TYPE DICOMScanThreaderCallback( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * info
+    = static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  const itk::ThreadIdType threadId = info->ThreadID;
+  const itk::ThreadIdType numberOfThreads = info->NumberOfThreads;
+  DICOMScanStruct * str = static_cast<DICOMScanStruct *>( info->UserData );
+
+  /** Every thread scans a contiguous part of the files with its own scanner. */
+  const std::size_t numberOfFiles = str->FileNames.size();
+  const std::size_t filesPerThread = ( numberOfFiles + numberOfThreads - 1 ) / numberOfThreads;
+  const std::size_t first = threadId * filesPerThread;
+  const std::size_t last = std::min( first + filesPerThread, numberOfFiles );
+  if( first >= last ) return ITK_THREAD_RETURN_VALUE;
+
+  gdcm::Scanner scanner;
+  for( unsigned int i = 0; i < str->Tags.size(); ++i )
+  {
+    scanner.AddTag( str->Tags[ i ] );
+  }
+  std::vector<std::string> paths;
+  for( std::size_t f = first; f < last; ++f )
+  {
+    paths.push_back( str->DirectoryName + "/" + str->FileNames[ f ] );
+  }
+  scanner.Scan( paths );
+
+  for( std::size_t f = first; f < last; ++f )
+  {
+    const char * path = paths[ f - first ].c_str();
+    DICOMIndexEntry * entry = str->Entries[ f ];
+    entry->IsDICOM = scanner.IsKey( path );
+    entry->Values.assign( str->Tags.size(), "" );
+    if( !entry->IsDICOM ) continue;
+    for( unsigned int i = 0; i < str->Tags.size(); ++i )
+    {
+      entry->Values[ i ] = CleanValue( scanner.GetValue( path, str->Tags[ i ] ) );
+    }
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end DICOMScanThreaderCallback()
+
+
+/**
+ * ******************* UpdateDICOMIndex *******************
+ */
+
+bool UpdateDICOMIndex( const std::string & directoryName,
+  const std::vector<std::string> & restrictions,
+  TagListType & tags, std::vector<unsigned int> & restrictionIndices,
+  DICOMIndexType & index )
+{
+  /** The required tags: the default ones and the restrictions. */
+  TagListType requiredTags;
+  for( unsigned int i = 0; i < NumberOfDefaultTags; ++i )
+  {
+    requiredTags.push_back( gdcm::Tag( DefaultTags[ i ][ 0 ], DefaultTags[ i ][ 1 ] ) );
+  }
+  for( unsigned int i = 0; i < restrictions.size(); ++i )
+  {
+    gdcm::Tag tag;
+    if( !StringToTag( restrictions[ i ], tag ) )
+    {
+      std::cerr << "ERROR: invalid DICOM restriction \"" << restrictions[ i ]
+        << "\", it should be of the form \"0020|0012\"." << std::endl;
+      return false;
+    }
+    requiredTags.push_back( tag );
+  }
+
+  /** Read the stored index. It can be reused if it contains all required tags. */
+  const std::string fullDirectoryName
+    = itksys::SystemTools::CollapseFullPath( directoryName.c_str() );
+  const std::string indexFileName = GetDICOMIndexFileName( fullDirectoryName );
+  DICOMIndexType storedIndex;
+  bool useStoredIndex = indexFileName != ""
+    && ReadDICOMIndex( indexFileName, fullDirectoryName, tags, storedIndex );
+  for( unsigned int i = 0; useStoredIndex && i < requiredTags.size(); ++i )
+  {
+    useStoredIndex = std::find( tags.begin(), tags.end(), requiredTags[ i ] ) != tags.end();
+  }
+  if( !useStoredIndex )
+  {
+    /** Keep the tags of the old index, so that alternating restrictions
+     * do not invalidate the index every time.
+     */
+    for( unsigned int i = 0; i < requiredTags.size(); ++i )
+    {
+      if( std::find( tags.begin(), tags.end(), requiredTags[ i ] ) == tags.end() )
+      {
+        tags.push_back( requiredTags[ i ] );
+      }
+    }
+    storedIndex.clear();
+  }
+  restrictionIndices.clear();
+  for( unsigned int i = NumberOfDefaultTags; i < requiredTags.size(); ++i )
+  {
+    restrictionIndices.push_back( static_cast<unsigned int>(
+      std::find( tags.begin(), tags.end(), requiredTags[ i ] ) - tags.begin() ) );
+  }
+
+  /** List the directory, and reuse the entries of unchanged files. */
+  itksys::Directory directory;
+  if( !directory.Load( directoryName.c_str() ) ) return false;
+
+  DICOMScanStruct str;
+  str.DirectoryName = directoryName;
+  str.Tags = tags;
+  index.clear();
+  for( unsigned long i = 0; i < directory.GetNumberOfFiles(); ++i )
+  {
+    const std::string name = directory.GetFile( i );
+    const std::string path = directoryName + "/" + name;
+    if( itksys::SystemTools::FileIsDirectory( path.c_str() ) ) continue;
+
+    DICOMIndexEntry & entry = index[ name ];
+    entry.ModifiedTime = itksys::SystemTools::ModifiedTime( path.c_str() );
+    entry.FileSize = itksys::SystemTools::FileLength( path.c_str() );
+
+    DICOMIndexType::const_iterator stored = storedIndex.find( name );
+    if( stored != storedIndex.end()
+      && stored->second.ModifiedTime == entry.ModifiedTime
+      && stored->second.FileSize == entry.FileSize )
+    {
+      entry.IsDICOM = stored->second.IsDICOM;
+      entry.Values = stored->second.Values;
+      continue;
+    }
+    str.FileNames.push_back( name );
+  }
+  /** Pointers into the map stay valid, since it is not modified anymore. */
+  for( unsigned int i = 0; i < str.FileNames.size(); ++i )
+  {
+    str.Entries.push_back( &index[ str.FileNames[ i ] ] );
+  }
+
+  /** Scan the new and changed files in parallel. */
+  if( !str.FileNames.empty() )
+  {
+    itk::ThreadIdType numberOfThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+    if( numberOfThreads > str.FileNames.size() )
+    {
+      numberOfThreads = static_cast<itk::ThreadIdType>( str.FileNames.size() );
+    }
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetNumberOfThreads( numberOfThreads );
+    threader->SetSingleMethod( DICOMScanThreaderCallback, &str );
+    threader->SingleMethodExecute();
+  }
+
+  /** Store the index if something changed. Failure is not an error,
+   * e.g. for a read-only cache directory.
+   */
+  if( indexFileName != ""
+    && ( !str.FileNames.empty() || index.size() != storedIndex.size() ) )
+  {
+    itksys::SystemTools::MakeDirectory(
+      itksys::SystemTools::GetFilenamePath( indexFileName ).c_str() );
+    WriteDICOMIndex( indexFileName, fullDirectoryName, tags, index );
+  }
+
+  return true;
+
+} // end UpdateDICOMIndex()
+
+
+/**
+ * ******************* CreateSeriesIdentifier *******************
+ */
+
+std::string CreateSeriesIdentifier( const DICOMIndexEntry & entry,
+  const std::vector<unsigned int> & restrictionIndices )
+{
+  /** As gdcm::SerieHelper::CreateUniqueSeriesIdentifier() with
+   * UseSeriesDetails: the series UID, series number, sequence name,
+   * slice thickness, rows, columns and the restrictions, separated by
+   * dots, keeping only dots and alphanumeric characters.
+   */
+  std::string id = entry.Values[ SeriesUIDTag ];
+  for( unsigned int i = 1; i <= ColumnsTag; ++i )
+  {
+    id += "." + entry.Values[ i ];
+  }
+  for( unsigned int i = 0; i < restrictionIndices.size(); ++i )
+  {
+    id += "." + entry.Values[ restrictionIndices[ i ] ];
+  }
+
+  std::string cleaned;
+  cleaned.reserve( id.size() );
+  for( std::string::size_type i = 0; i < id.size(); ++i )
+  {
+    const char c = id[ i ];
+    if( c == '.' || ( c >= 'a' && c <= 'z' )
+      || ( c >= 'A' && c <= 'Z' ) || ( c >= '0' && c <= '9' ) )
+    {
+      cleaned += c;
+    }
+  }
+  return cleaned;
+
+} // end CreateSeriesIdentifier()
+
+
+/** A file of a series with its sort key. */
+struct DICOMSortItem
+{
+  double      Key;
+  std::string FileName;
+  bool operator<( const DICOMSortItem & other ) const
+  {
+    return this->Key < other.Key;
+  }
+};
+
+
+/**
+ * ******************* OrderSeriesFileNames *******************
+ */
+
+void OrderSeriesFileNames( const DICOMIndexType & index,
+  const std::vector<std::string> & names, const std::string & directoryName,
+  std::vector<std::string> & fileNames )
+{
+  /** As gdcm::SerieHelper::OrderFileList(): by the distance along the
+   * slice normal, else by instance number, else by file name.
+   */
+  std::vector<DICOMSortItem> items( names.size() );
+  bool usePosition = names.size() > 1;
+  double normal[ 3 ] = { 0.0, 0.0, 0.0 };
+  for( std::size_t i = 0; usePosition && i < names.size(); ++i )
+  {
+    const DICOMIndexEntry & entry = index.find( names[ i ] )->second;
+    const std::vector<double> orientation = StringToNumbers( entry.Values[ OrientationTag ] );
+    const std::vector<double> position = StringToNumbers( entry.Values[ PositionTag ] );
+    if( orientation.size() != 6 || position.size() != 3 )
+    {
+      usePosition = false;
+      break;
+    }
+    if( i == 0 )
+    {
+      normal[ 0 ] = orientation[ 1 ] * orientation[ 5 ] - orientation[ 2 ] * orientation[ 4 ];
+      normal[ 1 ] = orientation[ 2 ] * orientation[ 3 ] - orientation[ 0 ] * orientation[ 5 ];
+      normal[ 2 ] = orientation[ 0 ] * orientation[ 4 ] - orientation[ 1 ] * orientation[ 3 ];
+    }
+    items[ i ].Key = normal[ 0 ] * position[ 0 ]
+      + normal[ 1 ] * position[ 1 ] + normal[ 2 ] * position[ 2 ];
+    items[ i ].FileName = directoryName + "/" + names[ i ];
+  }
+  if( usePosition )
+  {
+    std::stable_sort( items.begin(), items.end() );
+    usePosition = items.front().Key != items.back().Key;
+  }
+
+  bool useInstanceNumber = !usePosition && names.size() > 1;
+  for( std::size_t i = 0; useInstanceNumber && i < names.size(); ++i )
+  {
+    const DICOMIndexEntry & entry = index.find( names[ i ] )->second;
+    const std::vector<double> number = StringToNumbers( entry.Values[ InstanceNumberTag ] );
+    if( number.size() != 1 )
+    {
+      useInstanceNumber = false;
+      break;
+    }
+    items[ i ].Key = number[ 0 ];
+    items[ i ].FileName = directoryName + "/" + names[ i ];
+  }
+  if( useInstanceNumber )
+  {
+    std::stable_sort( items.begin(), items.end() );
+    useInstanceNumber = items.front().Key != items.back().Key;
+  }
+
+  fileNames.clear();
+  if( usePosition || useInstanceNumber )
+  {
+    for( std::size_t i = 0; i < items.size(); ++i )
+    {
+      fileNames.push_back( items[ i ].FileName );
+    }
+    return;
+  }
+
+  /** The names are sorted already, since they come from a map. */
+  for( std::size_t i = 0; i < names.size(); ++i )
+  {
+    fileNames.push_back( directoryName + "/" + names[ i ] );
+  }
+
+} // end OrderSeriesFileNames()
+
+
+/**
+ * ******************* GetDICOMSeries *******************
+ */
+
+typedef std::map< std::string, std::vector<std::string> > DICOMSeriesType;
+
+bool GetDICOMSeries( const std::string & directoryName,
+  const std::vector<std::string> & restrictions,
+  DICOMIndexType & index, DICOMSeriesType & series )
+{
+  TagListType tags;
+  std::vector<unsigned int> restrictionIndices;
+  if( !UpdateDICOMIndex( directoryName, restrictions, tags, restrictionIndices, index ) )
+  {
+    return false;
+  }
+
+  /** Group the image files by series identifier. */
+  series.clear();
+  for( DICOMIndexType::const_iterator it = index.begin(); it != index.end(); ++it )
+  {
+    const DICOMIndexEntry & entry = it->second;
+    if( !entry.IsDICOM || entry.Values[ RowsTag ].empty()
+      || entry.Values[ ColumnsTag ].empty() )
+    {
+      continue;
+    }
+    series[ CreateSeriesIdentifier( entry, restrictionIndices ) ].push_back( it->first );
+  }
+
+  return true;
+
+} // end GetDICOMSeries()
+
+} // end anonymous namespace
+
+
+/**
+ * ******************* GetDICOMIndexFileName *******************
+ */
+
+std::string GetDICOMIndexFileName( const std::string & directoryName )
+{
+  /** The index is disabled with ITKTOOLS_DICOM_INDEX=0 or OFF. */
+  std::string setting;
+  if( itksys::SystemTools::GetEnv( "ITKTOOLS_DICOM_INDEX", setting )
+    && ( setting == "0" || setting == "OFF" || setting == "off" ) )
+  {
+    return "";
+  }
+
+  /** The user cache directory. */
+  std::string cacheDirectory;
+#if defined( _WIN32 )
+  if( !itksys::SystemTools::GetEnv( "LOCALAPPDATA", cacheDirectory ) ) return "";
+#else
+  if( !itksys::SystemTools::GetEnv( "XDG_CACHE_HOME", cacheDirectory )
+    || cacheDirectory == "" )
+  {
+    if( !itksys::SystemTools::GetEnv( "HOME", cacheDirectory )
+      || cacheDirectory == "" )
+    {
+      return "";
+    }
+    cacheDirectory += "/.cache";
+  }
+#endif
+
+  /** A name per directory, from a hash (FNV-1a) of the full path. The
+   * path is stored in the index as well, so that a collision only
+   * causes a rescan.
+   */
+  const std::string fullPath
+    = itksys::SystemTools::CollapseFullPath( directoryName.c_str() );
+  unsigned long hash = 2166136261ul;
+  for( std::string::size_type i = 0; i < fullPath.size(); ++i )
+  {
+    hash = ( ( hash ^ static_cast<unsigned char>( fullPath[ i ] ) ) * 16777619ul ) & 0xfffffffful;
+  }
+  char name[ 16 ];
+  sprintf( name, "%08lx", hash );
+
+  return cacheDirectory + "/itktools/dicomindex/" + name;
+
+} // end GetDICOMIndexFileName()
+
+
+/**
+ * ******************* GetDICOMSeriesUIDs *******************
+ */
+
+bool GetDICOMSeriesUIDs(
+  const std::string & directoryName,
+  const std::vector<std::string> & restrictions,
+  std::vector<std::string> & seriesUIDs )
+{
+  DICOMIndexType index;
+  DICOMSeriesType series;
+  if( !GetDICOMSeries( directoryName, restrictions, index, series ) ) return false;
+
+  seriesUIDs.clear();
+  for( DICOMSeriesType::const_iterator it = series.begin(); it != series.end(); ++it )
+  {
+    seriesUIDs.push_back( it->first );
+  }
+  return true;
+
+} // end GetDICOMSeriesUIDs()
+
+
+/**
+ * ******************* GetDICOMSeriesFileNames *******************
+ */
+
+bool GetDICOMSeriesFileNames(
+  const std::string & directoryName,
+  const std::vector<std::string> & restrictions,
+  const std::string & seriesUID,
+  std::vector<std::string> & fileNames )
+{
+  std::vector<std::string> seriesUIDs;
+  return GetDICOMSeriesFileNames( directoryName, restrictions, seriesUID, fileNames, seriesUIDs );
+
+} // end GetDICOMSeriesFileNames()
+
+
+/**
+ * ******************* GetDICOMSeriesFileNames *******************
+ */
+
+bool GetDICOMSeriesFileNames(
+  const std::string & directoryName,
+  const std::vector<std::string> & restrictions,
+  const std::string & seriesUID,
+  std::vector<std::string> & fileNames,
+  std::vector<std::string> & seriesUIDs )
+{
+  fileNames.clear();
+  seriesUIDs.clear();
+  DICOMIndexType index;
+  DICOMSeriesType series;
+  if( !GetDICOMSeries( directoryName, restrictions, index, series ) ) return false;
+  for( DICOMSeriesType::const_iterator it = series.begin(); it != series.end(); ++it )
+  {
+    seriesUIDs.push_back( it->first );
+  }
+  if( series.empty() ) return false;
+
+  DICOMSeriesType::const_iterator it = series.begin();
+  if( seriesUID != "" )
+  {
+    it = series.find( seriesUID );
+    if( it == series.end() ) return false;
+  }
+
+  OrderSeriesFileNames( index, it->second, directoryName, fileNames );
+  return true;
+
+} // end GetDICOMSeriesFileNames()
+
+} // end namespace itktools
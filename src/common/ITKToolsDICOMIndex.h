@@ -0,0 +1,81 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __ITKToolsDICOMIndex_h_
+#define __ITKToolsDICOMIndex_h_
+
+#include <string>
+#include <vector>
+
+
+namespace itktools
+{
+
+/** Functions to find the DICOM series in a directory.
+ *
+ * They replace itk::GDCMSeriesFileNames with SetUseSeriesDetails( true ),
+ * and produce the same series identifiers and file orderings:
+ * the series instance UID extended with the series number, sequence name,
+ * slice thickness, rows, columns and the restriction tags, and files
+ * ordered by image position, instance number or file name.
+ *
+ * The headers are scanned in parallel. The key tags of every file are
+ * stored in a small index file, together with the file's modification
+ * time and size. Subsequent calls only rescan files that were added or
+ * changed, so that repeated calls on a large directory are fast. The
+ * index is stored in the user cache directory, not in the DICOM
+ * directory: $XDG_CACHE_HOME/itktools/dicomindex, ~/.cache/itktools/dicomindex
+ * or %LOCALAPPDATA%/itktools/dicomindex. It is not used when none of these
+ * exist or when the environment variable ITKTOOLS_DICOM_INDEX is 0 or OFF.
+ *
+ * Restrictions are given as "gggg|eeee", e.g. "0020|0012".
+ */
+
+/** Get the unique series identifiers in a directory, sorted. */
+bool GetDICOMSeriesUIDs(
+  const std::string & directoryName,
+  const std::vector<std::string> & restrictions,
+  std::vector<std::string> & seriesUIDs );
+
+/** Get the ordered file names of a series in a directory. When
+ * seriesUID is empty the first series is used.
+ * Returns false when the series does not exist.
+ */
+bool GetDICOMSeriesFileNames(
+  const std::string & directoryName,
+  const std::vector<std::string> & restrictions,
+  const std::string & seriesUID,
+  std::vector<std::string> & fileNames );
+
+/** As above, and also get all series identifiers in the directory,
+ * from the same scan, e.g. to tell why a series was not found.
+ */
+bool GetDICOMSeriesFileNames(
+  const std::string & directoryName,
+  const std::vector<std::string> & restrictions,
+  const std::string & seriesUID,
+  std::vector<std::string> & fileNames,
+  std::vector<std::string> & seriesUIDs );
+
+/** The name of the index file of a DICOM directory, in the user cache
+ * directory. Empty when the index is not used.
+ */
+std::string GetDICOMIndexFileName( const std::string & directoryName );
+
+} // end namespace itktools
+
+#endif // end #ifndef __ITKToolsDICOMIndex_h_
@@ -0,0 +1,251 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#include "ITKToolsExecutionOptions.h"
+#include "ITKToolsTiming.h"
+
+#include "itkCommandLineArgumentParser.h"
+#include "itkMultiThreader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#if defined( __linux__ )
+#include <sched.h>
+#endif
+
+
+namespace itktools
+{
+
+namespace
+{
+
+/** The options in effect. */
+ExecutionOptionsType ExecutionOptions;
+
+
+/**
+ * ******************* ParseCPUList *******************
+ *
+ * Parses a list like "0-3,8,10-11", the format of -cpus and of
+ * /sys/devices/system/node/node<n>/cpulist.
+ */
+
+bool ParseCPUList( const std::string & list, std::vector<unsigned int> & cpus )
+{
+  cpus.clear();
+  std::istringstream iss( list );
+  std::string range;
+  while( std::getline( iss, range, ',' ) )
+  {
+    unsigned int first = 0, last = 0;
+    const int n = sscanf( range.c_str(), "%u-%u", &first, &last );
+    if( n == 1 ) last = first;
+    else if( n != 2 || last < first ) return false;
+    for( unsigned int cpu = first; cpu <= last; ++cpu )
+    {
+      cpus.push_back( cpu );
+    }
+  }
+
+  return !cpus.empty();
+
+} // end ParseCPUList()
+
+
+/**
+ * ******************* SetCPUAffinity *******************
+ */
+
+bool SetCPUAffinity( const std::vector<unsigned int> & cpus )
+{
+#if defined( __linux__ )
+  /** Threads created later inherit the affinity of the main thread. */
+  cpu_set_t set;
+  CPU_ZERO( &set );
+  for( unsigned int i = 0; i < cpus.size(); ++i )
+  {
+    if( cpus[ i ] >= CPU_SETSIZE ) return false;
+    CPU_SET( cpus[ i ], &set );
+  }
+  return sched_setaffinity( 0, sizeof( set ), &set ) == 0;
+#else
+  std::cerr << "WARNING: -cpus and -numa are not supported on this platform, "
+    << "they are ignored." << std::endl;
+  return true;
+#endif
+
+} // end SetCPUAffinity()
+
+} // end anonymous namespace
+
+
+/**
+ * ******************* SetExecutionOptions *******************
+ */
+
+bool SetExecutionOptions( const itk::CommandLineArgumentParser * parser )
+{
+  ExecutionOptionsType options;
+
+  parser->GetCommandLineArgument( "-threads", options.NumberOfThreads );
+  parser->GetCommandLineArgument( "-numa", options.NUMANode );
+  parser->GetCommandLineArgument( "-maxmem", options.MaximumMemory );
+  parser->GetCommandLineArgument( "-streams", options.NumberOfStreams );
+  options.Deterministic = parser->ArgumentExists( "-deterministic" );
+
+  std::string cpuList = "";
+  parser->GetCommandLineArgument( "-cpus", cpuList );
+
+  /** Checks. */
+  if( parser->ArgumentExists( "-threads" ) && options.NumberOfThreads == 0 )
+  {
+    std::cerr << "ERROR: -threads should be at least 1." << std::endl;
+    return false;
+  }
+  if( options.MaximumMemory < 0.0 )
+  {
+    std::cerr << "ERROR: -maxmem should be positive." << std::endl;
+    return false;
+  }
+  if( cpuList != "" && parser->ArgumentExists( "-numa" ) )
+  {
+    std::cerr << "ERROR: -cpus and -numa can not be combined." << std::endl;
+    return false;
+  }
+
+  /** The cpus of a NUMA node are listed by the kernel. */
+  if( options.NUMANode >= 0 )
+  {
+    std::ostringstream nodeFileName;
+    nodeFileName << "/sys/devices/system/node/node" << options.NUMANode << "/cpulist";
+    std::ifstream nodeFile( nodeFileName.str().c_str() );
+    if( !nodeFile.is_open() || !std::getline( nodeFile, cpuList ) )
+    {
+      std::cerr << "ERROR: NUMA node " << options.NUMANode
+        << " does not exist." << std::endl;
+      return false;
+    }
+  }
+
+  /** Set the cpu affinity. */
+  if( cpuList != "" )
+  {
+    if( !ParseCPUList( cpuList, options.CPUs ) )
+    {
+      std::cerr << "ERROR: invalid cpu list \"" << cpuList << "\"." << std::endl;
+      return false;
+    }
+    if( !SetCPUAffinity( options.CPUs ) )
+    {
+      std::cerr << "ERROR: could not run on cpus \"" << cpuList << "\"." << std::endl;
+      return false;
+    }
+  }
+
+  /** Set the number of threads, for all filters created from now on. */
+  unsigned int numberOfThreads = options.NumberOfThreads;
+  if( numberOfThreads == 0 && !options.CPUs.empty() )
+  {
+    numberOfThreads = static_cast<unsigned int>( options.CPUs.size() );
+  }
+  if( numberOfThreads == 0 && options.Deterministic )
+  {
+    numberOfThreads = 1;
+  }
+  if( numberOfThreads > 0 )
+  {
+    itk::MultiThreader::SetGlobalMaximumNumberOfThreads( numberOfThreads );
+    itk::MultiThreader::SetGlobalDefaultNumberOfThreads( numberOfThreads );
+  }
+  options.NumberOfThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+
+  /** Stage timing. */
+  if( parser->ArgumentExists( "-timing" ) )
+  {
+    std::vector<std::string> timing;
+    parser->GetCommandLineArgument( "-timing", timing );
+    const std::string format = timing.size() > 0 ? timing[ 0 ] : "text";
+    const std::string fileName = timing.size() > 1 ? timing[ 1 ] : "";
+    if( !EnableTiming( format, fileName ) ) return false;
+  }
+
+  ExecutionOptions = options;
+  return true;
+
+} // end SetExecutionOptions()
+
+
+/**
+ * ******************* GetExecutionOptions *******************
+ */
+
+const ExecutionOptionsType & GetExecutionOptions( void )
+{
+  return ExecutionOptions;
+
+} // end GetExecutionOptions()
+
+
+/**
+ * ******************* GetExecutionOptionsHelpString *******************
+ */
+
+std::string GetExecutionOptionsHelpString( void )
+{
+  std::stringstream ss;
+  ss << "Execution options, accepted by all tools:\n"
+    << "  [-threads]       maximum number of threads, default all\n"
+    << "  [-cpus]          run on these cpus only, e.g. \"0-15,32-47\"\n"
+    << "  [-numa]          run on the cpus of this NUMA node only\n"
+    << "  [-maxmem]        memory budget in MB, converted to stream divisions\n"
+    << "  [-streams]       minimum number of stream divisions\n"
+    << "  [-deterministic] reproducible results: one thread, unless -threads is given\n"
+    << "  [-timing]        report timings at exit, \"text\" (default) or \"json\",\n"
+    << "                   optionally followed by an output file name; per reader,\n"
+    << "                   filter and writer of the pipelines that write images";
+
+  return ss.str();
+
+} // end GetExecutionOptionsHelpString()
+
+
+/**
+ * ******************* GetNumberOfStreamDivisions *******************
+ */
+
+unsigned int GetNumberOfStreamDivisions(
+  const double memoryInBytes, const unsigned int numberOfStreams )
+{
+  unsigned int divisions = std::max( numberOfStreams, ExecutionOptions.NumberOfStreams );
+  if( ExecutionOptions.MaximumMemory > 0.0 )
+  {
+    const double budget = ExecutionOptions.MaximumMemory * 1024.0 * 1024.0;
+    const double needed = std::ceil( memoryInBytes / budget );
+    if( needed > divisions ) divisions = static_cast<unsigned int>( needed );
+  }
+
+  return std::max( divisions, 1u );
+
+} // end GetNumberOfStreamDivisions()
+
+} // end namespace itktools
@@ -0,0 +1,84 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __ITKToolsExecutionOptions_h_
+#define __ITKToolsExecutionOptions_h_
+
+#include <string>
+#include <vector>
+
+namespace itk
+{
+class CommandLineArgumentParser;
+}
+
+
+namespace itktools
+{
+
+/** The execution options that every tool accepts:
+ *
+ *   [-threads]       maximum number of threads, default all
+ *   [-cpus]          run on these cpus only, e.g. "0-15,32-47"
+ *   [-numa]          run on the cpus of this NUMA node only
+ *   [-maxmem]        memory budget in MB, converted to stream divisions
+ *   [-streams]       minimum number of stream divisions of the output
+ *   [-deterministic] reproducible results, independent of the machine
+ *   [-timing]        report timings, see ITKToolsTiming.h
+ *
+ * They are parsed and applied by
+ * CommandLineArgumentParser::CheckForRequiredArguments(), so that
+ * tools do not need to handle them. Without -threads the number of
+ * threads equals the number of cpus selected with -cpus or -numa.
+ * In deterministic mode the number of threads is fixed to the -threads
+ * value or else to 1, so that the image splitting, and therefore the
+ * order of floating point reductions, does not depend on the machine.
+ */
+struct ExecutionOptionsType
+{
+  ExecutionOptionsType() : NumberOfThreads( 0 ), NUMANode( -1 ),
+    MaximumMemory( 0.0 ), NumberOfStreams( 0 ), Deterministic( false ) {}
+
+  unsigned int              NumberOfThreads;  // 0: not set
+  std::vector<unsigned int> CPUs;             // empty: not set
+  int                       NUMANode;         // -1: not set
+  double                    MaximumMemory;    // in MB, 0: unlimited
+  unsigned int              NumberOfStreams;  // 0: not set
+  bool                      Deterministic;
+};
+
+/** Parse the execution options from the command line and apply them.
+ * Returns false on invalid values.
+ */
+bool SetExecutionOptions( const itk::CommandLineArgumentParser * parser );
+
+/** Get the execution options that are in effect. */
+const ExecutionOptionsType & GetExecutionOptions( void );
+
+/** The part of the help text that describes the execution options. */
+std::string GetExecutionOptionsHelpString( void );
+
+/** Get the number of stream divisions for a pipeline that needs
+ * memoryInBytes when run in one piece: at least numberOfStreams and
+ * the -streams value, and enough to keep every piece within -maxmem.
+ */
+unsigned int GetNumberOfStreamDivisions(
+  const double memoryInBytes, const unsigned int numberOfStreams = 1 );
+
+} // end namespace itktools
+
+#endif // end #ifndef __ITKToolsExecutionOptions_h_
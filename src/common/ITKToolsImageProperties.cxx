@@ -18,11 +18,26 @@
 #include "ITKToolsImageProperties.h"
 
 #include "itkImage.h"
-#include "itkImageFileReader.h"
+#include "itkImageFileReader.h" // registers the ImageIO factories
+#include "itkImageIOFactory.h"
+#include "itkCachedInformationImageIO.h"
+#include <itksys/SystemTools.hxx>
+#include <map>
+#include <vector>
 
 namespace itktools
 {
 
+/** The ImageIOs of the files probed by GetImageIOBase(), with the
+ * header information of the file, until they are taken by GetProbedImageIO().
+ */
+typedef std::map< std::string, itk::ImageIOBase::Pointer > ProbedImageIOMapType;
+static ProbedImageIOMapType & GetProbedImageIOMap( void )
+{
+  static ProbedImageIOMapType probedImageIOs;
+  return probedImageIOs;
+}
+
 /**
  * ***************** GetImagePixelType ************************
  */
@@ -66,8 +81,7 @@ bool GetImageComponentType(
 
 itk::ImageIOBase::IOComponentType GetImageComponentType( const std::string & filename )
 {
-  itk::ImageIOBase::Pointer imageIO = itk::ImageIOFactory::CreateImageIO(
-    filename.c_str(), itk::ImageIOFactory::ReadMode);
+  itk::ImageIOBase::Pointer imageIO = CreateImageIOForReading( filename );
   if( imageIO.IsNull() )
   {
     return itk::ImageIOBase::UNKNOWNCOMPONENTTYPE; // complain
@@ -395,20 +409,33 @@ bool GetImageIOBase(
   const std::string & filename,
   itk::ImageIOBase::Pointer & testImageIOBase )
 {
-  /** Dummy image type. */
-  const unsigned int DummyDimension = 3;
-  typedef short      DummyPixelType;
-  typedef itk::Image< DummyPixelType, DummyDimension >   DummyImageType;
-
-  /** Create a testReader. */
-  typedef itk::ImageFileReader< DummyImageType >     ReaderType;
-  ReaderType::Pointer testReader = ReaderType::New();
-  testReader->SetFileName( filename.c_str() );
+  /** A file that was probed before, and not read since, is not probed
+   * again. Its information is reset, in case a caller changed it; this
+   * copies the cached header information, without parsing the file.
+   */
+  ProbedImageIOMapType & probedImageIOs = GetProbedImageIOMap();
+  ProbedImageIOMapType::const_iterator probed = probedImageIOs.find( filename );
+  if( probed != probedImageIOs.end() )
+  {
+    testImageIOBase = probed->second;
+    testImageIOBase->ReadImageInformation();
+    return true;
+  }
 
-  /** Generate all information. */
+  /** Create the ImageIO and read the header, once. */
+  itk::ImageIOBase::Pointer imageIO = CreateImageIOForReading( filename );
+  if( imageIO.IsNull() )
+  {
+    std::cerr << "ERROR: Could not create an ImageIO to read \""
+      << filename << "\"." << std::endl;
+    return false;
+  }
+  itk::CachedInformationImageIO::Pointer cachedIO = itk::CachedInformationImageIO::New();
+  cachedIO->SetImageIO( imageIO );
+  cachedIO->SetFileName( filename.c_str() );
   try
   {
-    testReader->GenerateOutputInformation();
+    cachedIO->ReadImageInformation();
   }
   catch( itk::ExceptionObject & excp )
   {
@@ -416,12 +443,87 @@ bool GetImageIOBase(
     return false;
   }
 
-  /** Extract the ImageIO from the testReader. */
-  testImageIOBase = testReader->GetImageIO();
+  /** Keep it for the reader of the tool, see GetProbedImageIO(). */
+  testImageIOBase = cachedIO.GetPointer();
+  probedImageIOs[ filename ] = testImageIOBase;
 
   return true;
 
-} // end GetImageProperties()
+} // end GetImageIOBase()
+
+
+/**
+ * ***************** CreateImageIOForReading ************************
+ */
+
+itk::ImageIOBase::Pointer CreateImageIOForReading( const std::string & filename )
+{
+  /** Create every registered ImageIO once. First try the ones that claim
+   * the extension of the file, so that not every ImageIO has to inspect
+   * the file, then ask the others, as itk::ImageIOFactory would.
+   */
+  const std::string lowerFileName = itksys::SystemTools::LowerCase( filename );
+  std::list< itk::LightObject::Pointer > allObjects
+    = itk::ObjectFactoryBase::CreateAllInstance( "itkImageIOBase" );
+  std::vector< itk::ImageIOBase * > others;
+  for( std::list< itk::LightObject::Pointer >::iterator it = allObjects.begin();
+    it != allObjects.end(); ++it )
+  {
+    itk::ImageIOBase * imageIO = dynamic_cast< itk::ImageIOBase * >( it->GetPointer() );
+    if( imageIO == NULL ) continue;
+
+    bool claimsExtension = false;
+    const itk::ImageIOBase::ArrayOfExtensionsType & extensions
+      = imageIO->GetSupportedReadExtensions();
+    for( unsigned int i = 0; i < extensions.size() && !claimsExtension; ++i )
+    {
+      const std::string extension = itksys::SystemTools::LowerCase( extensions[ i ] );
+      claimsExtension = extension.size() < lowerFileName.size()
+        && lowerFileName.compare( lowerFileName.size() - extension.size(),
+          extension.size(), extension ) == 0;
+    }
+    if( !claimsExtension )
+    {
+      others.push_back( imageIO );
+    }
+    else if( imageIO->CanReadFile( filename.c_str() ) )
+    {
+      return imageIO;
+    }
+  }
+
+  for( unsigned int i = 0; i < others.size(); ++i )
+  {
+    if( others[ i ]->CanReadFile( filename.c_str() ) ) return others[ i ];
+  }
+
+  return NULL;
+
+} // end CreateImageIOForReading()
+
+
+/**
+ * ***************** GetProbedImageIO ************************
+ */
+
+itk::ImageIOBase::Pointer GetProbedImageIO( const std::string & filename )
+{
+  /** Hand over the ImageIO of GetImageIOBase(), which does not parse the
+   * header again. It is given out once, so that two readers never share
+   * an ImageIO.
+   */
+  ProbedImageIOMapType & probedImageIOs = GetProbedImageIOMap();
+  ProbedImageIOMapType::iterator it = probedImageIOs.find( filename );
+  if( it != probedImageIOs.end() )
+  {
+    itk::ImageIOBase::Pointer imageIO = it->second;
+    probedImageIOs.erase( it );
+    return imageIO;
+  }
+
+  return CreateImageIOForReading( filename );
+
+} // end GetProbedImageIO()
 
 
 /**
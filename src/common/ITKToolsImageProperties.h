@@ -20,6 +20,7 @@
 
 #include <string>
 #include "itkImageIOBase.h"
+#include "ITKToolsTiming.h"
 
 
 namespace itktools
@@ -146,11 +147,42 @@ int GetImageProperties(
   std::vector<double> & origin,
   std::vector<double> & direction );
 
-/** Determine image properties, returning an ImageIOBase. */
+/** Determine image properties, returning an ImageIOBase. The header is
+ * parsed once per file: the ImageIOBase is kept, see GetProbedImageIO(),
+ * and returned again by later calls for the same file.
+ */
 bool GetImageIOBase(
   const std::string & filename,
   itk::ImageIOBase::Pointer & imageIOBase );
 
+/** Create an ImageIO that can read the file. Every registered ImageIO
+ * is instantiated once; the ones that support the extension of the file
+ * are tried first, before the others are queried.
+ * Returns NULL if no ImageIO can read the file.
+ */
+itk::ImageIOBase::Pointer CreateImageIOForReading(
+  const std::string & filename );
+
+/** Get the ImageIO with which GetImageIOBase(), and therefore
+ * GetImageProperties(), probed the file, or else a new one. The probed
+ * one is an itk::CachedInformationImageIO, so that the reader it is
+ * given to does not parse the header again.
+ */
+itk::ImageIOBase::Pointer GetProbedImageIO(
+  const std::string & filename );
+
+/** Let a reader reuse the ImageIO of GetImageProperties(), so that
+ * it does not query all ImageIO factories again. With -timing the
+ * reader is observed as well, also when it is not followed by a writer.
+ */
+template< class TReaderPointer >
+void ReuseImageIO( const TReaderPointer & reader, const std::string & filename )
+{
+  itk::ImageIOBase::Pointer imageIO = GetProbedImageIO( filename );
+  if( imageIO.IsNotNull() ) reader->SetImageIO( imageIO );
+  AddTimingObservers( reader );
+}
+
 /** Fill an ImageIOBase with values. */
 void FillImageIOBase(
   itk::ImageIOBase::Pointer & imageIOBase,
@@ -0,0 +1,180 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __ITKToolsLabelGeometry_h_
+#define __ITKToolsLabelGeometry_h_
+
+#include "ITKToolsImageProperties.h"
+#include "ITKToolsExecutionOptions.h"
+
+#include "itkImageFileReader.h"
+#include "itkLabelGeometryCalculator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <string>
+
+
+namespace itktools
+{
+
+/** Compute the label geometry of an image file, in one pass over the
+ * file. When the ImageIO can stream, such as for uncompressed MetaImage
+ * files, the image is read in slabs along the last dimension of at most
+ * 64 MB or within -maxmem, so that it is never held in memory as a whole.
+ */
+template< class TCalculator >
+void ComputeLabelGeometry( const std::string & fileName, TCalculator * calculator )
+{
+  typedef typename TCalculator::ImageType           ImageType;
+  typedef typename ImageType::PixelType             PixelType;
+  typedef typename ImageType::RegionType            RegionType;
+  typedef itk::ImageFileReader< ImageType >         ReaderType;
+  const unsigned int dimension = ImageType::ImageDimension;
+
+  typename ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( fileName );
+  ReuseImageIO( reader, fileName );
+  reader->UseStreamingOn();
+  reader->UpdateOutputInformation();
+  const RegionType region = reader->GetOutput()->GetLargestPossibleRegion();
+
+  /** Determine the slabs. */
+  const unsigned int lastDim = dimension - 1;
+  const std::size_t lines = region.GetSize()[ lastDim ];
+  const double bytes = static_cast<double>( region.GetNumberOfPixels() ) * sizeof( PixelType );
+  std::size_t numberOfSlabs = std::max<std::size_t>(
+    GetNumberOfStreamDivisions( bytes ),
+    static_cast<std::size_t>( std::ceil( bytes / ( 64.0 * 1024.0 * 1024.0 ) ) ) );
+  if( !reader->GetImageIO()->CanStreamRead() ) numberOfSlabs = 1;
+  numberOfSlabs = std::min( std::max<std::size_t>( numberOfSlabs, 1 ), std::max<std::size_t>( lines, 1 ) );
+  const std::size_t linesPerSlab = ( lines + numberOfSlabs - 1 ) / numberOfSlabs;
+
+  /** Read the slabs and add their labels. */
+  calculator->Initialize();
+  calculator->SetImage( reader->GetOutput() );
+  for( std::size_t first = 0; first < lines; first += linesPerSlab )
+  {
+    RegionType slab = region;
+    slab.SetIndex( lastDim, region.GetIndex()[ lastDim ] + first );
+    slab.SetSize( lastDim, std::min( linesPerSlab, lines - first ) );
+    reader->GetOutput()->SetRequestedRegion( slab );
+    reader->Update();
+
+    calculator->SetRegion( slab );
+    calculator->Compute();
+  }
+
+} // end ComputeLabelGeometry()
+
+
+/** Print the geometry of labels. With format "json" an array of objects
+ * is printed, otherwise a table with a header line and tab separated
+ * columns. Indices are per dimension, counts in voxels, volumes in mm^3,
+ * and bounding boxes and centroids in physical coordinates.
+ */
+template< class TCalculator, class TLabelMap >
+void PrintLabelGeometry( const TCalculator * calculator,
+  const TLabelMap & labels, const std::string & format, std::ostream & os )
+{
+  typedef typename TCalculator::PixelType           PixelType;
+  typedef typename TCalculator::PointType           PointType;
+  typedef typename itk::NumericTraits<PixelType>::PrintType PrintType;
+  typedef typename TLabelMap::const_iterator        IteratorType;
+  const unsigned int dimension = TCalculator::ImageDimension;
+  const char * axes[] = { "x", "y", "z", "t" };
+
+  os.precision( std::numeric_limits<double>::digits10 );
+  if( format == "json" )
+  {
+    os << "[";
+    for( IteratorType it = labels.begin(); it != labels.end(); ++it )
+    {
+      PointType minimumPoint, maximumPoint;
+      calculator->GetBoundingBox( it->second, minimumPoint, maximumPoint );
+      const PointType centroid = calculator->GetCentroid( it->second );
+      os << ( it == labels.begin() ? "" : "," ) << "\n  { "
+        << "\"label\": " << static_cast<PrintType>( it->first ) << ", "
+        << "\"count\": " << it->second.Count << ", "
+        << "\"volume\": " << calculator->GetVolume( it->second ) << ",\n    ";
+      os << "\"minimum_index\": [";
+      for( unsigned int i = 0; i < dimension; ++i )
+      {
+        os << ( i ? ", " : "" ) << it->second.MinimumIndex[ i ];
+      }
+      os << "], \"maximum_index\": [";
+      for( unsigned int i = 0; i < dimension; ++i )
+      {
+        os << ( i ? ", " : "" ) << it->second.MaximumIndex[ i ];
+      }
+      os << "],\n    \"minimum_point\": [";
+      for( unsigned int i = 0; i < dimension; ++i )
+      {
+        os << ( i ? ", " : "" ) << minimumPoint[ i ];
+      }
+      os << "], \"maximum_point\": [";
+      for( unsigned int i = 0; i < dimension; ++i )
+      {
+        os << ( i ? ", " : "" ) << maximumPoint[ i ];
+      }
+      os << "],\n    \"centroid\": [";
+      for( unsigned int i = 0; i < dimension; ++i )
+      {
+        os << ( i ? ", " : "" ) << centroid[ i ];
+      }
+      os << "] }";
+    }
+    os << "\n]" << std::endl;
+  }
+  else
+  {
+    os << "label\tcount\tvolume";
+    const char * columns[] = { "min_index_", "max_index_",
+      "min_point_", "max_point_", "centroid_" };
+    for( unsigned int c = 0; c < 5; ++c )
+    {
+      for( unsigned int i = 0; i < dimension; ++i )
+      {
+        os << "\t" << columns[ c ] << ( i < 4 ? axes[ i ] : "" );
+      }
+    }
+    os << "\n";
+
+    for( IteratorType it = labels.begin(); it != labels.end(); ++it )
+    {
+      PointType minimumPoint, maximumPoint;
+      calculator->GetBoundingBox( it->second, minimumPoint, maximumPoint );
+      const PointType centroid = calculator->GetCentroid( it->second );
+      os << static_cast<PrintType>( it->first ) << "\t" << it->second.Count
+        << "\t" << calculator->GetVolume( it->second );
+      for( unsigned int i = 0; i < dimension; ++i ) os << "\t" << it->second.MinimumIndex[ i ];
+      for( unsigned int i = 0; i < dimension; ++i ) os << "\t" << it->second.MaximumIndex[ i ];
+      for( unsigned int i = 0; i < dimension; ++i ) os << "\t" << minimumPoint[ i ];
+      for( unsigned int i = 0; i < dimension; ++i ) os << "\t" << maximumPoint[ i ];
+      for( unsigned int i = 0; i < dimension; ++i ) os << "\t" << centroid[ i ];
+      os << "\n";
+    }
+    os << std::flush;
+  }
+
+} // end PrintLabelGeometry()
+
+} // end namespace itktools
+
+#endif // end #ifndef __ITKToolsLabelGeometry_h_
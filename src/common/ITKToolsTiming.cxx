@@ -0,0 +1,491 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#include "ITKToolsTiming.h"
+
+#include "itkProcessObject.h"
+#include "itkCommand.h"
+#include "itkRealTimeClock.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itkMetaDataObject.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#if defined( _WIN32 )
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <pthread.h>
+#endif
+
+
+namespace itktools
+{
+
+namespace
+{
+
+/** A snapshot of the process counters. */
+struct TimingSample
+{
+  TimingSample() : WallTime( 0.0 ), CPUTime( 0.0 ), BytesRead( 0.0 ), BytesWritten( 0.0 ) {}
+  double WallTime;
+  double CPUTime;
+  double BytesRead;
+  double BytesWritten;
+
+  void Add( const TimingSample & other, const double factor )
+  {
+    this->WallTime += factor * other.WallTime;
+    this->CPUTime += factor * other.CPUTime;
+    this->BytesRead += factor * other.BytesRead;
+    this->BytesWritten += factor * other.BytesWritten;
+  }
+};
+
+/** The accumulated measurements of one stage. */
+struct TimingStage
+{
+  TimingStage() : NumberOfExecutions( 0 ), Order( 0 ) {}
+  std::string   Name;
+  unsigned int  NumberOfExecutions;
+  unsigned int  Order;    // order of the first execution
+  TimingSample  Start;    // of the running execution
+  TimingSample  Total;    // exclusive
+};
+
+/** The thread that runs a stage. */
+#if defined( _WIN32 )
+typedef DWORD TimingThreadType;
+inline TimingThreadType GetTimingThread( void ) { return GetCurrentThreadId(); }
+inline bool TimingThreadsAreEqual( TimingThreadType a, TimingThreadType b ) { return a == b; }
+#else
+typedef pthread_t TimingThreadType;
+inline TimingThreadType GetTimingThread( void ) { return pthread_self(); }
+inline bool TimingThreadsAreEqual( TimingThreadType a, TimingThreadType b )
+{
+  return pthread_equal( a, b ) != 0;
+}
+#endif
+
+/** A running execution of a stage. */
+struct TimingRunningStage
+{
+  unsigned int      Stage;
+  TimingThreadType  Thread;
+};
+
+/** The key of the tag that marks an observed process object, see
+ * AddTimingObserversRecursive(). The tag is stored on the object itself,
+ * so that a new object at the address of a deleted one is not mistaken
+ * for an observed one.
+ */
+const char * const TimingStageTag = "ITKTools_TimingStage";
+
+/** The timing state. All members are guarded by Mutex, since filters
+ * may be executed from several threads, e.g. the channel filters of
+ * itk::ChannelByChannelVectorImageFilter.
+ */
+struct TimingState
+{
+  TimingState() : Enabled( false ), NumberOfStartedStages( 0 ) {}
+  bool                        Enabled;
+  std::string                 Format;
+  std::string                 FileName;
+  TimingSample                Start;
+  std::vector<TimingStage>    Stages;
+  std::vector<TimingRunningStage> Running;  // stack of running stages, of all threads
+  unsigned int                NumberOfStartedStages;
+  std::map< std::string, unsigned int > NumberOfStagesPerClass;
+  itk::SimpleFastMutexLock    Mutex;
+};
+
+TimingState & GetTimingState( void )
+{
+  static TimingState state;
+  return state;
+}
+
+
+/**
+ * ******************* GetTimingSample *******************
+ */
+
+TimingSample GetTimingSample( void )
+{
+  static itk::RealTimeClock::Pointer clock = itk::RealTimeClock::New();
+
+  TimingSample sample;
+  sample.WallTime = clock->GetTimeInSeconds();
+
+#if defined( _WIN32 )
+  sample.CPUTime = static_cast<double>( std::clock() ) / CLOCKS_PER_SEC;
+#else
+  struct rusage usage;
+  getrusage( RUSAGE_SELF, &usage );
+  sample.CPUTime = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+    + 1e-6 * ( usage.ru_utime.tv_usec + usage.ru_stime.tv_usec );
+#endif
+
+#if defined( __linux__ )
+  /** Bytes passed through read() and write(), including the page cache. */
+  std::ifstream io( "/proc/self/io" );
+  std::string key;
+  double value;
+  while( io >> key >> value )
+  {
+    if( key == "rchar:" ) sample.BytesRead = value;
+    else if( key == "wchar:" ) sample.BytesWritten = value;
+  }
+#endif
+
+  return sample;
+
+} // end GetTimingSample()
+
+
+/**
+ * ******************* GetPeakResidentSetSize *******************
+ */
+
+double GetPeakResidentSetSize( void )
+{
+#if defined( _WIN32 )
+  PROCESS_MEMORY_COUNTERS counters;
+  GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters ) );
+  return static_cast<double>( counters.PeakWorkingSetSize );
+#else
+  struct rusage usage;
+  getrusage( RUSAGE_SELF, &usage );
+#if defined( __APPLE__ )
+  return static_cast<double>( usage.ru_maxrss );
+#else
+  return 1024.0 * usage.ru_maxrss;
+#endif
+#endif
+
+} // end GetPeakResidentSetSize()
+
+
+/** Records the start and end events of one stage. */
+class TimingCommand : public itk::Command
+{
+public:
+  typedef TimingCommand                   Self;
+  typedef itk::Command                    Superclass;
+  typedef itk::SmartPointer<Self>         Pointer;
+  itkNewMacro( Self );
+
+  void SetStage( const unsigned int stage ) { this->m_Stage = stage; }
+
+  void Execute( itk::Object * caller, const itk::EventObject & event )
+  {
+    this->Execute( const_cast<const itk::Object *>( caller ), event );
+  }
+
+  void Execute( const itk::Object *, const itk::EventObject & event )
+  {
+    if( itk::StartEvent().CheckEvent( &event ) ) this->Start();
+    else if( itk::EndEvent().CheckEvent( &event ) ) this->End();
+  }
+
+protected:
+  TimingCommand() : m_Stage( 0 ) {}
+
+  void Start( void )
+  {
+    TimingState & state = GetTimingState();
+    state.Mutex.Lock();
+    TimingStage & stage = state.Stages[ this->m_Stage ];
+    if( stage.NumberOfExecutions == 0 )
+    {
+      stage.Order = ++state.NumberOfStartedStages;
+    }
+    ++stage.NumberOfExecutions;
+    stage.Start = GetTimingSample();
+    TimingRunningStage running;
+    running.Stage = this->m_Stage;
+    running.Thread = GetTimingThread();
+    state.Running.push_back( running );
+    state.Mutex.Unlock();
+  }
+
+  void End( void )
+  {
+    TimingState & state = GetTimingState();
+    state.Mutex.Lock();
+
+    /** Find the last execution of this stage by this thread. */
+    const TimingThreadType thread = GetTimingThread();
+    std::size_t i = state.Running.size();
+    while( i > 0 && !( state.Running[ i - 1 ].Stage == this->m_Stage
+      && TimingThreadsAreEqual( state.Running[ i - 1 ].Thread, thread ) ) )
+    {
+      --i;
+    }
+    if( i == 0 )
+    {
+      state.Mutex.Unlock();
+      return;
+    }
+    state.Running.erase( state.Running.begin() + ( i - 1 ) );
+
+    /** Add the elapsed time to this stage, and remove it from the
+     * enclosing stage of the same thread, so that all times are exclusive.
+     */
+    TimingSample elapsed = GetTimingSample();
+    elapsed.Add( state.Stages[ this->m_Stage ].Start, -1.0 );
+    state.Stages[ this->m_Stage ].Total.Add( elapsed, 1.0 );
+    for( std::size_t j = i - 1; j > 0; --j )
+    {
+      if( TimingThreadsAreEqual( state.Running[ j - 1 ].Thread, thread ) )
+      {
+        state.Stages[ state.Running[ j - 1 ].Stage ].Total.Add( elapsed, -1.0 );
+        break;
+      }
+    }
+    state.Mutex.Unlock();
+  }
+
+private:
+  unsigned int m_Stage;
+};
+
+
+/**
+ * ******************* AddTimingObserversRecursive *******************
+ */
+
+void AddTimingObserversRecursive( itk::ProcessObject * filter, TimingState & state )
+{
+  if( filter == NULL ) return;
+  unsigned int observedStage = 0;
+  if( itk::ExposeMetaData<unsigned int>(
+    filter->GetMetaDataDictionary(), TimingStageTag, observedStage ) )
+  {
+    return;
+  }
+
+  /** Name the stages by class, numbered when a class occurs more often. */
+  TimingStage stage;
+  stage.Name = filter->GetNameOfClass();
+  const unsigned int count = ++state.NumberOfStagesPerClass[ stage.Name ];
+  if( count > 1 )
+  {
+    std::ostringstream name;
+    name << stage.Name << "#" << count;
+    stage.Name = name.str();
+  }
+
+  const unsigned int index = static_cast<unsigned int>( state.Stages.size() );
+  state.Stages.push_back( stage );
+  itk::EncapsulateMetaData<unsigned int>(
+    filter->GetMetaDataDictionary(), TimingStageTag, index );
+
+  TimingCommand::Pointer command = TimingCommand::New();
+  command->SetStage( index );
+  filter->AddObserver( itk::StartEvent(), command );
+  filter->AddObserver( itk::EndEvent(), command );
+
+  /** Walk upstream. */
+  itk::ProcessObject::DataObjectPointerArray inputs = filter->GetInputs();
+  for( unsigned int i = 0; i < inputs.size(); ++i )
+  {
+    if( inputs[ i ].IsNotNull() )
+    {
+      AddTimingObserversRecursive( inputs[ i ]->GetSource(), state );
+    }
+  }
+
+} // end AddTimingObserversRecursive()
+
+
+/**
+ * ******************* BytesToString *******************
+ */
+
+std::string BytesToString( const double bytes )
+{
+  std::ostringstream oss;
+  oss << std::fixed << std::setprecision( 0 ) << bytes;
+  return oss.str();
+
+} // end BytesToString()
+
+
+/** Sort the stages by their first execution. */
+struct TimingStageOrder
+{
+  bool operator()( const TimingStage * a, const TimingStage * b ) const
+  {
+    return a->Order < b->Order;
+  }
+};
+
+
+/**
+ * ******************* ReportTimingAtExit *******************
+ */
+
+void ReportTimingAtExit( void )
+{
+  ReportTiming();
+
+} // end ReportTimingAtExit()
+
+} // end anonymous namespace
+
+
+/**
+ * ******************* EnableTiming *******************
+ */
+
+bool EnableTiming( const std::string & format, const std::string & fileName )
+{
+  if( format != "text" && format != "json" )
+  {
+    std::cerr << "ERROR: -timing should be \"text\" or \"json\"." << std::endl;
+    return false;
+  }
+
+  TimingState & state = GetTimingState();
+  state.Format = format;
+  state.FileName = fileName;
+  state.Start = GetTimingSample();
+  if( !state.Enabled )
+  {
+    state.Enabled = true;
+    atexit( ReportTimingAtExit );
+  }
+
+  return true;
+
+} // end EnableTiming()
+
+
+/**
+ * ******************* TimingIsEnabled *******************
+ */
+
+bool TimingIsEnabled( void )
+{
+  return GetTimingState().Enabled;
+
+} // end TimingIsEnabled()
+
+
+/**
+ * ******************* AddTimingObservers *******************
+ */
+
+void AddTimingObservers( itk::ProcessObject * filter )
+{
+  TimingState & state = GetTimingState();
+  if( !state.Enabled ) return;
+
+  state.Mutex.Lock();
+  AddTimingObserversRecursive( filter, state );
+  state.Mutex.Unlock();
+
+} // end AddTimingObservers()
+
+
+/**
+ * ******************* ReportTiming *******************
+ */
+
+void ReportTiming( void )
+{
+  TimingState & state = GetTimingState();
+  if( !state.Enabled ) return;
+
+  TimingSample total = GetTimingSample();
+  total.Add( state.Start, -1.0 );
+  const double peakRSS = GetPeakResidentSetSize();
+
+  std::vector<const TimingStage *> stages;
+  for( unsigned int i = 0; i < state.Stages.size(); ++i )
+  {
+    if( state.Stages[ i ].NumberOfExecutions > 0 ) stages.push_back( &state.Stages[ i ] );
+  }
+  std::sort( stages.begin(), stages.end(), TimingStageOrder() );
+
+  std::ostringstream report;
+  if( state.Format == "json" )
+  {
+    report << "{\n"
+      << "  \"wall_time\": " << total.WallTime << ",\n"
+      << "  \"cpu_time\": " << total.CPUTime << ",\n"
+      << "  \"bytes_read\": " << BytesToString( total.BytesRead ) << ",\n"
+      << "  \"bytes_written\": " << BytesToString( total.BytesWritten ) << ",\n"
+      << "  \"peak_rss\": " << BytesToString( peakRSS ) << ",\n"
+      << "  \"stages\": [";
+    for( unsigned int i = 0; i < stages.size(); ++i )
+    {
+      const TimingSample & t = stages[ i ]->Total;
+      report << ( i ? "," : "" ) << "\n    { "
+        << "\"name\": \"" << stages[ i ]->Name << "\", "
+        << "\"executions\": " << stages[ i ]->NumberOfExecutions << ", "
+        << "\"wall_time\": " << t.WallTime << ", "
+        << "\"cpu_time\": " << t.CPUTime << ", "
+        << "\"bytes_read\": " << BytesToString( t.BytesRead ) << ", "
+        << "\"bytes_written\": " << BytesToString( t.BytesWritten ) << " }";
+    }
+    report << "\n  ]\n}\n";
+  }
+  else
+  {
+    report << "Timing:\n";
+    for( unsigned int i = 0; i < stages.size(); ++i )
+    {
+      const TimingSample & t = stages[ i ]->Total;
+      report << "  " << stages[ i ]->Name
+        << " (" << stages[ i ]->NumberOfExecutions << "x)"
+        << ": wall " << t.WallTime << " s"
+        << ", cpu " << t.CPUTime << " s"
+        << ", read " << t.BytesRead / 1048576.0 << " MB"
+        << ", written " << t.BytesWritten / 1048576.0 << " MB\n";
+    }
+    report << "  Total: wall " << total.WallTime << " s"
+      << ", cpu " << total.CPUTime << " s"
+      << ", read " << total.BytesRead / 1048576.0 << " MB"
+      << ", written " << total.BytesWritten / 1048576.0 << " MB"
+      << ", peak memory " << peakRSS / 1048576.0 << " MB\n";
+  }
+
+  if( state.FileName != "" )
+  {
+    std::ofstream file( state.FileName.c_str() );
+    file << report.str();
+  }
+  else
+  {
+    std::cerr << report.str();
+  }
+
+} // end ReportTiming()
+
+} // end namespace itktools
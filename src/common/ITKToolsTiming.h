@@ -0,0 +1,70 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __ITKToolsTiming_h_
+#define __ITKToolsTiming_h_
+
+#include <string>
+
+namespace itk
+{
+class ProcessObject;
+}
+
+
+namespace itktools
+{
+
+/** Stage timing, enabled by the -timing execution option:
+ *
+ *   [-timing]  report timings at exit, "text" (default) or "json",
+ *              optionally followed by an output file name, default stderr
+ *
+ * For every observed reader, filter and writer the wall time, cpu time
+ * and the bytes read and written are recorded between its start and end
+ * events. The times are exclusive: time spent in an upstream stage that
+ * is executed from within a stage, e.g. in a streaming writer, is only
+ * counted for the upstream stage. The cpu time is that of the whole
+ * process, so it includes all threads. Bytes are taken from /proc/self/io
+ * and are only available on Linux. The report also contains the totals
+ * and the peak resident set size.
+ *
+ * The tools call AddTimingObservers() on every image writer before
+ * updating it, which observes the whole pipeline upstream of it, and
+ * ReuseImageIO() observes the readers of the tools that use it. Stages
+ * that are not part of such a pipeline, e.g. a filter that is updated
+ * on its own to compute a statistic, are only counted in the totals.
+ */
+
+/** Enable timing. Called by SetExecutionOptions() for -timing. */
+bool EnableTiming( const std::string & format, const std::string & fileName );
+
+/** Is timing enabled. */
+bool TimingIsEnabled( void );
+
+/** Observe the process object and all process objects upstream of it.
+ * Does nothing when timing is not enabled. Call it on the last filter
+ * of a pipeline, usually the writer, before updating it.
+ */
+void AddTimingObservers( itk::ProcessObject * filter );
+
+/** Write the report. It is registered to run at exit by EnableTiming(). */
+void ReportTiming( void );
+
+} // end namespace itktools
+
+#endif // end #ifndef __ITKToolsTiming_h_
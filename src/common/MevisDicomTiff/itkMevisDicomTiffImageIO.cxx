@@ -19,10 +19,12 @@ PURPOSE.  See the above copyright notices for more information.
 #endif
 
 #include "itkMevisDicomTiffImageIO.h"
+#include "itkMevisTiffTileEncoder.h"
 #include "itkArray.h"
 #include "itkMetaDataObject.h"
 #include "itkVersion.h"
 #include "itkNumericTraits.h"
+#include "itkMultiThreader.h"
 
 // developed using gdcm 2.0 and libtiff 3.8.2
 #include "gdcmAttribute.h"
@@ -48,6 +50,8 @@ PURPOSE.  See the above copyright notices for more information.
 #include <vector>
 #include <fstream>
 #include <iostream>
+#include <algorithm>
+#include <cstring>
 
 #include <vnl/vnl_vector.h>
 #include <vnl/vnl_cross.h>
@@ -57,6 +61,220 @@ PURPOSE.  See the above copyright notices for more information.
 namespace itk
 {
 
+namespace
+{
+
+// shared state of the threads that decode the tiles of one tiff image
+// intersecting the requested region
+struct MevisTileReadStruct
+{
+  std::string                 FileName;
+  TIFF *                      MainTIFF;
+  unsigned char *             Buffer;
+  unsigned int                Width;
+  unsigned int                Length;
+  unsigned int                TileWidth;
+  unsigned int                TileLength;
+  unsigned int                BytesPerSample;
+  // requested region in x/y, and the tiff slices it covers, in buffer order
+  unsigned int                RegionX;
+  unsigned int                RegionY;
+  unsigned int                RegionWidth;
+  unsigned int                RegionLength;
+  std::vector<unsigned int>   Slices;
+  // tiles intersecting the region in x/y
+  unsigned int                FirstTileX;
+  unsigned int                FirstTileY;
+  unsigned int                NumberOfTilesX;
+  unsigned int                NumberOfTilesY;
+  unsigned long               NumberOfTiles;
+  std::vector<std::string>    Errors; // one entry per thread
+};
+
+// decode a contiguous range of tiles into the region buffer
+ITK_THREAD_RETURN_TYPE MevisReadTilesThreaderCallback(void * arg)
+{
+  MultiThreader::ThreadInfoStruct * info
+    = static_cast<MultiThreader::ThreadInfoStruct *>(arg);
+  const ThreadIdType threadId = info->ThreadID;
+  const ThreadIdType numberOfThreads = info->NumberOfThreads;
+  MevisTileReadStruct * str = static_cast<MevisTileReadStruct *>(info->UserData);
+
+  // a contiguous range of tiles per thread keeps file access sequential
+  const unsigned long tilesPerThread
+    = (str->NumberOfTiles + numberOfThreads - 1) / numberOfThreads;
+  const unsigned long first = threadId * tilesPerThread;
+  const unsigned long last = std::min(first + tilesPerThread, str->NumberOfTiles);
+  if (first >= last)
+  {
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+  TIFF * tif = str->MainTIFF;
+  if (threadId != 0)
+  {
+    tif = TIFFOpen(str->FileName.c_str(), "rc");
+    if (tif == NULL)
+    {
+      str->Errors[threadId] = "error opening file " + str->FileName;
+      return ITK_THREAD_RETURN_VALUE;
+    }
+  }
+
+  const tsize_t tilesize = TIFFTileSize(tif);
+  const tsize_t tilerowbytes = TIFFTileRowSize(tif);
+  const unsigned int bps = str->BytesPerSample;
+  const std::size_t regionrowbytes = static_cast<std::size_t>(str->RegionWidth) * bps;
+  const std::size_t regionslicebytes = regionrowbytes * str->RegionLength;
+  const unsigned int rx1 = str->RegionX + str->RegionWidth;
+  const unsigned int ry1 = str->RegionY + str->RegionLength;
+  unsigned char * tilebuf = NULL;
+
+  for (unsigned long t = first; t < last; ++t)
+  {
+    // x0,y0,z0 is position of tile in volume, top left corner
+    const unsigned long tilesPerSlice
+      = static_cast<unsigned long>(str->NumberOfTilesX) * str->NumberOfTilesY;
+    const unsigned int s = t / tilesPerSlice;
+    const unsigned int x0 = (str->FirstTileX + t % str->NumberOfTilesX) * str->TileWidth;
+    const unsigned int y0 = (str->FirstTileY + (t / str->NumberOfTilesX) % str->NumberOfTilesY)
+      * str->TileLength;
+    const unsigned int z0 = str->Slices[s];
+    const ttile_t tile = TIFFComputeTile(tif, x0, y0, z0, 0);
+
+    // part of the tile inside the requested region
+    const unsigned int ix0 = std::max(x0, str->RegionX);
+    const unsigned int ix1 = std::min(x0 + str->TileWidth, rx1);
+    const unsigned int iy0 = std::max(y0, str->RegionY);
+    const unsigned int iy1 = std::min(y0 + str->TileLength, ry1);
+
+    // set pointer of the region buffer to ix0,iy0,s position
+    unsigned char * pv = str->Buffer + s * regionslicebytes
+      + static_cast<std::size_t>(iy0 - str->RegionY) * regionrowbytes
+      + static_cast<std::size_t>(ix0 - str->RegionX) * bps;
+
+    // a tile spanning complete region rows, that lies inside the region, is
+    // contiguous in the buffer: decode it in place, without staging copy
+    if (x0 == str->RegionX && str->TileWidth == str->RegionWidth
+      && str->RegionWidth == str->Width && iy0 == y0 && iy1 == y0 + str->TileLength)
+    {
+      if (TIFFReadEncodedTile(tif, tile, pv, tilesize) < 0)
+      {
+        str->Errors[threadId] = "error reading tile";
+        break;
+      }
+      continue;
+    }
+
+    if (tilebuf == NULL)
+    {
+      tilebuf = static_cast<unsigned char*>(_TIFFmalloc(tilesize));
+    }
+    if (TIFFReadEncodedTile(tif, tile, tilebuf, tilesize) < 0)
+    {
+      str->Errors[threadId] = "error reading tile";
+      break;
+    }
+
+    // do row based copy of the part of the tile inside the region
+    const std::size_t tilexbytes = static_cast<std::size_t>(ix1 - ix0) * bps;
+    unsigned char * pb = tilebuf + (iy0 - y0) * tilerowbytes + (ix0 - x0) * bps;
+    for (unsigned int r = iy0; r < iy1; ++r)
+    {
+      memcpy(pv, pb, tilexbytes);
+      pv += regionrowbytes;
+      pb += tilerowbytes;
+    }
+  }
+
+  if (tilebuf != NULL)
+  {
+    _TIFFfree(tilebuf);
+  }
+  if (tif != str->MainTIFF)
+  {
+    TIFFClose(tif);
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+// shared state of the threads that encode a batch of tiles
+struct MevisTileWriteStruct
+{
+  const unsigned char *                     Buffer;
+  unsigned int                              Width;
+  unsigned int                              Length;
+  MevisTiffTileFormat                       Format;
+  unsigned int                              NumberOfTilesX;
+  unsigned int                              NumberOfTilesY;
+  unsigned long                             FirstTile;
+  unsigned long                             NumberOfTiles;
+  std::vector< std::vector<unsigned char> > Tiles;  // encoded tiles of the batch
+  std::vector<std::string>                  Errors; // one entry per thread
+};
+
+// encode a contiguous range of tiles of the current batch
+ITK_THREAD_RETURN_TYPE MevisEncodeTilesThreaderCallback(void * arg)
+{
+  MultiThreader::ThreadInfoStruct * info
+    = static_cast<MultiThreader::ThreadInfoStruct *>(arg);
+  const ThreadIdType threadId = info->ThreadID;
+  const ThreadIdType numberOfThreads = info->NumberOfThreads;
+  MevisTileWriteStruct * str = static_cast<MevisTileWriteStruct *>(info->UserData);
+
+  const unsigned long tilesPerThread
+    = (str->NumberOfTiles + numberOfThreads - 1) / numberOfThreads;
+  const unsigned long first = threadId * tilesPerThread;
+  const unsigned long last = std::min(first + tilesPerThread, str->NumberOfTiles);
+
+  const unsigned int bps = str->Format.BitsPerSample / 8;
+  const std::size_t tilerowbytes = static_cast<std::size_t>(str->Format.TileWidth) * bps;
+  const tsize_t tilesize = static_cast<tsize_t>(tilerowbytes * str->Format.TileLength);
+  const std::size_t volrowbytes = static_cast<std::size_t>(str->Width) * bps;
+  std::vector<unsigned char> tilebuf(tilesize);
+
+  for (unsigned long i = first; i < last; ++i)
+  {
+    const unsigned long t = str->FirstTile + i;
+    const unsigned int x0 = (t % str->NumberOfTilesX) * str->Format.TileWidth;
+    const unsigned int y0 = ((t / str->NumberOfTilesX) % str->NumberOfTilesY) * str->Format.TileLength;
+    const unsigned int z0 = t / (static_cast<unsigned long>(str->NumberOfTilesX) * str->NumberOfTilesY);
+    const unsigned int lenx = std::min(str->Format.TileWidth, str->Width - x0);
+    const unsigned int leny = std::min(str->Format.TileLength, str->Length - y0);
+
+    // fill tile, zero padded at the boundaries
+    if (lenx != str->Format.TileWidth || leny != str->Format.TileLength)
+    {
+      memset(&tilebuf[0], 0, tilesize);
+    }
+    const unsigned char * pv = str->Buffer
+      + (static_cast<std::size_t>(z0) * str->Length * str->Width
+      + static_cast<std::size_t>(y0) * str->Width + x0) * bps;
+    unsigned char * pb = &tilebuf[0];
+    for (unsigned int r = 0; r < leny; ++r)
+    {
+      memcpy(pb, pv, static_cast<std::size_t>(lenx) * bps);
+      pv += volrowbytes;
+      pb += tilerowbytes;
+    }
+
+    if (str->Format.Compression == COMPRESSION_NONE)
+    {
+      str->Tiles[i] = tilebuf;
+    }
+    else if (!MevisEncodeTile(str->Format, &tilebuf[0], tilesize, str->Tiles[i]))
+    {
+      str->Errors[threadId] = "error encoding tile";
+      break;
+    }
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+} // end anonymous namespace
+
 // constructor
 MevisDicomTiffImageIO
 ::MevisDicomTiffImageIO():
@@ -79,7 +297,10 @@ MevisDicomTiffImageIO
   m_RescaleIntercept(NumericTraits<double>::Zero),
   m_GantryTilt(NumericTraits<double>::Zero),
   m_EstimatedMinimum(NumericTraits<double>::Zero),
-  m_EstimatedMaximum(NumericTraits<double>::Zero)
+  m_EstimatedMaximum(NumericTraits<double>::Zero),
+  m_CompressionMethod(LZWCompression),
+  m_CompressionLevel(6),
+  m_UseHorizontalPredictor(false)
 {
   //this->SetNumberOfDimensions(4);
   this->SetFileType(Binary);
@@ -129,6 +350,9 @@ void MevisDicomTiffImageIO::PrintSelf(std::ostream& os, Indent indent) const
   os << indent << "RescaleIntercept : " << m_RescaleIntercept << std::endl;
   os << indent << "RescaleSlope     : " << m_RescaleSlope << std::endl;
   os << indent << "GantryTilt       : " << m_GantryTilt << std::endl;
+  os << indent << "CompressionMethod: " << m_CompressionMethod << std::endl;
+  os << indent << "CompressionLevel : " << m_CompressionLevel << std::endl;
+  os << indent << "UseHorizontalPredictor: " << m_UseHorizontalPredictor << std::endl;
 }
 
 // findelement
@@ -809,8 +1033,8 @@ void MevisDicomTiffImageIO::Read(void* buffer)
   // always assume contigous data (PLANARCONFIG =1)
   // image is either tiled or stripped
   //
-  // TIFFTileSize     returns size of one tile in bytes
-  // TIFFReadTile     reads one tile, returns number of bytes in decoded tile
+  // TIFFTileSize         returns size of one tile in bytes
+  // TIFFReadEncodedTile  decodes one tile, returns number of bytes in decoded tile
   //
   // note *buffer goes in scanline order!
   // very inconvenient if the tiff image is tiled, which damned
@@ -831,354 +1055,99 @@ void MevisDicomTiffImageIO::Read(void* buffer)
     }
   }
 
-  if (m_IsTiled)
+  if (!m_IsTiled)
   {
-    // only works for tile depth == 1 (used by mevislab),
-    // therefore in z-direction we do not need to do checking
-    // if the volume is multiple of tile.
-    if (m_TIFFDimension == 3 && m_TileDepth != 1)
-    {
-      itkExceptionMacro( << "mevisIO:read(): unsupported tiledepth (should be one)! " );
-      return;
-    }
-
-    // buffer pointer is scanline based (one dimensional array)
-    // tile is positioned on x,y,z; we read each tile, and fill
-    // the corresponding positions in the onedimensional array
-    unsigned char *vol = reinterpret_cast<unsigned char*>(buffer);
-
-    const unsigned int tilesize = TIFFTileSize(m_TIFFImage);
-    const unsigned int tilerowbytes = TIFFTileRowSize(m_TIFFImage);
-    const unsigned int bytespersample = m_BitsPerSample/8;
-
-    unsigned char *tilebuf = static_cast<unsigned char*>(_TIFFmalloc(tilesize));
+    // if not tiled then img is stripped
+    itkExceptionMacro( << "mevisIO:read(): non-tiled dcm/tiff reading not (yet) implemented" );
+    return;
+  }
 
-    //
-    // special cases, if the tilexy is larger than or equal to the image
-    // size itself, treat as three separate cases, both are larger/equal,
-    // or only direction
-    //
-    bool tileoversized(false);
+  // only works for tile depth == 1 (used by mevislab),
+  // therefore in z-direction we do not need to do checking
+  // if the volume is multiple of tile.
+  if (m_TIFFDimension == 3 && m_TileDepth != 1)
+  {
+    itkExceptionMacro( << "mevisIO:read(): unsupported tiledepth (should be one)! " );
+    return;
+  }
 
-    if (m_TileLength >= m_Length || m_TileWidth >= m_Width)
+  // only the tiles intersecting the requested io region are decoded,
+  // in parallel; libtiff handles are not thread safe, so every thread
+  // except the first opens its own. a tile may be larger than the image
+  // in x and/or y (oversized tiles), and the tiles at the right and
+  // bottom border may be partially outside the image; the worker clips
+  // each tile to the region.
+  const ImageIORegion & region = this->GetIORegion();
+  MevisTileReadStruct str;
+  str.FileName = m_TiffFileName;
+  str.MainTIFF = m_TIFFImage;
+  str.Buffer = reinterpret_cast<unsigned char*>(buffer);
+  str.Width = m_Width;
+  str.Length = m_Length;
+  str.TileWidth = m_TileWidth;
+  str.TileLength = m_TileLength;
+  str.BytesPerSample = m_BitsPerSample/8;
+  str.RegionX = region.GetIndex(0);
+  str.RegionY = region.GetIndex(1);
+  str.RegionWidth = region.GetSize(0);
+  str.RegionLength = region.GetSize(1);
+
+  // the tiff stores 4d images as a stack of 3d volumes, so the slice
+  // of voxel (z,t) is z + t * m_Dimensions[2]
+  const unsigned int regionDimension = region.GetImageDimension();
+  const unsigned int z0 = regionDimension > 2 ? region.GetIndex(2) : 0;
+  const unsigned int nz = regionDimension > 2 ? region.GetSize(2) : 1;
+  const unsigned int t0 = regionDimension > 3 ? region.GetIndex(3) : 0;
+  const unsigned int nt = regionDimension > 3 ? region.GetSize(3) : 1;
+  const unsigned int depth3d = m_NumberOfDimensions > 2 ? m_Dimensions[2] : 1;
+  for (unsigned int t = t0; t < t0 + nt; ++t)
+  {
+    for (unsigned int z = z0; z < z0 + nz; ++z)
     {
-      tileoversized = true;
-
-      // case one both x,y is larger
-      if (m_TileLength >= m_Length && m_TileWidth >= m_Width)
-      {
-        for (unsigned int z0 = 0; z0< (m_TIFFDimension == 3 ? m_Depth :1); z0++)
-        {
-          if (TIFFReadTile(m_TIFFImage, tilebuf, 0, 0, z0, 0) < 0)
-          {
-            _TIFFfree(tilebuf);
-            itkExceptionMacro( << "mevisIO:read(): error reading tile (topleft)" );
-            return;
-          }
-          else
-          {
-            // do row based copy of tile into volume
-            const unsigned lenx = m_Width;
-            const unsigned leny = m_Length;
-            const unsigned int tilexbytes = lenx * bytespersample;
-
-            unsigned char * pv = vol;
-            const unsigned int p = z0 * m_Length * m_Width;
-            pv += p * bytespersample;
-
-            unsigned char * pb = tilebuf;
-            for (unsigned int r = 0; r<leny; ++r)
-            {
-              memcpy(pv,pb,tilexbytes);
-              pv += tilexbytes;
-              pb += tilerowbytes;
-            }
-          }
-        }
-      } // end case one
-
-      // case two, larger x, smaller y
-      if (m_TileWidth >= m_Width && m_TileLength < m_Length)
-      {
-
-        const unsigned lenx = m_Width;
-        const unsigned int tilexbytes = lenx * bytespersample;
-
-        const bool my = ( m_Length%m_TileLength == 0) ? true : false;
-        for (unsigned int z0 = 0; z0 < (m_TIFFDimension == 3 ? m_Depth : 1); z0++)
-        {
-          for (unsigned int y0 = 0; y0 < (my ? m_Length : m_Length-m_TileLength); y0 += m_TileLength)
-          {
-            if (TIFFReadTile(m_TIFFImage, tilebuf, 0, y0, z0, 0) < 0)
-            {
-              _TIFFfree(tilebuf);
-              itkExceptionMacro( << "mevisIO:read(): error reading tile (top image)" );
-              return;
-            }
-            else
-            {
-
-              unsigned char * pb = tilebuf;
-              unsigned char * pv = vol;
-              const unsigned int p = z0 * m_Length * m_Width + y0 * m_Width;
-              pv += p * bytespersample;
-
-              for (unsigned int r = 0; r<m_TileLength; ++r)
-              {
-                memcpy(pv,pb,tilerowbytes);
-                pv += tilexbytes;
-                pb += tilerowbytes;
-              }
-            }
-          }
-
-          if (!my)
-          {
-            const unsigned leny = m_Length%m_TileLength;
-            const unsigned int y0 = m_Length - leny;
-
-            if (TIFFReadTile(m_TIFFImage, tilebuf, 0, y0, z0, 0) < 0)
-            {
-              _TIFFfree(tilebuf);
-              itkExceptionMacro( << "mevisIO:read(): error reading tile (strip bottom)" );
-              return;
-            }
-            else
-            {
-              unsigned char * pb = tilebuf;
-              unsigned char * pv = vol;
-              const unsigned int p = z0 * m_Length * m_Width + y0 * m_Width;
-              pv += p * bytespersample;
-
-              for (unsigned int r = 0; r<leny; ++r)
-              {
-                memcpy(pv,pb,tilexbytes);
-                pv += tilexbytes;
-                pb += tilerowbytes;
-              }
-            }
-          }
-        }
-
-      } // end case two
-
-      // case three, smaller x, larger y
-      if (m_TileWidth < m_Width && m_TileLength >= m_Length)
-      {
-
-        const unsigned leny = m_Length;
-        const bool mx = ( m_Width%m_TileWidth == 0) ? true: false;
+      str.Slices.push_back(z + t * depth3d);
+    }
+  }
 
-        for (unsigned int z0 = 0; z0 < (m_TIFFDimension == 3 ? m_Depth : 1); z0++)
-        {
-          for (unsigned int x0 = 0; x0 < (mx ? m_Width : m_Width-m_TileWidth); x0 += m_TileWidth)
-          {
-            // read tile
-            if (TIFFReadTile(m_TIFFImage, tilebuf, x0, 0, z0, 0) < 0)
-            {
-              _TIFFfree(tilebuf);
-              itkExceptionMacro( << "mevisIO:read(): error reading tile (top image)" );
-              return;
-            }
-            else
-            {
-              unsigned char * pb = tilebuf;
-              unsigned char * pv = vol;
-              const unsigned int p = z0 * m_Length * m_Width + x0;
-              pv += p * bytespersample;
-
-              for (unsigned int r = 0; r<leny; ++r)
-              {
-                memcpy(pv,pb,tilerowbytes);
-                pv += m_Width * bytespersample;
-                pb += tilerowbytes;
-              }
-            }
-          }
-          // fill strip right
-          if (!mx)
-          {
-            const unsigned lenx = m_Width%m_TileWidth;
-            const unsigned int x0 = m_Width - lenx;
-            const unsigned int tilexbytes = lenx * bytespersample;
-
-            if (TIFFReadTile(m_TIFFImage, tilebuf, x0, 0, z0, 0) < 0)
-            {
-              _TIFFfree(tilebuf);
-              itkExceptionMacro( << "mevisIO:read(): error reading tile (strip right)" );
-              return;
-            }
-            else
-            {
-              unsigned char * pb = tilebuf;
-              unsigned char * pv = vol;
-              const unsigned int p = z0 * m_Length * m_Width + x0;
-              pv += p * bytespersample;
-
-              for (unsigned int r = 0; r<leny; ++r)
-              {
-                memcpy(pv,pb,tilexbytes);
-                pv += m_Width * bytespersample;
-                pb += tilerowbytes;
-              }
-            }
-          }
-        }
+  if (str.RegionWidth == 0 || str.RegionLength == 0 || str.Slices.empty())
+  {
+    return;
+  }
+  if (str.RegionX + str.RegionWidth > m_Width
+    || str.RegionY + str.RegionLength > m_Length
+    || str.Slices.back() >= (m_TIFFDimension == 3 ? m_Depth : 1))
+  {
+    itkExceptionMacro( << "mevisIO:read(): requested region outside the image!" );
+  }
 
-      } // end case three
+  str.FirstTileX = str.RegionX / m_TileWidth;
+  str.FirstTileY = str.RegionY / m_TileLength;
+  str.NumberOfTilesX = (str.RegionX + str.RegionWidth - 1) / m_TileWidth - str.FirstTileX + 1;
+  str.NumberOfTilesY = (str.RegionY + str.RegionLength - 1) / m_TileLength - str.FirstTileY + 1;
+  str.NumberOfTiles = static_cast<unsigned long>(str.NumberOfTilesX)
+    * str.NumberOfTilesY * str.Slices.size();
 
-    } // end oversized tile
+  unsigned long numberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+  if (numberOfThreads > str.NumberOfTiles)
+  {
+    numberOfThreads = str.NumberOfTiles;
+  }
+  if (numberOfThreads < 1)
+  {
+    numberOfThreads = 1;
+  }
+  str.Errors.resize(numberOfThreads);
 
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads(numberOfThreads);
+  threader->SetSingleMethod(MevisReadTilesThreaderCallback, &str);
+  threader->SingleMethodExecute();
 
-    //
-    // normal case, tile is smaller than image
-    //
-    if (!tileoversized)
+  for (unsigned int i = 0; i < str.Errors.size(); ++i)
+  {
+    if (!str.Errors[i].empty())
     {
-      // is volume direction a multiple of tiledirection?
-      const bool mx = ( m_Width%m_TileWidth == 0) ? true: false;
-      const bool my = ( m_Length%m_TileLength == 0) ? true : false;
-
-      // fill everything inside ie from topleft
-      for (unsigned int z0 = 0; z0 < (m_TIFFDimension == 3 ? m_Depth : 1); z0++)
-      {
-        for (unsigned int y0 = 0; y0 < (my ? m_Length : m_Length-m_TileLength); y0 += m_TileLength)
-          for (unsigned int x0 = 0; x0 < (mx ? m_Width : m_Width-m_TileWidth); x0 += m_TileWidth)
-          {
-            // x0,y0,z0 is position of tile in volume, top left corner
-            // pointer to volume (at 0,0,0)
-            unsigned char * pv = vol;
-
-            // set pointer of volume to y0,x0,z0 position
-            const unsigned int p = z0 * m_Length * m_Width + y0 * m_Width + x0;
-            pv += p * bytespersample;
-
-            // read tile
-            if (TIFFReadTile(m_TIFFImage, tilebuf, x0, y0, z0, 0) < 0)
-            {
-              _TIFFfree(tilebuf);
-              itkExceptionMacro( << "mevisIO:read(): error reading tile (topleft image)" );
-              return;
-            }
-            else
-            {
-              // do row based copy of tile into volume
-              unsigned char * pb = tilebuf;
-              for (unsigned int r = 0; r<m_TileLength; ++r)
-              {
-                memcpy(pv,pb,tilerowbytes);
-                // move pointers
-                // x remain same, y is one complete vol line
-                // (ie width of image)
-                pv += m_Width * bytespersample;
-                pb += tilerowbytes;
-              }
-            }
-
-          }
-          // fill boundaries
-          if (!mx)
-          {
-            // x is fixed
-            const unsigned lenx = m_Width%m_TileWidth;
-            const unsigned int x0 = m_Width - lenx;
-            const unsigned int tilexbytes = lenx * bytespersample;
-
-            for (unsigned int y0 = 0; y0 < (my ? m_Length: m_Length - m_TileLength); y0 += m_TileLength)
-            {
-              unsigned char * pv = vol;
-              const unsigned int p = z0 * m_Length * m_Width + y0 * m_Width + x0;
-              pv += p * bytespersample;
-
-              if (TIFFReadTile(m_TIFFImage, tilebuf, x0, y0, z0, 0) < 0)
-              {
-                _TIFFfree(tilebuf);
-                itkExceptionMacro( << "mevisIO:read(): error reading tile (ydirection)" );
-                return;
-              }
-              else
-              {
-                unsigned char * pb = tilebuf;
-                for (unsigned int r = 0; r<m_TileLength; ++r)
-                {
-                  memcpy(pv,pb,tilexbytes);
-                  pv += m_Width * bytespersample;
-                  pb += tilerowbytes;
-                }
-              }
-            }
-          }
-          if (!my)
-          {
-            // y is fixed
-            const unsigned leny = m_Length%m_TileLength;
-            const unsigned int y0 = m_Length - leny;
-
-            for (unsigned int x0 = 0; x0 < (mx ? m_Width : m_Width-m_TileWidth); x0 += m_TileWidth)
-            {
-              unsigned char * pv = vol;
-              const unsigned int p = z0 * m_Length * m_Width + y0 * m_Width + x0;
-              pv += p * bytespersample;
-
-              if (TIFFReadTile(m_TIFFImage, tilebuf, x0, y0, z0, 0) < 0)
-              {
-                _TIFFfree(tilebuf);
-                itkExceptionMacro( << "mevisIO:read(): error reading tile (x-direction)");
-                return;
-              }
-              else
-              {
-                unsigned char * pb = tilebuf;
-                for (unsigned int r = 0; r<leny; ++r)
-                {
-                  memcpy(pv,pb,tilerowbytes);
-                  pv += m_Width * bytespersample;
-                  pb += tilerowbytes;
-                }
-              }
-            }
-          }
-          // fill corner bottom
-          if (!mx && !my)
-          {
-            // x0,y0 is fixed
-            const unsigned lenx = m_Width%m_TileWidth;
-            const unsigned int x0 = m_Width - lenx;
-            const unsigned int tilexbytes = lenx * bytespersample;
-            const unsigned leny = m_Length%m_TileLength;
-            const unsigned int y0 = m_Length - leny;
-
-            unsigned char * pv = vol;
-            const unsigned int p = z0 * m_Length * m_Width + y0 * m_Width + x0;
-            pv += p * bytespersample;
-
-            if (TIFFReadTile(m_TIFFImage, tilebuf, x0, y0, z0, 0) < 0)
-            {
-              _TIFFfree(tilebuf);
-              itkExceptionMacro( << "mevisIO:read(): error reading tile (corner bottom)" );
-              return;
-            }
-            else
-            {
-              unsigned char * pb = tilebuf;
-              for (unsigned int r = 0; r<leny; ++r)
-              {
-                memcpy(pv,pb,tilexbytes);
-                pv += m_Width * bytespersample;
-                pb += tilerowbytes;
-              }
-            }
-          }
-      }
+      itkExceptionMacro( << "mevisIO:read(): " << str.Errors[i] );
     }
-
-    _TIFFfree(tilebuf);
-  }
-  else
-  {
-    // if not tiled then img is stripped
-    itkExceptionMacro( << "mevisIO:read(): non-tiled dcm/tiff reading not (yet) implemented" );
-    return;
   }
   return;
 }
@@ -1855,26 +1824,43 @@ void MevisDicomTiffImageIO
     itkExceptionMacro( << "mevisIO:write(): error setting BITSPERSAMPLE " );
   }
 
-  // compression, default always using lzw (overriding
-  // member values)
+  // compression, default using lzw (overriding
+  // member values), or deflate when selected
   // 1 none
   // 2 ccit
   // 5 lzw
+  // 8 deflate
   // 32773 packbits
 
+  unsigned short compression = COMPRESSION_NONE;
   if (this->GetUseCompression())
   {
-    if (!TIFFSetField(m_TIFFImage, TIFFTAG_COMPRESSION, 5))
+    compression = (m_CompressionMethod == DeflateCompression)
+      ? COMPRESSION_ADOBE_DEFLATE : COMPRESSION_LZW;
+  }
+  if (!TIFFSetField(m_TIFFImage, TIFFTAG_COMPRESSION, compression))
+  {
+    itkDebugMacro( << "WARNING: mevisIO:write(): error setting COMPRESSION to " << compression );
+    compression = COMPRESSION_NONE;
+  }
+  if (compression == COMPRESSION_ADOBE_DEFLATE)
+  {
+    if (!TIFFSetField(m_TIFFImage, TIFFTAG_ZIPQUALITY, m_CompressionLevel))
     {
-      itkDebugMacro( << "WARNING: mevisIO:write(): error setting COMPRESSION to LZW" );
+      itkDebugMacro( << "WARNING: mevisIO:write(): error setting ZIPQUALITY" );
     }
-  }else
+  }
+  unsigned short predictor = PREDICTOR_NONE;
+  if (compression != COMPRESSION_NONE && m_UseHorizontalPredictor)
   {
-    if (!TIFFSetField(m_TIFFImage, TIFFTAG_COMPRESSION, 1))
+    predictor = PREDICTOR_HORIZONTAL;
+    if (!TIFFSetField(m_TIFFImage, TIFFTAG_PREDICTOR, predictor))
     {
-      itkDebugMacro( << "WARNING: mevisIO:write(): error setting COMPRESSION to NONE" );
+      itkDebugMacro( << "WARNING: mevisIO:write(): error setting PREDICTOR" );
+      predictor = PREDICTOR_NONE;
     }
   }
+
   // resolution (always assuming cm)
   if (!TIFFSetField(m_TIFFImage, TIFFTAG_RESOLUTIONUNIT, RESUNIT_CENTIMETER))
   {
@@ -1970,144 +1956,68 @@ void MevisDicomTiffImageIO
     itkExceptionMacro( << "mevisIO:write(): image x,y smaller than tilesize (16)! Consider different layout for tif (eg scanline layout)");
     return;
   }
-  else
-  {
-    const unsigned int tilesize = TIFFTileSize(m_TIFFImage);
-    const unsigned int tilerowbytes = TIFFTileRowSize(m_TIFFImage);
-    const unsigned int bytespersample = m_BitsPerSample/8;
-
-    const unsigned char *vol = reinterpret_cast<const unsigned char*>(buffer);
-    unsigned char *tilebuf = static_cast<unsigned char*>(_TIFFmalloc(tilesize));
 
-    // is volume direction a multiple of tiledirection?
-    const bool mx = ( m_Width%m_TileWidth == 0) ? true: false;
-    const bool my = ( m_Length%m_TileLength == 0) ? true : false;
-
-    for (unsigned int z0 = 0; z0 < (m_TIFFDimension == 3 ? m_Depth:1); z0++)
+  // the tiles are encoded in parallel into memory, in batches to bound
+  // the memory use, and appended to the file in tile order with
+  // TIFFWriteRawTile. tiles at the right and bottom border are padded
+  // with zeros.
+  uint16 format = 1;
+  TIFFGetField(m_TIFFImage, TIFFTAG_SAMPLEFORMAT, &format);
+
+  MevisTileWriteStruct str;
+  str.Buffer = reinterpret_cast<const unsigned char*>(buffer);
+  str.Width = m_Width;
+  str.Length = m_Length;
+  str.Format.TileWidth = m_TileWidth;
+  str.Format.TileLength = m_TileLength;
+  str.Format.BitsPerSample = m_BitsPerSample;
+  str.Format.SampleFormat = format;
+  str.Format.Compression = compression;
+  str.Format.CompressionLevel = m_CompressionLevel;
+  str.Format.Predictor = predictor;
+  str.NumberOfTilesX = (m_Width + m_TileWidth - 1) / m_TileWidth;
+  str.NumberOfTilesY = (m_Length + m_TileLength - 1) / m_TileLength;
+  const unsigned long numberOfTiles = static_cast<unsigned long>(str.NumberOfTilesX)
+    * str.NumberOfTilesY * (m_TIFFDimension == 3 ? m_Depth : 1);
+
+  const unsigned long numberOfThreads = std::max<unsigned long>(1,
+    MultiThreader::GetGlobalDefaultNumberOfThreads());
+  const unsigned long batchSize = numberOfThreads * 16;
+  str.Errors.resize(numberOfThreads);
+
+  MultiThreader::Pointer threader = MultiThreader::New();
+  for (unsigned long first = 0; first < numberOfTiles; first += batchSize)
+  {
+    str.FirstTile = first;
+    str.NumberOfTiles = std::min(batchSize, numberOfTiles - first);
+    str.Tiles.clear();
+    str.Tiles.resize(str.NumberOfTiles);
+
+    threader->SetNumberOfThreads(std::min(numberOfThreads, str.NumberOfTiles));
+    threader->SetSingleMethod(MevisEncodeTilesThreaderCallback, &str);
+    threader->SingleMethodExecute();
+
+    for (unsigned int i = 0; i < str.Errors.size(); ++i)
     {
-      for (unsigned int y0 = 0; y0 < (my ? m_Length : m_Length-m_TileLength); y0 += m_TileLength)
-        for (unsigned int x0 = 0; x0 < (mx ? m_Width : m_Width-m_TileWidth); x0 += m_TileWidth)
-        {
-          // set bufferpointer to begin of tile
-          const unsigned char * pv = vol;
-          const unsigned int p = z0 * m_Length * m_Width + y0 * m_Width + x0;
-          pv += p * bytespersample;
-
-          // fill tile
-          unsigned char * pb = tilebuf;
-          for (unsigned int r=0; r<m_TileLength; ++r)
-          {
-            memcpy(pb,pv,tilerowbytes);
-            pv += m_Width * bytespersample;
-            pb += tilerowbytes;
-          }
-          // write tile
-          if (TIFFWriteTile(m_TIFFImage, tilebuf,x0,y0,z0,0)< 0)
-          {
-
-            _TIFFfree(tilebuf);
-            TIFFClose(m_TIFFImage);
-            itkExceptionMacro( << "mevisIO:write(): error writing tile." );
-            return;
-          }
-        }
-        // boundaries
-        if (!mx)
-        {
-          // x is fixed
-          const unsigned lenx = m_Width%m_TileWidth;
-          const unsigned int x0 = m_Width - lenx;
-          const unsigned int tilexbytes = lenx * bytespersample;
-
-          for (unsigned int y0 = 0; y0 < (my ? m_Length: m_Length - m_TileLength); y0 += m_TileLength)
-          {
-            const unsigned char * pv = vol;
-            const unsigned int p = z0 * m_Length * m_Width + y0 * m_Width + x0;
-            pv += p * bytespersample;
-
-            unsigned char * pb = tilebuf;
-            memset (pb,0,tilesize);
-
-            // fill tile
-            for (unsigned int r = 0; r<m_TileLength; ++r)
-            {
-              memcpy(pb,pv,tilexbytes);
-              pv += m_Width * bytespersample;
-              pb += tilerowbytes;
-            }
-
-            if (TIFFWriteTile(m_TIFFImage, tilebuf, x0, y0, z0, 0) < 0)
-            {
-              _TIFFfree(tilebuf);
-              TIFFClose(m_TIFFImage);
-              itkExceptionMacro( << "mevisIO:write(): error writing tile (ydirection)" );
-              return;
-            }
-          }
-        }
-        if (!my)
-        {
-          const unsigned leny = m_Length%m_TileLength;
-          const unsigned int y0 = m_Length - leny;
-
-          for (unsigned int x0 = 0; x0 < (mx ? m_Width : m_Width-m_TileWidth); x0 += m_TileWidth)
-          {
-            const unsigned char * pv = vol;
-            const unsigned int p = z0 * m_Length * m_Width + y0 * m_Width + x0;
-            pv += p * bytespersample;
-
-            unsigned char * pb = tilebuf;
-            memset (pb,0,tilesize);
-
-            for (unsigned int r = 0; r<leny; ++r)
-            {
-              memcpy(pb,pv,tilerowbytes);
-              pv += m_Width * bytespersample;
-              pb += tilerowbytes;
-            }
-
-            if (TIFFWriteTile(m_TIFFImage, tilebuf, x0, y0, z0, 0) < 0)
-            {
-              _TIFFfree(tilebuf);
-              TIFFClose(m_TIFFImage);
-              itkExceptionMacro( << "mevisIO:write(): error writing tile (x-direction)" );
-              return;
-            }
-          }
-        }
-        if (!mx && !my)
-        {
-          // x0,y0 is fixed
-          const unsigned lenx = m_Width%m_TileWidth;
-          const unsigned int x0 = m_Width - lenx;
-          const unsigned int tilexbytes = lenx * bytespersample;
-          const unsigned leny = m_Length%m_TileLength;
-          const unsigned int y0 = m_Length - leny;
-
-          const unsigned char * pv = vol;
-          const unsigned int p = z0 * m_Length * m_Width + y0 * m_Width + x0;
-          pv += p * bytespersample;
-
-          unsigned char * pb = tilebuf;
-          memset (pb,0,tilesize);
-
-          for (unsigned int r = 0; r<leny; ++r)
-          {
-            memcpy(pb,pv,tilexbytes);
-            pv += m_Width * bytespersample;
-            pb += tilerowbytes;
-          }
+      if (!str.Errors[i].empty())
+      {
+        TIFFClose(m_TIFFImage);
+        itkExceptionMacro( << "mevisIO:write(): " << str.Errors[i] );
+      }
+    }
 
-          if (TIFFWriteTile(m_TIFFImage, tilebuf, x0, y0, z0, 0) < 0)
-          {
-            _TIFFfree(tilebuf);
-            TIFFClose(m_TIFFImage);
-            itkExceptionMacro( << "mevisIO:write(): error writing tile (corner bottom)" );
-            return;
-          }
-        }
-    } // end z
-    _TIFFfree(tilebuf);
+    // write tiles, in order
+    for (unsigned long i = 0; i < str.NumberOfTiles; ++i)
+    {
+      std::vector<unsigned char> & data = str.Tiles[i];
+      if (TIFFWriteRawTile(m_TIFFImage, static_cast<ttile_t>(first + i),
+        &data[0], static_cast<tsize_t>(data.size())) < 0)
+      {
+        TIFFClose(m_TIFFImage);
+        itkExceptionMacro( << "mevisIO:write(): error writing tile." );
+        return;
+      }
+    }
   }
 
   TIFFClose(m_TIFFImage);
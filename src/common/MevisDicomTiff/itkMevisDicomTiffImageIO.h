@@ -64,10 +64,13 @@ namespace itk
  *  PROPERTIES:
  *  - 2D/3D/4D, scalar types supported
  *  - input/output tiff image expected to be tiled
+ *  - streamed reading of any region, only the tiles that intersect
+ *    the region are decoded
  *  - types supported uchar, char, ushort, short, uint, int, and float
  *    (double is not accepted by MevisLab)
  *  - writing defaults is tiled tiff, tilesize is 128, 128,
- *    LZW compression and cm metric system
+ *    LZW compression and cm metric system; deflate compression with a
+ *    configurable level and the horizontal predictor can be selected
  *  - default extension for tiff-image is ".tif" to comply with mevislab
  *    standards
  *  - gdcm header during reading is stored as (global) metadata
@@ -99,6 +102,13 @@ namespace itk
  *  18 apr 2011
  *    added reading dicom tags from sequences of tags, suggestion and
  *    code proposal by Reinhard Hameeteman
+ *  18 oct 2026
+ *    tiles are decoded in parallel, each thread using its own tiff
+ *    handle; full-width tiles are decoded directly into the buffer;
+ *    streamed reading: only the tiles intersecting the requested
+ *    region are decoded
+ *    tiles are compressed in parallel in memory and written in order
+ *    as raw tiles; added deflate compression and horizontal predictor
  *
  *  email: rashindra@gmail.com
  *
@@ -121,6 +131,22 @@ public:
   itkGetMacro(RescaleIntercept, double);
   itkGetMacro(GantryTilt, double);
 
+  /** Codec used when UseCompression is on. LZW is the MevisLab default,
+   * deflate is faster at a similar ratio. */
+  typedef enum { LZWCompression, DeflateCompression } CompressionMethodType;
+  itkSetMacro(CompressionMethod, CompressionMethodType);
+  itkGetConstMacro(CompressionMethod, CompressionMethodType);
+
+  /** The deflate compression level, 1 (fast) to 9 (small). Default 6. */
+  itkSetClampMacro(CompressionLevel, int, 1, 9);
+  itkGetConstMacro(CompressionLevel, int);
+
+  /** Apply the tiff horizontal differencing predictor before compression,
+   * which improves the ratio for smooth images. Default false. */
+  itkSetMacro(UseHorizontalPredictor, bool);
+  itkGetConstMacro(UseHorizontalPredictor, bool);
+  itkBooleanMacro(UseHorizontalPredictor);
+
   virtual bool CanReadFile(const char*);
   virtual void ReadImageInformation();
   virtual void Read(void* buffer);
@@ -129,7 +155,7 @@ public:
   virtual void Write(const void* buffer);
   virtual bool CanStreamRead()
     {
-    return false;
+    return true;
     }
 
   virtual bool CanStreamWrite()
@@ -173,6 +199,10 @@ private:
   double                                m_EstimatedMinimum;
   double                                m_EstimatedMaximum;
 
+  CompressionMethodType                 m_CompressionMethod;
+  int                                   m_CompressionLevel;
+  bool                                  m_UseHorizontalPredictor;
+
 };
 
 } // end namespace itk
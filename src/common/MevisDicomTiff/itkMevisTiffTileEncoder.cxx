@@ -0,0 +1,141 @@
+/*=========================================================================
+
+Program:   Insight Segmentation & Registration Toolkit
+Module:    $RCSfile: itkMevisTiffTileEncoder.cxx,v $
+Language:  C++
+
+Copyright (c) Insight Software Consortium. All rights reserved.
+See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+This software is distributed WITHOUT ANY WARRANTY; without even
+the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#include "itkMevisTiffTileEncoder.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace itk
+{
+
+namespace
+{
+
+// in-memory file for libtiff, used to encode single tiles
+struct MevisMemoryFile
+{
+  std::vector<unsigned char>  Data;
+  toff_t                      Position;
+};
+
+tsize_t MevisMemoryRead(thandle_t handle, tdata_t buf, tsize_t size)
+{
+  MevisMemoryFile * file = reinterpret_cast<MevisMemoryFile *>(handle);
+  if (file->Position >= file->Data.size())
+  {
+    return 0;
+  }
+  const tsize_t n = static_cast<tsize_t>(std::min<toff_t>(size, file->Data.size() - file->Position));
+  memcpy(buf, &file->Data[file->Position], n);
+  file->Position += n;
+  return n;
+}
+
+tsize_t MevisMemoryWrite(thandle_t handle, tdata_t buf, tsize_t size)
+{
+  MevisMemoryFile * file = reinterpret_cast<MevisMemoryFile *>(handle);
+  if (file->Position + size > file->Data.size())
+  {
+    file->Data.resize(file->Position + size);
+  }
+  memcpy(&file->Data[file->Position], buf, size);
+  file->Position += size;
+  return size;
+}
+
+toff_t MevisMemorySeek(thandle_t handle, toff_t offset, int whence)
+{
+  MevisMemoryFile * file = reinterpret_cast<MevisMemoryFile *>(handle);
+  switch (whence)
+  {
+  case SEEK_SET: file->Position = offset; break;
+  case SEEK_CUR: file->Position += offset; break;
+  case SEEK_END: file->Position = file->Data.size() + offset; break;
+  }
+  return file->Position;
+}
+
+int MevisMemoryClose(thandle_t)
+{
+  return 0;
+}
+
+toff_t MevisMemorySize(thandle_t handle)
+{
+  return reinterpret_cast<MevisMemoryFile *>(handle)->Data.size();
+}
+
+int MevisMemoryMap(thandle_t, tdata_t *, toff_t *)
+{
+  return 0;
+}
+
+void MevisMemoryUnmap(thandle_t, tdata_t, toff_t)
+{
+}
+
+} // end anonymous namespace
+
+
+bool MevisEncodeTile(const MevisTiffTileFormat & format,
+  unsigned char * tile, tsize_t tilesize, std::vector<unsigned char> & data)
+{
+  MevisMemoryFile file;
+  file.Position = 0;
+  TIFF * tif = TIFFClientOpen("memory", "w", reinterpret_cast<thandle_t>(&file),
+    MevisMemoryRead, MevisMemoryWrite, MevisMemorySeek, MevisMemoryClose,
+    MevisMemorySize, MevisMemoryMap, MevisMemoryUnmap);
+  if (tif == NULL)
+  {
+    return false;
+  }
+  TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, format.TileWidth);
+  TIFFSetField(tif, TIFFTAG_IMAGELENGTH, format.TileLength);
+  TIFFSetField(tif, TIFFTAG_TILEWIDTH, format.TileWidth);
+  TIFFSetField(tif, TIFFTAG_TILELENGTH, format.TileLength);
+  TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, format.BitsPerSample);
+  TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, 1);
+  TIFFSetField(tif, TIFFTAG_SAMPLEFORMAT, format.SampleFormat);
+  TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+  TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_MINISBLACK);
+  TIFFSetField(tif, TIFFTAG_COMPRESSION, format.Compression);
+  if (format.Compression == COMPRESSION_ADOBE_DEFLATE)
+  {
+    TIFFSetField(tif, TIFFTAG_ZIPQUALITY, format.CompressionLevel);
+  }
+  if (format.Predictor != PREDICTOR_NONE)
+  {
+    TIFFSetField(tif, TIFFTAG_PREDICTOR, format.Predictor);
+  }
+
+  // the tile is flushed by TIFFWriteEncodedTile, after which libtiff
+  // knows where it is and how long it is
+  bool ok = TIFFWriteEncodedTile(tif, 0, tile, tilesize) >= 0;
+  toff_t * offsets = NULL;
+  toff_t * bytecounts = NULL;
+  ok = ok && TIFFGetField(tif, TIFFTAG_TILEOFFSETS, &offsets)
+    && TIFFGetField(tif, TIFFTAG_TILEBYTECOUNTS, &bytecounts)
+    && offsets != NULL && bytecounts != NULL
+    && offsets[0] + bytecounts[0] <= file.Data.size();
+  if (ok)
+  {
+    data.assign(file.Data.begin() + offsets[0],
+      file.Data.begin() + offsets[0] + bytecounts[0]);
+  }
+  TIFFClose(tif);
+  return ok;
+}
+
+} // end namespace itk
@@ -0,0 +1,51 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    $RCSfile: itkMevisTiffTileEncoder.h,v $
+  Language:  C++
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkMevisTiffTileEncoder_h
+#define __itkMevisTiffTileEncoder_h
+
+#include "itk_tiff.h"
+#include <vector>
+
+namespace itk
+{
+
+/** The layout and codec of the tiles of a tiff file. */
+struct MevisTiffTileFormat
+{
+  unsigned int    TileWidth;
+  unsigned int    TileLength;
+  unsigned int    BitsPerSample;
+  unsigned short  SampleFormat;
+  unsigned short  Compression;
+  int             CompressionLevel; // for deflate
+  unsigned short  Predictor;
+};
+
+/** Encode a tile with the libtiff codec of format, so that it can be
+ * written with TIFFWriteRawTile to a file with the same tile format.
+ *
+ * The tile is written with TIFFWriteEncodedTile as the only tile of a
+ * tiff in memory, and the encoded bytes are taken from the tile offset
+ * and byte count that libtiff records for it. So the result does not
+ * depend on where libtiff puts the header, the directory or the tile in
+ * the file. Every thread can encode its own tiles. Note that the codec
+ * may modify tile, eg with the predictor. Returns false on errors.
+ */
+bool MevisEncodeTile(const MevisTiffTileFormat & format,
+  unsigned char * tile, tsize_t tilesize, std::vector<unsigned char> & data);
+
+} // end namespace itk
+
+#endif // __itkMevisTiffTileEncoder_h
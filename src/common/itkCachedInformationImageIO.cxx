@@ -0,0 +1,247 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#include "itkCachedInformationImageIO.h"
+
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+CachedInformationImageIO
+::CachedInformationImageIO()
+{
+  this->m_InformationFileName = "";
+
+} // end Constructor
+
+
+/**
+ * ******************* SetImageIO *******************
+ */
+
+void
+CachedInformationImageIO
+::SetImageIO( ImageIOBase * imageIO )
+{
+  if( this->m_ImageIO.GetPointer() == imageIO ) return;
+
+  this->m_ImageIO = imageIO;
+  this->m_InformationFileName = "";
+  this->Modified();
+
+} // end SetImageIO()
+
+
+/**
+ * ******************* CanReadFile *******************
+ */
+
+bool
+CachedInformationImageIO
+::CanReadFile( const char * fileName )
+{
+  return this->m_ImageIO.IsNotNull() && this->m_ImageIO->CanReadFile( fileName );
+
+} // end CanReadFile()
+
+
+/**
+ * ******************* UpdateImageIOInformation *******************
+ */
+
+void
+CachedInformationImageIO
+::UpdateImageIOInformation( void )
+{
+  if( this->m_ImageIO.IsNull() )
+  {
+    itkExceptionMacro( << "No ImageIO to read " << this->GetFileName() << " with." );
+  }
+
+  const std::string fileName = this->GetFileName();
+  if( fileName != this->m_InformationFileName )
+  {
+    this->m_InformationFileName = "";
+    this->m_ImageIO->SetFileName( fileName.c_str() );
+    this->m_ImageIO->ReadImageInformation();
+    this->m_InformationFileName = fileName;
+  }
+
+} // end UpdateImageIOInformation()
+
+
+/**
+ * ******************* ReadImageInformation *******************
+ */
+
+void
+CachedInformationImageIO
+::ReadImageInformation( void )
+{
+  this->UpdateImageIOInformation();
+
+  /** Copy the information, so that nothing a previous reader did remains. */
+  const ImageIOBase * imageIO = this->m_ImageIO;
+  const unsigned int dimension = imageIO->GetNumberOfDimensions();
+  this->SetNumberOfDimensions( dimension );
+  for( unsigned int i = 0; i < dimension; ++i )
+  {
+    this->SetDimensions( i, imageIO->GetDimensions( i ) );
+    this->SetSpacing( i, imageIO->GetSpacing( i ) );
+    this->SetOrigin( i, imageIO->GetOrigin( i ) );
+    this->SetDirection( i, imageIO->GetDirection( i ) );
+  }
+  this->SetPixelType( imageIO->GetPixelType() );
+  this->SetComponentType( imageIO->GetComponentType() );
+  this->SetNumberOfComponents( imageIO->GetNumberOfComponents() );
+  this->SetByteOrder( imageIO->GetByteOrder() );
+  this->SetFileType( imageIO->GetFileType() );
+  this->SetMetaDataDictionary( imageIO->GetMetaDataDictionary() );
+  this->ComputeStrides();
+
+} // end ReadImageInformation()
+
+
+/**
+ * ******************* Read *******************
+ */
+
+void
+CachedInformationImageIO
+::Read( void * buffer )
+{
+  this->UpdateImageIOInformation();
+  this->m_ImageIO->SetUseStreamedReading( this->GetUseStreamedReading() );
+  this->m_ImageIO->SetIORegion( this->GetIORegion() );
+  this->m_ImageIO->Read( buffer );
+
+} // end Read()
+
+
+/**
+ * ******************* CanStreamRead *******************
+ */
+
+bool
+CachedInformationImageIO
+::CanStreamRead( void )
+{
+  return this->m_ImageIO.IsNotNull() && this->m_ImageIO->CanStreamRead();
+
+} // end CanStreamRead()
+
+
+/**
+ * ******************* SetUseStreamedReading *******************
+ */
+
+void
+CachedInformationImageIO
+::SetUseStreamedReading( bool useStreamedReading )
+{
+  Superclass::SetUseStreamedReading( useStreamedReading );
+  if( this->m_ImageIO.IsNotNull() )
+  {
+    this->m_ImageIO->SetUseStreamedReading( useStreamedReading );
+  }
+
+} // end SetUseStreamedReading()
+
+
+/**
+ * ******************* SupportsDimension *******************
+ */
+
+bool
+CachedInformationImageIO
+::SupportsDimension( unsigned long dimension )
+{
+  return this->m_ImageIO.IsNotNull() && this->m_ImageIO->SupportsDimension( dimension );
+
+} // end SupportsDimension()
+
+
+/**
+ * ******************* GenerateStreamableReadRegionFromRequestedRegion *******************
+ */
+
+ImageIORegion
+CachedInformationImageIO
+::GenerateStreamableReadRegionFromRequestedRegion( const ImageIORegion & requested ) const
+{
+  if( this->m_ImageIO.IsNull() )
+  {
+    return Superclass::GenerateStreamableReadRegionFromRequestedRegion( requested );
+  }
+  return this->m_ImageIO->GenerateStreamableReadRegionFromRequestedRegion( requested );
+
+} // end GenerateStreamableReadRegionFromRequestedRegion()
+
+
+/**
+ * ******************* WriteImageInformation *******************
+ */
+
+void
+CachedInformationImageIO
+::WriteImageInformation( void )
+{
+  itkExceptionMacro( << "CachedInformationImageIO can not write." );
+
+} // end WriteImageInformation()
+
+
+/**
+ * ******************* Write *******************
+ */
+
+void
+CachedInformationImageIO
+::Write( const void * )
+{
+  itkExceptionMacro( << "CachedInformationImageIO can not write." );
+
+} // end Write()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+void
+CachedInformationImageIO
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+  os << indent << "InformationFileName: " << this->m_InformationFileName << std::endl;
+  os << indent << "ImageIO: ";
+  if( this->m_ImageIO.IsNotNull() )
+  {
+    os << this->m_ImageIO->GetNameOfClass() << std::endl;
+  }
+  else
+  {
+    os << "(none)" << std::endl;
+  }
+
+} // end PrintSelf()
+
+} // end namespace itk
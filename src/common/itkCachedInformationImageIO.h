@@ -0,0 +1,101 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkCachedInformationImageIO_h_
+#define __itkCachedInformationImageIO_h_
+
+#include "itkImageIOBase.h"
+#include <string>
+
+
+namespace itk
+{
+
+/**
+ * \class CachedInformationImageIO
+ *
+ * \brief Reads through another ImageIO, of which it parses the header once.
+ *
+ * itk::ImageFileReader calls ReadImageInformation() on its ImageIO every
+ * time it generates its output information. For a file that was already
+ * probed, e.g. by itktools::GetImageProperties(), this parses the header
+ * a second time. This ImageIO wraps the probing ImageIO: the header is
+ * read by the wrapped ImageIO once, and ReadImageInformation() copies the
+ * result of that, unless the file name changed. Since the information is
+ * copied again on every call, a reader of any pixel type starts from the
+ * information of the file, whatever an earlier reader did with it.
+ *
+ * Read() and the streaming queries are forwarded to the wrapped ImageIO.
+ * Writing is not supported.
+ */
+
+class CachedInformationImageIO : public ImageIOBase
+{
+public:
+  /** Standard class typedefs. */
+  typedef CachedInformationImageIO    Self;
+  typedef ImageIOBase                 Superclass;
+  typedef SmartPointer<Self>          Pointer;
+  typedef SmartPointer<const Self>    ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( CachedInformationImageIO, ImageIOBase );
+
+  /** The ImageIO that reads the file. */
+  void SetImageIO( ImageIOBase * imageIO );
+  itkGetObjectMacro( ImageIO, ImageIOBase );
+
+  /** Reading, forwarded to the wrapped ImageIO. */
+  virtual bool CanReadFile( const char * fileName );
+  virtual void ReadImageInformation( void );
+  virtual void Read( void * buffer );
+  virtual bool CanStreamRead( void );
+  virtual void SetUseStreamedReading( bool useStreamedReading );
+  virtual bool SupportsDimension( unsigned long dimension );
+  virtual ImageIORegion GenerateStreamableReadRegionFromRequestedRegion(
+    const ImageIORegion & requested ) const;
+
+  /** Writing is not supported. */
+  virtual bool CanWriteFile( const char * ) { return false; }
+  virtual void WriteImageInformation( void );
+  virtual void Write( const void * buffer );
+
+protected:
+  CachedInformationImageIO();
+  virtual ~CachedInformationImageIO() {}
+  virtual void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Let the wrapped ImageIO read the header, if it has not done so
+   * for the current file name.
+   */
+  void UpdateImageIOInformation( void );
+
+private:
+  CachedInformationImageIO( const Self & ); // purposely not implemented
+  void operator=( const Self & );           // purposely not implemented
+
+  ImageIOBase::Pointer  m_ImageIO;
+  std::string           m_InformationFileName;
+
+}; // end class CachedInformationImageIO
+
+} // end namespace itk
+
+#endif // end #ifndef __itkCachedInformationImageIO_h_
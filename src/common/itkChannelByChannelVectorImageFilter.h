@@ -18,11 +18,13 @@
 #ifndef __itkChannelByChannelVectorImageFilter_h
 #define __itkChannelByChannelVectorImageFilter_h
 
-#include "itkVectorIndexSelectionCastImageFilter.h" // decompose
-#include "itkImageToVectorImageFilter.h" // reassemble
 #include "itkImage.h"
 #include "itkVectorImage.h"
 #include "itkImageToImageFilter.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+
+#include <vector>
 
 namespace itk
 {
@@ -32,6 +34,13 @@ namespace itk
  *  The user can specify the inputs to this filter in two ways. First, they can specify a single filter to be used
  *  on every channel of the image. Second, they can specify a different filter (of the same class, but with different
  *  parameters) for each channel of the image. Filters with multiple inputs are allowed.
+ *
+ *  Every channel is copied from the inputs into scalar images, filtered, and copied straight into its component
+ *  of the output, without composing the channels afterwards.
+ *
+ *  With one filter per channel, the channels are processed concurrently, each filter with its share of the threads.
+ *  MaximumMemory limits the number of channels in flight, by the memory of their scalar inputs and output.
+ *  A single filter for all channels is run channel after channel, with all threads.
  */
 template <class TInputImage, class TOutputImage = TInputImage>
 class ITK_EXPORT ChannelByChannelVectorImageFilter
@@ -68,7 +77,17 @@ public:
   void SetAllFilters(FilterPointerType filter);
   void SetFilterForSingleChannel(unsigned int channel, FilterPointerType filter);
 
+  /** Set/Get the memory in bytes that the channels in flight may use. Default 0: unlimited. */
+  itkSetMacro(MaximumMemory, double);
+  itkGetConstMacro(MaximumMemory, double);
+
 protected:
+  /** Set the number of components of the output. */
+  virtual void GenerateOutputInformation(void);
+  /** The filters need the whole inputs. */
+  virtual void GenerateInputRequestedRegion(void);
+  /** The whole output is produced. */
+  virtual void EnlargeOutputRequestedRegion(DataObject * output);
   /** Main computation method */
   virtual void GenerateData(void);
   /** Constructor */
@@ -78,16 +97,36 @@ protected:
   /**PrintSelf method */
   virtual void PrintSelf(std::ostream& os, itk::Indent indent) const;
 
+  /** Copy a channel of the inputs into scalar images, run the filter on them,
+   * and copy its output into the channel of the output. */
+  void ProcessChannel(unsigned int channel, FilterType * filter, ThreadIdType numberOfThreads);
+
   /**If the user chooses to specify a filter for each channel separately, they are stored here.*/
   std::vector<FilterPointerType> m_Filters;
 
   /**If the user chooses to only specify a single filter to be used for all channels, it is stored here.*/
   FilterPointerType m_SingleFilter;
 
+  double m_MaximumMemory;
+
 private:
   ChannelByChannelVectorImageFilter(const Self &); //purposely not implemented
   void operator =(const Self&); //purposely not implemented
 
+  /** The data shared by the threads that process channels. */
+  struct ChannelStruct
+  {
+    Self *                    Filter;
+    unsigned int              NumberOfChannels;
+    unsigned int              NextChannel;
+    ThreadIdType              ThreadsPerChannel;
+    SimpleFastMutexLock       Mutex;
+    std::string               ErrorMessage;
+  };
+
+  /** Take channels from the shared counter and process them. */
+  static ITK_THREAD_RETURN_TYPE ChannelThreaderCallback(void * arg);
+
 };
 } // End namespace itk
 #ifndef ITK_MANUAL_INSTANTIATION
@@ -19,6 +19,9 @@
 #define __itkChannelByChannelVectorImageFilter_txx
 
 #include "itkChannelByChannelVectorImageFilter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+#include <algorithm>
 
 namespace itk
 {
@@ -27,9 +30,10 @@ namespace itk
  */
 template <class TInputImage, class TOutputImage>
 ChannelByChannelVectorImageFilter<TInputImage, TOutputImage>
-::ChannelByChannelVectorImageFilter2()
+::ChannelByChannelVectorImageFilter()
 {
   m_SingleFilter = NULL;
+  m_MaximumMemory = 0.0;
 }
 
 /**
@@ -38,10 +42,11 @@ ChannelByChannelVectorImageFilter<TInputImage, TOutputImage>
 template <class TInputImage, class TOutputImage>
 void
 ChannelByChannelVectorImageFilter<TInputImage, TOutputImage>
-::SetAllFilters(typename TFilter::Pointer filter)
+::SetAllFilters(FilterPointerType filter)
 {
   // For now, just store this filter. It will be applied to each channel later.
-  m_SingleFilter = dynamic_cast<FilterType*>(filter->CreateAnother().GetPointer());
+  m_SingleFilter = filter;
+  this->Modified();
 }
 
 /**
@@ -50,114 +55,246 @@ ChannelByChannelVectorImageFilter<TInputImage, TOutputImage>
 template <class TInputImage, class TOutputImage>
 void
 ChannelByChannelVectorImageFilter<TInputImage, TOutputImage>
-::SetFilterForSingleChannel(unsigned int channel, typename TFilter::Pointer filter)
+::SetFilterForSingleChannel(unsigned int channel, FilterPointerType filter)
 {
   // If necessary, expand the m_Filters vector and set the new elements to NULL
-  if(m_Filters.size() - 1 < channel)
+  if(channel >= m_Filters.size())
     {
-    m_Filters.resize(channel, NULL);
+    m_Filters.resize(channel + 1, NULL);
     }
 
   // Store the filter for the specified channel
   m_Filters[channel] = filter;
+  this->Modified();
 }
 
 /**
- * Main computation method
+ * Set the number of components of the output.
  */
 template <class TInputImage, class TOutputImage>
 void
 ChannelByChannelVectorImageFilter<TInputImage, TOutputImage>
-::GenerateData()
+::GenerateOutputInformation()
 {
-  // One of two conditions must be true:
-  // 1) The number of channels in the input matches the size of the m_Filters vector
-  // 2) m_SingleFilter is set
+  Superclass::GenerateOutputInformation();
 
-  // Case 1 - the number of channels in the input matches the size of m_Filters
-  bool valid = false;
-  if(m_Filters.size() == this->GetInput()->GetNumberOfComponentsPerPixel())
-  {
-    // If all filters have been set, we can proceed with case 1
-    valid = true;
+  this->GetOutput()->SetNumberOfComponentsPerPixel(
+    this->GetInput()->GetNumberOfComponentsPerPixel());
+}
 
-    // Ensure every filter has been set
-    for(unsigned int channel = 0; channel < numberOfChannels; ++channel)
-      {
-      if(!m_Filters[channel])
-  {
-  valid = false;
-  }
-      }
-  }
+/**
+ * Request the whole inputs.
+ */
+template <class TInputImage, class TOutputImage>
+void
+ChannelByChannelVectorImageFilter<TInputImage, TOutputImage>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
 
-  // Case 2 - m_SingleFilter is set
-  if(m_SingleFilter)
+  for(unsigned int inputId = 0; inputId < this->GetNumberOfInputs(); inputId++)
     {
-    if(valid) // if case 1 was true, the filter does not know which method to use!
+    InputVectorImageType * input = const_cast<InputVectorImageType *>(this->GetInput(inputId));
+    if(input)
       {
-      std::cerr << "You must set EITHER m_SingleFilter OR all of the filters (one per channel)" << std::endl;
-      return;
+      input->SetRequestedRegionToLargestPossibleRegion();
       }
-    // Create a filter for each channel - duplicating all of the settings of the input filter
-    for(unsigned int channel = 0; channel < numberOfChannels; ++channel) // how to know the number of channels at this point?
+    }
+}
+
+/**
+ * Produce the whole output.
+ */
+template <class TInputImage, class TOutputImage>
+void
+ChannelByChannelVectorImageFilter<TInputImage, TOutputImage>
+::EnlargeOutputRequestedRegion(DataObject * output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+/**
+ * Main computation method
+ */
+template <class TInputImage, class TOutputImage>
+void
+ChannelByChannelVectorImageFilter<TInputImage, TOutputImage>
+::GenerateData()
+{
+  const unsigned int numberOfChannels = this->GetInput()->GetNumberOfComponentsPerPixel();
+  for(unsigned int inputId = 1; inputId < this->GetNumberOfInputs(); inputId++)
+    {
+    if(this->GetInput(inputId)->GetNumberOfComponentsPerPixel() != numberOfChannels)
       {
-      m_Filters[channel] = m_SingleFilter;
+      itkExceptionMacro(<< "Input " << inputId << " does not have " << numberOfChannels << " channels.");
       }
-    valid = true;
     }
 
-  if(!valid)
+  // One of two conditions must be true:
+  // 1) The number of channels in the input matches the size of the m_Filters vector,
+  //    and all filters have been set
+  // 2) m_SingleFilter is set
+  bool perChannel = m_Filters.size() == numberOfChannels;
+  for(unsigned int channel = 0; perChannel && channel < numberOfChannels; ++channel)
     {
-    std::cerr << "Neither method was specified!" << std::endl;
-    return;
+    perChannel = m_Filters[channel].IsNotNull();
+    }
+  if(perChannel && m_SingleFilter)
+    {
+    itkExceptionMacro(<< "You must set EITHER a single filter OR all of the filters (one per channel).");
+    }
+  if(!perChannel && !m_SingleFilter)
+    {
+    itkExceptionMacro(<< "Set a single filter or one filter per channel.");
     }
 
-  // Typedefs
-  typedef itk::VectorIndexSelectionCastImageFilter<TInputImage, InputScalarImageType> DisassemblerType;
-  typedef itk::ImageToVectorImageFilter<InputScalarImageType> ReassemblerType;
+  this->AllocateOutputs();
 
-  // Create a vector to store the disassemblers. We will need one for each input to the filter.
-  std::vector<typename DisassemblerType::Pointer> disassemblers;
+  // The number of channels in flight: one filter can not run on two channels at once,
+  // and every channel in flight holds its scalar inputs and output.
+  const ThreadIdType numberOfThreads = std::max<ThreadIdType>(this->GetNumberOfThreads(), 1);
+  unsigned int channelsInFlight = perChannel ? std::min<unsigned int>(numberOfChannels, numberOfThreads) : 1;
+  if(m_MaximumMemory > 0.0)
+    {
+    const double memoryPerChannel = static_cast<double>(
+      this->GetInput()->GetBufferedRegion().GetNumberOfPixels())
+      * (this->GetNumberOfInputs() * sizeof(InputPixelType) + sizeof(OutputPixelType));
+    const unsigned int fits = static_cast<unsigned int>(m_MaximumMemory / memoryPerChannel);
+    channelsInFlight = std::max(1u, std::min(channelsInFlight, fits));
+    }
 
-  // Create a vector to store the outputs.
-  std::vector<InputScalarImageType::Pointer> outputs;
+  ChannelStruct str;
+  str.Filter = this;
+  str.NumberOfChannels = numberOfChannels;
+  str.NextChannel = 0;
+  str.ThreadsPerChannel = std::max<ThreadIdType>(1, numberOfThreads / channelsInFlight);
 
-  // Add each input image to its own disassembler
-  for(unsigned int inputId = 0; inputId < this->GetNumberOfInputs(); inputId++)
+  if(channelsInFlight == 1)
     {
-    typename DisassemblerType::Pointer disassembler = DisassemblerType::New();
-    disassembler->SetInput(this->GetInput(inputId));
-    disassemblers.push_back(disassembler);
+    for(unsigned int channel = 0; channel < numberOfChannels; channel++)
+      {
+      this->ProcessChannel(channel,
+        perChannel ? m_Filters[channel].GetPointer() : m_SingleFilter.GetPointer(),
+        str.ThreadsPerChannel);
+      this->UpdateProgress(static_cast<float>(channel + 1) / numberOfChannels);
+      }
+    return;
     }
 
-  // Create the re-assembler. Only one is needed.
-  typename ReassemblerType::Pointer reasassembler = ReassemblerType::New();
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads(channelsInFlight);
+  threader->SetSingleMethod(ChannelThreaderCallback, &str);
+  threader->SingleMethodExecute();
 
-  // Apply the filter to each channel
-  for(unsigned int channel = 0; channel < this->GetInput()->GetNumberOfComponentsPerPixel(); channel++)
+  if(str.ErrorMessage != "")
     {
-    // Get the 'channel'th channel of every input and feed it to the filter
-    for(unsigned int inputId = 0; inputId < this->GetNumberOfInputs(); inputId++)
+    itkExceptionMacro(<< str.ErrorMessage);
+    }
+}
+
+/**
+ * Take channels from the shared counter and process them.
+ */
+template <class TInputImage, class TOutputImage>
+ITK_THREAD_RETURN_TYPE
+ChannelByChannelVectorImageFilter<TInputImage, TOutputImage>
+::ChannelThreaderCallback(void * arg)
+{
+  MultiThreader::ThreadInfoStruct * info = static_cast<MultiThreader::ThreadInfoStruct *>(arg);
+  ChannelStruct * str = static_cast<ChannelStruct *>(info->UserData);
+
+  while(true)
+    {
+    str->Mutex.Lock();
+    const unsigned int channel = str->NextChannel++;
+    const bool stop = channel >= str->NumberOfChannels || str->ErrorMessage != "";
+    str->Mutex.Unlock();
+    if(stop)
       {
-      disassemblers[inputId]->SetIndex(channel);
-      disassemblers[inputId]->Update();
+      break;
+      }
 
-      filters[channel]->SetInput(inputId, disassemblers[inputId]->GetOutput());
-      filters[channel]->Update();
-      outputs.push_back(filters[channel]->GetOutput());
-      filters[channel]->DisconnectPipeline();
+    try
+      {
+      str->Filter->ProcessChannel(channel,
+        str->Filter->m_Filters[channel].GetPointer(), str->ThreadsPerChannel);
       }
+    catch(ExceptionObject & excp)
+      {
+      str->Mutex.Lock();
+      str->ErrorMessage = excp.GetDescription();
+      str->Mutex.Unlock();
+      }
+    }
 
-    // Add the 'channel'th output to the output vector image
-    reasassembler->SetNthInput(channel, outputs[channel]);
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+/**
+ * Process one channel.
+ */
+template <class TInputImage, class TOutputImage>
+void
+ChannelByChannelVectorImageFilter<TInputImage, TOutputImage>
+::ProcessChannel(unsigned int channel, FilterType * filter, ThreadIdType numberOfThreads)
+{
+  // Copy the 'channel'th channel of every input, and feed it to the filter
+  for(unsigned int inputId = 0; inputId < this->GetNumberOfInputs(); inputId++)
+    {
+    const InputVectorImageType * input = this->GetInput(inputId);
+    typename InputScalarImageType::Pointer scalar = InputScalarImageType::New();
+    scalar->CopyInformation(input);
+    scalar->SetBufferedRegion(input->GetBufferedRegion());
+    scalar->SetRequestedRegion(input->GetBufferedRegion());
+    scalar->Allocate();
+
+    const SizeValueType numberOfPixels = input->GetBufferedRegion().GetNumberOfPixels();
+    const unsigned int stride = input->GetNumberOfComponentsPerPixel();
+    const InputPixelType * in = input->GetBufferPointer() + channel;
+    InputPixelType * out = scalar->GetBufferPointer();
+    for(SizeValueType p = 0; p < numberOfPixels; ++p, in += stride)
+      {
+      out[p] = *in;
+      }
+
+    filter->SetInput(inputId, scalar);
     }
 
-  reasassembler->Update();
+  filter->SetNumberOfThreads(numberOfThreads);
+  filter->UpdateLargestPossibleRegion();
+
+  // Copy the result into the 'channel'th component of the output
+  OutputVectorImageType * output = this->GetOutput();
+  const OutputScalarImageType * result = filter->GetOutput();
+  const unsigned int stride = output->GetNumberOfComponentsPerPixel();
+  OutputPixelType * out = output->GetBufferPointer() + channel;
+  if(result->GetBufferedRegion() == output->GetBufferedRegion())
+    {
+    const SizeValueType numberOfPixels = output->GetBufferedRegion().GetNumberOfPixels();
+    const OutputPixelType * in = result->GetBufferPointer();
+    for(SizeValueType p = 0; p < numberOfPixels; ++p, out += stride)
+      {
+      *out = in[p];
+      }
+    }
+  else
+    {
+    ImageRegionConstIteratorWithIndex<OutputScalarImageType> it(result, output->GetBufferedRegion());
+    for(it.GoToBegin(); !it.IsAtEnd(); ++it)
+      {
+      out[output->ComputeOffset(it.GetIndex()) * stride] = it.Get();
+      }
+    }
 
-  // Copy the output (reassembled) to the output of the filter.
-  this->GraftOutput(reasassembler->GetOutput());
+  // Release the scalar images of this channel
+  filter->GetOutput()->ReleaseData();
+  for(unsigned int inputId = 0; inputId < this->GetNumberOfInputs(); inputId++)
+    {
+    filter->SetInput(inputId, NULL);
+    }
 }
+
 /**
  * PrintSelf Method
  */
@@ -167,6 +304,7 @@ ChannelByChannelVectorImageFilter<TInputImage, TOutputImage>
 ::PrintSelf(std::ostream& os, itk::Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
+  os << indent << "MaximumMemory: " << m_MaximumMemory << std::endl;
 }
 } // End namespace itk
 #endif
@@ -19,6 +19,7 @@
 #define __itkCommandLineArgumentParser_cxx_
 
 #include "itkCommandLineArgumentParser.h"
+#include "ITKToolsExecutionOptions.h"
 
 #include <limits>
 
@@ -260,7 +261,8 @@ CommandLineArgumentParser
   /** If no arguments were specified at all, display the help text. */
   if( this->m_Argv.size() == 1 )
   {
-    std::cerr << this->m_ProgramHelpText << std::endl;
+    std::cerr << this->m_ProgramHelpText << "\n\n"
+      << itktools::GetExecutionOptionsHelpString() << std::endl;
     return HELPREQUESTED;
   }
 
@@ -269,7 +271,8 @@ CommandLineArgumentParser
     || this->ArgumentExists( "-help" )
     || this->ArgumentExists( "--h" ) )
   {
-    std::cerr << this->m_ProgramHelpText << std::endl;
+    std::cerr << this->m_ProgramHelpText << "\n\n"
+      << itktools::GetExecutionOptionsHelpString() << std::endl;
     return HELPREQUESTED;
   }
 
@@ -309,6 +312,9 @@ CommandLineArgumentParser
 
   if( !allRequiredArgumentsSpecified ) return FAILED;
 
+  /** Apply the options that all tools share, e.g. -threads. */
+  if( !itktools::SetExecutionOptions( this ) ) return FAILED;
+
   return PASSED;
 
 } // end CheckForRequiredArguments()
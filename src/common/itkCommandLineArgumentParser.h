@@ -74,6 +74,10 @@ namespace itk
  * We make use of the casting functionality of string streams to
  * automatically cast the stored string to the requested type.
  *
+ * CheckForRequiredArguments() also applies the execution options that
+ * all tools share, such as -threads and -maxmem,
+ * see itktools::SetExecutionOptions().
+ *
  */
 
 class CommandLineArgumentParser :
@@ -0,0 +1,200 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkLabelGeometryCalculator_h_
+#define __itkLabelGeometryCalculator_h_
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkMultiThreader.h"
+#include "itkNumericTraits.h"
+
+#include <map>
+#include <vector>
+
+
+namespace itk
+{
+
+/** \class LabelGeometryCalculator
+ * \brief Computes the voxel count, bounding box and centroid of every label.
+ *
+ * Every pixel value other than the BackgroundValue is a label. For every
+ * label the number of voxels, the bounding box in index space and the
+ * sum of the voxel indices are accumulated, from which the volume, the
+ * world space bounding box and the centroid follow.
+ *
+ * Compute() adds the voxels of the Region, by default the buffered
+ * region of the image, to the labels computed so far. So an image that
+ * is read in slabs can be processed slab by slab, after a call to
+ * Initialize().
+ *
+ * The rows along the first dimension are divided over the threads,
+ * and every thread keeps its own label table, which are merged at the
+ * end. Rows without labels are skipped after a single comparison per
+ * voxel, and every run of equal labels in a row updates the table once.
+ * For 8 and 16 bit pixel types a label is found in a lookup table,
+ * otherwise in a map. The sums of indices are integers that are exact
+ * in double precision, so the results do not depend on the number of
+ * threads.
+ *
+ * \ingroup Operators
+ * \ingroup Multithreaded
+ */
+
+template < class TInputImage >
+class ITK_EXPORT LabelGeometryCalculator : public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef LabelGeometryCalculator     Self;
+  typedef Object                      Superclass;
+  typedef SmartPointer<Self>          Pointer;
+  typedef SmartPointer<const Self>    ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( LabelGeometryCalculator, Object );
+
+  /** Image dimension. */
+  itkStaticConstMacro( ImageDimension, unsigned int, TInputImage::ImageDimension );
+
+  /** Typedefs. */
+  typedef TInputImage                                 ImageType;
+  typedef typename ImageType::ConstPointer            ImageConstPointer;
+  typedef typename ImageType::PixelType               PixelType;
+  typedef typename ImageType::RegionType              RegionType;
+  typedef typename ImageType::IndexType               IndexType;
+  typedef typename IndexType::IndexValueType          IndexValueType;
+  typedef typename ImageType::PointType               PointType;
+
+  /** The geometry of a label, in index space. */
+  struct LabelGeometry
+  {
+    LabelGeometry();
+
+    /** Add the run of length voxels from index along the first dimension. */
+    void AddRun( const IndexType & index, const IndexValueType length );
+
+    /** Add the voxels of another label geometry. */
+    void Merge( const LabelGeometry & other );
+
+    SizeValueType   Count;
+    IndexType       MinimumIndex;
+    IndexType       MaximumIndex;
+    double          SumOfIndices[ ImageDimension ];
+  };
+
+  typedef std::map< PixelType, LabelGeometry >        LabelGeometryMapType;
+
+  /** Set/Get the image. */
+  itkSetConstObjectMacro( Image, ImageType );
+  itkGetConstObjectMacro( Image, ImageType );
+
+  /** Set the region to process, by default the buffered region of the image. */
+  void SetRegion( const RegionType & region );
+
+  /** Set/Get the background value, which is not a label. Default 0. */
+  itkSetMacro( BackgroundValue, PixelType );
+  itkGetConstMacro( BackgroundValue, PixelType );
+
+  /** Set/Get the number of threads. Default the global default. */
+  itkSetClampMacro( NumberOfThreads, ThreadIdType, 1, ITK_MAX_THREADS );
+  itkGetConstMacro( NumberOfThreads, ThreadIdType );
+
+  /** Remove all labels. */
+  void Initialize( void );
+
+  /** Add the labels of the region of the image. */
+  void Compute( void );
+
+  /** Get the labels, in increasing order. */
+  const LabelGeometryMapType & GetLabels( void ) const
+  { return this->m_Labels; }
+
+  /** Get the volume of a label, in physical units. */
+  double GetVolume( const LabelGeometry & geometry ) const;
+
+  /** Get the centroid of a label, in physical coordinates. */
+  PointType GetCentroid( const LabelGeometry & geometry ) const;
+
+  /** Get the axis aligned bounding box of a label in physical coordinates,
+   * spanned by the voxel centers of the corners of its index bounding box.
+   */
+  void GetBoundingBox( const LabelGeometry & geometry,
+    PointType & minimumPoint, PointType & maximumPoint ) const;
+
+protected:
+  LabelGeometryCalculator();
+  virtual ~LabelGeometryCalculator() {};
+
+  /** PrintSelf. */
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+private:
+  LabelGeometryCalculator( const Self & ); // purposely not implemented
+  void operator=( const Self & );          // purposely not implemented
+
+  /** The label table of a thread. Labels of 8 and 16 bit pixel types are
+   * looked up in Slots, others in SlotMap.
+   */
+  struct LabelTable
+  {
+    LabelTable();
+
+    /** Get the geometry of a label, adding it if it is new. */
+    LabelGeometry & Get( const PixelType label );
+
+    std::vector<int>              Slots;
+    std::map<PixelType, int>      SlotMap;
+    std::vector<PixelType>        Labels;
+    std::vector<LabelGeometry>    Geometries;
+  };
+
+  /** The data shared by the threads. */
+  struct ThreadStruct
+  {
+    Self *                    Calculator;
+    std::vector<LabelTable>   Tables;
+  };
+
+  /** Process the rows of a thread. */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void * arg );
+
+  /** Process the rows firstRow to lastRow - 1 of the region. */
+  void ThreadedCompute( const SizeValueType firstRow, const SizeValueType lastRow,
+    LabelTable & table ) const;
+
+  /** Member variables. */
+  ImageConstPointer       m_Image;
+  RegionType              m_Region;
+  bool                    m_RegionSetByUser;
+  PixelType               m_BackgroundValue;
+  ThreadIdType            m_NumberOfThreads;
+  LabelGeometryMapType    m_Labels;
+
+}; // end class LabelGeometryCalculator
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLabelGeometryCalculator.txx"
+#endif
+
+#endif // end #ifndef __itkLabelGeometryCalculator_h_
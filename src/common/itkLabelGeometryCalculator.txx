@@ -0,0 +1,423 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef _itkLabelGeometryCalculator_txx_
+#define _itkLabelGeometryCalculator_txx_
+
+#include "itkLabelGeometryCalculator.h"
+#include "itkContinuousIndex.h"
+
+#include <algorithm>
+#include <limits>
+
+
+namespace itk
+{
+
+/**
+ * ******************* LabelGeometry *******************
+ */
+
+template <class TInputImage>
+LabelGeometryCalculator<TInputImage>::LabelGeometry
+::LabelGeometry()
+{
+  this->Count = 0;
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    this->MinimumIndex[ i ] = NumericTraits<IndexValueType>::max();
+    this->MaximumIndex[ i ] = NumericTraits<IndexValueType>::NonpositiveMin();
+    this->SumOfIndices[ i ] = 0.0;
+  }
+
+} // end LabelGeometry()
+
+
+/**
+ * ******************* AddRun *******************
+ */
+
+template <class TInputImage>
+void
+LabelGeometryCalculator<TInputImage>::LabelGeometry
+::AddRun( const IndexType & index, const IndexValueType length )
+{
+  this->Count += length;
+
+  /** The run covers index[ 0 ] to index[ 0 ] + length - 1. */
+  const IndexValueType last = index[ 0 ] + length - 1;
+  this->MinimumIndex[ 0 ] = std::min( this->MinimumIndex[ 0 ], index[ 0 ] );
+  this->MaximumIndex[ 0 ] = std::max( this->MaximumIndex[ 0 ], last );
+  this->SumOfIndices[ 0 ] += 0.5 * static_cast<double>( length )
+    * static_cast<double>( index[ 0 ] + last );
+
+  for( unsigned int i = 1; i < ImageDimension; ++i )
+  {
+    this->MinimumIndex[ i ] = std::min( this->MinimumIndex[ i ], index[ i ] );
+    this->MaximumIndex[ i ] = std::max( this->MaximumIndex[ i ], index[ i ] );
+    this->SumOfIndices[ i ] += static_cast<double>( length ) * index[ i ];
+  }
+
+} // end AddRun()
+
+
+/**
+ * ******************* Merge *******************
+ */
+
+template <class TInputImage>
+void
+LabelGeometryCalculator<TInputImage>::LabelGeometry
+::Merge( const LabelGeometry & other )
+{
+  this->Count += other.Count;
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    this->MinimumIndex[ i ] = std::min( this->MinimumIndex[ i ], other.MinimumIndex[ i ] );
+    this->MaximumIndex[ i ] = std::max( this->MaximumIndex[ i ], other.MaximumIndex[ i ] );
+    this->SumOfIndices[ i ] += other.SumOfIndices[ i ];
+  }
+
+} // end Merge()
+
+
+/**
+ * ******************* LabelTable *******************
+ */
+
+template <class TInputImage>
+LabelGeometryCalculator<TInputImage>::LabelTable
+::LabelTable()
+{
+  if( std::numeric_limits<PixelType>::is_integer && sizeof( PixelType ) <= 2 )
+  {
+    this->Slots.resize( 1 << ( 8 * sizeof( PixelType ) ), -1 );
+  }
+
+} // end LabelTable()
+
+
+/**
+ * ******************* Get *******************
+ */
+
+template <class TInputImage>
+typename LabelGeometryCalculator<TInputImage>::LabelGeometry &
+LabelGeometryCalculator<TInputImage>::LabelTable
+::Get( const PixelType label )
+{
+  int * slot = 0;
+  if( !this->Slots.empty() )
+  {
+    slot = &this->Slots[ static_cast<long>( label )
+      - static_cast<long>( std::numeric_limits<PixelType>::min() ) ];
+  }
+  else
+  {
+    typename std::map<PixelType, int>::iterator it
+      = this->SlotMap.insert( std::make_pair( label, -1 ) ).first;
+    slot = &it->second;
+  }
+
+  if( *slot < 0 )
+  {
+    *slot = static_cast<int>( this->Geometries.size() );
+    this->Labels.push_back( label );
+    this->Geometries.push_back( LabelGeometry() );
+  }
+  return this->Geometries[ *slot ];
+
+} // end Get()
+
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template <class TInputImage>
+LabelGeometryCalculator<TInputImage>
+::LabelGeometryCalculator()
+{
+  this->m_Image = 0;
+  this->m_RegionSetByUser = false;
+  this->m_BackgroundValue = NumericTraits<PixelType>::Zero;
+  this->m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+
+} // end Constructor
+
+
+/**
+ * ******************* SetRegion *******************
+ */
+
+template <class TInputImage>
+void
+LabelGeometryCalculator<TInputImage>
+::SetRegion( const RegionType & region )
+{
+  this->m_Region = region;
+  this->m_RegionSetByUser = true;
+  this->Modified();
+
+} // end SetRegion()
+
+
+/**
+ * ******************* Initialize *******************
+ */
+
+template <class TInputImage>
+void
+LabelGeometryCalculator<TInputImage>
+::Initialize( void )
+{
+  this->m_Labels.clear();
+
+} // end Initialize()
+
+
+/**
+ * ******************* Compute *******************
+ */
+
+template <class TInputImage>
+void
+LabelGeometryCalculator<TInputImage>
+::Compute( void )
+{
+  if( this->m_Image.IsNull() )
+  {
+    itkExceptionMacro( << "ERROR: no image is set." );
+  }
+  if( !this->m_RegionSetByUser )
+  {
+    this->m_Region = this->m_Image->GetBufferedRegion();
+  }
+  if( !this->m_Image->GetBufferedRegion().IsInside( this->m_Region ) )
+  {
+    itkExceptionMacro( << "ERROR: the region " << this->m_Region
+      << " is not inside the buffered region of the image." );
+  }
+
+  /** Do not start more threads than there are rows. */
+  const SizeValueType rows = this->m_Region.GetNumberOfPixels()
+    / std::max<SizeValueType>( this->m_Region.GetSize()[ 0 ], 1 );
+  if( rows == 0 ) return;
+  const ThreadIdType numberOfThreads = static_cast<ThreadIdType>(
+    std::min<SizeValueType>( this->m_NumberOfThreads, rows ) );
+
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( numberOfThreads );
+
+  ThreadStruct str;
+  str.Calculator = this;
+  str.Tables.resize( threader->GetNumberOfThreads() );
+  threader->SetSingleMethod( this->ThreaderCallback, &str );
+  threader->SingleMethodExecute();
+
+  /** Merge the label tables of the threads. */
+  for( ThreadIdType t = 0; t < str.Tables.size(); ++t )
+  {
+    const LabelTable & table = str.Tables[ t ];
+    for( unsigned int i = 0; i < table.Labels.size(); ++i )
+    {
+      this->m_Labels[ table.Labels[ i ] ].Merge( table.Geometries[ i ] );
+    }
+  }
+
+} // end Compute()
+
+
+/**
+ * ******************* ThreaderCallback *******************
+ */
+
+template <class TInputImage>
+ITK_THREAD_RETURN_TYPE
+LabelGeometryCalculator<TInputImage>
+::ThreaderCallback( void * arg )
+{
+  MultiThreader::ThreadInfoStruct * info
+    = static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  ThreadStruct * str = static_cast<ThreadStruct *>( info->UserData );
+
+  /** The threads process equal parts of the rows. */
+  const RegionType & region = str->Calculator->m_Region;
+  const SizeValueType rows = region.GetNumberOfPixels() / region.GetSize()[ 0 ];
+  const ThreadIdType threadId = info->ThreadID;
+  if( threadId >= str->Tables.size() ) return ITK_THREAD_RETURN_VALUE;
+
+  const SizeValueType numberOfThreads = str->Tables.size();
+  const SizeValueType firstRow = rows * threadId / numberOfThreads;
+  const SizeValueType lastRow = rows * ( threadId + 1 ) / numberOfThreads;
+  str->Calculator->ThreadedCompute( firstRow, lastRow, str->Tables[ threadId ] );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ThreaderCallback()
+
+
+/**
+ * ******************* ThreadedCompute *******************
+ */
+
+template <class TInputImage>
+void
+LabelGeometryCalculator<TInputImage>
+::ThreadedCompute( const SizeValueType firstRow, const SizeValueType lastRow,
+  LabelTable & table ) const
+{
+  const RegionType & region = this->m_Region;
+  const IndexValueType rowLength = region.GetSize()[ 0 ];
+  const PixelType background = this->m_BackgroundValue;
+  const PixelType * buffer = this->m_Image->GetBufferPointer();
+
+  for( SizeValueType row = firstRow; row < lastRow; ++row )
+  {
+    /** The index of the first voxel of the row. */
+    IndexType index = region.GetIndex();
+    SizeValueType rest = row;
+    for( unsigned int i = 1; i < ImageDimension; ++i )
+    {
+      index[ i ] += rest % region.GetSize()[ i ];
+      rest /= region.GetSize()[ i ];
+    }
+    const PixelType * line = buffer + this->m_Image->ComputeOffset( index );
+
+    /** Skip the background at both ends, and rows of only background. */
+    IndexValueType first = 0;
+    while( first < rowLength && line[ first ] == background ) ++first;
+    if( first == rowLength ) continue;
+    IndexValueType end = rowLength;
+    while( line[ end - 1 ] == background ) --end;
+
+    /** Add the runs of equal labels. */
+    const IndexValueType start = index[ 0 ];
+    IndexValueType x = first;
+    while( x < end )
+    {
+      const PixelType label = line[ x ];
+      if( label == background )
+      {
+        ++x;
+        continue;
+      }
+      const IndexValueType runStart = x;
+      while( x < end && line[ x ] == label ) ++x;
+      index[ 0 ] = start + runStart;
+      table.Get( label ).AddRun( index, x - runStart );
+    }
+  }
+
+} // end ThreadedCompute()
+
+
+/**
+ * ******************* GetVolume *******************
+ */
+
+template <class TInputImage>
+double
+LabelGeometryCalculator<TInputImage>
+::GetVolume( const LabelGeometry & geometry ) const
+{
+  double voxelVolume = 1.0;
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    voxelVolume *= this->m_Image->GetSpacing()[ i ];
+  }
+  return geometry.Count * voxelVolume;
+
+} // end GetVolume()
+
+
+/**
+ * ******************* GetCentroid *******************
+ */
+
+template <class TInputImage>
+typename LabelGeometryCalculator<TInputImage>::PointType
+LabelGeometryCalculator<TInputImage>
+::GetCentroid( const LabelGeometry & geometry ) const
+{
+  ContinuousIndex<double, ImageDimension> cindex;
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    cindex[ i ] = geometry.Count > 0
+      ? geometry.SumOfIndices[ i ] / geometry.Count : 0.0;
+  }
+  PointType centroid;
+  this->m_Image->TransformContinuousIndexToPhysicalPoint( cindex, centroid );
+  return centroid;
+
+} // end GetCentroid()
+
+
+/**
+ * ******************* GetBoundingBox *******************
+ */
+
+template <class TInputImage>
+void
+LabelGeometryCalculator<TInputImage>
+::GetBoundingBox( const LabelGeometry & geometry,
+  PointType & minimumPoint, PointType & maximumPoint ) const
+{
+  /** Visit the 2^D corners, which differ with a direction cosine matrix. */
+  for( unsigned int corner = 0; corner < ( 1u << ImageDimension ); ++corner )
+  {
+    IndexType index;
+    for( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+      index[ i ] = ( corner >> i ) & 1
+        ? geometry.MaximumIndex[ i ] : geometry.MinimumIndex[ i ];
+    }
+    PointType point;
+    this->m_Image->TransformIndexToPhysicalPoint( index, point );
+    for( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+      if( corner == 0 || point[ i ] < minimumPoint[ i ] ) minimumPoint[ i ] = point[ i ];
+      if( corner == 0 || point[ i ] > maximumPoint[ i ] ) maximumPoint[ i ] = point[ i ];
+    }
+  }
+
+} // end GetBoundingBox()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template <class TInputImage>
+void
+LabelGeometryCalculator<TInputImage>
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Region: " << this->m_Region << std::endl;
+  os << indent << "BackgroundValue: "
+    << static_cast<typename NumericTraits<PixelType>::PrintType>( this->m_BackgroundValue )
+    << std::endl;
+  os << indent << "NumberOfThreads: " << this->m_NumberOfThreads << std::endl;
+  os << indent << "NumberOfLabels: " << this->m_Labels.size() << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef _itkLabelGeometryCalculator_txx_
@@ -43,7 +43,15 @@ std::string GetHelpString( void )
     << "Usage:\n"
     << "pxcomputeboundingbox\n"
     << "-in      inputFilename\n"
-    << "Supported: 2D, 3D, short. Images with PixelType other than short are automatically converted.";
+    << "[-labels] report every label separately: its voxel count, volume in mm^3,\n"
+    << "         bounding box in index and world space, and centroid.\n"
+    << "         All labels are found in a single pass over the image.\n"
+    << "[-format] the output format of the labels, \"text\" (default) for a table\n"
+    << "         or \"json\". Without -labels, \"json\" reports the pixels > 0 as label 1,\n"
+    << "         or an empty array if there are none.\n"
+    << "Supported: 2D, 3D, short. Images with PixelType other than short are automatically converted.\n"
+    << "With -labels: 2D, 3D, (unsigned) char, (unsigned) short, (unsigned) int.\n"
+    << "Images with a non-integer PixelType are converted to int.";
 
   return ss.str();
 
@@ -78,6 +86,16 @@ int main( int argc, char **argv )
   std::string inputFileName = "";
   parser->GetCommandLineArgument( "-in", inputFileName );
 
+  const bool labels = parser->ArgumentExists( "-labels" );
+
+  std::string format = "text";
+  parser->GetCommandLineArgument( "-format", format );
+  if( format != "text" && format != "json" )
+  {
+    std::cerr << "ERROR: -format should be one of {text, json}" << std::endl;
+    return EXIT_FAILURE;
+  }
+
   /** Determine image properties. */
   itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
   itk::ImageIOBase::IOComponentType componentType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
@@ -92,27 +110,40 @@ int main( int argc, char **argv )
   if( !retNOCCheck ) return EXIT_FAILURE;
 
   /** Overrule component type, since only short will do something,
-   * and it is not relevant in this case.
+   * and it is not relevant in this case. Labels keep their integer type.
    */
-  componentType = itk::ImageIOBase::SHORT;
+  if( !labels )
+  {
+    componentType = itk::ImageIOBase::SHORT;
+  }
+  else if( !itktools::ComponentTypeIsInteger( componentType ) )
+  {
+    componentType = itk::ImageIOBase::INT;
+  }
+  componentType = itktools::ReadComponentType<
+    itktools::LabelComponentTypes >::Get( componentType );
 
   /** Class that does the work. */
   ITKToolsComputeBoundingBoxBase * filter = 0;
 
   try
   {
-    // now call all possible template combinations.
-    if( !filter ) filter = ITKToolsComputeBoundingBox< 2, short >::New( dim, componentType );
+    /** Create the filter. Labels are read as one of a few types,
+     * e.g. unsigned char as short, which gives the same output with
+     * fewer instantiations.
+     */
+    filter = itktools::ToolDispatch< ITKToolsComputeBoundingBoxBase, ITKToolsComputeBoundingBox,
+      itktools::SupportedDimensions, itktools::LabelComponentTypes >
+      ::New( dim, componentType );
 
-#ifdef ITKTOOLS_3D_SUPPORT
-    if( !filter ) filter = ITKToolsComputeBoundingBox< 3, short >::New( dim, componentType );
-#endif
     /** Check if filter was instantiated. */
     bool supported = itktools::IsFilterSupportedCheck( filter, dim, componentType );
     if( !supported ) return EXIT_FAILURE;
 
     /** Set the filter arguments. */
     filter->m_InputFileName = inputFileName;
+    filter->m_Labels = labels;
+    filter->m_Format = format;
 
     filter->Run();
 
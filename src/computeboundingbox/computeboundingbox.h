@@ -19,10 +19,10 @@
 #define __computeboundingbox_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsLabelGeometry.h"
 
-#include "itkImageRegionConstIteratorWithIndex.h"
-#include "itkImageFileReader.h"
-#include "vnl/vnl_math.h"
+#include "itkImage.h"
+#include "itkLabelGeometryCalculator.h"
 
 
 /** \class ITKToolsComputeBoundingBoxBase
@@ -39,6 +39,8 @@ public:
   {
     this->m_InputFileName = "";
     this->m_OutputFileName = "";
+    this->m_Labels = false;
+    this->m_Format = "text";
   }
   /** Destructor. */
   ~ITKToolsComputeBoundingBoxBase(){};
@@ -46,6 +48,8 @@ public:
   /** Input member parameters. */
   std::string m_InputFileName;
   std::string m_OutputFileName;
+  bool m_Labels;
+  std::string m_Format;
 
 }; // end ITKToolsComputeBoundingBoxBase
 
@@ -54,6 +58,10 @@ public:
  *
  * Templated class that implements the Run() function
  * and the New() function for its creation.
+ *
+ * The image is read once, in slabs when possible, and all labels are
+ * found in that pass by the itk::LabelGeometryCalculator. Without
+ * m_Labels the labels > 0 are merged into one bounding box.
  */
 
 template< unsigned int VDimension, class TComponentType >
@@ -72,53 +80,62 @@ public:
   {
     /** Typedefs. */
     typedef itk::Image<TComponentType, VDimension>      InputImageType;
-    typedef itk::ImageFileReader< InputImageType >      ReaderType;
-    typedef itk::ImageRegionConstIteratorWithIndex<
-      InputImageType>                                   IteratorType;
-    typedef typename InputImageType::PixelType          PixelType;
+    typedef itk::LabelGeometryCalculator<
+      InputImageType >                                  CalculatorType;
+    typedef typename CalculatorType::LabelGeometry      LabelGeometryType;
+    typedef typename CalculatorType::LabelGeometryMapType LabelGeometryMapType;
+    typedef typename LabelGeometryMapType::const_iterator IteratorType;
+    typedef typename InputImageType::RegionType         RegionType;
     typedef typename InputImageType::IndexType          IndexType;
     typedef typename InputImageType::PointType          PointType;
     const unsigned int dimension = InputImageType::GetImageDimension();
 
-    /** Declarations */
-    typename ReaderType::Pointer reader = ReaderType::New();
-    typename InputImageType::Pointer image;
-    IndexType minIndex;
-    IndexType maxIndex;
+    /** Find the labels of the input image. */
+    typename CalculatorType::Pointer calculator = CalculatorType::New();
+    itktools::ComputeLabelGeometry( this->m_InputFileName, calculator.GetPointer() );
+    const LabelGeometryMapType & labels = calculator->GetLabels();
 
-    /** Read input image */
-    reader->SetFileName( this->m_InputFileName.c_str() );
-    reader->Update();
-    image = reader->GetOutput();
+    if( this->m_Labels )
+    {
+      itktools::PrintLabelGeometry( calculator.GetPointer(), labels,
+        this->m_Format, std::cout );
+      return;
+    }
 
-    /** Define iterator on input image */
-    IteratorType iterator( image, image->GetLargestPossibleRegion() );
+    /** Merge the labels > 0, as label 1. */
+    LabelGeometryMapType foreground;
+    LabelGeometryType & box = foreground[ 1 ];
+    for( IteratorType it = labels.begin(); it != labels.end(); ++it )
+    {
+      if( it->first > 0 ) box.Merge( it->second );
+    }
 
-    /** Initialize the two corner points */
-    iterator.GoToReverseBegin();
-    minIndex = iterator.GetIndex();
-    iterator.GoToBegin();
-    maxIndex = iterator.GetIndex();
-    PixelType zero = itk::NumericTraits< PixelType>::Zero;
+    if( this->m_Format == "json" )
+    {
+      /** Without pixels > 0 the array is empty. */
+      if( box.Count == 0 ) foreground.clear();
+      itktools::PrintLabelGeometry( calculator.GetPointer(), foreground,
+        this->m_Format, std::cout );
+      return;
+    }
 
-    while ( ! iterator.IsAtEnd() )
+    /** Without foreground the corners are reported the other way around. */
+    IndexType minIndex = box.MinimumIndex;
+    IndexType maxIndex = box.MaximumIndex;
+    if( box.Count == 0 )
     {
-      if( iterator.Get() > zero )
+      const RegionType region = calculator->GetImage()->GetLargestPossibleRegion();
+      for( unsigned int i = 0; i < dimension; ++i )
       {
-        const IndexType & index = iterator.GetIndex();
-        for( unsigned int i = 0; i < dimension; ++i )
-        {
-          minIndex[ i ] = vnl_math_min( index[ i ], minIndex[ i ] );
-          maxIndex[ i ] = vnl_math_max( index[ i ], maxIndex[ i ] );
-        }
+        minIndex[ i ] = region.GetIndex()[ i ] + region.GetSize()[ i ] - 1;
+        maxIndex[ i ] = region.GetIndex()[ i ];
       }
-      ++iterator;
     }
 
     PointType minPoint;
     PointType maxPoint;
-    image->TransformIndexToPhysicalPoint(minIndex, minPoint);
-    image->TransformIndexToPhysicalPoint(maxIndex, maxPoint);
+    calculator->GetImage()->TransformIndexToPhysicalPoint(minIndex, minPoint);
+    calculator->GetImage()->TransformIndexToPhysicalPoint(maxIndex, maxPoint);
 
     /** Print output. */
     std::cout << "MinimumIndex = " << minIndex << "\n"
@@ -19,6 +19,7 @@
 #define __contrastenhanceimage_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include <iostream>
 #include <string>
@@ -99,6 +100,7 @@ public:
     /** Try to read input image */
     typename ReaderType::Pointer reader = ReaderType::New();
     reader->SetFileName( this->m_InputFileName.c_str() );
+    itktools::ReuseImageIO( reader, this->m_InputFileName );
     reader->Update();
 
     /** Setup pipeline and configure its components */
@@ -112,6 +114,7 @@ public:
     typename WriterType::Pointer writer = WriterType::New();
     writer->SetInput( enhancer->GetOutput() );
     writer->SetFileName( this->m_OutputFileName.c_str() );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
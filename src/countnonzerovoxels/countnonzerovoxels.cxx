@@ -26,9 +26,7 @@
 
 #include "itkCommandLineArgumentParser.h"
 #include "ITKToolsHelpers.h"
-
-#include "itkImageFileReader.h"
-#include "itkImageRegionConstIterator.h"
+#include "countnonzerovoxels.h"
 
 
 /**
@@ -39,9 +37,20 @@ std::string GetHelpString( void )
 {
   std::stringstream ss;
   ss << "ITKTools v" << itktools::GetITKToolsVersion() << "\n"
+    << "This program counts the nonzero voxels of an image.\n"
+    << "Returns the count and the volume in ml.\n"
     << "Usage:\n"
     << "pxcountnonzerovoxels\n"
-    << "  -in      inputFilename";
+    << "  -in      inputFilename\n"
+    << "  [-labels] report every label separately: its voxel count, volume in mm^3,\n"
+    << "           bounding box in index and world space, and centroid.\n"
+    << "           All labels are found in a single pass over the image.\n"
+    << "  [-format] the output format of the labels, \"text\" (default) for a table\n"
+    << "           or \"json\". Without -labels, \"json\" reports the nonzero voxels as label 1,\n"
+    << "           or an empty array if there are none.\n"
+    << "Supported: 2D, 3D, short. Images with PixelType other than short are automatically converted.\n"
+    << "With -labels: 2D, 3D, (unsigned) char, (unsigned) short, (unsigned) int.\n"
+    << "Images with a non-integer PixelType are converted to int.";
   return ss.str();
 
 } // end GetHelpString()
@@ -75,61 +84,77 @@ int main( int argc, char *argv[] )
   std::string inputFileName;
   parser->GetCommandLineArgument( "-in", inputFileName );
 
-  // Some consts.
-  const unsigned int  Dimension = 3;
-  typedef short PixelType;
+  const bool labels = parser->ArgumentExists( "-labels" );
 
-  // TYPEDEF's
-  typedef itk::Image< PixelType, Dimension >          ImageType;
-  typedef ImageType::SpacingType                      SpacingType;
-  typedef itk::ImageFileReader< ImageType >           ReaderType;
-  typedef itk::ImageRegionConstIterator< ImageType >  IteratorType;
+  std::string format = "text";
+  parser->GetCommandLineArgument( "-format", format );
+  if( format != "text" && format != "json" )
+  {
+    std::cerr << "ERROR: -format should be one of {text, json}" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /** Determine image properties. */
+  itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
+  itk::ImageIOBase::IOComponentType componentType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
+  unsigned int dim = 0;
+  unsigned int numberOfComponents = 0;
+  bool retgip = itktools::GetImageProperties(
+    inputFileName, pixelType, componentType, dim, numberOfComponents );
+  if( !retgip ) return EXIT_FAILURE;
+
+  /** Check for vector images. */
+  bool retNOCCheck = itktools::NumberOfComponentsCheck( numberOfComponents );
+  if( !retNOCCheck ) return EXIT_FAILURE;
+
+  /** Without labels the voxels are counted as short, as before.
+   * Labels keep their integer type.
+   */
+  if( !labels )
+  {
+    componentType = itk::ImageIOBase::SHORT;
+  }
+  else if( !itktools::ComponentTypeIsInteger( componentType ) )
+  {
+    componentType = itk::ImageIOBase::INT;
+  }
+  componentType = itktools::ReadComponentType<
+    itktools::LabelComponentTypes >::Get( componentType );
 
-  /** Read image. */
-  ReaderType::Pointer reader = ReaderType::New();
-  reader->SetFileName( inputFileName.c_str() );
+  /** Class that does the work. */
+  ITKToolsCountNonZeroVoxelsBase * filter = 0;
 
   try
   {
-    reader->Update();
+    /** Create the filter. Labels are read as one of a few types,
+     * e.g. unsigned char as short, which gives the same output with
+     * fewer instantiations.
+     */
+    filter = itktools::ToolDispatch< ITKToolsCountNonZeroVoxelsBase, ITKToolsCountNonZeroVoxels,
+      itktools::SupportedDimensions, itktools::LabelComponentTypes >
+      ::New( dim, componentType );
+
+    /** Check if filter was instantiated. */
+    bool supported = itktools::IsFilterSupportedCheck( filter, dim, componentType );
+    if( !supported ) return EXIT_FAILURE;
+
+    /** Set the filter arguments. */
+    filter->m_InputFileName = inputFileName;
+    filter->m_Labels = labels;
+    filter->m_Format = format;
+
+    filter->Run();
+
+    delete filter;
   }
   catch( itk::ExceptionObject & excp )
   {
-    std::cerr << "ERROR: caught ITK exception while reading image "
-      << inputFileName << "." << std::endl;
-    std::cerr << excp << std::endl;
+    std::cerr << "ERROR: Caught ITK exception: " << excp << std::endl;
+    delete filter;
     return EXIT_FAILURE;
   }
 
-  /** Get the spacing. */
-  SpacingType sp = reader->GetOutput()->GetSpacing();
-  double voxelVolume = 1.0;
-  for( unsigned int i = 0; i < Dimension; i++ )
-  {
-    voxelVolume *= sp[ i ];
-  }
-
-  /** Create iterator and counter. */
-  IteratorType it( reader->GetOutput(),
-    reader->GetOutput()->GetLargestPossibleRegion() );
-  it.GoToBegin();
-  std::size_t counter = 0;
-
-  /** Walk over the image. */
-  while ( !it.IsAtEnd() )
-  {
-    if( it.Value() )
-    {
-      counter++;
-    }
-    ++it;
-  } // end while
-
-  /** Print to screen. */
-  std::cout << "count: " << counter << std::endl;
-  std::cout << "volume: " << counter * voxelVolume / 1000.0 << std::endl;
-
-  /** End program. Return a value. */
+  /** End program. */
   return EXIT_SUCCESS;
 
 } // end main
@@ -0,0 +1,124 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __countnonzerovoxels_h_
+#define __countnonzerovoxels_h_
+
+#include "ITKToolsBase.h"
+#include "ITKToolsLabelGeometry.h"
+
+#include "itkImage.h"
+#include "itkLabelGeometryCalculator.h"
+
+
+/** \class ITKToolsCountNonZeroVoxelsBase
+ *
+ * Untemplated pure virtual base class that holds
+ * the Run() function and all required parameters.
+ */
+
+class ITKToolsCountNonZeroVoxelsBase : public itktools::ITKToolsBase
+{
+public:
+  /** Constructor. */
+  ITKToolsCountNonZeroVoxelsBase()
+  {
+    this->m_InputFileName = "";
+    this->m_Labels = false;
+    this->m_Format = "text";
+  }
+  /** Destructor. */
+  ~ITKToolsCountNonZeroVoxelsBase(){};
+
+  /** Input member parameters. */
+  std::string m_InputFileName;
+  bool m_Labels;
+  std::string m_Format;
+
+}; // end ITKToolsCountNonZeroVoxelsBase
+
+
+/** \class ITKToolsCountNonZeroVoxels
+ *
+ * Templated class that implements the Run() function
+ * and the New() function for its creation.
+ *
+ * The image is read once, in slabs when possible, and all labels are
+ * found in that pass by the itk::LabelGeometryCalculator. Without
+ * m_Labels all nonzero labels are counted together.
+ */
+
+template< unsigned int VDimension, class TComponentType >
+class ITKToolsCountNonZeroVoxels : public ITKToolsCountNonZeroVoxelsBase
+{
+public:
+  /** Standard ITKTools stuff. */
+  typedef ITKToolsCountNonZeroVoxels Self;
+  itktoolsOneTypeNewMacro( Self );
+
+  ITKToolsCountNonZeroVoxels(){};
+  ~ITKToolsCountNonZeroVoxels(){};
+
+  /** Run function. */
+  void Run( void )
+  {
+    /** Typedefs. */
+    typedef itk::Image<TComponentType, VDimension>      InputImageType;
+    typedef itk::LabelGeometryCalculator<
+      InputImageType >                                  CalculatorType;
+    typedef typename CalculatorType::LabelGeometry      LabelGeometryType;
+    typedef typename CalculatorType::LabelGeometryMapType LabelGeometryMapType;
+    typedef typename LabelGeometryMapType::const_iterator IteratorType;
+
+    /** Find the labels of the input image. */
+    typename CalculatorType::Pointer calculator = CalculatorType::New();
+    itktools::ComputeLabelGeometry( this->m_InputFileName, calculator.GetPointer() );
+    const LabelGeometryMapType & labels = calculator->GetLabels();
+
+    if( this->m_Labels )
+    {
+      itktools::PrintLabelGeometry( calculator.GetPointer(), labels,
+        this->m_Format, std::cout );
+      return;
+    }
+
+    /** Merge the nonzero labels, as label 1. */
+    LabelGeometryMapType foreground;
+    LabelGeometryType & nonzero = foreground[ 1 ];
+    for( IteratorType it = labels.begin(); it != labels.end(); ++it )
+    {
+      nonzero.Merge( it->second );
+    }
+
+    if( this->m_Format == "json" )
+    {
+      /** Without nonzero voxels the array is empty. */
+      if( nonzero.Count == 0 ) foreground.clear();
+      itktools::PrintLabelGeometry( calculator.GetPointer(), foreground,
+        this->m_Format, std::cout );
+      return;
+    }
+
+    /** Print to screen. */
+    std::cout << "count: " << nonzero.Count << std::endl;
+    std::cout << "volume: " << calculator->GetVolume( nonzero ) / 1000.0 << std::endl;
+
+  } // end Run()
+
+}; // end class ITKToolsCountNonZeroVoxels
+
+#endif // end #ifndef __countnonzerovoxels_h_
@@ -20,6 +20,7 @@
 
 #include "ITKToolsBase.h"
 #include "ITKToolsHelpers.h"
+#include "ITKToolsTiming.h"
 #include "CommandLineArgumentHelper.h"
 
 #include "itkBoxSpatialFunction.h"
@@ -201,6 +202,7 @@ public:
     typename ImageWriterType::Pointer writer = ImageWriterType::New();
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetInput( image );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
@@ -27,6 +27,7 @@
 #include "itkCommandLineArgumentParser.h"
 #include "ITKToolsHelpers.h"
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkCylinderSpatialFunction.h"
 #include "itkImageRegionIteratorWithIndex.h"
@@ -114,6 +115,7 @@ public:
     /** Create a testReader. */
     typename ReaderType::Pointer testReader = ReaderType::New();
     testReader->SetFileName( this->m_InputFileName.c_str() );
+    itktools::ReuseImageIO( testReader, this->m_InputFileName );
     testReader->Update();
 
     typename OutputImageType::Pointer outputImage = OutputImageType::New();
@@ -159,6 +161,7 @@ public:
     typename WriterType::Pointer writer = WriterType::New();
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetInput( outputImage );
+    itktools::AddTimingObservers( writer );
     writer->Update();
   }
 
@@ -19,6 +19,7 @@
 #define __createellipsoid_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkEllipsoidInteriorExteriorSpatialFunction.h"
 #include "itkImageRegionIterator.h"
@@ -140,6 +141,7 @@ public:
     typename ImageWriterType::Pointer writer = ImageWriterType::New();
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetInput( image );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
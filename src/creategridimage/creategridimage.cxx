@@ -27,6 +27,7 @@
 #include "itkCommandLineArgumentParser.h"
 #include "ITKToolsHelpers.h"
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImage.h"
 #include "itkImageRegionIteratorWithIndex.h"
@@ -127,6 +128,7 @@ public:
     if( this->m_InputFileName != "" )
     {
       reader->SetFileName( this->m_InputFileName.c_str() );
+      itktools::ReuseImageIO( reader, this->m_InputFileName );
       reader->GenerateOutputInformation();
 
       SizeType size = reader->GetOutput()->GetLargestPossibleRegion().GetSize();
@@ -179,6 +181,7 @@ public:
     /* Write result to file. */
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetInput( image );
+    itktools::AddTimingObservers( writer );
     writer->Update();
   }
 
@@ -129,11 +129,15 @@ int main( int argc, char** argv )
     makeString << "-d" << i;
     unsigned int dimsize = 0;
     bool retdimsize = parser->GetCommandLineArgument( makeString.str(), dimsize );
-    if( !retdimsize )
+    if( !retdimsize || dimsize == 0 )
     {
-      sizes[ i ] = dimsize;
-      nrOfPixels *= sizes[ i ];
+      std::cerr << "ERROR: " << makeString.str()
+        << " should be given and larger than 0 for an image of dimension "
+        << dim << "." << std::endl;
+      return EXIT_FAILURE;
     }
+    sizes[ i ] = dimsize;
+    nrOfPixels *= sizes[ i ];
   }
 
   unsigned long resolution = nrOfPixels / 64;
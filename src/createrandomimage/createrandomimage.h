@@ -19,6 +19,7 @@
 #define __createrandomimage_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImageFileWriter.h"
 #include "itkArray.h"
@@ -300,6 +301,7 @@ public:
 
     vectorWriter = VectorWriterType::New();
     vectorWriter->SetInput(imageToVectorImageFilter->GetOutput());
+    itktools::AddTimingObservers( vectorWriter );
     vectorWriter->Update();
 
   } // end Run()
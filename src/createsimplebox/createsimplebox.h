@@ -19,6 +19,7 @@
 #define __createsimplebox_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImage.h"
 #include "itkImageFileReader.h"
@@ -125,6 +126,7 @@ public:
       /** Take dimension, origin and spacing from the inputfile.*/
       ReaderPointer reader = ReaderType::New();
       reader->SetFileName( this->m_InputFileName.c_str() );
+      itktools::ReuseImageIO( reader, this->m_InputFileName );
       reader->Update();
 
       ImagePointer inputImage = reader->GetOutput();
@@ -174,6 +176,7 @@ public:
 
     writer->SetInput( boxGenerator->GetOutput() );
     writer->SetFileName( this->m_OutputFileName.c_str() );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
@@ -19,6 +19,7 @@
 #define __createsphere_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkSphereSpatialFunction.h"
 #include "itkImageRegionIterator.h"
@@ -130,6 +131,7 @@ public:
     typename ImageWriterType::Pointer writer = ImageWriterType::New();
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetInput( image );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
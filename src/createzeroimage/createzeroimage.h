@@ -19,6 +19,7 @@
 #define __createzeroimage_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 #include "itkImage.h"
 #include "itkImageFileWriter.h"
 
@@ -100,6 +101,7 @@ public:
     typename WriterType::Pointer writer = WriterType::New();
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetInput( image );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
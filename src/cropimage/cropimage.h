@@ -19,6 +19,7 @@
 #define __cropimage_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImage.h"
 #include "itkCropImageFilter.h"
@@ -101,9 +102,13 @@ public:
     typename ReaderType::Pointer reader = ReaderType::New();
     typename WriterType::Pointer writer = WriterType::New();
 
-    /** Read the image. */
+    /** Set up the reader. Nothing is read until the writer updates the
+     * pipeline; the crop filter then requests only the cropped region,
+     * so formats that support streamed reading read just that part.
+     */
     reader->SetFileName( this->m_InputFileName.c_str() );
-    reader->Update();
+    itktools::ReuseImageIO( reader, this->m_InputFileName );
+    reader->UseStreamingOn();
 
     /** Convert the lower and upper boundary to SizeType. */
     SizeType downSize, upSize;
@@ -143,6 +148,7 @@ public:
     /** Setup and process the pipeline. */
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetUseCompression( this->m_UseCompression );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
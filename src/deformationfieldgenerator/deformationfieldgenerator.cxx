@@ -50,6 +50,9 @@ std::string GetHelpString( void )
     << "           with points in the fixed image.\n"
     << "  -ipp2    inputPointFile2: a transformix style input point file\n"
     << "           with the corresponding points in the moving image.\n"
+    << "  [-opp]   outputPointFile1 outputPointFile2: write the input points\n"
+    << "           also in the binary point file format, which is read without\n"
+    << "           parsing, to speed up later runs with the same points.\n"
     << "  [-s]     stiffness: a number that allows to vary between\n"
     << "           interpolating and approximating spline.\n"
     << "           0.0 = interpolating = default.\n"
@@ -64,6 +67,12 @@ std::string GetHelpString( void )
     << "           EBSR: elastic body reciprocal spline\n"
     << "           See ITK documentation and the there cited paper\n"
     << "           for more information on these methods.\n"
+    << "  [-e]     maximum error of the far field approximation, in mm:\n"
+    << "           clusters of landmarks that are far from a voxel are\n"
+    << "           replaced by a first order expansion, such that every\n"
+    << "           displacement component differs at most this value from\n"
+    << "           the exact field. Only for TPS, TPSR2LOGR and VS.\n"
+    << "           default 0.0: exact\n"
     << "  -out     outputFilename: the name of the resulting deformation field,\n"
     << "           which is written as a vector<float/double,dim> image.\n"
     << "  [-opct]  output pixel component type, choose one of {float, double}, default float.\n"
@@ -113,6 +122,14 @@ int main( int argc, char **argv )
   std::string inputPoints2FileName = "";
   parser->GetCommandLineArgument( "-ipp2", inputPoints2FileName );
 
+  std::vector<std::string> outputPointsFileNames;
+  parser->GetCommandLineArgument( "-opp", outputPointsFileNames );
+  if( !outputPointsFileNames.empty() && outputPointsFileNames.size() != 2 )
+  {
+    std::cerr << "ERROR: -opp should be followed by two file names." << std::endl;
+    return EXIT_FAILURE;
+  }
+
   std::string outputImageFileName = "";
   parser->GetCommandLineArgument( "-out", outputImageFileName );
 
@@ -122,6 +139,9 @@ int main( int argc, char **argv )
   double stiffness = 0.0;
   parser->GetCommandLineArgument( "-s", stiffness );
 
+  double maximumError = 0.0;
+  parser->GetCommandLineArgument( "-e", maximumError );
+
   /** Determine image properties. */
   itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
   itk::ImageIOBase::IOComponentType componentType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
@@ -162,9 +182,11 @@ int main( int argc, char **argv )
     filter->m_InputImage2FileName = inputImage2FileName;
     filter->m_InputPoints1FileName = inputPoints1FileName;
     filter->m_InputPoints2FileName = inputPoints2FileName;
+    filter->m_OutputPointsFileNames = outputPointsFileNames;
     filter->m_OutputImageFileName = outputImageFileName;
     filter->m_KernelName = kernelName;
     filter->m_Stiffness = stiffness;
+    filter->m_MaximumError = maximumError;
 
     filter->Run();
 
@@ -19,11 +19,12 @@
 #define __deformationfieldgenerator_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
-#include "itkImageRegionIteratorWithIndex.h"
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 #include "itkTransformixInputPointFileReader.h"
+#include "itkTransformixInputPointFileWriter.h"
 #include "itkVector.h"
 #include "itkImage.h"
 #include "itkThinPlateSplineKernelTransform.h"
@@ -31,8 +32,11 @@
 #include "itkVolumeSplineKernelTransform.h"
 #include "itkElasticBodySplineKernelTransform.h"
 #include "itkElasticBodyReciprocalSplineKernelTransform.h"
+#include "itkKernelTransformDisplacementFieldSource.h"
 #include "vnl/vnl_math.h"
 
+#include <vector>
+
 
 /** \class ITKToolsDeformationFieldGeneratorBase
  *
@@ -53,6 +57,7 @@ public:
     this->m_OutputImageFileName = "";
     this->m_KernelName = "";
     this->m_Stiffness = 0.0f;
+    this->m_MaximumError = 0.0;
   };
   /** Destructor. */
   ~ITKToolsDeformationFieldGeneratorBase(){};
@@ -62,9 +67,11 @@ public:
   std::string m_InputImage2FileName;
   std::string m_InputPoints1FileName;
   std::string m_InputPoints2FileName;
+  std::vector<std::string> m_OutputPointsFileNames;
   std::string m_OutputImageFileName;
   std::string m_KernelName;
   double m_Stiffness;
+  double m_MaximumError;
 
 }; // end class ITKToolsDeformationFieldGeneratorBase
 
@@ -99,8 +106,6 @@ public:
     typedef itk::Vector<
       DeformationVectorValueType, VDimension >              DeformationVectorType;
     typedef itk::Image< DeformationVectorType, VDimension > DeformationFieldType;
-    typedef itk::ImageRegionIteratorWithIndex<
-      DeformationFieldType >                                DeformationFieldIteratorType;
     typedef itk::ImageFileWriter< DeformationFieldType >    DeformationFieldWriterType;
     typedef typename DeformationFieldType::IndexType        IndexType;
     typedef typename DeformationFieldType::PointType        PointType;
@@ -113,20 +118,29 @@ public:
 
     typedef itk::KernelTransform<
       CoordRepType, VDimension>                             KernelTransformType;
-    typedef itk::ThinPlateSplineKernelTransform<
-      CoordRepType, VDimension>                             TPSTransformType;
-    typedef itk::ThinPlateR2LogRSplineKernelTransform<
-      CoordRepType, VDimension>                             TPSR2LOGRTransformType;
-    typedef itk::VolumeSplineKernelTransform<
-      CoordRepType, VDimension>                             VSTransformType;
-    typedef itk::ElasticBodySplineKernelTransform<
-      CoordRepType, VDimension>                             EBSTransformType;
-    typedef itk::ElasticBodyReciprocalSplineKernelTransform<
-      CoordRepType, VDimension>                             EBSRTransformType;
+    typedef itk::KernelTransformWithCoefficients<
+      itk::ThinPlateSplineKernelTransform<
+      CoordRepType, VDimension> >                           TPSTransformType;
+    typedef itk::KernelTransformWithCoefficients<
+      itk::ThinPlateR2LogRSplineKernelTransform<
+      CoordRepType, VDimension> >                           TPSR2LOGRTransformType;
+    typedef itk::KernelTransformWithCoefficients<
+      itk::VolumeSplineKernelTransform<
+      CoordRepType, VDimension> >                           VSTransformType;
+    typedef itk::KernelTransformWithCoefficients<
+      itk::ElasticBodySplineKernelTransform<
+      CoordRepType, VDimension> >                           EBSTransformType;
+    typedef itk::KernelTransformWithCoefficients<
+      itk::ElasticBodyReciprocalSplineKernelTransform<
+      CoordRepType, VDimension> >                           EBSRTransformType;
+    typedef itk::KernelTransformDisplacementFieldSource<
+      DeformationFieldType >                                FieldSourceType;
 
     typedef typename KernelTransformType::PointSetType      PointSetType;
     typedef itk::TransformixInputPointFileReader<
       PointSetType >                                        IPPReaderType;
+    typedef itk::TransformixInputPointFileWriter<
+      PointSetType >                                        IPPWriterType;
 
     /** Declarations */
     typename InputImageReaderType::Pointer reader1 = InputImageReaderType::New();
@@ -135,8 +149,7 @@ public:
     typename IPPReaderType::Pointer ipp2Reader = IPPReaderType::New();
     typename PointSetType::Pointer inputPointSet1 = 0;
     typename PointSetType::Pointer inputPointSet2 = 0;
-    typename KernelTransformType::Pointer kernelTransform = 0;
-    typename DeformationFieldType::Pointer deformationField = DeformationFieldType::New();
+    typename FieldSourceType::Pointer fieldSource = FieldSourceType::New();
     typename DeformationFieldWriterType::Pointer writer = DeformationFieldWriterType::New();
 
     ipp1Reader->SetFileName( this->m_InputPoints1FileName.c_str() );
@@ -179,6 +192,23 @@ public:
     }
     const unsigned int nrofpoints = nrofpoints1;
 
+    /** Write the input points in the binary format, if requested. */
+    if( this->m_OutputPointsFileNames.size() == 2 )
+    {
+      IPPReaderType * ippReaders[ 2 ] = { ipp1Reader.GetPointer(), ipp2Reader.GetPointer() };
+      for( unsigned int i = 0; i < 2; ++i )
+      {
+        std::cout << "Writing binary point file " << i + 1 << ": "
+          << this->m_OutputPointsFileNames[ i ] << std::endl;
+        typename IPPWriterType::Pointer ippWriter = IPPWriterType::New();
+        ippWriter->SetInput( ippReaders[ i ]->GetOutput() );
+        ippWriter->SetFileName( this->m_OutputPointsFileNames[ i ] );
+        ippWriter->SetPointsAreIndices( ippReaders[ i ]->GetPointsAreIndices() );
+        ippWriter->UseBinaryOn();
+        ippWriter->Write();
+      }
+    }
+
     /** Read input images */
     std::cout << "Reading Input image(s)." << std::endl;
     reader1->SetFileName( this->m_InputImage1FileName.c_str() );
@@ -246,25 +276,43 @@ public:
       inputPointSet2 = tempPointSet;
     }
 
+    /** Fit the kernel transform, and pass its coefficients to the field source. */
     if( this->m_KernelName == "TPS" )
     {
-      kernelTransform = TPSTransformType::New();
+      typename TPSTransformType::Pointer kernelTransform = TPSTransformType::New();
+      this->FitKernelTransform( kernelTransform.GetPointer(),
+        inputPointSet1.GetPointer(), inputPointSet2.GetPointer(), fieldSource.GetPointer() );
+      fieldSource->SetKernel( FieldSourceType::ThinPlateSpline );
     }
     else if( this->m_KernelName == "TPSR2LOGR" )
     {
-      kernelTransform = TPSR2LOGRTransformType::New();
+      typename TPSR2LOGRTransformType::Pointer kernelTransform = TPSR2LOGRTransformType::New();
+      this->FitKernelTransform( kernelTransform.GetPointer(),
+        inputPointSet1.GetPointer(), inputPointSet2.GetPointer(), fieldSource.GetPointer() );
+      fieldSource->SetKernel( FieldSourceType::ThinPlateR2LogRSpline );
     }
     else if( this->m_KernelName == "VS" )
     {
-      kernelTransform = VSTransformType::New();
+      typename VSTransformType::Pointer kernelTransform = VSTransformType::New();
+      this->FitKernelTransform( kernelTransform.GetPointer(),
+        inputPointSet1.GetPointer(), inputPointSet2.GetPointer(), fieldSource.GetPointer() );
+      fieldSource->SetKernel( FieldSourceType::VolumeSpline );
     }
     else if( this->m_KernelName == "EBS" )
     {
-      kernelTransform = EBSTransformType::New();
+      typename EBSTransformType::Pointer kernelTransform = EBSTransformType::New();
+      this->FitKernelTransform( kernelTransform.GetPointer(),
+        inputPointSet1.GetPointer(), inputPointSet2.GetPointer(), fieldSource.GetPointer() );
+      fieldSource->SetKernel( FieldSourceType::ElasticBodySpline );
+      fieldSource->SetAlpha( kernelTransform->GetAlpha() );
     }
     else if( this->m_KernelName == "EBSR" )
     {
-      kernelTransform = EBSRTransformType::New();
+      typename EBSRTransformType::Pointer kernelTransform = EBSRTransformType::New();
+      this->FitKernelTransform( kernelTransform.GetPointer(),
+        inputPointSet1.GetPointer(), inputPointSet2.GetPointer(), fieldSource.GetPointer() );
+      fieldSource->SetKernel( FieldSourceType::ElasticBodyReciprocalSpline );
+      fieldSource->SetAlpha( kernelTransform->GetAlpha() );
     }
     else
     {
@@ -272,40 +320,43 @@ public:
       itkGenericExceptionMacro( << "Unknown kernel transform!." );
     }
 
-    kernelTransform->SetStiffness( this->m_Stiffness );
-    kernelTransform->SetSourceLandmarks( inputPointSet1 );
-    kernelTransform->SetTargetLandmarks( inputPointSet2 );
-    kernelTransform->ComputeWMatrix();
-
-    /** Define the deformation field and an iterator on it */
-    deformationField->SetSpacing( reader1->GetOutput()->GetSpacing() );
-    deformationField->SetOrigin( reader1->GetOutput()->GetOrigin() );
-    deformationField->SetRegions( reader1->GetOutput()->GetLargestPossibleRegion() );
-    deformationField->Allocate();
-    DeformationFieldIteratorType iterator(
-      deformationField, deformationField->GetLargestPossibleRegion() );
-    iterator.GoToBegin();
-
-    std::cout << "Generating deformation field. " << std::endl;
-
-    while ( !iterator.IsAtEnd() )
+    if( this->m_MaximumError > 0.0
+      && ( this->m_KernelName == "EBS" || this->m_KernelName == "EBSR" ) )
     {
-      PointType pointin;
-      const IndexType & index = iterator.GetIndex();
-      deformationField->TransformIndexToPhysicalPoint( index, pointin);
-      PointType pointout = kernelTransform->TransformPoint( pointin );
-      DeformationVectorType vec = pointout - pointin;
-      iterator.Set( vec );
-      ++iterator;
+      std::cerr << "WARNING: the far field approximation is not available for "
+        << this->m_KernelName << ", the field is computed exactly." << std::endl;
     }
 
-    std::cout << "Saving deformation field to disk as " << this->m_OutputImageFileName << std::endl;
+    /** Define the deformation field on the grid of the first image. */
+    fieldSource->SetOutputSpacing( reader1->GetOutput()->GetSpacing() );
+    fieldSource->SetOutputOrigin( reader1->GetOutput()->GetOrigin() );
+    fieldSource->SetOutputRegion( reader1->GetOutput()->GetLargestPossibleRegion() );
+    fieldSource->SetMaximumError( this->m_MaximumError );
+
+    std::cout << "Generating deformation field and saving it to disk as "
+      << this->m_OutputImageFileName << std::endl;
     writer->SetFileName( this->m_OutputImageFileName.c_str() );
-    writer->SetInput( deformationField );
+    writer->SetInput( fieldSource->GetOutput() );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
 
+  /** Fit a kernel transform to the landmarks, and pass its coefficients to the field source. */
+  template< class TKernelTransform, class TPointSet, class TFieldSource >
+  void FitKernelTransform( TKernelTransform * kernelTransform,
+    TPointSet * sourceLandmarks, TPointSet * targetLandmarks, TFieldSource * fieldSource )
+  {
+    kernelTransform->SetStiffness( this->m_Stiffness );
+    kernelTransform->SetSourceLandmarks( sourceLandmarks );
+    kernelTransform->SetTargetLandmarks( targetLandmarks );
+    kernelTransform->ComputeWMatrix();
+
+    fieldSource->SetCoefficients( sourceLandmarks, kernelTransform->GetDMatrix(),
+      kernelTransform->GetAMatrix(), kernelTransform->GetBVector() );
+
+  } // end FitKernelTransform()
+
 }; // end class ITKToolsDeformationFieldGenerator
 
 
@@ -0,0 +1,252 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkKernelTransformDisplacementFieldSource_h_
+#define __itkKernelTransformDisplacementFieldSource_h_
+
+#include "itkImageSource.h"
+#include "itkKernelTransform.h"
+#include <vector>
+
+
+namespace itk
+{
+
+/** \class KernelTransformWithCoefficients
+ * \brief Gives access to the coefficients of a fitted kernel transform.
+ *
+ * TKernelTransform is one of the itk::KernelTransform subclasses. After
+ * ComputeWMatrix() its deformation, affine and translation coefficients
+ * can be passed to a KernelTransformDisplacementFieldSource.
+ */
+
+template < class TKernelTransform >
+class ITK_EXPORT KernelTransformWithCoefficients : public TKernelTransform
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef KernelTransformWithCoefficients     Self;
+  typedef TKernelTransform                    Superclass;
+  typedef SmartPointer<Self>                  Pointer;
+  typedef SmartPointer<const Self>            ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( KernelTransformWithCoefficients, TKernelTransform );
+
+  /** Typedefs. */
+  typedef typename Superclass::DMatrixType    DMatrixType;
+  typedef typename Superclass::AMatrixType    AMatrixType;
+  typedef typename Superclass::BMatrixType    BMatrixType;
+
+  /** Get the coefficients, valid after ComputeWMatrix(). */
+  const DMatrixType & GetDMatrix( void ) const { return this->m_DMatrix; }
+  const AMatrixType & GetAMatrix( void ) const { return this->m_AMatrix; }
+  const BMatrixType & GetBVector( void ) const { return this->m_BVector; }
+
+protected:
+  KernelTransformWithCoefficients() {};
+  virtual ~KernelTransformWithCoefficients() {};
+
+private:
+  KernelTransformWithCoefficients( const Self & ); // purposely not implemented
+  void operator=( const Self & );                  // purposely not implemented
+
+}; // end class KernelTransformWithCoefficients
+
+
+/** \class KernelTransformDisplacementFieldSource
+ * \brief Generates the displacement field of a kernel transform.
+ *
+ * The field T(x) - x is evaluated for every voxel of the output grid,
+ * from the landmarks and coefficients of a fitted itk::KernelTransform:
+ * T(x) = x + A x + b + sum_j G( x - s_j ) d_j. The kernels G of the
+ * thin plate spline, thin plate R2LogR spline, volume spline, elastic
+ * body spline and elastic body reciprocal spline are supported.
+ *
+ * The landmarks and coefficients are stored as one array per coordinate.
+ * Voxels are processed in runs along the first dimension, against blocks
+ * of landmarks that stay in cache, and output regions are computed in
+ * parallel.
+ *
+ * With MaximumError > 0, far landmarks are approximated for the radial
+ * kernels (thin plate, thin plate R2LogR and volume spline). The
+ * landmarks are clustered in a tree by recursive bisection. A cluster
+ * that is far from a run of voxels is replaced by a first order
+ * expansion of the kernel around its center, if the Taylor remainder
+ * bound 1/2 rho^2 H sum_j |d_j| for the cluster guarantees that the total
+ * error stays within MaximumError: every component of the displacement
+ * then differs at most MaximumError, in physical units, from the exact
+ * field. Here rho is the cluster radius and H bounds the second
+ * derivative of the kernel between the voxels and the cluster. For the
+ * elastic body splines the field is always exact.
+ *
+ * \ingroup DataSources
+ * \ingroup Multithreaded
+ */
+
+template < typename TOutputImage >
+class ITK_EXPORT KernelTransformDisplacementFieldSource:
+    public ImageSource< TOutputImage >
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef KernelTransformDisplacementFieldSource    Self;
+  typedef ImageSource< TOutputImage >               Superclass;
+  typedef SmartPointer<Self>                        Pointer;
+  typedef SmartPointer<const Self>                  ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( KernelTransformDisplacementFieldSource, ImageSource );
+
+  /** Image dimension. */
+  itkStaticConstMacro( ImageDimension, unsigned int, TOutputImage::ImageDimension );
+
+  /** Typedefs. */
+  typedef TOutputImage                                OutputImageType;
+  typedef typename OutputImageType::PixelType         OutputPixelType;
+  typedef typename OutputPixelType::ValueType         OutputValueType;
+  typedef typename OutputImageType::RegionType        OutputImageRegionType;
+  typedef typename OutputImageType::SpacingType       SpacingType;
+  typedef typename OutputImageType::PointType         OriginType;
+  typedef typename OutputImageType::DirectionType     DirectionType;
+  typedef KernelTransform< double, ImageDimension >   KernelTransformType;
+  typedef typename KernelTransformType::PointSetType  PointSetType;
+  typedef typename KernelTransformType::DMatrixType   DMatrixType;
+  typedef typename KernelTransformType::AMatrixType   AMatrixType;
+  typedef typename KernelTransformType::BMatrixType   BMatrixType;
+
+  /** The supported kernels. */
+  enum KernelType {
+    ThinPlateSpline,
+    ThinPlateR2LogRSpline,
+    VolumeSpline,
+    ElasticBodySpline,
+    ElasticBodyReciprocalSpline };
+
+  /** Set/Get the output grid. */
+  itkSetMacro( OutputRegion, OutputImageRegionType );
+  itkGetConstReferenceMacro( OutputRegion, OutputImageRegionType );
+  itkSetMacro( OutputSpacing, SpacingType );
+  itkGetConstReferenceMacro( OutputSpacing, SpacingType );
+  itkSetMacro( OutputOrigin, OriginType );
+  itkGetConstReferenceMacro( OutputOrigin, OriginType );
+  itkSetMacro( OutputDirection, DirectionType );
+  itkGetConstReferenceMacro( OutputDirection, DirectionType );
+
+  /** Set/Get the kernel. Default ThinPlateSpline. */
+  itkSetMacro( Kernel, KernelType );
+  itkGetConstMacro( Kernel, KernelType );
+
+  /** Set/Get the alpha of the elastic body splines, see their GetAlpha(). */
+  itkSetMacro( Alpha, double );
+  itkGetConstMacro( Alpha, double );
+
+  /** Set the source landmarks and the coefficients of the fitted transform,
+   * see KernelTransformWithCoefficients.
+   */
+  void SetCoefficients( const PointSetType * sourceLandmarks,
+    const DMatrixType & dMatrix, const AMatrixType & aMatrix, const BMatrixType & bVector );
+
+  /** Set/Get the maximum error of the far field approximation. Default 0: exact. */
+  itkSetMacro( MaximumError, double );
+  itkGetConstMacro( MaximumError, double );
+
+protected:
+  KernelTransformDisplacementFieldSource();
+  virtual ~KernelTransformDisplacementFieldSource() {};
+
+  /** PrintSelf. */
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Set the output grid. */
+  virtual void GenerateOutputInformation( void );
+
+  /** Build the landmark tree. */
+  virtual void BeforeThreadedGenerateData( void );
+
+  /** Evaluate the field in a region. */
+  virtual void ThreadedGenerateData(
+    const OutputImageRegionType & outputRegionForThread,
+    ThreadIdType threadId );
+
+  /** Evaluate the field in a region, for a kernel. */
+  template< class TKernel >
+  void ThreadedGenerateDataForKernel(
+    const OutputImageRegionType & outputRegionForThread,
+    ThreadIdType threadId );
+
+private:
+  KernelTransformDisplacementFieldSource( const Self & ); // purposely not implemented
+  void operator=( const Self & );                         // purposely not implemented
+
+  /** A node of the landmark tree. The landmarks Begin to End, in tree
+   * order, lie within Radius of Center. Moment0 is the sum of their
+   * coefficients d_j, Moment1[ k ][ o ] the sum of ( s_jk - c_k ) d_jo.
+   */
+  struct NodeType
+  {
+    double        Center[ ImageDimension ];
+    double        Radius;
+    unsigned int  Begin;
+    unsigned int  End;
+    int           Children[ 2 ];
+    double        Moment0[ ImageDimension ];
+    double        Moment1[ ImageDimension ][ ImageDimension ];
+  };
+
+  /** Build the subtree of the landmarks order[ begin ] to order[ end - 1 ]. */
+  unsigned int BuildTree( std::vector<unsigned int> & order,
+    const unsigned int begin, const unsigned int end );
+
+  /** Member variables. */
+  OutputImageRegionType   m_OutputRegion;
+  SpacingType             m_OutputSpacing;
+  OriginType              m_OutputOrigin;
+  DirectionType           m_OutputDirection;
+  KernelType              m_Kernel;
+  double                  m_Alpha;
+  double                  m_MaximumError;
+
+  /** The landmarks and coefficients as set. */
+  std::vector<double>     m_InputLandmarks[ ImageDimension ];
+  std::vector<double>     m_InputCoefficients[ ImageDimension ];
+  AMatrixType             m_AMatrix;
+  BMatrixType             m_BVector;
+
+  /** The landmarks and coefficients in tree order, and the tree. */
+  std::vector<double>     m_Landmarks[ ImageDimension ];
+  std::vector<double>     m_Coefficients[ ImageDimension ];
+  std::vector<NodeType>   m_Nodes;
+  double                  m_SumOfCoefficientNorms;
+
+}; // end class KernelTransformDisplacementFieldSource
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkKernelTransformDisplacementFieldSource.txx"
+#endif
+
+#endif // end #ifndef __itkKernelTransformDisplacementFieldSource_h_
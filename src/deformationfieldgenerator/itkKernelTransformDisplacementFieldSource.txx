@@ -0,0 +1,685 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef _itkKernelTransformDisplacementFieldSource_txx_
+#define _itkKernelTransformDisplacementFieldSource_txx_
+
+#include "itkKernelTransformDisplacementFieldSource.h"
+
+#include "itkImageLinearIteratorWithIndex.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+
+namespace itk
+{
+
+namespace KernelTransformField
+{
+
+/** The number of voxels along a line that are processed together. */
+const unsigned int ChunkSize = 64;
+
+/** The number of landmarks that are processed together. */
+const unsigned int LandmarkBlockSize = 256;
+
+/** The maximum number of landmarks in a leaf of the tree. */
+const unsigned int LeafSize = 32;
+
+
+/** The kernels. Evaluate() computes G( x ) = radial I + factor x x^T from
+ * r2 = |x|^2, as in the ComputeG() of the corresponding itk::KernelTransform.
+ * For the radial kernels G( x ) = g( r ) I, Derivative() is g'( r ), and
+ * HessianBound() bounds the Hessian of g( |x| ) for rlo <= |x| <= rhi.
+ */
+
+struct ThinPlateSplineKernel
+{
+  static const bool IsRadial = true;
+  static inline void Evaluate( const double r2, const double, double & radial, double & factor )
+  {
+    radial = std::sqrt( r2 ); factor = 0.0;
+  }
+  static inline double Derivative( const double ) { return 1.0; }
+  static inline double HessianBound( const double rlo, const double ) { return 1.0 / rlo; }
+};
+
+struct ThinPlateR2LogRSplineKernel
+{
+  static const bool IsRadial = true;
+  static inline void Evaluate( const double r2, const double, double & radial, double & factor )
+  {
+    radial = r2 > 1e-16 ? 0.5 * r2 * std::log( r2 ) : 0.0; factor = 0.0;
+  }
+  static inline double Derivative( const double r )
+  {
+    return r > 1e-8 ? r * ( 2.0 * std::log( r ) + 1.0 ) : 0.0;
+  }
+  static inline double HessianBound( const double rlo, const double rhi )
+  {
+    const double llo = 2.0 * std::log( rlo );
+    const double lhi = 2.0 * std::log( rhi );
+    return std::max( std::max( std::abs( llo + 3.0 ), std::abs( lhi + 3.0 ) ),
+      std::max( std::abs( llo + 1.0 ), std::abs( lhi + 1.0 ) ) );
+  }
+};
+
+struct VolumeSplineKernel
+{
+  static const bool IsRadial = true;
+  static inline void Evaluate( const double r2, const double, double & radial, double & factor )
+  {
+    radial = r2 * std::sqrt( r2 ); factor = 0.0;
+  }
+  static inline double Derivative( const double r ) { return 3.0 * r * r; }
+  static inline double HessianBound( const double, const double rhi ) { return 6.0 * rhi; }
+};
+
+/** The far field is only approximated for the radial kernels, so the
+ * elastic body splines do not need Derivative() and HessianBound().
+ */
+struct ElasticBodySplineKernel
+{
+  static const bool IsRadial = false;
+  static inline void Evaluate( const double r2, const double alpha, double & radial, double & factor )
+  {
+    const double r = std::sqrt( r2 );
+    radial = alpha * r2 * r; factor = -3.0 * r;
+  }
+  static inline double Derivative( const double ) { return 0.0; }
+  static inline double HessianBound( const double, const double ) { return 0.0; }
+};
+
+struct ElasticBodyReciprocalSplineKernel
+{
+  static const bool IsRadial = false;
+  static inline void Evaluate( const double r2, const double alpha, double & radial, double & factor )
+  {
+    const double r = std::sqrt( r2 );
+    radial = alpha * r; factor = r > 1e-8 ? -3.0 / r : 0.0;
+  }
+  static inline double Derivative( const double ) { return 0.0; }
+  static inline double HessianBound( const double, const double ) { return 0.0; }
+};
+
+
+/** Compares landmarks by one coordinate. */
+struct CoordinateCompare
+{
+  CoordinateCompare( const double * coordinates ) : m_Coordinates( coordinates ) {}
+  bool operator()( const unsigned int a, const unsigned int b ) const
+  {
+    return this->m_Coordinates[ a ] < this->m_Coordinates[ b ];
+  }
+  const double * m_Coordinates;
+};
+
+
+/**
+ * ******************* AccumulateExact *******************
+ *
+ * Add sum_j G( p - s_j ) d_j over the landmarks begin to end - 1 to the
+ * result of the n points. Points, landmarks and coefficients are stored
+ * per coordinate.
+ */
+
+template< class TKernel, unsigned int VDimension >
+void AccumulateExact(
+  const double * const landmarks[ VDimension ],
+  const double * const coefficients[ VDimension ],
+  const unsigned int begin, const unsigned int end, const double alpha,
+  const double points[ VDimension ][ ChunkSize ], const unsigned int n,
+  double result[ VDimension ][ ChunkSize ] )
+{
+  for( unsigned int blockBegin = begin; blockBegin < end; blockBegin += LandmarkBlockSize )
+  {
+    const unsigned int blockEnd = std::min( end, blockBegin + LandmarkBlockSize );
+    for( unsigned int v = 0; v < n; ++v )
+    {
+      double sum[ VDimension ];
+      for( unsigned int o = 0; o < VDimension; ++o ) sum[ o ] = 0.0;
+
+      for( unsigned int j = blockBegin; j < blockEnd; ++j )
+      {
+        double x[ VDimension ];
+        double r2 = 0.0;
+        for( unsigned int d = 0; d < VDimension; ++d )
+        {
+          x[ d ] = points[ d ][ v ] - landmarks[ d ][ j ];
+          r2 += x[ d ] * x[ d ];
+        }
+        double radial, factor;
+        TKernel::Evaluate( r2, alpha, radial, factor );
+        if( TKernel::IsRadial )
+        {
+          for( unsigned int o = 0; o < VDimension; ++o )
+          {
+            sum[ o ] += radial * coefficients[ o ][ j ];
+          }
+        }
+        else
+        {
+          double xd = 0.0;
+          for( unsigned int k = 0; k < VDimension; ++k )
+          {
+            xd += x[ k ] * coefficients[ k ][ j ];
+          }
+          for( unsigned int o = 0; o < VDimension; ++o )
+          {
+            sum[ o ] += radial * coefficients[ o ][ j ] + factor * x[ o ] * xd;
+          }
+        }
+      }
+
+      for( unsigned int o = 0; o < VDimension; ++o ) result[ o ][ v ] += sum[ o ];
+    }
+  }
+
+} // end AccumulateExact()
+
+} // end namespace KernelTransformField
+
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template <typename TOutputImage>
+KernelTransformDisplacementFieldSource<TOutputImage>
+::KernelTransformDisplacementFieldSource()
+{
+  this->m_OutputSpacing.Fill( 1.0 );
+  this->m_OutputOrigin.Fill( 0.0 );
+  this->m_OutputDirection.SetIdentity();
+  this->m_Kernel = ThinPlateSpline;
+  this->m_Alpha = 0.0;
+  this->m_MaximumError = 0.0;
+  this->m_AMatrix.fill( 0.0 );
+  this->m_BVector.fill( 0.0 );
+  this->m_SumOfCoefficientNorms = 0.0;
+
+} // end Constructor
+
+
+/**
+ * ******************* SetCoefficients *******************
+ */
+
+template <typename TOutputImage>
+void
+KernelTransformDisplacementFieldSource<TOutputImage>
+::SetCoefficients( const PointSetType * sourceLandmarks,
+  const DMatrixType & dMatrix, const AMatrixType & aMatrix, const BMatrixType & bVector )
+{
+  const unsigned int numberOfLandmarks = sourceLandmarks->GetNumberOfPoints();
+  if( dMatrix.rows() != ImageDimension || dMatrix.cols() != numberOfLandmarks )
+  {
+    itkExceptionMacro( << "The D matrix should have size " << ImageDimension
+      << " x " << numberOfLandmarks << "." );
+  }
+
+  typename PointSetType::PointType point;
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    this->m_InputLandmarks[ d ].resize( numberOfLandmarks );
+    this->m_InputCoefficients[ d ].resize( numberOfLandmarks );
+  }
+  for( unsigned int j = 0; j < numberOfLandmarks; ++j )
+  {
+    sourceLandmarks->GetPoint( j, &point );
+    for( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+      this->m_InputLandmarks[ d ][ j ] = point[ d ];
+      this->m_InputCoefficients[ d ][ j ] = dMatrix( d, j );
+    }
+  }
+  this->m_AMatrix = aMatrix;
+  this->m_BVector = bVector;
+  this->Modified();
+
+} // end SetCoefficients()
+
+
+/**
+ * ******************* GenerateOutputInformation *******************
+ */
+
+template <typename TOutputImage>
+void
+KernelTransformDisplacementFieldSource<TOutputImage>
+::GenerateOutputInformation( void )
+{
+  OutputImageType * output = this->GetOutput();
+  if( !output ) return;
+
+  output->SetLargestPossibleRegion( this->m_OutputRegion );
+  output->SetSpacing( this->m_OutputSpacing );
+  output->SetOrigin( this->m_OutputOrigin );
+  output->SetDirection( this->m_OutputDirection );
+
+} // end GenerateOutputInformation()
+
+
+/**
+ * ******************* BuildTree *******************
+ */
+
+template <typename TOutputImage>
+unsigned int
+KernelTransformDisplacementFieldSource<TOutputImage>
+::BuildTree( std::vector<unsigned int> & order,
+  const unsigned int begin, const unsigned int end )
+{
+  /** The center of the bounding box, and the radius around it. */
+  NodeType node;
+  double minimum[ ImageDimension ];
+  double maximum[ ImageDimension ];
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    const std::vector<double> & landmarks = this->m_InputLandmarks[ d ];
+    minimum[ d ] = maximum[ d ] = landmarks[ order[ begin ] ];
+    for( unsigned int p = begin + 1; p < end; ++p )
+    {
+      minimum[ d ] = std::min( minimum[ d ], landmarks[ order[ p ] ] );
+      maximum[ d ] = std::max( maximum[ d ], landmarks[ order[ p ] ] );
+    }
+    node.Center[ d ] = 0.5 * ( minimum[ d ] + maximum[ d ] );
+  }
+  double radius2 = 0.0;
+  for( unsigned int p = begin; p < end; ++p )
+  {
+    double r2 = 0.0;
+    for( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+      const double x = this->m_InputLandmarks[ d ][ order[ p ] ] - node.Center[ d ];
+      r2 += x * x;
+    }
+    radius2 = std::max( radius2, r2 );
+  }
+  node.Radius = std::sqrt( radius2 );
+  node.Begin = begin;
+  node.End = end;
+  node.Children[ 0 ] = node.Children[ 1 ] = -1;
+
+  const unsigned int index = this->m_Nodes.size();
+  this->m_Nodes.push_back( node );
+
+  /** Split at the median of the largest extent. */
+  if( end - begin > KernelTransformField::LeafSize )
+  {
+    unsigned int axis = 0;
+    for( unsigned int d = 1; d < ImageDimension; ++d )
+    {
+      if( maximum[ d ] - minimum[ d ] > maximum[ axis ] - minimum[ axis ] ) axis = d;
+    }
+    const unsigned int middle = begin + ( end - begin ) / 2;
+    std::nth_element( order.begin() + begin, order.begin() + middle, order.begin() + end,
+      KernelTransformField::CoordinateCompare( &this->m_InputLandmarks[ axis ][ 0 ] ) );
+
+    const unsigned int child0 = this->BuildTree( order, begin, middle );
+    const unsigned int child1 = this->BuildTree( order, middle, end );
+    this->m_Nodes[ index ].Children[ 0 ] = child0;
+    this->m_Nodes[ index ].Children[ 1 ] = child1;
+  }
+
+  return index;
+
+} // end BuildTree()
+
+
+/**
+ * ******************* BeforeThreadedGenerateData *******************
+ */
+
+template <typename TOutputImage>
+void
+KernelTransformDisplacementFieldSource<TOutputImage>
+::BeforeThreadedGenerateData( void )
+{
+  const unsigned int numberOfLandmarks = this->m_InputLandmarks[ 0 ].size();
+
+  /** Order the landmarks by the tree, if the far field is approximated. */
+  std::vector<unsigned int> order( numberOfLandmarks );
+  for( unsigned int j = 0; j < numberOfLandmarks; ++j ) order[ j ] = j;
+  this->m_Nodes.clear();
+  if( this->m_MaximumError > 0.0 && numberOfLandmarks > 0 )
+  {
+    this->BuildTree( order, 0, numberOfLandmarks );
+  }
+
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    this->m_Landmarks[ d ].resize( numberOfLandmarks );
+    this->m_Coefficients[ d ].resize( numberOfLandmarks );
+    for( unsigned int j = 0; j < numberOfLandmarks; ++j )
+    {
+      this->m_Landmarks[ d ][ j ] = this->m_InputLandmarks[ d ][ order[ j ] ];
+      this->m_Coefficients[ d ][ j ] = this->m_InputCoefficients[ d ][ order[ j ] ];
+    }
+  }
+
+  this->m_SumOfCoefficientNorms = 0.0;
+  for( unsigned int j = 0; j < numberOfLandmarks; ++j )
+  {
+    double norm2 = 0.0;
+    for( unsigned int o = 0; o < ImageDimension; ++o )
+    {
+      norm2 += this->m_Coefficients[ o ][ j ] * this->m_Coefficients[ o ][ j ];
+    }
+    this->m_SumOfCoefficientNorms += std::sqrt( norm2 );
+  }
+
+  /** The moments of the clusters. */
+  for( unsigned int i = 0; i < this->m_Nodes.size(); ++i )
+  {
+    NodeType & node = this->m_Nodes[ i ];
+    for( unsigned int o = 0; o < ImageDimension; ++o )
+    {
+      node.Moment0[ o ] = 0.0;
+      for( unsigned int k = 0; k < ImageDimension; ++k ) node.Moment1[ k ][ o ] = 0.0;
+    }
+    for( unsigned int j = node.Begin; j < node.End; ++j )
+    {
+      for( unsigned int o = 0; o < ImageDimension; ++o )
+      {
+        const double coefficient = this->m_Coefficients[ o ][ j ];
+        node.Moment0[ o ] += coefficient;
+        for( unsigned int k = 0; k < ImageDimension; ++k )
+        {
+          node.Moment1[ k ][ o ] += ( this->m_Landmarks[ k ][ j ] - node.Center[ k ] ) * coefficient;
+        }
+      }
+    }
+  }
+
+} // end BeforeThreadedGenerateData()
+
+
+/**
+ * ******************* ThreadedGenerateData *******************
+ */
+
+template <typename TOutputImage>
+void
+KernelTransformDisplacementFieldSource<TOutputImage>
+::ThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  switch( this->m_Kernel )
+  {
+    case ThinPlateSpline:
+      this->ThreadedGenerateDataForKernel<
+        KernelTransformField::ThinPlateSplineKernel>( outputRegionForThread, threadId );
+      break;
+    case ThinPlateR2LogRSpline:
+      this->ThreadedGenerateDataForKernel<
+        KernelTransformField::ThinPlateR2LogRSplineKernel>( outputRegionForThread, threadId );
+      break;
+    case VolumeSpline:
+      this->ThreadedGenerateDataForKernel<
+        KernelTransformField::VolumeSplineKernel>( outputRegionForThread, threadId );
+      break;
+    case ElasticBodySpline:
+      this->ThreadedGenerateDataForKernel<
+        KernelTransformField::ElasticBodySplineKernel>( outputRegionForThread, threadId );
+      break;
+    case ElasticBodyReciprocalSpline:
+      this->ThreadedGenerateDataForKernel<
+        KernelTransformField::ElasticBodyReciprocalSplineKernel>( outputRegionForThread, threadId );
+      break;
+  }
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * ******************* ThreadedGenerateDataForKernel *******************
+ */
+
+template <typename TOutputImage>
+template< class TKernel >
+void
+KernelTransformDisplacementFieldSource<TOutputImage>
+::ThreadedGenerateDataForKernel(
+  const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  typedef ImageLinearIteratorWithIndex<OutputImageType>   IteratorType;
+  typedef typename OutputImageType::PointType             PointType;
+  const unsigned int ChunkSize = KernelTransformField::ChunkSize;
+
+  OutputImageType * output = this->GetOutput();
+  const unsigned int lineLength = outputRegionForThread.GetSize()[ 0 ];
+  if( lineLength == 0 ) return;
+
+  /** The step between neighbouring voxels along a line. */
+  double step[ ImageDimension ];
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    step[ d ] = output->GetDirection()[ d ][ 0 ] * output->GetSpacing()[ 0 ];
+  }
+
+  const unsigned int numberOfLandmarks = this->m_Landmarks[ 0 ].size();
+  const double * landmarks[ ImageDimension ];
+  const double * coefficients[ ImageDimension ];
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    landmarks[ d ] = numberOfLandmarks > 0 ? &this->m_Landmarks[ d ][ 0 ] : 0;
+    coefficients[ d ] = numberOfLandmarks > 0 ? &this->m_Coefficients[ d ][ 0 ] : 0;
+  }
+
+  /** A cluster may be expanded if 1/2 rho^2 H <= maximumRemainder, so that
+   * the remainders of all expanded clusters sum to at most MaximumError.
+   */
+  const bool farField = TKernel::IsRadial && !this->m_Nodes.empty()
+    && this->m_SumOfCoefficientNorms > 0.0;
+  const double maximumRemainder = farField
+    ? this->m_MaximumError / this->m_SumOfCoefficientNorms : 0.0;
+
+  std::vector<unsigned int> stack;
+  std::vector<unsigned int> farNodes;
+  std::vector< std::pair<unsigned int, unsigned int> > nearRanges;
+  double points[ ImageDimension ][ KernelTransformField::ChunkSize ];
+  double result[ ImageDimension ][ KernelTransformField::ChunkSize ];
+
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() / lineLength );
+
+  IteratorType it( output, outputRegionForThread );
+  it.SetDirection( 0 );
+  for( it.GoToBegin(); !it.IsAtEnd(); it.NextLine() )
+  {
+    PointType first;
+    output->TransformIndexToPhysicalPoint( it.GetIndex(), first );
+
+    for( unsigned int chunkBegin = 0; chunkBegin < lineLength; chunkBegin += ChunkSize )
+    {
+      const unsigned int n = std::min( ChunkSize, lineLength - chunkBegin );
+      for( unsigned int d = 0; d < ImageDimension; ++d )
+      {
+        for( unsigned int v = 0; v < n; ++v )
+        {
+          points[ d ][ v ] = first[ d ] + ( chunkBegin + v ) * step[ d ];
+          result[ d ][ v ] = 0.0;
+        }
+      }
+
+      /** Select the landmarks that are evaluated exactly, and the clusters
+       * that are expanded, for this run of voxels.
+       */
+      nearRanges.clear();
+      farNodes.clear();
+      if( !farField )
+      {
+        if( numberOfLandmarks > 0 ) nearRanges.push_back( std::make_pair( 0u, numberOfLandmarks ) );
+      }
+      else
+      {
+        double segment[ ImageDimension ];
+        double segmentLength2 = 0.0;
+        for( unsigned int d = 0; d < ImageDimension; ++d )
+        {
+          segment[ d ] = points[ d ][ n - 1 ] - points[ d ][ 0 ];
+          segmentLength2 += segment[ d ] * segment[ d ];
+        }
+
+        stack.assign( 1, 0 );
+        while( !stack.empty() )
+        {
+          const unsigned int index = stack.back();
+          stack.pop_back();
+          const NodeType & node = this->m_Nodes[ index ];
+
+          /** The distance of the center to the nearest and farthest voxel. */
+          double t = 0.0;
+          if( segmentLength2 > 0.0 )
+          {
+            for( unsigned int d = 0; d < ImageDimension; ++d )
+            {
+              t += ( node.Center[ d ] - points[ d ][ 0 ] ) * segment[ d ];
+            }
+            t = std::min( std::max( t / segmentLength2, 0.0 ), 1.0 );
+          }
+          double nearest2 = 0.0;
+          double first2 = 0.0;
+          double last2 = 0.0;
+          for( unsigned int d = 0; d < ImageDimension; ++d )
+          {
+            const double xn = points[ d ][ 0 ] + t * segment[ d ] - node.Center[ d ];
+            const double x0 = points[ d ][ 0 ] - node.Center[ d ];
+            const double x1 = points[ d ][ n - 1 ] - node.Center[ d ];
+            nearest2 += xn * xn;
+            first2 += x0 * x0;
+            last2 += x1 * x1;
+          }
+          const double rlo = std::sqrt( nearest2 ) - node.Radius;
+          const double rhi = std::sqrt( std::max( first2, last2 ) ) + node.Radius;
+
+          if( rlo > 0.0 && 0.5 * node.Radius * node.Radius
+            * TKernel::HessianBound( rlo, rhi ) <= maximumRemainder )
+          {
+            farNodes.push_back( index );
+          }
+          else if( node.Children[ 0 ] < 0 )
+          {
+            /** Leaves are visited in order, so neighbouring ranges are merged. */
+            if( !nearRanges.empty() && nearRanges.back().second == node.Begin )
+            {
+              nearRanges.back().second = node.End;
+            }
+            else
+            {
+              nearRanges.push_back( std::make_pair( node.Begin, node.End ) );
+            }
+          }
+          else
+          {
+            stack.push_back( node.Children[ 1 ] );
+            stack.push_back( node.Children[ 0 ] );
+          }
+        }
+      }
+
+      /** The exact part. */
+      for( unsigned int r = 0; r < nearRanges.size(); ++r )
+      {
+        KernelTransformField::AccumulateExact<TKernel, ImageDimension>(
+          landmarks, coefficients, nearRanges[ r ].first, nearRanges[ r ].second,
+          this->m_Alpha, points, n, result );
+      }
+
+      /** The expanded clusters: g( R ) Moment0 - g'( R ) / R ( x - c )^T Moment1. */
+      for( unsigned int f = 0; f < farNodes.size(); ++f )
+      {
+        const NodeType & node = this->m_Nodes[ farNodes[ f ] ];
+        for( unsigned int v = 0; v < n; ++v )
+        {
+          double x[ ImageDimension ];
+          double r2 = 0.0;
+          for( unsigned int d = 0; d < ImageDimension; ++d )
+          {
+            x[ d ] = points[ d ][ v ] - node.Center[ d ];
+            r2 += x[ d ] * x[ d ];
+          }
+          double radial, factor;
+          TKernel::Evaluate( r2, this->m_Alpha, radial, factor );
+          const double r = std::sqrt( r2 );
+          const double gradient = TKernel::Derivative( r ) / r;
+          for( unsigned int o = 0; o < ImageDimension; ++o )
+          {
+            double dipole = 0.0;
+            for( unsigned int k = 0; k < ImageDimension; ++k )
+            {
+              dipole += x[ k ] * node.Moment1[ k ][ o ];
+            }
+            result[ o ][ v ] += radial * node.Moment0[ o ] - gradient * dipole;
+          }
+        }
+      }
+
+      /** Add the affine part and write the displacements. */
+      for( unsigned int v = 0; v < n; ++v )
+      {
+        OutputPixelType displacement;
+        for( unsigned int i = 0; i < ImageDimension; ++i )
+        {
+          double value = result[ i ][ v ] + this->m_BVector[ i ];
+          for( unsigned int j = 0; j < ImageDimension; ++j )
+          {
+            value += this->m_AMatrix( i, j ) * points[ j ][ v ];
+          }
+          displacement[ i ] = static_cast<OutputValueType>( value );
+        }
+        it.Set( displacement );
+        ++it;
+      }
+    }
+
+    progress.CompletedPixel();
+  }
+
+} // end ThreadedGenerateDataForKernel()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template <typename TOutputImage>
+void
+KernelTransformDisplacementFieldSource<TOutputImage>
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "OutputRegion: " << this->m_OutputRegion << std::endl;
+  os << indent << "OutputSpacing: " << this->m_OutputSpacing << std::endl;
+  os << indent << "OutputOrigin: " << this->m_OutputOrigin << std::endl;
+  os << indent << "OutputDirection: " << this->m_OutputDirection << std::endl;
+  os << indent << "Kernel: " << this->m_Kernel << std::endl;
+  os << indent << "Alpha: " << this->m_Alpha << std::endl;
+  os << indent << "MaximumError: " << this->m_MaximumError << std::endl;
+  os << indent << "NumberOfLandmarks: " << this->m_InputLandmarks[ 0 ].size() << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef _itkKernelTransformDisplacementFieldSource_txx_
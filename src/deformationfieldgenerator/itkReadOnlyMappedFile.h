@@ -0,0 +1,132 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkReadOnlyMappedFile_h_
+#define __itkReadOnlyMappedFile_h_
+
+#include <string>
+#include <cstddef>
+
+#if defined( _WIN32 )
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace itk
+{
+
+  /** \class ReadOnlyMappedFile
+   *
+   * \brief Maps a file read-only into memory.
+   *
+   * The contents are available through GetData() and GetSize() between
+   * Open() and Close(); the pages are loaded by the operating system
+   * when they are first accessed.
+   **/
+
+  class ReadOnlyMappedFile
+  {
+  public:
+    ReadOnlyMappedFile() : m_Data( 0 ), m_Size( 0 )
+    {
+#if defined( _WIN32 )
+      this->m_File = INVALID_HANDLE_VALUE;
+      this->m_Mapping = NULL;
+#endif
+    }
+    ~ReadOnlyMappedFile() { this->Close(); }
+
+    /** Map the file. Returns false if it cannot be opened or mapped. */
+    bool Open( const std::string & fileName )
+    {
+      this->Close();
+#if defined( _WIN32 )
+      this->m_File = CreateFileA( fileName.c_str(), GENERIC_READ, FILE_SHARE_READ,
+        NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+      if( this->m_File == INVALID_HANDLE_VALUE ) return false;
+      LARGE_INTEGER size;
+      if( !GetFileSizeEx( this->m_File, &size ) ) { this->Close(); return false; }
+      this->m_Size = static_cast<std::size_t>( size.QuadPart );
+      if( this->m_Size == 0 ) return true;
+      this->m_Mapping = CreateFileMappingA( this->m_File, NULL, PAGE_READONLY, 0, 0, NULL );
+      if( this->m_Mapping == NULL ) { this->Close(); return false; }
+      this->m_Data = static_cast<const char *>(
+        MapViewOfFile( this->m_Mapping, FILE_MAP_READ, 0, 0, 0 ) );
+      if( this->m_Data == NULL ) { this->Close(); return false; }
+#else
+      const int fd = open( fileName.c_str(), O_RDONLY );
+      if( fd < 0 ) return false;
+      struct stat status;
+      if( fstat( fd, &status ) != 0 ) { close( fd ); return false; }
+      this->m_Size = static_cast<std::size_t>( status.st_size );
+      if( this->m_Size > 0 )
+      {
+        void * data = mmap( 0, this->m_Size, PROT_READ, MAP_PRIVATE, fd, 0 );
+        if( data == MAP_FAILED ) { close( fd ); this->m_Size = 0; return false; }
+        this->m_Data = static_cast<const char *>( data );
+#if defined( POSIX_MADV_SEQUENTIAL )
+        posix_madvise( data, this->m_Size, POSIX_MADV_SEQUENTIAL );
+#endif
+      }
+      close( fd );
+#endif
+      return true;
+    }
+
+    /** Unmap the file. */
+    void Close( void )
+    {
+#if defined( _WIN32 )
+      if( this->m_Data ) UnmapViewOfFile( this->m_Data );
+      if( this->m_Mapping != NULL ) CloseHandle( this->m_Mapping );
+      if( this->m_File != INVALID_HANDLE_VALUE ) CloseHandle( this->m_File );
+      this->m_Mapping = NULL;
+      this->m_File = INVALID_HANDLE_VALUE;
+#else
+      if( this->m_Data ) munmap( const_cast<char *>( this->m_Data ), this->m_Size );
+#endif
+      this->m_Data = 0;
+      this->m_Size = 0;
+    }
+
+    /** Get the contents. */
+    const char * GetData( void ) const { return this->m_Data; }
+    std::size_t GetSize( void ) const { return this->m_Size; }
+
+  private:
+    ReadOnlyMappedFile( const ReadOnlyMappedFile & ); // purposely not implemented
+    void operator=( const ReadOnlyMappedFile & );     // purposely not implemented
+
+    const char *  m_Data;
+    std::size_t   m_Size;
+#if defined( _WIN32 )
+    HANDLE        m_File;
+    HANDLE        m_Mapping;
+#endif
+
+  }; // end class
+
+} // end namespace itk
+
+#endif // end #ifndef __itkReadOnlyMappedFile_h_
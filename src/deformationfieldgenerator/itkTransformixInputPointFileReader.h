@@ -19,12 +19,32 @@
 #define __itkTransformixInputPointFileReader_h_
 
 #include "itkMeshFileReaderBase.h"
+#include "itkReadOnlyMappedFile.h"
+#include "itkMultiThreader.h"
 
-#include <fstream>
+#include <vector>
 
 namespace itk
 {
 
+  namespace TransformixInputPointFile
+  {
+    /** The binary format is, in little endian:
+     *   char[ 8 ]  "pxpoints"
+     *   uint32     version, 1
+     *   uint32     1 if the points are indices, 0 otherwise
+     *   uint32     dimension
+     *   uint32     0
+     *   uint64     number of points
+     *   float64    the coordinates, point after point
+     */
+    const char          BinaryMagic[] = "pxpoints";
+    const std::size_t   BinaryMagicSize = 8;
+    const std::size_t   BinaryHeaderSize = 32;
+    const unsigned int  BinaryVersion = 1;
+  } // end namespace TransformixInputPointFile
+
+
   /** \class TransformixInputPointFileReader
    *
    * \brief A reader that understands transformix input point files
@@ -39,6 +59,14 @@ namespace itk
    *
    * The second word in the text file represents the number of points that
    * should be read.
+   *
+   * The file is mapped into memory and split on line boundaries over the
+   * threads, that parse their part directly into the point container.
+   * Numbers are parsed without the locale, so the decimal separator is
+   * always a point.
+   *
+   * Files written by the TransformixInputPointFileWriter in binary format
+   * are recognized by their first bytes, and copied without parsing.
    **/
 
   template <class TOutputMesh>
@@ -92,7 +120,31 @@ namespace itk
     unsigned long m_NumberOfPoints;
     bool m_PointsAreIndices;
 
-    std::ifstream m_Reader;
+    /** The mapped file, between GenerateOutputInformation() and GenerateData(). */
+    ReadOnlyMappedFile m_File;
+    bool               m_IsBinary;
+    std::size_t        m_DataOffset;
+
+    /** Parse the text after the header into the point container. */
+    void ParseText( void );
+
+    /** Copy the binary points into the point container. */
+    void CopyBinary( void );
+
+    /** The part of the text a thread parses, and the index of its first number. */
+    struct ThreadStruct
+    {
+      Self *                    Filter;
+      std::vector<const char *> Begins;
+      std::vector<std::size_t>  FirstNumbers;
+      std::vector<std::size_t>  NumbersFound;
+      std::vector<std::string>  Errors;
+      bool                      CountOnly;
+      typename OutputMeshType::PointType * Points;
+    };
+
+    /** Count or parse the numbers of a part of the text. */
+    static ITK_THREAD_RETURN_TYPE ParseThreaderCallback( void * arg );
 
   private:
     TransformixInputPointFileReader(const Self&); //purposely not implemented
@@ -19,10 +19,117 @@
 #define __itkTransformixInputPointFileReader_hxx_
 
 #include "itkTransformixInputPointFileReader.h"
+#include "itkByteSwapper.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <locale>
+#include <sstream>
+#include <algorithm>
 
 namespace itk
 {
 
+  namespace TransformixInputPointFile
+  {
+
+    /** Whether c separates words. */
+    inline bool IsSpace( const char c )
+    {
+      return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    /** Parse the number in [ begin, end ), without the locale. Numbers with
+     * at most 19 significant digits and a decimal exponent of at most 22
+     * fit the fast path, which is exact; other numbers are parsed by a
+     * stream with the classic locale. Returns false if it is not a number.
+     */
+    inline bool ParseNumber( const char * begin, const char * end, double & value )
+    {
+      static const double powersOf10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+      const char * p = begin;
+      bool negative = false;
+      if( p < end && ( *p == '-' || *p == '+' ) )
+      {
+        negative = *p == '-';
+        ++p;
+      }
+
+      unsigned long long mantissa = 0;
+      unsigned int digits = 0;
+      int exponent = 0;
+      bool anyDigit = false;
+      for( ; p < end && *p >= '0' && *p <= '9'; ++p )
+      {
+        anyDigit = true;
+        if( digits < 19 )
+        {
+          mantissa = mantissa * 10 + ( *p - '0' );
+          if( mantissa != 0 ) ++digits;
+        }
+        else ++exponent;
+      }
+      if( p < end && *p == '.' )
+      {
+        for( ++p; p < end && *p >= '0' && *p <= '9'; ++p )
+        {
+          anyDigit = true;
+          if( digits < 19 )
+          {
+            mantissa = mantissa * 10 + ( *p - '0' );
+            if( mantissa != 0 ) ++digits;
+            --exponent;
+          }
+        }
+      }
+      if( anyDigit && p < end && ( *p == 'e' || *p == 'E' ) )
+      {
+        ++p;
+        bool negativeExponent = false;
+        if( p < end && ( *p == '-' || *p == '+' ) )
+        {
+          negativeExponent = *p == '-';
+          ++p;
+        }
+        if( p == end || *p < '0' || *p > '9' ) anyDigit = false;
+        int decimalExponent = 0;
+        for( ; p < end && *p >= '0' && *p <= '9'; ++p )
+        {
+          if( decimalExponent < 100000 ) decimalExponent = decimalExponent * 10 + ( *p - '0' );
+        }
+        exponent += negativeExponent ? -decimalExponent : decimalExponent;
+      }
+
+      /** The fast path. */
+      if( anyDigit && p == end )
+      {
+        if( mantissa == 0 )
+        {
+          value = negative ? -0.0 : 0.0;
+          return true;
+        }
+        if( mantissa < ( 1ULL << 53 ) && exponent >= -22 && exponent <= 22 )
+        {
+          value = static_cast<double>( mantissa );
+          value = exponent < 0 ? value / powersOf10[ -exponent ] : value * powersOf10[ exponent ];
+          if( negative ) value = -value;
+          return true;
+        }
+      }
+
+      /** The slow path, also for inf and nan. */
+      std::istringstream stream( std::string( begin, end ) );
+      stream.imbue( std::locale::classic() );
+      stream >> value;
+      return !stream.fail() && stream.peek() == std::char_traits<char>::eof();
+    }
+
+  } // end namespace TransformixInputPointFile
+
+
   /**
    * **************** Constructor ***************
    */
@@ -32,6 +139,8 @@ namespace itk
   {
     this->m_NumberOfPoints = 0;
     this->m_PointsAreIndices = false;
+    this->m_IsBinary = false;
+    this->m_DataOffset = 0;
 
   } // end constructor
 
@@ -43,10 +152,7 @@ namespace itk
   TransformixInputPointFileReader<TOutputMesh>
   ::~TransformixInputPointFileReader()
   {
-    if( this->m_Reader.is_open() )
-    {
-      this->m_Reader.close();
-    }
+    this->m_File.Close();
 
   } // end constructor
 
@@ -62,30 +168,69 @@ namespace itk
   {
     this->Superclass::GenerateOutputInformation();
 
-    /** The superclass tests already if it's a valid file; so just open it and
+    /** The superclass tests already if it's a valid file; so just map it and
      * assume it goes alright */
-    if( this->m_Reader.is_open() )
+    if( !this->m_File.Open( this->m_FileName ) )
+    {
+      std::ostringstream msg;
+      msg << "The file cannot be mapped into memory. "
+        << std::endl << "Filename: " << this->m_FileName
+        << std::endl;
+      MeshFileReaderException e( __FILE__, __LINE__, msg.str().c_str(), ITK_LOCATION );
+      throw e;
+    }
+    const char * data = this->m_File.GetData();
+    const std::size_t size = this->m_File.GetSize();
+
+    /** A binary file. */
+    this->m_IsBinary = size >= TransformixInputPointFile::BinaryHeaderSize
+      && std::memcmp( data, TransformixInputPointFile::BinaryMagic,
+      TransformixInputPointFile::BinaryMagicSize ) == 0;
+    if( this->m_IsBinary )
     {
-      this->m_Reader.close();
+      unsigned int header[ 4 ];
+      unsigned long long numberOfPoints;
+      std::memcpy( header, data + 8, sizeof( header ) );
+      std::memcpy( &numberOfPoints, data + 24, sizeof( numberOfPoints ) );
+      ByteSwapper<unsigned int>::SwapRangeFromSystemToLittleEndian( header, 4 );
+      ByteSwapper<unsigned long long>::SwapFromSystemToLittleEndian( &numberOfPoints );
+
+      if( header[ 0 ] != TransformixInputPointFile::BinaryVersion
+        || header[ 2 ] != OutputMeshType::PointDimension )
+      {
+        std::ostringstream msg;
+        msg << "The binary point file has version " << header[ 0 ]
+          << " and dimension " << header[ 2 ] << ", expected version "
+          << TransformixInputPointFile::BinaryVersion << " and dimension "
+          << OutputMeshType::PointDimension << "."
+          << std::endl << "Filename: " << this->m_FileName
+          << std::endl;
+        MeshFileReaderException e( __FILE__, __LINE__, msg.str().c_str(), ITK_LOCATION );
+        throw e;
+      }
+      this->m_PointsAreIndices = header[ 1 ] != 0;
+      this->m_NumberOfPoints = static_cast<unsigned long>( numberOfPoints );
+      this->m_DataOffset = TransformixInputPointFile::BinaryHeaderSize;
+      return;
     }
-    this->m_Reader.open( this->m_FileName.c_str() );
 
     /** Read the first entry */
-    std::string indexOrPoint;
-    this->m_Reader >> indexOrPoint;
+    const char * end = data + size;
+    const char * p = data;
+    while( p < end && TransformixInputPointFile::IsSpace( *p ) ) ++p;
+    const char * word = p;
+    while( p < end && !TransformixInputPointFile::IsSpace( *p ) ) ++p;
+    const std::string indexOrPoint( word, p );
 
     /** Set the IsIndex bool and the number of points.*/
-    if(indexOrPoint == "point")
+    if( indexOrPoint == "point" || indexOrPoint == "index" )
     {
-      /** Input points are specified in world coordinates. */
-      this->m_PointsAreIndices = false;
-      this->m_Reader >> this->m_NumberOfPoints;
-    }
-    else if(indexOrPoint == "index")
-    {
-      /** Input points are specified as image indices. */
-      this->m_PointsAreIndices = true;
-      this->m_Reader >> this->m_NumberOfPoints;
+      /** Input points are specified in world coordinates or as image indices. */
+      this->m_PointsAreIndices = indexOrPoint == "index";
+      while( p < end && TransformixInputPointFile::IsSpace( *p ) ) ++p;
+      word = p;
+      while( p < end && !TransformixInputPointFile::IsSpace( *p ) ) ++p;
+      this->m_NumberOfPoints = std::strtoul( std::string( word, p ).c_str(), 0, 10 );
     }
     else
     {
@@ -93,8 +238,9 @@ namespace itk
       this->m_PointsAreIndices = true;
       this->m_NumberOfPoints = atoi( indexOrPoint.c_str() );
     }
+    this->m_DataOffset = p - data;
 
-    /** Leave the file open for the generate data  method */
+    /** Leave the file mapped for the generate data method */
 
   }  // end GenerateOutputInformation
 
@@ -107,69 +253,228 @@ namespace itk
   void
   TransformixInputPointFileReader<TOutputMesh>
   ::GenerateData()
+  {
+    if( this->m_File.GetData() == 0 && this->m_NumberOfPoints > 0 )
+    {
+      std::ostringstream msg;
+      msg <<"The file has unexpectedly been closed. "
+          << std::endl << "Filename: " << this->m_FileName
+          << std::endl;
+      MeshFileReaderException e(__FILE__, __LINE__,msg.str().c_str(),ITK_LOCATION);
+      throw e;
+    }
+
+    if( this->m_IsBinary )
+    {
+      this->CopyBinary();
+    }
+    else
+    {
+      this->ParseText();
+    }
+
+    /** Unmap the file */
+    this->m_File.Close();
+
+    /** This indicates that the current BufferedRegion is equal to the
+     * requested region. This action prevents useless re-executions of
+     * the pipeline.
+     * (I copied this from the BinaryMaskToNarrowBandPointSetFilter) */
+    OutputMeshPointer output = this->GetOutput();
+    output->SetBufferedRegion( output->GetRequestedRegion() );
+
+  } // end GenerateData
+
+
+  /**
+   * ***************CopyBinary ***********
+   */
+
+  template <class TOutputMesh>
+  void
+  TransformixInputPointFileReader<TOutputMesh>
+  ::CopyBinary( void )
   {
     typedef typename OutputMeshType::PointsContainer  PointsContainerType;
-    typedef typename PointsContainerType::Pointer     PointsContainerPointer;
     typedef typename OutputMeshType::PointType        PointType;
+    typedef typename PointType::ValueType             ValueType;
     const unsigned int dimension = OutputMeshType::PointDimension;
 
+    const std::size_t numberOfValues = this->m_NumberOfPoints * dimension;
+    if( this->m_File.GetSize() < this->m_DataOffset + numberOfValues * sizeof( double ) )
+    {
+      std::ostringstream msg;
+      msg <<"The file is not large enough. "
+        << std::endl << "Filename: " << this->m_FileName
+        << std::endl;
+      MeshFileReaderException e(__FILE__, __LINE__,msg.str().c_str(),ITK_LOCATION);
+      throw e;
+    }
+
+    /** Fill the points directly, since ElementAt() calls Modified() per point. */
+    typename PointsContainerType::Pointer points = PointsContainerType::New();
+    points->Reserve( this->m_NumberOfPoints );
+    const char * data = this->m_File.GetData() + this->m_DataOffset;
+    for( unsigned long i = 0; i < this->m_NumberOfPoints; ++i )
+    {
+      double values[ dimension ];
+      std::memcpy( values, data + i * sizeof( values ), sizeof( values ) );
+      ByteSwapper<double>::SwapRangeFromSystemToLittleEndian( values, dimension );
+      PointType & point = points->CastToSTLContainer()[ i ];
+      for( unsigned int j = 0; j < dimension; ++j )
+      {
+        point[ j ] = static_cast<ValueType>( values[ j ] );
+      }
+    }
+    points->Modified();
+
+    /** set in output */
     OutputMeshPointer output = this->GetOutput();
+    output->Initialize();
+    output->SetPoints( points );
+
+  } // end CopyBinary
+
+
+  /**
+   * ***************ParseText ***********
+   */
+
+  template <class TOutputMesh>
+  void
+  TransformixInputPointFileReader<TOutputMesh>
+  ::ParseText( void )
+  {
+    typedef typename OutputMeshType::PointsContainer  PointsContainerType;
+    const unsigned int dimension = OutputMeshType::PointDimension;
+
+    typename PointsContainerType::Pointer points = PointsContainerType::New();
+    points->Reserve( this->m_NumberOfPoints );
 
-    PointsContainerPointer points = PointsContainerType::New();
+    /** Split the text on line boundaries, in parts of at least 1 MB. */
+    const char * begin = this->m_File.GetData() + this->m_DataOffset;
+    const char * end = this->m_File.GetData() + this->m_File.GetSize();
+    const std::size_t size = end - begin;
+    const std::size_t minimumPartSize = 1 << 20;
+    ThreadIdType numberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+    numberOfThreads = static_cast<ThreadIdType>( std::max<std::size_t>( 1,
+      std::min<std::size_t>( numberOfThreads, size / minimumPartSize ) ) );
 
-    /** read the file */
-    if( this->m_Reader.is_open() )
+    /** The threads fill the points directly: ElementAt() calls Modified(),
+     * which is not thread safe.
+     */
+    ThreadStruct str;
+    str.Filter = this;
+    str.Points = this->m_NumberOfPoints > 0 ? &points->CastToSTLContainer()[ 0 ] : 0;
+    str.Begins.push_back( begin );
+    for( ThreadIdType t = 1; t < numberOfThreads; ++t )
     {
-      for( unsigned int i = 0; i < this->m_NumberOfPoints; ++i )
-      {
-        //read point from textfile
-        PointType point;
-        for( unsigned int j = 0; j < dimension; j++ )
-        {
-          if( !this->m_Reader.eof() )
-          {
-            this->m_Reader >> point[j];
-          }
-          else
-          {
-            std::ostringstream msg;
-            msg <<"The file is not large enough. "
-              << std::endl << "Filename: " << this->m_FileName
-              << std::endl;
-            MeshFileReaderException e(__FILE__, __LINE__,msg.str().c_str(),ITK_LOCATION);
-            throw e;
-            return;
+      const char * p = std::max( begin + size / numberOfThreads * t, str.Begins.back() );
+      const char * newline = static_cast<const char *>( std::memchr( p, '\n', end - p ) );
+      str.Begins.push_back( newline ? newline + 1 : end );
+    }
+    str.Begins.push_back( end );
+    str.FirstNumbers.assign( numberOfThreads, 0 );
+    str.NumbersFound.assign( numberOfThreads, 0 );
+    str.Errors.assign( numberOfThreads, "" );
 
-          }
-        }
-        points->push_back(point);
-      }
+    MultiThreader::Pointer threader = MultiThreader::New();
+    threader->SetNumberOfThreads( numberOfThreads );
+    threader->SetSingleMethod( ParseThreaderCallback, &str );
+
+    /** Count the numbers of every part, to know where they go. */
+    str.CountOnly = true;
+    if( numberOfThreads > 1 ) threader->SingleMethodExecute();
+    std::size_t numberOfValues = 0;
+    for( ThreadIdType t = 0; t < numberOfThreads; ++t )
+    {
+      str.FirstNumbers[ t ] = numberOfValues;
+      numberOfValues += str.NumbersFound[ t ];
     }
-    else
+
+    /** Parse the numbers into the points. */
+    str.CountOnly = false;
+    threader->SingleMethodExecute();
+    points->Modified();
+    for( ThreadIdType t = 0; t < numberOfThreads; ++t )
     {
-      std::ostringstream msg;
-      msg <<"The file has unexpectedly been closed. "
+      if( str.Errors[ t ] != "" )
+      {
+        std::ostringstream msg;
+        msg << str.Errors[ t ]
           << std::endl << "Filename: " << this->m_FileName
           << std::endl;
+        MeshFileReaderException e(__FILE__, __LINE__,msg.str().c_str(),ITK_LOCATION);
+        throw e;
+      }
+    }
+    numberOfValues = str.FirstNumbers[ numberOfThreads - 1 ] + str.NumbersFound[ numberOfThreads - 1 ];
+    if( numberOfValues < this->m_NumberOfPoints * dimension )
+    {
+      std::ostringstream msg;
+      msg <<"The file is not large enough. "
+        << std::endl << "Filename: " << this->m_FileName
+        << std::endl;
       MeshFileReaderException e(__FILE__, __LINE__,msg.str().c_str(),ITK_LOCATION);
       throw e;
-      return;
     }
 
     /** set in output */
+    OutputMeshPointer output = this->GetOutput();
     output->Initialize();
     output->SetPoints( points );
 
-    /** Close the reader */
-    this->m_Reader.close();
+  } // end ParseText
 
-    /** This indicates that the current BufferedRegion is equal to the
-     * requested region. This action prevents useless re-executions of
-     * the pipeline.
-     * (I copied this from the BinaryMaskToNarrowBandPointSetFilter) */
-    output->SetBufferedRegion( output->GetRequestedRegion() );
 
-  } // end GenerateData
+  /**
+   * ***************ParseThreaderCallback ***********
+   */
+
+  template <class TOutputMesh>
+  ITK_THREAD_RETURN_TYPE
+  TransformixInputPointFileReader<TOutputMesh>
+  ::ParseThreaderCallback( void * arg )
+  {
+    typedef typename OutputMeshType::PointType        PointType;
+    typedef typename PointType::ValueType             ValueType;
+    const unsigned int dimension = OutputMeshType::PointDimension;
+
+    MultiThreader::ThreadInfoStruct * info
+      = static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+    ThreadStruct * str = static_cast<ThreadStruct *>( info->UserData );
+    const ThreadIdType threadId = info->ThreadID;
+    if( threadId + 1 >= str->Begins.size() ) return ITK_THREAD_RETURN_VALUE;
+
+    const char * p = str->Begins[ threadId ];
+    const char * end = str->Begins[ threadId + 1 ];
+    const std::size_t numberOfValues = str->Filter->m_NumberOfPoints * dimension;
+    std::size_t k = str->FirstNumbers[ threadId ];
+    std::size_t found = 0;
+    while( p < end )
+    {
+      while( p < end && TransformixInputPointFile::IsSpace( *p ) ) ++p;
+      if( p == end ) break;
+      const char * word = p;
+      while( p < end && !TransformixInputPointFile::IsSpace( *p ) ) ++p;
+      ++found;
+
+      /** Numbers beyond the given number of points are ignored. */
+      if( str->CountOnly || k >= numberOfValues ) continue;
+      double value;
+      if( !TransformixInputPointFile::ParseNumber( word, p, value ) )
+      {
+        str->Errors[ threadId ] = "Invalid number \"" + std::string( word, p ) + "\".";
+        break;
+      }
+      str->Points[ k / dimension ][ k % dimension ] = static_cast<ValueType>( value );
+      ++k;
+    }
+    str->NumbersFound[ threadId ] = found;
+
+    return ITK_THREAD_RETURN_VALUE;
+
+  } // end ParseThreaderCallback
 
 
 } // end namespace itk
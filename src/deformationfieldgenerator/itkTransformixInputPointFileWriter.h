@@ -0,0 +1,109 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkTransformixInputPointFileWriter_h_
+#define __itkTransformixInputPointFileWriter_h_
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkTransformixInputPointFileReader.h"
+
+namespace itk
+{
+
+  /** \class TransformixInputPointFileWriter
+   *
+   * \brief Writes the points of a point set as a transformix input point file.
+   *
+   * The text format starts with "point" or "index", followed by the number
+   * of points and then one point per line. The numbers are written with 17
+   * significant digits without the locale, so they are read back exactly.
+   *
+   * With UseBinary the points are written in the binary format described
+   * in TransformixInputPointFile, which the TransformixInputPointFileReader
+   * copies without parsing.
+   **/
+
+  template <class TInputMesh>
+  class TransformixInputPointFileWriter : public Object
+  {
+  public:
+    /** Standard class typedefs. */
+    typedef TransformixInputPointFileWriter        Self;
+    typedef Object                                 Superclass;
+    typedef SmartPointer<Self>                     Pointer;
+    typedef SmartPointer<const Self>               ConstPointer;
+
+    /** Method for creation through the object factory. */
+    itkNewMacro(Self);
+
+    /** Run-time type information (and related methods). */
+    itkTypeMacro(TransformixInputPointFileWriter, Object);
+
+    /** Some convenient typedefs. */
+    typedef TInputMesh                             InputMeshType;
+    typedef typename InputMeshType::ConstPointer   InputMeshConstPointer;
+
+    /** Set/Get the point set to write. */
+    itkSetConstObjectMacro(Input, InputMeshType);
+    itkGetConstObjectMacro(Input, InputMeshType);
+
+    /** Set/Get the file name. */
+    itkSetStringMacro(FileName);
+    itkGetStringMacro(FileName);
+
+    /** Set/Get whether the points are indices. Default false. */
+    itkSetMacro(PointsAreIndices, bool);
+    itkGetConstMacro(PointsAreIndices, bool);
+    itkBooleanMacro(PointsAreIndices);
+
+    /** Set/Get whether to write the binary format. Default false. */
+    itkSetMacro(UseBinary, bool);
+    itkGetConstMacro(UseBinary, bool);
+    itkBooleanMacro(UseBinary);
+
+    /** Write the file. */
+    virtual void Write( void );
+
+    /** Same as Write(), for symmetry with the pipeline classes. */
+    virtual void Update( void ) { this->Write(); }
+
+  protected:
+    TransformixInputPointFileWriter();
+    virtual ~TransformixInputPointFileWriter() {};
+
+    /** PrintSelf. */
+    void PrintSelf( std::ostream & os, Indent indent ) const;
+
+    InputMeshConstPointer m_Input;
+    std::string           m_FileName;
+    bool                  m_PointsAreIndices;
+    bool                  m_UseBinary;
+
+  private:
+    TransformixInputPointFileWriter(const Self&); //purposely not implemented
+    void operator=(const Self&); //purposely not implemented
+
+  }; // end class
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkTransformixInputPointFileWriter.hxx"
+#endif
+
+#endif // end #ifndef __itkTransformixInputPointFileWriter_h_
@@ -0,0 +1,166 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkTransformixInputPointFileWriter_hxx_
+#define __itkTransformixInputPointFileWriter_hxx_
+
+#include "itkTransformixInputPointFileWriter.h"
+#include "itkByteSwapper.h"
+
+#include <fstream>
+#include <locale>
+#include <cstring>
+
+namespace itk
+{
+
+  /**
+   * **************** Constructor ***************
+   */
+
+  template <class TInputMesh>
+  TransformixInputPointFileWriter<TInputMesh>
+  ::TransformixInputPointFileWriter()
+  {
+    this->m_PointsAreIndices = false;
+    this->m_UseBinary = false;
+
+  } // end constructor
+
+
+  /**
+   * ***************Write ***********
+   */
+
+  template <class TInputMesh>
+  void
+  TransformixInputPointFileWriter<TInputMesh>
+  ::Write( void )
+  {
+    typedef typename InputMeshType::PointsContainer   PointsContainerType;
+    typedef typename PointsContainerType::ConstIterator PointsIteratorType;
+    const unsigned int dimension = InputMeshType::PointDimension;
+
+    if( this->m_Input.IsNull() )
+    {
+      itkExceptionMacro( << "No input to write." );
+    }
+    if( this->m_FileName == "" )
+    {
+      itkExceptionMacro( << "No file name given." );
+    }
+
+    const PointsContainerType * points = this->m_Input->GetPoints();
+    const unsigned long numberOfPoints = points ? points->Size() : 0;
+
+    std::ofstream file;
+    if( this->m_UseBinary )
+    {
+      file.open( this->m_FileName.c_str(), std::ios::out | std::ios::binary );
+    }
+    else
+    {
+      file.open( this->m_FileName.c_str() );
+    }
+    if( !file.is_open() )
+    {
+      itkExceptionMacro( << "The file " << this->m_FileName << " cannot be opened for writing." );
+    }
+
+    if( this->m_UseBinary )
+    {
+      /** The header. */
+      char header[ TransformixInputPointFile::BinaryHeaderSize ];
+      unsigned int words[ 4 ];
+      unsigned long long numberOfPoints64 = numberOfPoints;
+      words[ 0 ] = TransformixInputPointFile::BinaryVersion;
+      words[ 1 ] = this->m_PointsAreIndices ? 1 : 0;
+      words[ 2 ] = dimension;
+      words[ 3 ] = 0;
+      ByteSwapper<unsigned int>::SwapRangeFromSystemToLittleEndian( words, 4 );
+      ByteSwapper<unsigned long long>::SwapFromSystemToLittleEndian( &numberOfPoints64 );
+      std::memcpy( header, TransformixInputPointFile::BinaryMagic,
+        TransformixInputPointFile::BinaryMagicSize );
+      std::memcpy( header + 8, words, sizeof( words ) );
+      std::memcpy( header + 24, &numberOfPoints64, sizeof( numberOfPoints64 ) );
+      file.write( header, sizeof( header ) );
+
+      /** The coordinates. */
+      if( points )
+      {
+        for( PointsIteratorType it = points->Begin(); it != points->End(); ++it )
+        {
+          double values[ dimension ];
+          for( unsigned int j = 0; j < dimension; ++j )
+          {
+            values[ j ] = static_cast<double>( it.Value()[ j ] );
+          }
+          ByteSwapper<double>::SwapRangeFromSystemToLittleEndian( values, dimension );
+          file.write( reinterpret_cast<const char *>( values ), sizeof( values ) );
+        }
+      }
+    }
+    else
+    {
+      file.imbue( std::locale::classic() );
+      file.precision( 17 );
+      file << ( this->m_PointsAreIndices ? "index" : "point" ) << "\n";
+      file << numberOfPoints << "\n";
+      if( points )
+      {
+        for( PointsIteratorType it = points->Begin(); it != points->End(); ++it )
+        {
+          for( unsigned int j = 0; j < dimension; ++j )
+          {
+            if( j > 0 ) file << " ";
+            file << static_cast<double>( it.Value()[ j ] );
+          }
+          file << "\n";
+        }
+      }
+    }
+
+    if( !file.good() )
+    {
+      itkExceptionMacro( << "An error occurred while writing " << this->m_FileName << "." );
+    }
+    file.close();
+
+  } // end Write
+
+
+  /**
+   * ***************PrintSelf ***********
+   */
+
+  template <class TInputMesh>
+  void
+  TransformixInputPointFileWriter<TInputMesh>
+  ::PrintSelf( std::ostream & os, Indent indent ) const
+  {
+    Superclass::PrintSelf( os, indent );
+
+    os << indent << "FileName: " << this->m_FileName << std::endl;
+    os << indent << "PointsAreIndices: " << this->m_PointsAreIndices << std::endl;
+    os << indent << "UseBinary: " << this->m_UseBinary << std::endl;
+
+  } // end PrintSelf
+
+
+} // end namespace itk
+
+#endif // end #ifndef __itkTransformixInputPointFileWriter_hxx_
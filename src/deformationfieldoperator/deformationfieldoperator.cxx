@@ -16,7 +16,7 @@
 *
 *=========================================================================*/
 /** \file
- \brief This program converts between deformations (displacement fields) and transformations, and computes the magnitude or Jacobian of a deformation field.
+ \brief This program converts between deformations (displacement fields) and transformations, and computes the magnitude, Jacobian or inverse of a deformation field.
 
  \verbinclude deformationfieldoperator.help
  */
@@ -45,13 +45,26 @@ std::string GetHelpString( void )
     << "and transformations, and computes the magnitude or Jacobian of a\n"
     << "deformation field.\n"
     << "  -in      inputFilename\n"
-    << "  [-out]   outputFilename; default: in + {operation}.mhd\n"
-    << "  [-ops]   operation, choose one of {DEF2TRANS, TRANS2DEF,\n"
+    << "  [-out]   outputFilenames, one per operation; default: in + {operation}.mhd\n"
+    << "  [-ops]   operations, one or more of {DEF2TRANS, TRANS2DEF,\n"
     << "           MAGNITUDE, JACOBIAN, DEF2JAC, INVERSE}.\n"
     << "           default: MAGNITUDE\n"
+    << "           All operations but INVERSE are computed in one multi-threaded\n"
+    << "           pass over the input, streamed in slabs when -s > 1\n"
     << "  [-s]     number of streams, default 1\n"
-    << "  [-it]    number of iterations, for the iterative inversion, default 1, increase to get better results\n"
-    << "  [-stop]  allowed error, default 0.0, increase to get faster convergence\n"
+    << "  [-m]     inversion method, choose one of {fixedpoint, iterative}.\n"
+    << "           fixedpoint: iterates v <- -u(x+v) per voxel, in parallel;\n"
+    << "           iterative: the itk::IterativeInverseDisplacementFieldImageFilter.\n"
+    << "           default: fixedpoint\n"
+    << "  [-it]    number of iterations, for the inversion,\n"
+    << "           default 20 for fixedpoint and 1 for iterative, increase to get better results\n"
+    << "  [-stop]  allowed error, default 0.0, increase to get faster convergence;\n"
+    << "           for fixedpoint the inverse consistency error per voxel, in mm\n"
+    << "  [-levels] number of resolution levels for the fixedpoint inversion;\n"
+    << "           each level initializes the next with the inverse of the field\n"
+    << "           subsampled by a factor 2, default 1\n"
+    << "  [-outr]  output filename of the inverse consistency error per voxel,\n"
+    << "           |v(x) + u(x+v(x))|, for the fixedpoint inversion; disables streaming\n"
     << "Supported: 2D, 3D, vector of floats or doubles, number of components\n"
     << "must equal number of dimensions.";
   return ss.str();
@@ -86,18 +99,26 @@ int main( int argc, char **argv )
   std::string inputFileName = "";
   parser->GetCommandLineArgument( "-in", inputFileName );
 
-  std::string ops = "MAGNITUDE";
+  std::vector<std::string> ops( 1, "MAGNITUDE" );
   parser->GetCommandLineArgument( "-ops", ops );
 
-  std::string outputFileName = "";
-  parser->GetCommandLineArgument( "-out", outputFileName );
-  if( outputFileName == "" )
+  std::vector<std::string> outputFileNames;
+  parser->GetCommandLineArgument( "-out", outputFileNames );
+  if( outputFileNames.empty() )
   {
     std::string part1 =
       itksys::SystemTools::GetFilenameWithoutLastExtension(inputFileName);
     std::string ext =
       itksys::SystemTools::GetFilenameLastExtension(inputFileName);
-    outputFileName = part1 + ops + ext;
+    for( unsigned int i = 0; i < ops.size(); ++i )
+    {
+      outputFileNames.push_back( part1 + ops[ i ] + ext );
+    }
+  }
+  if( outputFileNames.size() != ops.size() )
+  {
+    std::cerr << "ERROR: The number of output filenames should equal the number of operations." << std::endl;
+    return EXIT_FAILURE;
   }
 
   /** Support for streaming. */
@@ -105,12 +126,33 @@ int main( int argc, char **argv )
   parser->GetCommandLineArgument( "-s", numberOfStreams );
 
   /** Parameters for the inversion. */
-  unsigned int numberOfIterations = 1;
+  std::string inversionMethod = "fixedpoint";
+  parser->GetCommandLineArgument( "-m", inversionMethod );
+
+  unsigned int numberOfIterations = inversionMethod == "fixedpoint" ? 20 : 1;
   parser->GetCommandLineArgument( "-it", numberOfIterations );
 
   double stopValue = 0.0;
   parser->GetCommandLineArgument( "-stop", stopValue );
 
+  unsigned int numberOfLevels = 1;
+  parser->GetCommandLineArgument( "-levels", numberOfLevels );
+
+  std::string residualFileName = "";
+  parser->GetCommandLineArgument( "-outr", residualFileName );
+
+  /** Checks. */
+  if( inversionMethod != "fixedpoint" && inversionMethod != "iterative" )
+  {
+    std::cerr << "ERROR: -m should be one of {fixedpoint, iterative}." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if( numberOfLevels == 0 )
+  {
+    std::cerr << "ERROR: -levels should be at least 1." << std::endl;
+    return EXIT_FAILURE;
+  }
+
   /** Determine image properties. */
   itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
   itk::ImageIOBase::IOComponentType componentType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
@@ -151,11 +193,14 @@ int main( int argc, char **argv )
 
     /** Set the filter arguments. */
     filter->m_InputFileName = inputFileName;
-    filter->m_OutputFileName = outputFileName;
+    filter->m_OutputFileNames = outputFileNames;
     filter->m_Ops = ops;
     filter->m_NumberOfStreams = numberOfStreams;
     filter->m_NumberOfIterations = numberOfIterations;
     filter->m_StopValue = stopValue;
+    filter->m_InversionMethod = inversionMethod;
+    filter->m_NumberOfLevels = numberOfLevels;
+    filter->m_ResidualFileName = residualFileName;
 
     filter->Run();
 
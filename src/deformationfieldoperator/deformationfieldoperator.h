@@ -19,15 +19,23 @@
 #define __deformationfieldoperator_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsExecutionOptions.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImage.h"
 #include "itkExceptionObject.h"
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
-#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageIOFactory.h"
+#include "itkImageIORegion.h"
 #include "itkDisplacementFieldJacobianDeterminantFilter.h"
 #include "itkVectorMagnitudeImageFilter.h"
 #include "itkIterativeInverseDisplacementFieldImageFilter.h"
+#include "itkFixedPointInverseDisplacementFieldImageFilter.h"
+#include "itkDeformationToTransformationImageFilter.h"
+
+#include <vector>
+#include <algorithm>
 
 
 /** \class ITKToolsDeformationFieldOperatorBase
@@ -43,22 +51,26 @@ public:
   ITKToolsDeformationFieldOperatorBase()
   {
     this->m_InputFileName = "";
-    this->m_OutputFileName = "";
-    this->m_Ops = "";
     this->m_NumberOfStreams = 0;
     this->m_NumberOfIterations = 0;
     this->m_StopValue = 0.0f;
+    this->m_InversionMethod = "fixedpoint";
+    this->m_NumberOfLevels = 1;
+    this->m_ResidualFileName = "";
   };
   /** Destructor. */
   ~ITKToolsDeformationFieldOperatorBase(){};
 
   /** Input member parameters. */
   std::string m_InputFileName;
-  std::string m_OutputFileName;
-  std::string m_Ops;
+  std::vector<std::string> m_OutputFileNames;
+  std::vector<std::string> m_Ops;
   unsigned int m_NumberOfStreams;
   unsigned int m_NumberOfIterations;
   double m_StopValue;
+  std::string m_InversionMethod;
+  unsigned int m_NumberOfLevels;
+  std::string m_ResidualFileName;
 
 }; // end class ITKToolsDeformationFieldOperatorBase
 
@@ -89,176 +101,198 @@ public:
   /** Run function. */
   void Run( void )
   {
-    typedef itk::ImageFileReader< VectorImageType >       ReaderType;
-
-    /** DECLARATION'S. */
-    typename VectorImageType::Pointer workingImage;
-    typename ReaderType::Pointer reader = ReaderType::New();
-
-    /** Read in the inputImage. */
-    reader->SetFileName( this->m_InputFileName.c_str() );
-    // temporarily: only streaming support for Jacobian case needed for EMPIRE10 challenge.
-    if( this->m_Ops != "DEF2JAC" && this->m_Ops != "JACOBIAN" )
+    /** Check the operators before doing any work. */
+    for( unsigned int i = 0; i < this->m_Ops.size(); ++i )
     {
-      reader->Update();
+      const std::string & op = this->m_Ops[ i ];
+      if( op != "DEF2TRANS" && op != "TRANS2DEF" && op != "MAGNITUDE"
+        && op != "JACOBIAN" && op != "DEF2JAC" && op != "INVERSE" )
+      {
+        itkGenericExceptionMacro( << "<< invalid operator: " << op );
+      }
     }
 
-    /** Change to Transformation or Deformation by adding/subtracting pixel coordinates */
-    workingImage = reader->GetOutput();
-
-    /** Do something with this image and save the result */
-    if( this->m_Ops == "DEF2TRANS" )
-    {
-      this->Deformation2Transformation( workingImage, true );
-    }
-    else if( this->m_Ops == "TRANS2DEF" )
-    {
-      this->Deformation2Transformation( workingImage, false );
-    }
-    else if( this->m_Ops == "MAGNITUDE" )
-    {
-      this->ComputeMagnitude( workingImage );
-    }
-    else if( this->m_Ops == "DEF2JAC" )
+    /** All operators but the inversion need only a neighbourhood of every
+     * voxel, so they are computed together in a single streamed pass.
+     * The inversion needs the whole field.
+     */
+    std::vector<std::string> streamedOps;
+    std::vector<std::string> streamedOutputFileNames;
+    for( unsigned int i = 0; i < this->m_Ops.size(); ++i )
     {
-      this->ComputeJacobian();
+      if( this->m_Ops[ i ] != "INVERSE" )
+      {
+        streamedOps.push_back( this->m_Ops[ i ] );
+        streamedOutputFileNames.push_back( this->m_OutputFileNames[ i ] );
+      }
     }
-    else if( this->m_Ops == "INVERSE" )
+    if( !streamedOps.empty() )
     {
-      this->ComputeInverse();
+      this->ComputeStreamed( streamedOps, streamedOutputFileNames );
     }
-    else
+
+    for( unsigned int i = 0; i < this->m_Ops.size(); ++i )
     {
-      itkGenericExceptionMacro( << "<< invalid operator: " << this->m_Ops );
+      if( this->m_Ops[ i ] == "INVERSE" )
+      {
+        this->ComputeInverse( this->m_OutputFileNames[ i ] );
+      }
     }
   } // end Run()
 
   /** Helper functions that implement the real functionality. */
-  void Deformation2Transformation( VectorImageType * inputImage, bool def2trans );
-  void ComputeMagnitude( VectorImageType * inputImage );
-  void ComputeJacobian( void );
-  void ComputeInverse( void );
+  void ComputeStreamed( const std::vector<std::string> & ops,
+    const std::vector<std::string> & outputFileNames );
+  void ComputeInverse( const std::string & outputFileName );
 
 }; // end class ITKToolsDeformationFieldOperator
 
 // \todo: should be moved to hxx
 
 /**
- * *************** Deformation2Transformation *********************
- * convert between deformation fields and transformation 'fields'
- */
-
-template< unsigned int VDimension, class TComponentType >
-void
-ITKToolsDeformationFieldOperator< VDimension, TComponentType >
-::Deformation2Transformation( VectorImageType * inputImage, bool def2trans )
-{
-  typedef itk::ImageFileWriter< VectorImageType >     WriterType;
-  typedef itk::ImageRegionIteratorWithIndex<
-    VectorImageType >                                 IteratorType;
-  typedef typename VectorImageType::IndexType         IndexType;
-  typedef typename VectorImageType::PointType         PointType;
-
-  /** We are going to change the image, so make sure these changes are not undone */
-  inputImage->Update();
-  inputImage->DisconnectPipeline();
-
-  IteratorType it( inputImage, inputImage->GetLargestPossibleRegion() );
-  it.GoToBegin();
-  double plusormin = 1.0;
-  std::string message = "from deformation to transformation";
-  if( !def2trans )
-  {
-    plusormin = -1.0;
-    message = "from transformation to deformation";
-  }
-  std::cout << "Changing image " << message << "..." << std::endl;
-  while ( !( it.IsAtEnd() ) )
-  {
-    const IndexType & index = it.GetIndex();
-    VectorPixelType & value = it.Value();
-    PointType point;
-    inputImage->TransformIndexToPhysicalPoint( index, point );
-    for( unsigned int i = 0; i < VDimension; ++i )
-    {
-      value[ i ] += static_cast<TComponentType>( plusormin * point[ i ] );
-    }
-    ++it;
-  }
-  std::cout << "Ready changing image " << message << "." << std::endl;
-
-  /** Write the output image. */
-  typename WriterType::Pointer writer = WriterType::New();
-  writer->SetInput( inputImage );
-  writer->SetFileName( this->m_OutputFileName.c_str() );
-  writer->Update();
-
-} // end Deformation2Transformation()
-
-
-/**
- * ******************* ComputeMagnitude ************************
- * Write magnitude of deformation field to disk
- */
-
-template< unsigned int VDimension, class TComponentType >
-void
-ITKToolsDeformationFieldOperator< VDimension, TComponentType >
-::ComputeMagnitude( VectorImageType * inputImage )
-{
-  typedef itk::ImageFileWriter< ScalarImageType >     WriterType;
-  typedef itk::VectorMagnitudeImageFilter<
-    VectorImageType, ScalarImageType >                MagnitudeFilterType;
-
-  typename MagnitudeFilterType::Pointer magnitudeFilter = MagnitudeFilterType::New();
-  typename WriterType::Pointer writer = WriterType::New();
-
-  magnitudeFilter->SetInput( inputImage );
-  magnitudeFilter->Update();
-
-  /** Write the output image. */
-  writer->SetInput( magnitudeFilter->GetOutput() );
-  writer->SetFileName( this->m_OutputFileName.c_str() );
-  writer->Update();
-
-} // end ComputeMagnitude()
-
-
-/**
- * ******************* ComputeJacobian ************************
- * Compute Jacobian of deformation field
+ * ******************* ComputeStreamed ************************
+ * Compute DEF2TRANS, TRANS2DEF, MAGNITUDE and JACOBIAN (DEF2JAC)
+ * from one read of the deformation field, slab by slab.
  */
 
 template< unsigned int VDimension, class TComponentType >
 void
 ITKToolsDeformationFieldOperator< VDimension, TComponentType >
-::ComputeJacobian( void )
+::ComputeStreamed( const std::vector<std::string> & ops,
+  const std::vector<std::string> & outputFileNames )
 {
   /** Typedef's. */
   typedef itk::ImageFileReader< VectorImageType >       ReaderType;
+  typedef itk::ImageFileWriter< VectorImageType >       VectorWriterType;
+  typedef itk::ImageFileWriter< ScalarImageType >       ScalarWriterType;
+  typedef itk::DeformationToTransformationImageFilter<
+    VectorImageType, VectorImageType >                  DefToTransFilterType;
+  typedef itk::VectorMagnitudeImageFilter<
+    VectorImageType, ScalarImageType >                  MagnitudeFilterType;
   typedef itk::DisplacementFieldJacobianDeterminantFilter<
     VectorImageType, TComponentType, ScalarImageType >  DefToJacFilterType;
-  typedef itk::ImageFileWriter< ScalarImageType >       WriterType;
+  typedef typename VectorImageType::RegionType          RegionType;
 
   /** Setup reader. */
   typename ReaderType::Pointer reader = ReaderType::New();
   reader->SetFileName( this->m_InputFileName.c_str() );
+  itktools::ReuseImageIO( reader, this->m_InputFileName );
+  reader->UseStreamingOn();
+  reader->UpdateOutputInformation();
+  const RegionType largestRegion = reader->GetOutput()->GetLargestPossibleRegion();
+
+  /** Setup a pipeline per operator on the shared reader. The Jacobian needs
+   * a border of neighbours around every slab, so it is computed first: the
+   * other operators then find their slab already read. The filters are
+   * kept alive, since a writer does not own the filter that feeds it.
+   */
+  std::vector<itk::ProcessObject::Pointer>        filters;
+  std::vector<typename ScalarWriterType::Pointer> scalarWriters;
+  std::vector<typename VectorWriterType::Pointer> vectorWriters;
+  double memoryInBytes = largestRegion.GetNumberOfPixels()
+    * static_cast<double>( sizeof( VectorPixelType ) );
+  bool canStreamWrite = true;
+  for( unsigned int pass = 0; pass < 2; ++pass )
+  {
+    for( unsigned int i = 0; i < ops.size(); ++i )
+    {
+      const std::string & op = ops[ i ];
+      const bool isJacobian = op == "JACOBIAN" || op == "DEF2JAC";
+      if( isJacobian != ( pass == 0 ) ) continue;
+
+      itk::ImageIOBase::Pointer outputIO = itk::ImageIOFactory::CreateImageIO(
+        outputFileNames[ i ].c_str(), itk::ImageIOFactory::WriteMode );
+      canStreamWrite &= outputIO.IsNotNull() && outputIO->CanStreamWrite();
+
+      if( op == "DEF2TRANS" || op == "TRANS2DEF" )
+      {
+        typename DefToTransFilterType::Pointer defToTransFilter = DefToTransFilterType::New();
+        defToTransFilter->SetInput( reader->GetOutput() );
+        defToTransFilter->SetTransformationToDeformation( op == "TRANS2DEF" );
+        defToTransFilter->ReleaseDataFlagOn();
+        filters.push_back( defToTransFilter.GetPointer() );
+
+        typename VectorWriterType::Pointer writer = VectorWriterType::New();
+        writer->SetInput( defToTransFilter->GetOutput() );
+        writer->SetFileName( outputFileNames[ i ].c_str() );
+        vectorWriters.push_back( writer );
+        memoryInBytes += largestRegion.GetNumberOfPixels()
+          * static_cast<double>( sizeof( VectorPixelType ) );
+      }
+      else
+      {
+        typename ScalarWriterType::Pointer writer = ScalarWriterType::New();
+        if( isJacobian )
+        {
+          typename DefToJacFilterType::Pointer defToJacFilter = DefToJacFilterType::New();
+          defToJacFilter->SetUseImageSpacingOn();
+          defToJacFilter->SetInput( reader->GetOutput() );
+          defToJacFilter->ReleaseDataFlagOn();
+          filters.push_back( defToJacFilter.GetPointer() );
+          writer->SetInput( defToJacFilter->GetOutput() );
+        }
+        else
+        {
+          typename MagnitudeFilterType::Pointer magnitudeFilter = MagnitudeFilterType::New();
+          magnitudeFilter->SetInput( reader->GetOutput() );
+          magnitudeFilter->ReleaseDataFlagOn();
+          filters.push_back( magnitudeFilter.GetPointer() );
+          writer->SetInput( magnitudeFilter->GetOutput() );
+        }
+        writer->SetFileName( outputFileNames[ i ].c_str() );
+        scalarWriters.push_back( writer );
+        memoryInBytes += largestRegion.GetNumberOfPixels()
+          * static_cast<double>( sizeof( ScalarPixelType ) );
+      }
+    }
+  }
 
-  /** Setup Jacobian filter. */
-  typename DefToJacFilterType::Pointer defToJacFilter = DefToJacFilterType::New();
-  defToJacFilter->SetUseImageSpacingOn();
-  defToJacFilter->SetInput( reader->GetOutput() );
+  /** Determine the number of slabs, along the last dimension. */
+  const unsigned int lastDim = VDimension - 1;
+  const unsigned int numberOfSlices = largestRegion.GetSize()[ lastDim ];
+  unsigned int numberOfSlabs = std::min( numberOfSlices,
+    itktools::GetNumberOfStreamDivisions( memoryInBytes, this->m_NumberOfStreams ) );
+  if( numberOfSlabs > 1 && !canStreamWrite )
+  {
+    std::cerr << "WARNING: not all output formats support streamed writing, "
+      << "the operators are computed in one piece." << std::endl;
+    numberOfSlabs = 1;
+  }
 
-  /** Setup writer.  No intermediate calls to Update() are allowed,
-   * otherwise streaming does not work.
+  /** Compute all operators slab after slab. Every writer pastes its slab
+   * into its output file, so the reader reads every slab only once.
    */
-  typename WriterType::Pointer writer = WriterType::New();
-  writer->SetInput( defToJacFilter->GetOutput() );
-  writer->SetFileName( this->m_OutputFileName.c_str() );
-  writer->SetNumberOfStreamDivisions( this->m_NumberOfStreams );
-  writer->Update();
+  for( unsigned int slab = 0; slab < numberOfSlabs; ++slab )
+  {
+    const unsigned int firstSlice = static_cast<unsigned int>(
+      static_cast<unsigned long long>( slab ) * numberOfSlices / numberOfSlabs );
+    const unsigned int endSlice = static_cast<unsigned int>(
+      static_cast<unsigned long long>( slab + 1 ) * numberOfSlices / numberOfSlabs );
+
+    itk::ImageIORegion ioRegion( VDimension );
+    for( unsigned int d = 0; d < VDimension; ++d )
+    {
+      ioRegion.SetIndex( d, 0 );
+      ioRegion.SetSize( d, largestRegion.GetSize()[ d ] );
+    }
+    ioRegion.SetIndex( lastDim, firstSlice );
+    ioRegion.SetSize( lastDim, endSlice - firstSlice );
+
+    for( unsigned int i = 0; i < scalarWriters.size(); ++i )
+    {
+      if( numberOfSlabs > 1 ) scalarWriters[ i ]->SetIORegion( ioRegion );
+      itktools::AddTimingObservers( scalarWriters[ i ] );
+      scalarWriters[ i ]->Update();
+    }
+    for( unsigned int i = 0; i < vectorWriters.size(); ++i )
+    {
+      if( numberOfSlabs > 1 ) vectorWriters[ i ]->SetIORegion( ioRegion );
+      itktools::AddTimingObservers( vectorWriters[ i ] );
+      vectorWriters[ i ]->Update();
+    }
+  }
 
-} // end ComputeJacobian()
+} // end ComputeStreamed()
 
 
 /**
@@ -269,34 +303,74 @@ ITKToolsDeformationFieldOperator< VDimension, TComponentType >
 template< unsigned int VDimension, class TComponentType >
 void
 ITKToolsDeformationFieldOperator< VDimension, TComponentType >
-::ComputeInverse( void )
+::ComputeInverse( const std::string & outputFileName )
 {
   /** Typedef's. */
   typedef itk::ImageFileReader< VectorImageType >     ReaderType;
   typedef itk::ImageFileWriter< VectorImageType >     WriterType;
   typedef itk::IterativeInverseDisplacementFieldImageFilter<
-    VectorImageType, VectorImageType >                InverseDeformationFilterType;
+    VectorImageType, VectorImageType >                IterativeInverseFilterType;
+  typedef itk::FixedPointInverseDisplacementFieldImageFilter<
+    VectorImageType, VectorImageType >                FixedPointInverseFilterType;
+  typedef typename FixedPointInverseFilterType::ResidualImageType ResidualImageType;
+  typedef itk::ImageFileWriter< ResidualImageType >   ResidualWriterType;
 
   /** Declare filters. */
   typename ReaderType::Pointer reader = ReaderType::New();
-  typename InverseDeformationFilterType::Pointer inversionFilter
-    = InverseDeformationFilterType::New();
   typename WriterType::Pointer writer = WriterType::New();
 
   /** Setup reader. */
   reader->SetFileName( this->m_InputFileName.c_str() );
+  itktools::ReuseImageIO( reader, this->m_InputFileName );
 
-  /** Setup inversion filter. */
-  inversionFilter->SetInput( reader->GetOutput() );
-  inversionFilter->SetNumberOfIterations( this->m_NumberOfIterations );
-  inversionFilter->SetStopValue( this->m_StopValue );
+  /** Setup the inversion filter. The filters are declared here, since the
+   * writer does not keep the filter that feeds it alive.
+   */
+  typename FixedPointInverseFilterType::Pointer fixedPointFilter;
+  typename IterativeInverseFilterType::Pointer iterativeFilter;
+  if( this->m_InversionMethod == "fixedpoint" )
+  {
+    fixedPointFilter = FixedPointInverseFilterType::New();
+    fixedPointFilter->SetInput( reader->GetOutput() );
+    fixedPointFilter->SetNumberOfIterations( this->m_NumberOfIterations );
+    fixedPointFilter->SetTolerance( this->m_StopValue );
+    fixedPointFilter->SetNumberOfLevels( this->m_NumberOfLevels );
+    writer->SetInput( fixedPointFilter->GetOutput() );
+  }
+  else if( this->m_InversionMethod == "iterative" )
+  {
+    iterativeFilter = IterativeInverseFilterType::New();
+    iterativeFilter->SetInput( reader->GetOutput() );
+    iterativeFilter->SetNumberOfIterations( this->m_NumberOfIterations );
+    iterativeFilter->SetStopValue( this->m_StopValue );
+    writer->SetInput( iterativeFilter->GetOutput() );
+  }
+  else
+  {
+    itkGenericExceptionMacro( << "invalid inversion method: " << this->m_InversionMethod );
+  }
+  writer->SetFileName( outputFileName.c_str() );
+
+  /** The residual image is only complete after a single update. */
+  if( fixedPointFilter.IsNotNull() && this->m_ResidualFileName != "" )
+  {
+    fixedPointFilter->Update();
+    itktools::AddTimingObservers( writer );
+    writer->Update();
+
+    typename ResidualWriterType::Pointer residualWriter = ResidualWriterType::New();
+    residualWriter->SetInput( fixedPointFilter->GetResidualOutput() );
+    residualWriter->SetFileName( this->m_ResidualFileName.c_str() );
+    itktools::AddTimingObservers( residualWriter );
+    residualWriter->Update();
+    return;
+  }
 
   /** Setup writer.  No intermediate calls to Update() are allowed,
    * otherwise streaming does not work.
    */
-  writer->SetInput( inversionFilter->GetOutput() );
-  writer->SetFileName( this->m_OutputFileName.c_str() );
   writer->SetNumberOfStreamDivisions( this->m_NumberOfStreams );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end ComputeInverse()
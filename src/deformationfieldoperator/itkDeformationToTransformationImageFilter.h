@@ -0,0 +1,100 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkDeformationToTransformationImageFilter_h_
+#define __itkDeformationToTransformationImageFilter_h_
+
+#include "itkImageToImageFilter.h"
+
+
+namespace itk
+{
+
+/** \class DeformationToTransformationImageFilter
+ * \brief Converts a deformation (displacement) field to a transformation
+ * field, by adding the physical position of every voxel, or back.
+ *
+ * Every voxel is converted independently, so the filter is threaded and
+ * streams: every output region only needs the same region of the input.
+ *
+ * \ingroup ImageToImageFilter
+ * \ingroup Multithreaded
+ */
+
+template < typename TInputImage, typename TOutputImage = TInputImage >
+class ITK_EXPORT DeformationToTransformationImageFilter:
+    public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef DeformationToTransformationImageFilter            Self;
+  typedef ImageToImageFilter< TInputImage, TOutputImage >   Superclass;
+  typedef SmartPointer<Self>                                Pointer;
+  typedef SmartPointer<const Self>                          ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( DeformationToTransformationImageFilter, ImageToImageFilter );
+
+  /** Image dimension. */
+  itkStaticConstMacro( ImageDimension, unsigned int, TInputImage::ImageDimension );
+
+  /** Typedefs. */
+  typedef TInputImage                                 InputImageType;
+  typedef TOutputImage                                OutputImageType;
+  typedef typename OutputImageType::PixelType         OutputPixelType;
+  typedef typename OutputPixelType::ValueType         OutputValueType;
+  typedef typename OutputImageType::RegionType        OutputImageRegionType;
+
+  /** Set/Get the direction of the conversion. When on, a transformation
+   * field is converted to a deformation field. Default off.
+   */
+  itkSetMacro( TransformationToDeformation, bool );
+  itkGetConstMacro( TransformationToDeformation, bool );
+  itkBooleanMacro( TransformationToDeformation );
+
+protected:
+  DeformationToTransformationImageFilter();
+  virtual ~DeformationToTransformationImageFilter() {};
+
+  /** PrintSelf. */
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** Convert a region. */
+  virtual void ThreadedGenerateData(
+    const OutputImageRegionType & outputRegionForThread,
+    ThreadIdType threadId );
+
+private:
+  DeformationToTransformationImageFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );                         // purposely not implemented
+
+  /** Member variables. */
+  bool m_TransformationToDeformation;
+
+}; // end class DeformationToTransformationImageFilter
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkDeformationToTransformationImageFilter.txx"
+#endif
+
+#endif // end #ifndef __itkDeformationToTransformationImageFilter_h_
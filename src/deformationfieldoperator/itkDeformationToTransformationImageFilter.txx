@@ -0,0 +1,103 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef _itkDeformationToTransformationImageFilter_txx_
+#define _itkDeformationToTransformationImageFilter_txx_
+
+#include "itkDeformationToTransformationImageFilter.h"
+
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkProgressReporter.h"
+
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template <typename TInputImage, typename TOutputImage>
+DeformationToTransformationImageFilter<TInputImage, TOutputImage>
+::DeformationToTransformationImageFilter()
+{
+  this->m_TransformationToDeformation = false;
+
+} // end Constructor
+
+
+/**
+ * ******************* ThreadedGenerateData *******************
+ */
+
+template <typename TInputImage, typename TOutputImage>
+void
+DeformationToTransformationImageFilter<TInputImage, TOutputImage>
+::ThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  typedef ImageRegionConstIterator<InputImageType>        InputIteratorType;
+  typedef ImageRegionIteratorWithIndex<OutputImageType>   OutputIteratorType;
+  typedef typename OutputImageType::PointType             PointType;
+
+  const InputImageType * input = this->GetInput();
+  OutputImageType * output = this->GetOutput();
+  const double sign = this->m_TransformationToDeformation ? -1.0 : 1.0;
+
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+
+  InputIteratorType inIt( input, outputRegionForThread );
+  OutputIteratorType outIt( output, outputRegionForThread );
+  for( inIt.GoToBegin(), outIt.GoToBegin(); !outIt.IsAtEnd(); ++inIt, ++outIt )
+  {
+    PointType point;
+    output->TransformIndexToPhysicalPoint( outIt.GetIndex(), point );
+
+    const typename InputImageType::PixelType & in = inIt.Get();
+    OutputPixelType & out = outIt.Value();
+    for( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+      out[ i ] = static_cast<OutputValueType>( in[ i ] + sign * point[ i ] );
+    }
+
+    progress.CompletedPixel();
+  }
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template <typename TInputImage, typename TOutputImage>
+void
+DeformationToTransformationImageFilter<TInputImage, TOutputImage>
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "TransformationToDeformation: "
+    << this->m_TransformationToDeformation << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef _itkDeformationToTransformationImageFilter_txx_
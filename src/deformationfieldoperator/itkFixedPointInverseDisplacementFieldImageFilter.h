@@ -0,0 +1,160 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkFixedPointInverseDisplacementFieldImageFilter_h_
+#define __itkFixedPointInverseDisplacementFieldImageFilter_h_
+
+#include "itkImageToImageFilter.h"
+#include "itkVectorLinearInterpolateImageFunction.h"
+
+
+namespace itk
+{
+
+/** \class FixedPointInverseDisplacementFieldImageFilter
+ * \brief Inverts a displacement field by fixed point iteration.
+ *
+ * For every voxel x the inverse displacement v is found by iterating
+ * v <- -u( x + v ), with u the forward displacement sampled by linear
+ * interpolation, clamped to the image. The iteration stops when the
+ * inverse consistency error | v + u( x + v ) | is at most the
+ * Tolerance, in physical units, or after NumberOfIterations updates.
+ * The iterate with the smallest error is kept, which also guards
+ * against voxels where the iteration does not converge.
+ *
+ * Voxels are independent, so the output regions of the threads, and of
+ * stream divisions, are computed separately; the whole input is needed.
+ *
+ * With NumberOfLevels > 1 the iteration is initialized with the inverse
+ * of the field subsampled by a factor of two, computed with one level
+ * less, which saves iterations for large displacements. This initial
+ * inverse is computed once and reused by all stream divisions, until
+ * the input or the parameters change.
+ *
+ * The second output is the inverse consistency error of every voxel.
+ *
+ * \ingroup ImageToImageFilter
+ * \ingroup Multithreaded
+ */
+
+template < typename TInputImage, typename TOutputImage = TInputImage >
+class ITK_EXPORT FixedPointInverseDisplacementFieldImageFilter:
+    public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef FixedPointInverseDisplacementFieldImageFilter     Self;
+  typedef ImageToImageFilter< TInputImage, TOutputImage >   Superclass;
+  typedef SmartPointer<Self>                                Pointer;
+  typedef SmartPointer<const Self>                          ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( FixedPointInverseDisplacementFieldImageFilter, ImageToImageFilter );
+
+  /** Image dimension. */
+  itkStaticConstMacro( ImageDimension, unsigned int, TInputImage::ImageDimension );
+
+  /** Typedefs. */
+  typedef TInputImage                                     InputImageType;
+  typedef typename InputImageType::Pointer                InputImagePointer;
+  typedef TOutputImage                                    OutputImageType;
+  typedef typename OutputImageType::Pointer               OutputImagePointer;
+  typedef typename OutputImageType::PixelType             OutputPixelType;
+  typedef typename OutputPixelType::ValueType             OutputValueType;
+  typedef typename OutputImageType::RegionType            OutputImageRegionType;
+  typedef Image< OutputValueType, ImageDimension >        ResidualImageType;
+  typedef typename ProcessObject::DataObjectPointer       DataObjectPointer;
+  typedef typename ProcessObject::DataObjectPointerArraySizeType
+    DataObjectPointerArraySizeType;
+
+  /** Set/Get the maximum number of iterations per voxel. Default 20. */
+  itkSetMacro( NumberOfIterations, unsigned int );
+  itkGetConstMacro( NumberOfIterations, unsigned int );
+
+  /** Set/Get the inverse consistency error at which a voxel has converged. Default 0. */
+  itkSetMacro( Tolerance, double );
+  itkGetConstMacro( Tolerance, double );
+
+  /** Set/Get the number of resolution levels. Default 1. */
+  itkSetMacro( NumberOfLevels, unsigned int );
+  itkGetConstMacro( NumberOfLevels, unsigned int );
+
+  /** Get the inverse consistency error image, the second output. */
+  ResidualImageType * GetResidualOutput( void );
+
+  /** Create the outputs. */
+  using Superclass::MakeOutput;
+  virtual DataObjectPointer MakeOutput( DataObjectPointerArraySizeType idx );
+
+protected:
+  FixedPointInverseDisplacementFieldImageFilter();
+  virtual ~FixedPointInverseDisplacementFieldImageFilter() {};
+
+  /** PrintSelf. */
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** The whole input is needed. */
+  virtual void GenerateInputRequestedRegion( void );
+
+  /** Compute the initial inverse when needed, and set up the interpolators. */
+  virtual void BeforeThreadedGenerateData( void );
+
+  /** Invert the field in a region. */
+  virtual void ThreadedGenerateData(
+    const OutputImageRegionType & outputRegionForThread,
+    ThreadIdType threadId );
+
+  /** Release the input interpolator. */
+  virtual void AfterThreadedGenerateData( void );
+
+private:
+  FixedPointInverseDisplacementFieldImageFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );                                // purposely not implemented
+
+  typedef VectorLinearInterpolateImageFunction<
+    InputImageType, double >                              InputInterpolatorType;
+  typedef VectorLinearInterpolateImageFunction<
+    OutputImageType, double >                             InitialInterpolatorType;
+
+  /** Sample an image at a point, clamped to the image. */
+  template< class TInterpolator, class TImage >
+  typename TInterpolator::OutputType ClampedEvaluate( const TInterpolator * interpolator,
+    const TImage * image, const typename TImage::PointType & point ) const;
+
+  /** Member variables. */
+  unsigned int  m_NumberOfIterations;
+  double        m_Tolerance;
+  unsigned int  m_NumberOfLevels;
+
+  typename InputInterpolatorType::Pointer     m_InputInterpolator;
+  OutputImagePointer                          m_InitialInverse;
+  typename InitialInterpolatorType::Pointer   m_InitialInterpolator;
+  TimeStamp                                   m_InitialInverseTime;
+
+}; // end class FixedPointInverseDisplacementFieldImageFilter
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkFixedPointInverseDisplacementFieldImageFilter.txx"
+#endif
+
+#endif // end #ifndef __itkFixedPointInverseDisplacementFieldImageFilter_h_
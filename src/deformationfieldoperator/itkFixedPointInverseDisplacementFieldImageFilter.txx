@@ -0,0 +1,307 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef _itkFixedPointInverseDisplacementFieldImageFilter_txx_
+#define _itkFixedPointInverseDisplacementFieldImageFilter_txx_
+
+#include "itkFixedPointInverseDisplacementFieldImageFilter.h"
+
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkShrinkImageFilter.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+#include <limits>
+
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template <typename TInputImage, typename TOutputImage>
+FixedPointInverseDisplacementFieldImageFilter<TInputImage, TOutputImage>
+::FixedPointInverseDisplacementFieldImageFilter()
+{
+  this->m_NumberOfIterations = 20;
+  this->m_Tolerance = 0.0;
+  this->m_NumberOfLevels = 1;
+
+  /** The second output is the residual image. */
+  this->SetNumberOfRequiredOutputs( 2 );
+  this->SetNthOutput( 1, this->MakeOutput( 1 ) );
+
+} // end Constructor
+
+
+/**
+ * ******************* MakeOutput *******************
+ */
+
+template <typename TInputImage, typename TOutputImage>
+typename FixedPointInverseDisplacementFieldImageFilter<TInputImage, TOutputImage>::DataObjectPointer
+FixedPointInverseDisplacementFieldImageFilter<TInputImage, TOutputImage>
+::MakeOutput( DataObjectPointerArraySizeType idx )
+{
+  if( idx == 1 )
+  {
+    return ResidualImageType::New().GetPointer();
+  }
+  return Superclass::MakeOutput( idx );
+
+} // end MakeOutput()
+
+
+/**
+ * ******************* GetResidualOutput *******************
+ */
+
+template <typename TInputImage, typename TOutputImage>
+typename FixedPointInverseDisplacementFieldImageFilter<TInputImage, TOutputImage>::ResidualImageType *
+FixedPointInverseDisplacementFieldImageFilter<TInputImage, TOutputImage>
+::GetResidualOutput( void )
+{
+  return dynamic_cast<ResidualImageType *>( this->ProcessObject::GetOutput( 1 ) );
+
+} // end GetResidualOutput()
+
+
+/**
+ * ******************* GenerateInputRequestedRegion *******************
+ */
+
+template <typename TInputImage, typename TOutputImage>
+void
+FixedPointInverseDisplacementFieldImageFilter<TInputImage, TOutputImage>
+::GenerateInputRequestedRegion( void )
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType * input = const_cast<InputImageType *>( this->GetInput() );
+  if( input ) input->SetRequestedRegionToLargestPossibleRegion();
+
+} // end GenerateInputRequestedRegion()
+
+
+/**
+ * ******************* BeforeThreadedGenerateData *******************
+ */
+
+template <typename TInputImage, typename TOutputImage>
+void
+FixedPointInverseDisplacementFieldImageFilter<TInputImage, TOutputImage>
+::BeforeThreadedGenerateData( void )
+{
+  /** The residual output is not allocated by AllocateOutputs(). */
+  ResidualImageType * residual = this->GetResidualOutput();
+  residual->SetBufferedRegion( residual->GetRequestedRegion() );
+  residual->Allocate();
+
+  /** Use a copy of the input without source, for the internal pipelines. */
+  InputImagePointer input = InputImageType::New();
+  input->Graft( const_cast<InputImageType *>( this->GetInput() ) );
+
+  this->m_InputInterpolator = InputInterpolatorType::New();
+  this->m_InputInterpolator->SetInputImage( input );
+
+  /** Reuse the initial inverse of a previous stream division, unless the
+   * input or the parameters changed since it was computed.
+   */
+  if( this->m_InitialInverseTime.GetMTime() > this->GetMTime()
+    && this->m_InitialInverseTime.GetMTime() > this->GetInput()->GetMTime()
+    && this->m_InitialInverseTime.GetMTime() > this->GetInput()->GetUpdateMTime() )
+  {
+    return;
+  }
+
+  /** Compute the inverse of the subsampled field as initialization. */
+  this->m_InitialInverse = 0;
+  this->m_InitialInterpolator = 0;
+  const typename InputImageType::SizeType size = input->GetLargestPossibleRegion().GetSize();
+  bool canShrink = true;
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    if( size[ i ] < 4 ) canShrink = false;
+  }
+  if( this->m_NumberOfLevels > 1 && canShrink )
+  {
+    typedef ShrinkImageFilter<InputImageType, InputImageType> ShrinkerType;
+    typename ShrinkerType::Pointer shrinker = ShrinkerType::New();
+    shrinker->SetInput( input );
+    shrinker->SetShrinkFactors( 2 );
+
+    typename Self::Pointer coarse = Self::New();
+    coarse->SetInput( shrinker->GetOutput() );
+    coarse->SetNumberOfIterations( this->m_NumberOfIterations );
+    coarse->SetTolerance( this->m_Tolerance );
+    coarse->SetNumberOfLevels( this->m_NumberOfLevels - 1 );
+    coarse->SetNumberOfThreads( this->GetNumberOfThreads() );
+    coarse->Update();
+
+    this->m_InitialInverse = coarse->GetOutput();
+    this->m_InitialInverse->DisconnectPipeline();
+    this->m_InitialInterpolator = InitialInterpolatorType::New();
+    this->m_InitialInterpolator->SetInputImage( this->m_InitialInverse );
+  }
+  this->m_InitialInverseTime.Modified();
+
+} // end BeforeThreadedGenerateData()
+
+
+/**
+ * ******************* ClampedEvaluate *******************
+ */
+
+template <typename TInputImage, typename TOutputImage>
+template< class TInterpolator, class TImage >
+typename TInterpolator::OutputType
+FixedPointInverseDisplacementFieldImageFilter<TInputImage, TOutputImage>
+::ClampedEvaluate( const TInterpolator * interpolator,
+  const TImage * image, const typename TImage::PointType & point ) const
+{
+  typedef typename TInterpolator::ContinuousIndexType ContinuousIndexType;
+
+  ContinuousIndexType cindex;
+  image->TransformPhysicalPointToContinuousIndex( point, cindex );
+  const typename TImage::RegionType & region = image->GetBufferedRegion();
+  for( unsigned int i = 0; i < ImageDimension; ++i )
+  {
+    const double first = region.GetIndex()[ i ];
+    const double last = first + region.GetSize()[ i ] - 1;
+    cindex[ i ] = std::min( std::max( static_cast<double>( cindex[ i ] ), first ), last );
+  }
+
+  return interpolator->EvaluateAtContinuousIndex( cindex );
+
+} // end ClampedEvaluate()
+
+
+/**
+ * ******************* ThreadedGenerateData *******************
+ */
+
+template <typename TInputImage, typename TOutputImage>
+void
+FixedPointInverseDisplacementFieldImageFilter<TInputImage, TOutputImage>
+::ThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  typedef ImageRegionIteratorWithIndex<OutputImageType>   OutputIteratorType;
+  typedef ImageRegionIterator<ResidualImageType>          ResidualIteratorType;
+  typedef typename InputInterpolatorType::OutputType      VectorType;
+  typedef typename OutputImageType::PointType             PointType;
+
+  OutputImageType * output = this->GetOutput();
+  ResidualImageType * residual = this->GetResidualOutput();
+  const InputImageType * input = this->m_InputInterpolator->GetInputImage();
+  const double tolerance = this->m_Tolerance;
+
+  ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+
+  OutputIteratorType outIt( output, outputRegionForThread );
+  ResidualIteratorType resIt( residual, outputRegionForThread );
+  for( outIt.GoToBegin(), resIt.GoToBegin(); !outIt.IsAtEnd(); ++outIt, ++resIt )
+  {
+    PointType x;
+    output->TransformIndexToPhysicalPoint( outIt.GetIndex(), x );
+
+    /** The initial inverse. */
+    VectorType v;
+    v.Fill( 0.0 );
+    if( this->m_InitialInverse.IsNotNull() )
+    {
+      v = this->ClampedEvaluate( this->m_InitialInterpolator.GetPointer(),
+        this->m_InitialInverse.GetPointer(), x );
+    }
+
+    /** Iterate v <- -u( x + v ), keeping the best iterate. */
+    VectorType best = v;
+    double bestError = std::numeric_limits<double>::max();
+    for( unsigned int iteration = 0; ; ++iteration )
+    {
+      PointType p = x;
+      for( unsigned int i = 0; i < ImageDimension; ++i ) p[ i ] += v[ i ];
+      const VectorType u = this->ClampedEvaluate(
+        this->m_InputInterpolator.GetPointer(), input, p );
+
+      double error = 0.0;
+      for( unsigned int i = 0; i < ImageDimension; ++i )
+      {
+        error += ( v[ i ] + u[ i ] ) * ( v[ i ] + u[ i ] );
+      }
+      error = vcl_sqrt( error );
+      if( error < bestError )
+      {
+        bestError = error;
+        best = v;
+      }
+
+      if( error <= tolerance || iteration == this->m_NumberOfIterations ) break;
+      v = -u;
+    }
+
+    OutputPixelType & out = outIt.Value();
+    for( unsigned int i = 0; i < ImageDimension; ++i )
+    {
+      out[ i ] = static_cast<OutputValueType>( best[ i ] );
+    }
+    resIt.Set( static_cast<OutputValueType>( bestError ) );
+
+    progress.CompletedPixel();
+  }
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * ******************* AfterThreadedGenerateData *******************
+ */
+
+template <typename TInputImage, typename TOutputImage>
+void
+FixedPointInverseDisplacementFieldImageFilter<TInputImage, TOutputImage>
+::AfterThreadedGenerateData( void )
+{
+  this->m_InputInterpolator = 0;
+
+} // end AfterThreadedGenerateData()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template <typename TInputImage, typename TOutputImage>
+void
+FixedPointInverseDisplacementFieldImageFilter<TInputImage, TOutputImage>
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "NumberOfIterations: " << this->m_NumberOfIterations << std::endl;
+  os << indent << "Tolerance: " << this->m_Tolerance << std::endl;
+  os << indent << "NumberOfLevels: " << this->m_NumberOfLevels << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef _itkFixedPointInverseDisplacementFieldImageFilter_txx_
@@ -20,6 +20,8 @@
 
 #include <string>
 
+#include "ITKToolsTiming.h"
+
 #include "itkImage.h"
 #include "itkExceptionObject.h"
 #include "itkImageFileReader.h"
@@ -146,24 +148,28 @@ void DistanceTransform(
   {
     distance_Maurer->Update();
     writer->SetInput( distance_Maurer->GetOutput() );
+    itktools::AddTimingObservers( writer );
     writer->Update();
   }
   else if( method == "Danielsson" )
   {
     distance_Danielsson->Update();
     writer->SetInput( distance_Danielsson->GetOutput() );
+    itktools::AddTimingObservers( writer );
     writer->Update();
   }
   else if( method == "Morphological" )
   {
     distance_Morphological->Update();
     writer->SetInput( distance_Morphological->GetOutput() );
+    itktools::AddTimingObservers( writer );
     writer->Update();
   }
   else if( method == "MorphologicalSigned" )
   {
     distance_MorphologicalSigned->Update();
     writer->SetInput( distance_MorphologicalSigned->GetOutput() );
+    itktools::AddTimingObservers( writer );
     writer->Update();
   }
 
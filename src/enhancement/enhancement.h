@@ -19,6 +19,7 @@
 #define __enhancement_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 //
 #include "itkImage.h"
@@ -158,6 +159,7 @@ public:
     /** Read the input image. */
     typename ReaderType::Pointer reader = ReaderType::New();
     reader->SetFileName( this->m_InputFileName.c_str() );
+    itktools::ReuseImageIO( reader, this->m_InputFileName );
 
     /** Setup the multi-scale filter. */
     typename MultiScaleFilterType::Pointer multiScaleFilter
@@ -274,6 +276,7 @@ public:
     typename WriterType::Pointer writer = WriterType::New();
     writer->SetInput( multiScaleFilter->GetOutput() );
     writer->SetFileName( this->m_OutputFileNames[ 0 ] );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
     /** Write the maximumn scale response. */
@@ -281,6 +284,7 @@ public:
     {
       writer->SetInput( multiScaleFilter->GetOutput( 1 ) );
       writer->SetFileName( this->m_OutputFileNames[ 1 ] );
+      itktools::AddTimingObservers( writer );
       writer->Update();
     }
 
@@ -19,6 +19,7 @@
 #define __extracteveryotherslice_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImageSliceConstIteratorWithIndex.h"
 #include "itkImageSliceIteratorWithIndex.h"
@@ -92,6 +93,7 @@ public:
     /** Read in the inputImage. */
     typename ReaderType::Pointer reader = ReaderType::New();
     reader->SetFileName( this->m_InputFileName.c_str() );
+    itktools::ReuseImageIO( reader, this->m_InputFileName );
     reader->Update();
 
     /** Define size of output image. */
@@ -178,6 +180,7 @@ public:
     typename WriterType::Pointer writer = WriterType::New();
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetInput( outputImage );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
@@ -41,8 +41,12 @@ std::string GetHelpString( void )
     << "Usage:\n"
     << "pxextractindexfromvectorimage\n"
     << "  -in      inputFilename\n"
-    << "  [-out]   outputFilename, default in + INDEXEXTRACTED.mhd\n"
+    << "  [-out]   outputFilename(s), default in + INDEXEXTRACTED.mhd\n"
+    << "           one file: all indices in one vector image\n"
+    << "           one file per index: every index in a scalar image\n"
     << "  -ind     one or more valid indices\n"
+    << "Only the selected components are kept; streamable inputs, such as\n"
+    << "raw MetaImage files, are read in slabs.\n"
     << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, (unsigned) int,\n"
     << "long, float, double.";
   return ss.str();
@@ -76,13 +80,20 @@ int main( int argc, char ** argv )
   std::string inputFileName = "";
   parser->GetCommandLineArgument( "-in", inputFileName );
 
-  std::string outputFileName = inputFileName.substr( 0, inputFileName.rfind( "." ) );
-  outputFileName += "INDEXEXTRACTED.mhd";
-  parser->GetCommandLineArgument( "-out", outputFileName );
+  std::vector<std::string> outputFileNames( 1,
+    inputFileName.substr( 0, inputFileName.rfind( "." ) ) + "INDEXEXTRACTED.mhd" );
+  parser->GetCommandLineArgument( "-out", outputFileNames );
 
   std::vector<unsigned int> indices;
   parser->GetCommandLineArgument( "-ind", indices );
 
+  /** Check the number of outputs. */
+  if( outputFileNames.size() != 1 && outputFileNames.size() != indices.size() )
+  {
+    std::cerr << "ERROR: Give one output file, or one output file per index." << std::endl;
+    return EXIT_FAILURE;
+  }
+
   /** Determine image properties. */
   itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
   itk::ImageIOBase::IOComponentType componentType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
@@ -148,7 +159,7 @@ int main( int argc, char ** argv )
 
     /** Set the filter arguments. */
     filter->m_InputFileName = inputFileName;
-    filter->m_OutputFileName = outputFileName;
+    filter->m_OutputFileNames = outputFileNames;
     filter->m_Indices = indices;
 
     filter->Run();
@@ -19,15 +19,20 @@
 #define __extractindexfromvectorimage_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsHelpers.h"
+#include "ITKToolsExecutionOptions.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImageFileReader.h"
-#include "itkComposeImageFilter.h"
 #include "itkImageFileWriter.h"
-#include "itkVectorIndexSelectionCastImageFilter.h"
+#include "itkMultiThreader.h"
 
 #include "itkImage.h"
 #include "itkVectorImage.h"
-#include "itkVector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 
 /** \class ITKToolsExtractIndexBase
@@ -43,14 +48,13 @@ public:
   ITKToolsExtractIndexBase()
   {
     this->m_InputFileName = "";
-    this->m_OutputFileName = "";
   };
   /** Destructor. */
   ~ITKToolsExtractIndexBase(){};
 
   /** Input member parameters. */
   std::string m_InputFileName;
-  std::string m_OutputFileName;
+  std::vector<std::string> m_OutputFileNames;
   std::vector<unsigned int> m_Indices;
 
 }; // end class ITKToolsExtractIndexBase
@@ -60,6 +64,16 @@ public:
  *
  * Templated class that implements the Run() function
  * and the New() function for its creation.
+ *
+ * The input is read with its ImageIO in slabs along the last dimension,
+ * when the ImageIO can stream, such as for uncompressed MetaImage files.
+ * The requested components of every slab are then de-interleaved by all
+ * threads, straight into the outputs. So the full vector image is never
+ * held in memory, only the selected components and one slab.
+ *
+ * With one output file all indices are written as one vector image;
+ * with one output file per index every index is written as a scalar
+ * image, all from the same pass over the input.
  */
 
 template< unsigned int VDimension, class TComponentType >
@@ -80,42 +94,163 @@ public:
     typedef itk::VectorImage< TComponentType, VDimension >  VectorImageType;
     typedef itk::Image< TComponentType, VDimension >        ScalarImageType;
     typedef itk::ImageFileReader< VectorImageType >         ImageReaderType;
-    typedef itk::VectorIndexSelectionCastImageFilter<
-      VectorImageType, ScalarImageType >                    IndexExtractorType;
-    typedef itk::ImageFileWriter< VectorImageType >         ImageWriterType;
+    typedef itk::ImageFileWriter< VectorImageType >         VectorWriterType;
+    typedef itk::ImageFileWriter< ScalarImageType >         ScalarWriterType;
+    typedef typename VectorImageType::RegionType            RegionType;
 
-    /** Read input image. */
+    /** Read the input image information. */
     typename ImageReaderType::Pointer reader = ImageReaderType::New();
     reader->SetFileName( this->m_InputFileName );
-    reader->Update();
+    itktools::ReuseImageIO( reader, this->m_InputFileName );
+    reader->UpdateOutputInformation();
+    const VectorImageType * input = reader->GetOutput();
+    itk::ImageIOBase * imageIO = reader->GetImageIO();
+    const RegionType region = input->GetLargestPossibleRegion();
+    const unsigned int numberOfComponents = imageIO->GetNumberOfComponents();
+    const unsigned int numberOfIndices = this->m_Indices.size();
+    const bool separate = this->m_OutputFileNames.size() > 1;
 
-    /** Extract indices. */
+    /** Allocate the outputs. */
+    typename VectorImageType::Pointer vectorOutput;
+    std::vector<typename ScalarImageType::Pointer> scalarOutputs;
+    DeinterleaveStruct str;
+    str.NumberOfComponents = numberOfComponents;
+    str.Indices = this->m_Indices;
+    if( separate )
+    {
+      for( unsigned int i = 0; i < numberOfIndices; ++i )
+      {
+        typename ScalarImageType::Pointer output = ScalarImageType::New();
+        output->CopyInformation( input );
+        output->SetRegions( region );
+        output->Allocate();
+        scalarOutputs.push_back( output );
+        str.Outputs.push_back( output->GetBufferPointer() );
+        str.OutputStrides.push_back( 1 );
+      }
+    }
+    else
+    {
+      vectorOutput = VectorImageType::New();
+      vectorOutput->CopyInformation( input );
+      vectorOutput->SetNumberOfComponentsPerPixel( numberOfIndices );
+      vectorOutput->SetRegions( region );
+      vectorOutput->Allocate();
+      for( unsigned int i = 0; i < numberOfIndices; ++i )
+      {
+        str.Outputs.push_back( vectorOutput->GetBufferPointer() + i );
+        str.OutputStrides.push_back( numberOfIndices );
+      }
+    }
 
-    // Create the assembler
-    typedef itk::ComposeImageFilter<ScalarImageType> ImageToVectorImageFilterType;
-    typename ImageToVectorImageFilterType::Pointer imageToVectorImageFilter = ImageToVectorImageFilterType::New();
+    /** Determine the slabs, of at most 64 MB or within -maxmem. */
+    const unsigned int lastDim = VDimension - 1;
+    const std::size_t lines = region.GetSize()[ lastDim ];
+    const std::size_t pixelsPerLine = region.GetNumberOfPixels() / std::max<std::size_t>( lines, 1 );
+    const double bytes = static_cast<double>( region.GetNumberOfPixels() )
+      * numberOfComponents * sizeof( TComponentType );
+    std::size_t numberOfSlabs = std::max<std::size_t>(
+      itktools::GetNumberOfStreamDivisions( bytes ),
+      static_cast<std::size_t>( std::ceil( bytes / ( 64.0 * 1024.0 * 1024.0 ) ) ) );
+    if( !imageIO->CanStreamRead() ) numberOfSlabs = 1;
+    numberOfSlabs = std::min( std::max<std::size_t>( numberOfSlabs, 1 ), std::max<std::size_t>( lines, 1 ) );
+    const std::size_t linesPerSlab = ( lines + numberOfSlabs - 1 ) / numberOfSlabs;
+    imageIO->SetUseStreamedReading( imageIO->CanStreamRead() );
 
-    for( unsigned int i = 0; i < this->m_Indices.size(); ++i )
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetNumberOfThreads( itk::MultiThreader::GetGlobalDefaultNumberOfThreads() );
+    threader->SetSingleMethod( DeinterleaveThreaderCallback, &str );
+
+    /** Read the slabs and de-interleave them. */
+    std::vector<TComponentType> buffer;
+    for( std::size_t first = 0; first < lines; first += linesPerSlab )
     {
-      typename IndexExtractorType::Pointer extractor = IndexExtractorType::New();
-      extractor->SetInput( reader->GetOutput() );
-      extractor->SetIndex( this->m_Indices[ i ] );
-      extractor->Update();
-      //extractor->DisconnectPipeline();
+      const std::size_t slabLines = std::min( linesPerSlab, lines - first );
+      itk::ImageIORegion ioRegion( VDimension );
+      for( unsigned int d = 0; d < VDimension; ++d )
+      {
+        ioRegion.SetIndex( d, 0 );
+        ioRegion.SetSize( d, region.GetSize()[ d ] );
+      }
+      ioRegion.SetIndex( lastDim, first );
+      ioRegion.SetSize( lastDim, slabLines );
+      imageIO->SetIORegion( ioRegion );
 
-      imageToVectorImageFilter->SetInput( i, extractor->GetOutput() );
-    }
+      str.NumberOfPixels = slabLines * pixelsPerLine;
+      buffer.resize( str.NumberOfPixels * numberOfComponents );
+      imageIO->Read( &buffer[ 0 ] );
 
-    imageToVectorImageFilter->Update();
+      str.Input = &buffer[ 0 ];
+      str.FirstPixel = first * pixelsPerLine;
+      threader->SingleMethodExecute();
+    }
 
-    /** Write output image. */
-    typename ImageWriterType::Pointer writer = ImageWriterType::New();
-    writer->SetFileName( this->m_OutputFileName );
-    writer->SetInput( imageToVectorImageFilter->GetOutput() );
-    writer->Update();
+    /** Write output images. */
+    if( separate )
+    {
+      for( unsigned int i = 0; i < numberOfIndices; ++i )
+      {
+        typename ScalarWriterType::Pointer writer = ScalarWriterType::New();
+        writer->SetFileName( this->m_OutputFileNames[ i ] );
+        writer->SetInput( scalarOutputs[ i ] );
+        itktools::AddTimingObservers( writer );
+        writer->Update();
+      }
+    }
+    else
+    {
+      typename VectorWriterType::Pointer writer = VectorWriterType::New();
+      writer->SetFileName( this->m_OutputFileNames[ 0 ] );
+      writer->SetInput( vectorOutput );
+      itktools::AddTimingObservers( writer );
+      writer->Update();
+    }
 
   } // end Run()
 
+protected:
+
+  /** The data shared by the de-interleaving threads. Component
+   * Indices[ i ] of pixel p of the slab goes to
+   * Outputs[ i ][ ( FirstPixel + p ) * OutputStrides[ i ] ].
+   */
+  struct DeinterleaveStruct
+  {
+    const TComponentType *          Input;
+    unsigned int                    NumberOfComponents;
+    std::size_t                     NumberOfPixels;
+    std::size_t                     FirstPixel;
+    std::vector<unsigned int>       Indices;
+    std::vector<TComponentType *>   Outputs;
+    std::vector<std::size_t>        OutputStrides;
+  };
+
+
+  /** De-interleave an equal part of the pixels of the slab. */
+  static ITK_THREAD_RETURN_TYPE DeinterleaveThreaderCallback( void * arg )
+  {
+    itk::MultiThreader::ThreadInfoStruct * info
+      = static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+    const DeinterleaveStruct * str = static_cast<DeinterleaveStruct *>( info->UserData );
+
+    const std::size_t begin = str->NumberOfPixels * info->ThreadID / info->NumberOfThreads;
+    const std::size_t end = str->NumberOfPixels * ( info->ThreadID + 1 ) / info->NumberOfThreads;
+    const unsigned int n = str->NumberOfComponents;
+    for( unsigned int i = 0; i < str->Indices.size(); ++i )
+    {
+      const TComponentType * in = str->Input + str->Indices[ i ];
+      const std::size_t stride = str->OutputStrides[ i ];
+      TComponentType * out = str->Outputs[ i ] + ( str->FirstPixel + begin ) * stride;
+      for( std::size_t p = begin; p < end; ++p, out += stride )
+      {
+        *out = in[ p * n ];
+      }
+    }
+
+    return ITK_THREAD_RETURN_VALUE;
+
+  } // end DeinterleaveThreaderCallback()
+
 }; // end class ITKToolsExtractIndex
 
 
@@ -19,6 +19,7 @@
 #define __extractslice_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImageFileReader.h"
 #include "itkExtractImageFilter.h"
@@ -94,7 +95,14 @@ public:
     /** Create reader. */
     typename ImageReaderType::Pointer reader = ImageReaderType::New();
     reader->SetFileName( this->m_InputFileName.c_str() );
-    reader->Update();
+    itktools::ReuseImageIO( reader, this->m_InputFileName );
+
+    /** Read only the header here. The extractor requests just the slice,
+     * which formats that support streamed reading, e.g. uncompressed mhd
+     * and mha, raw and Mevis DICOM/TIFF, read directly from the file.
+     */
+    reader->UseStreamingOn();
+    reader->UpdateOutputInformation();
 
     /** Create extractor. */
     typename ExtractFilterType::Pointer extractor = ExtractFilterType::New();
@@ -124,6 +132,7 @@ public:
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetInput( extractor->GetOutput() );
     writer->SetUseCompression( this->m_UseCompression );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
@@ -26,19 +26,19 @@
 #include <itksys/SystemTools.hxx>
 #include "ITKToolsImageProperties.h"
 #include "ITKToolsHelpers.h"
+#include "ITKToolsExecutionOptions.h"
+#include "ITKToolsTiming.h"
 
-//#include "itkFFTWRealToComplexConjugateImageFilter.h"
-#include "itkFFTWForwardFFTImageFilter.h"
-//#include "itkFFTWComplexConjugateToRealImageFilter.h"
-#include "itkFFTWInverseFFTImageFilter.h"
-#include "itkComplexToRealImageFilter.h"
-#include "itkComplexToImaginaryImageFilter.h"
-//#include "itkComposeComplexImageFilter.h"
-#include "itkComposeImageFilter.h"
-
+#include "itkImage.h"
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 
+#include "fftw3.h"
+
+#include <complex>
+#include <algorithm>
+#include <cctype>
+
 //-------------------------------------------------------------------------------------
 
 
@@ -52,21 +52,29 @@ std::string GetHelpString( void )
   << "Usage:" << std::endl
   << "pxfftimage" << std::endl
   << "  -in      inputFilenames" << std::endl
-  << "             forward: only one input" << std::endl
+  << "             forward: one or more images of the same size" << std::endl
   << "             backward, # given:" << std::endl
   << "               1: a complex image" << std::endl
   << "               2: a real and imaginary part" << std::endl
   << "  -op      operator, {forward, backward} FFT" << std::endl
   << "  [-out]   outputFilenames" << std::endl
-  << "             forward, # given:" << std::endl
+  << "             forward, without -parts, # given per input:" << std::endl
   << "               1: write the complex image, default in + Complex.mhd" << std::endl
   << "               2: write the real and imaginary images, default in + Real.mhd and in + Imaginary.mhd" << std::endl
   << "               3: write the complex, real and imaginary images" << std::endl
+  << "             forward, with -parts: one per part per input, default in + Part.mhd" << std::endl
   << "             backward: only one output, default in + IFFT" << std::endl
+  << "  [-parts] the parts of the forward FFT to write" << std::endl
+  << "             choose one or more from {complex, real, imaginary, magnitude}" << std::endl
   << "  [-opct]  the output type" << std::endl
   << "             choose from {float, double}, default float" << std::endl
-//  << "  [-xdim]  the backward transform needs to know if the actual x-dimension was odd or even." << std::endl
-//  << "             choose from {odd, even}, default even" << std::endl
+  << "  [-plan]  the FFTW planning effort" << std::endl
+  << "             choose from {estimate, measure, patient, exhaustive}," << std::endl
+  << "             default estimate, or measure when -wisdom is given" << std::endl
+  << "  [-wisdom] a file to cache FFTW plans in, read at start and updated at the end;" << std::endl
+  << "             the plans are kept in wisdom + .float and wisdom + .double" << std::endl
+  << "The FFTs use the number of threads of -threads. With -deterministic" << std::endl
+  << "the plan effort is always estimate, so that the results do not depend on timings." << std::endl
   << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, (unsigned) int, (unsigned) long, float, double.";
 
   return ss.str();
@@ -74,17 +82,268 @@ std::string GetHelpString( void )
 } // end GetHelpString()
 
 
+//-------------------------------------------------------------------------------------
+
+/** FFTWTraits: the single and double precision FFTW interfaces. */
+template< class T > struct FFTWTraits;
+
+template<> struct FFTWTraits< float >
+{
+  typedef fftwf_plan      PlanType;
+  typedef fftwf_complex   ComplexType;
+  static const char * GetName( void ) { return "float"; }
+  static int InitThreads( void ) { return fftwf_init_threads(); }
+  static void PlanWithNThreads( int n ) { fftwf_plan_with_nthreads( n ); }
+  static int ImportWisdom( const char * f ) { return fftwf_import_wisdom_from_filename( f ); }
+  static int ExportWisdom( const char * f ) { return fftwf_export_wisdom_to_filename( f ); }
+  static PlanType PlanR2C( int rank, const int * n, float * in, ComplexType * out, unsigned flags )
+  { return fftwf_plan_dft_r2c( rank, n, in, out, flags ); }
+  static PlanType PlanC2R( int rank, const int * n, ComplexType * in, float * out, unsigned flags )
+  { return fftwf_plan_dft_c2r( rank, n, in, out, flags ); }
+  static void Execute( PlanType p ) { fftwf_execute( p ); }
+  static void DestroyPlan( PlanType p ) { fftwf_destroy_plan( p ); }
+  static void * Malloc( std::size_t n ) { return fftwf_malloc( n ); }
+  static void Free( void * p ) { fftwf_free( p ); }
+};
+
+template<> struct FFTWTraits< double >
+{
+  typedef fftw_plan       PlanType;
+  typedef fftw_complex    ComplexType;
+  static const char * GetName( void ) { return "double"; }
+  static int InitThreads( void ) { return fftw_init_threads(); }
+  static void PlanWithNThreads( int n ) { fftw_plan_with_nthreads( n ); }
+  static int ImportWisdom( const char * f ) { return fftw_import_wisdom_from_filename( f ); }
+  static int ExportWisdom( const char * f ) { return fftw_export_wisdom_to_filename( f ); }
+  static PlanType PlanR2C( int rank, const int * n, double * in, ComplexType * out, unsigned flags )
+  { return fftw_plan_dft_r2c( rank, n, in, out, flags ); }
+  static PlanType PlanC2R( int rank, const int * n, ComplexType * in, double * out, unsigned flags )
+  { return fftw_plan_dft_c2r( rank, n, in, out, flags ); }
+  static void Execute( PlanType p ) { fftw_execute( p ); }
+  static void DestroyPlan( PlanType p ) { fftw_destroy_plan( p ); }
+  static void * Malloc( std::size_t n ) { return fftw_malloc( n ); }
+  static void Free( void * p ) { fftw_free( p ); }
+};
+
+
+/** HalfSpectrumPlan: an FFTW plan between a real image and the half of its
+ * spectrum, with its buffers. The first image dimension is the halved one:
+ * FFTW arrays are row-major, so the sizes are passed in reverse order.
+ */
+template< class TPixel, unsigned int VDimension >
+class HalfSpectrumPlan
+{
+public:
+  typedef FFTWTraits< TPixel >                  TraitsType;
+  typedef typename TraitsType::ComplexType      FFTWComplexType;
+  typedef itk::Size< VDimension >               SizeType;
+
+  HalfSpectrumPlan( const SizeType & size, const bool forward, const unsigned int flags )
+  {
+    this->m_Size = size;
+    this->m_HalfWidth = size[ 0 ] / 2 + 1;
+    this->m_NumberOfLines = 1;
+    int n[ VDimension ];
+    for( unsigned int i = 0; i < VDimension; ++i )
+    {
+      n[ i ] = static_cast<int>( size[ VDimension - 1 - i ] );
+      if( i > 0 ) this->m_NumberOfLines *= size[ i ];
+    }
+
+    this->m_Real = static_cast<TPixel *>( TraitsType::Malloc(
+      this->m_NumberOfLines * size[ 0 ] * sizeof( TPixel ) ) );
+    this->m_Half = static_cast<FFTWComplexType *>( TraitsType::Malloc(
+      this->m_NumberOfLines * this->m_HalfWidth * sizeof( FFTWComplexType ) ) );
+
+    /** Planning overwrites the buffers, so they are filled afterwards. */
+    TraitsType::PlanWithNThreads( itktools::GetExecutionOptions().NumberOfThreads );
+    this->m_Plan = forward
+      ? TraitsType::PlanR2C( VDimension, n, this->m_Real, this->m_Half, flags )
+      : TraitsType::PlanC2R( VDimension, n, this->m_Half, this->m_Real, flags );
+  }
+
+  ~HalfSpectrumPlan()
+  {
+    TraitsType::DestroyPlan( this->m_Plan );
+    TraitsType::Free( this->m_Real );
+    TraitsType::Free( this->m_Half );
+  }
+
+  void Execute( void ) { TraitsType::Execute( this->m_Plan ); }
+
+  const SizeType & GetSize( void ) const { return this->m_Size; }
+  std::size_t GetHalfWidth( void ) const { return this->m_HalfWidth; }
+  std::size_t GetNumberOfLines( void ) const { return this->m_NumberOfLines; }
+  TPixel * GetReal( void ) { return this->m_Real; }
+  std::complex< TPixel > * GetHalf( void )
+  {
+    return reinterpret_cast< std::complex< TPixel > * >( this->m_Half );
+  }
+
+  /** The line of the half spectrum that holds the conjugates of line l:
+   * every index except the first is mirrored, i -> ( n - i ) mod n.
+   */
+  std::size_t GetMirroredLine( std::size_t l ) const
+  {
+    std::size_t mirrored = 0;
+    std::size_t stride = 1;
+    for( unsigned int i = 1; i < VDimension; ++i )
+    {
+      const std::size_t index = l % this->m_Size[ i ];
+      l /= this->m_Size[ i ];
+      mirrored += ( ( this->m_Size[ i ] - index ) % this->m_Size[ i ] ) * stride;
+      stride *= this->m_Size[ i ];
+    }
+    return mirrored;
+  }
+
+private:
+  HalfSpectrumPlan( const HalfSpectrumPlan & ); // purposely not implemented
+  void operator=( const HalfSpectrumPlan & );   // purposely not implemented
+
+  SizeType                      m_Size;
+  std::size_t                   m_HalfWidth;
+  std::size_t                   m_NumberOfLines;
+  TPixel *                      m_Real;
+  FFTWComplexType *             m_Half;
+  typename TraitsType::PlanType m_Plan;
+};
+
+
+/** Functors from a complex value to an output pixel. */
+template< class TPixel > struct ComplexPart
+{
+  std::complex< TPixel > operator()( const std::complex< TPixel > & c ) const { return c; }
+};
+template< class TPixel > struct RealPart
+{
+  TPixel operator()( const std::complex< TPixel > & c ) const { return c.real(); }
+};
+template< class TPixel > struct ImaginaryPart
+{
+  TPixel operator()( const std::complex< TPixel > & c ) const { return c.imag(); }
+};
+template< class TPixel > struct MagnitudePart
+{
+  TPixel operator()( const std::complex< TPixel > & c ) const { return std::abs( c ); }
+};
+
+
+/** Expand the half spectrum of a plan to a full size image, with a part
+ * of every value. The missing half follows from the conjugate symmetry of
+ * the spectrum of a real image: F( -k ) = conj( F( k ) ).
+ */
+template< class TPixel, unsigned int VDimension, class TOutputPixel, class TFunctor >
+void WriteFullSpectrumPart( HalfSpectrumPlan< TPixel, VDimension > & plan,
+  const itk::ImageBase< VDimension > * inputImage,
+  const std::string & outputFileName, const TFunctor & part )
+{
+  typedef itk::Image< TOutputPixel, VDimension >    OutputImageType;
+  typedef itk::ImageFileWriter< OutputImageType >   WriterType;
+
+  typename OutputImageType::Pointer output = OutputImageType::New();
+  output->CopyInformation( inputImage );
+  output->SetRegions( inputImage->GetLargestPossibleRegion() );
+  output->Allocate();
+
+  const std::complex< TPixel > * half = plan.GetHalf();
+  const std::size_t width = plan.GetSize()[ 0 ];
+  const std::size_t halfWidth = plan.GetHalfWidth();
+  TOutputPixel * out = output->GetBufferPointer();
+  for( std::size_t l = 0; l < plan.GetNumberOfLines(); ++l )
+  {
+    const std::complex< TPixel > * line = half + l * halfWidth;
+    const std::complex< TPixel > * mirrored = half + plan.GetMirroredLine( l ) * halfWidth;
+    TOutputPixel * outLine = out + l * width;
+    for( std::size_t x = 0; x < halfWidth; ++x )
+    {
+      outLine[ x ] = part( line[ x ] );
+    }
+    for( std::size_t x = halfWidth; x < width; ++x )
+    {
+      outLine[ x ] = part( std::conj( mirrored[ width - x ] ) );
+    }
+  }
+
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName( outputFileName.c_str() );
+  writer->SetInput( output );
+  itktools::AddTimingObservers( writer );
+  writer->Update();
+
+} // end WriteFullSpectrumPart()
+
+
+/** The wisdom of single and double precision FFTW can not be stored in
+ * one file.
+ */
+template< class TPixel >
+std::string GetWisdomFileName( const std::string & wisdomFileName )
+{
+  return wisdomFileName + "." + FFTWTraits< TPixel >::GetName();
+
+} // end GetWisdomFileName()
+
+
+/** Set up FFTW: threads and the wisdom file. Returns the planner flags. */
+template< class TPixel >
+unsigned int SetUpFFTW( const std::string & planEffort, const std::string & wisdomFileName )
+{
+  static bool threadsInitialized = false;
+  if( !threadsInitialized )
+  {
+    FFTWTraits< TPixel >::InitThreads();
+    threadsInitialized = true;
+  }
+
+  const std::string fileName = GetWisdomFileName< TPixel >( wisdomFileName );
+  if( wisdomFileName != "" && itksys::SystemTools::FileExists( fileName.c_str() ) )
+  {
+    if( !FFTWTraits< TPixel >::ImportWisdom( fileName.c_str() ) )
+    {
+      std::cerr << "WARNING: the wisdom in " << fileName
+        << " could not be read, it is ignored." << std::endl;
+    }
+  }
+
+  /** FFTW_ESTIMATE does not time the candidate plans, and therefore
+   * always chooses the same one.
+   */
+  if( itktools::GetExecutionOptions().Deterministic ) return FFTW_ESTIMATE;
+  if( planEffort == "measure" ) return FFTW_MEASURE;
+  if( planEffort == "patient" ) return FFTW_PATIENT;
+  if( planEffort == "exhaustive" ) return FFTW_EXHAUSTIVE;
+  return FFTW_ESTIMATE;
+
+} // end SetUpFFTW()
+
+
+/** Save the wisdom, including that of the plans just made. */
+template< class TPixel >
+void SaveFFTWWisdom( const std::string & wisdomFileName )
+{
+  if( wisdomFileName == "" ) return;
+  const std::string fileName = GetWisdomFileName< TPixel >( wisdomFileName );
+  if( !FFTWTraits< TPixel >::ExportWisdom( fileName.c_str() ) )
+  {
+    std::cerr << "WARNING: the wisdom could not be written to "
+      << fileName << "." << std::endl;
+  }
+
+} // end SaveFFTWWisdom()
+
+
 /** run: A macro to call a function. */
 #define run( type, dim ) \
 if ( componentType == #type && Dimension == dim ) \
 { \
   if ( op == "forward" ) \
   { \
-    FFTImage< type, dim >( inputFileNames[ 0 ], outputFileNames ); \
+    FFTImage< type, dim >( inputFileNames, outputFileNames, parts, planEffort, wisdomFileName ); \
   } \
   else \
   { \
-    IFFTImage< type, dim >( inputFileNames, outputFileNames[ 0 ] ); \
+    IFFTImage< type, dim >( inputFileNames, outputFileNames[ 0 ], planEffort, wisdomFileName ); \
   } \
 }
 
@@ -92,13 +351,18 @@ if ( componentType == #type && Dimension == dim ) \
 
 /* Declare FFTImage. */
 template< class PixelType, unsigned int Dimension >
-void FFTImage( const std::string & inputFileName,
-  const std::vector<std::string> & outputFileNames );
+void FFTImage( const std::vector<std::string> & inputFileNames,
+  const std::vector<std::string> & outputFileNames,
+  const std::vector<std::string> & parts,
+  const std::string & planEffort,
+  const std::string & wisdomFileName );
 
 /* Declare IFFTImage. */
 template< class PixelType, unsigned int Dimension >
 void IFFTImage( const std::vector<std::string> & inputFileNames,
-  const std::string & outputFileName );
+  const std::string & outputFileName,
+  const std::string & planEffort,
+  const std::string & wisdomFileName );
 
 /** Declare other functions. */
 std::string GetHelpString( void );
@@ -133,16 +397,22 @@ int main( int argc, char **argv )
   parser->GetCommandLineArgument( "-in", inputFileNames );
 
   std::vector<std::string>  outputFileNames;
-  bool retout = parser->GetCommandLineArgument( "-out", outputFileNames );
+  parser->GetCommandLineArgument( "-out", outputFileNames );
 
   std::string op = "";
   parser->GetCommandLineArgument( "-op", op );
 
+  std::vector<std::string>  parts;
+  bool retparts = parser->GetCommandLineArgument( "-parts", parts );
+
   std::string componentType = "float";
-  bool retopct = parser->GetCommandLineArgument( "-opct", componentType );
+  parser->GetCommandLineArgument( "-opct", componentType );
+
+  std::string wisdomFileName = "";
+  bool retwisdom = parser->GetCommandLineArgument( "-wisdom", wisdomFileName );
 
-  //std::string xdim = "even";
-  //bool retxdim = parser->GetCommandLineArgument( "-xdim", xdim );
+  std::string planEffort = retwisdom ? "measure" : "estimate";
+  parser->GetCommandLineArgument( "-plan", planEffort );
 
   /** Check operator. */
   op = itksys::SystemTools::LowerCase( op );
@@ -153,46 +423,83 @@ int main( int argc, char **argv )
     return 1;
   }
 
-  /** Check input. */
-  if ( op == "forward" && inputFileNames.size() > 1 )
+  /** Check the plan effort. */
+  planEffort = itksys::SystemTools::LowerCase( planEffort );
+  if ( planEffort != "estimate" && planEffort != "measure"
+    && planEffort != "patient" && planEffort != "exhaustive" )
   {
-    std::cerr << "ERROR: Only one input file is expected." << std::endl;
+    std::cerr << "ERROR: \"-plan\" should be one of {estimate, measure, patient, exhaustive}." << std::endl;
     return 1;
   }
+
+  /** Check input. */
   if ( op == "backward" && inputFileNames.size() > 2 )
   {
     std::cerr << "ERROR: Only one or two input files are expected." << std::endl;
     return 1;
   }
+  if ( op == "backward" && retparts )
+  {
+    std::cerr << "ERROR: \"-parts\" is only used for the forward FFT." << std::endl;
+    return 1;
+  }
 
-  /** Check xdim. 
-  if ( op == "backward" && retxdim )
+  /** Check the parts, or derive them from the number of outputs. */
+  const std::size_t numberOfInputs = inputFileNames.size();
+  if ( op == "forward" && retparts )
+  {
+    for ( std::size_t i = 0; i < parts.size(); ++i )
+    {
+      parts[ i ] = itksys::SystemTools::LowerCase( parts[ i ] );
+      if ( parts[ i ] != "complex" && parts[ i ] != "real"
+        && parts[ i ] != "imaginary" && parts[ i ] != "magnitude" )
+      {
+        std::cerr << "ERROR: \"-parts\" should be from {complex, real, imaginary, magnitude}." << std::endl;
+        return 1;
+      }
+    }
+  }
+  else if ( op == "forward" )
   {
-    if ( xdim != "odd" && xdim != "even" )
+    const std::size_t perInput = outputFileNames.size() / numberOfInputs;
+    if ( outputFileNames.size() != 0
+      && ( perInput * numberOfInputs != outputFileNames.size() || perInput > 3 ) )
     {
-      std::cerr << "ERROR: \"-xdim\" should be one of {odd, even}." << std::endl;
+      std::cerr << "ERROR: 1, 2 or 3 output files per input are expected." << std::endl;
       return 1;
     }
+    if ( perInput != 2 ) parts.push_back( "complex" );
+    if ( perInput != 1 )
+    {
+      parts.push_back( "real" );
+      parts.push_back( "imaginary" );
+    }
   }
-  */
 
   /** Check output names. */
-  if ( outputFileNames.size() == 0 )
+  if ( op == "forward" && outputFileNames.size() == 0 )
   {
-    std::string inputpart = inputFileNames[ 0 ].substr( 0, inputFileNames[ 0 ].rfind( "." ) );
-    if ( op == "forward" )
+    for ( std::size_t i = 0; i < numberOfInputs; ++i )
     {
-    outputFileNames.resize( 3 );
-      outputFileNames[ 0 ] = inputpart + "Complex.mhd";
-      outputFileNames[ 1 ] = inputpart + "Real.mhd";
-      outputFileNames[ 2 ] = inputpart + "Imaginary.mhd";
-    }
-    else if ( op == "backward" )
-    {
-    outputFileNames.resize( 1 );
-      outputFileNames[ 0 ] = inputpart + "IFFT.mhd";
+      std::string inputpart = inputFileNames[ i ].substr( 0, inputFileNames[ i ].rfind( "." ) );
+      for ( std::size_t j = 0; j < parts.size(); ++j )
+      {
+        std::string part = parts[ j ];
+        part[ 0 ] = toupper( part[ 0 ] );
+        outputFileNames.push_back( inputpart + part + ".mhd" );
+      }
     }
   }
+  else if ( op == "forward" && outputFileNames.size() != numberOfInputs * parts.size() )
+  {
+    std::cerr << "ERROR: One output file per part per input is expected." << std::endl;
+    return 1;
+  }
+  else if ( op == "backward" && outputFileNames.size() == 0 )
+  {
+    std::string inputpart = inputFileNames[ 0 ].substr( 0, inputFileNames[ 0 ].rfind( "." ) );
+    outputFileNames.push_back( inputpart + "IFFT.mhd" );
+  }
 
   /** Determine image properties. */
   std::string ComponentTypeIn = "short";
@@ -260,70 +567,83 @@ int main( int argc, char **argv )
    */
 
 template< class PixelType, unsigned int Dimension >
-void FFTImage( const std::string & inputFileName,
-  const std::vector<std::string> & outputFileNames )
+void FFTImage( const std::vector<std::string> & inputFileNames,
+  const std::vector<std::string> & outputFileNames,
+  const std::vector<std::string> & parts,
+  const std::string & planEffort,
+  const std::string & wisdomFileName )
 {
   /** Typedefs. */
   typedef itk::Image< PixelType, Dimension >        ImageType;
   typedef itk::ImageFileReader< ImageType >         ReaderType;
-  typedef itk::ImageFileWriter< ImageType >         WriterType;
-  typedef itk::FFTWForwardFFTImageFilter< 
-    ImageType >                                     FFTFilterType;
-  typedef typename FFTFilterType::OutputImageType   ComplexImageType;
-  typedef itk::ImageFileWriter< ComplexImageType >  ComplexWriterType;
-  typedef itk::ComplexToRealImageFilter<
-    ComplexImageType, ImageType >                   RealFilterType;
-  typedef itk::ComplexToImaginaryImageFilter<
-    ComplexImageType, ImageType >                   ImaginaryFilterType;
-
-  /** Read the image as float or double. */
-  typename ReaderType::Pointer reader = ReaderType::New();
-  reader->SetFileName( inputFileName.c_str() );
-
-  /** Compute the FFT of the image. */
-  typename FFTFilterType::Pointer fftFilter = FFTFilterType::New();
-  fftFilter->SetInput( reader->GetOutput() );
-  fftFilter->Update();
-
-  /** Write the output image(s).
-   * If 1 output image is given: write the complex image.
-   * If 2 output images are given: write the real and imaginary images.
-   * If 3 output images are given: write the complex, real and imaginary images.
-   */
-  if ( outputFileNames.size() == 1 || outputFileNames.size() == 3 )
-  {
-    typename ComplexWriterType::Pointer complexWriter = ComplexWriterType::New();
-    complexWriter->SetFileName( outputFileNames[ 0 ].c_str() );
-    complexWriter->SetInput( fftFilter->GetOutput() );
-    complexWriter->Update();
-  }
-  if ( outputFileNames.size() > 1 )
-  {
-    typename RealFilterType::Pointer realFilter = RealFilterType::New();
-    realFilter->SetInput( fftFilter->GetOutput() );
-
-    typename ImaginaryFilterType::Pointer imaginaryFilter = ImaginaryFilterType::New();
-    imaginaryFilter->SetInput( fftFilter->GetOutput() );
+  typedef std::complex< PixelType >                 ComplexPixelType;
+  typedef HalfSpectrumPlan< PixelType, Dimension >  PlanType;
 
-    typename WriterType::Pointer writer1 = WriterType::New();
-    typename WriterType::Pointer writer2 = WriterType::New();
+  const unsigned int flags = SetUpFFTW< PixelType >( planEffort, wisdomFileName );
 
-    if ( outputFileNames.size() == 2 )
-    {
-      writer1->SetFileName( outputFileNames[ 0 ].c_str() );
-      writer2->SetFileName( outputFileNames[ 1 ].c_str() );
-    }
-    else
+  /** The plan is made for the first image, and reused for the other
+   * images as long as they have the same size.
+   */
+  PlanType * plan = 0;
+  try
+  {
+    for ( std::size_t i = 0; i < inputFileNames.size(); ++i )
     {
-      writer1->SetFileName( outputFileNames[ 1 ].c_str() );
-      writer2->SetFileName( outputFileNames[ 2 ].c_str() );
+      /** Read the image as float or double. */
+      typename ReaderType::Pointer reader = ReaderType::New();
+      reader->SetFileName( inputFileNames[ i ].c_str() );
+      reader->Update();
+      const ImageType * input = reader->GetOutput();
+      const typename ImageType::SizeType size = input->GetLargestPossibleRegion().GetSize();
+
+      if ( !plan || plan->GetSize() != size )
+      {
+        delete plan;
+        plan = 0;
+        plan = new PlanType( size, true, flags );
+      }
+
+      /** Compute the half spectrum of the image. */
+      std::copy( input->GetBufferPointer(),
+        input->GetBufferPointer() + input->GetLargestPossibleRegion().GetNumberOfPixels(),
+        plan->GetReal() );
+      plan->Execute();
+
+      /** Write the requested parts, each straight from the half spectrum. */
+      for ( std::size_t j = 0; j < parts.size(); ++j )
+      {
+        const std::string & outputFileName = outputFileNames[ i * parts.size() + j ];
+        if ( parts[ j ] == "complex" )
+        {
+          WriteFullSpectrumPart< PixelType, Dimension, ComplexPixelType >(
+            *plan, input, outputFileName, ComplexPart< PixelType >() );
+        }
+        else if ( parts[ j ] == "real" )
+        {
+          WriteFullSpectrumPart< PixelType, Dimension, PixelType >(
+            *plan, input, outputFileName, RealPart< PixelType >() );
+        }
+        else if ( parts[ j ] == "imaginary" )
+        {
+          WriteFullSpectrumPart< PixelType, Dimension, PixelType >(
+            *plan, input, outputFileName, ImaginaryPart< PixelType >() );
+        }
+        else
+        {
+          WriteFullSpectrumPart< PixelType, Dimension, PixelType >(
+            *plan, input, outputFileName, MagnitudePart< PixelType >() );
+        }
+      }
     }
-    writer1->SetInput( realFilter->GetOutput() );
-    writer1->Update();
-
-    writer2->SetInput( imaginaryFilter->GetOutput() );
-    writer2->Update();
   }
+  catch( ... )
+  {
+    delete plan;
+    throw;
+  }
+  delete plan;
+
+  SaveFFTWWisdom< PixelType >( wisdomFileName );
 
 } // end FFTImage()
 
@@ -334,61 +654,95 @@ void FFTImage( const std::string & inputFileName,
 
 template< class PixelType, unsigned int Dimension >
 void IFFTImage( const std::vector<std::string> & inputFileNames,
-  const std::string & outputFileName )
+  const std::string & outputFileName,
+  const std::string & planEffort,
+  const std::string & wisdomFileName )
 {
   /** Typedefs. */
   typedef itk::Image< PixelType, Dimension >            ImageType;
-  typedef itk::Image< 
-    std::complex< PixelType >, Dimension >                ComplexImageType;
-  typedef itk::FFTWInverseFFTImageFilter<
-    ComplexImageType >                                  IFFTFilterType;
+  typedef std::complex< PixelType >                     ComplexPixelType;
+  typedef itk::Image< ComplexPixelType, Dimension >     ComplexImageType;
   typedef itk::ImageFileReader< ImageType >             ReaderType;
   typedef itk::ImageFileReader< ComplexImageType >      ComplexReaderType;
-  typedef itk::ComposeImageFilter<
-    ImageType, ComplexImageType>                        ComposeComplexImageFilterType;
   typedef itk::ImageFileWriter< ImageType >             WriterType;
+  typedef HalfSpectrumPlan< PixelType, Dimension >      PlanType;
 
-  /** The IFFT of the image. */
-  typename IFFTFilterType::Pointer ifftFilter = IFFTFilterType::New();
-
-  /** Read one complex image, or two scalar images, which need to
-   * be combined into one complex image. */
-  typename ComplexReaderType::Pointer complexReader
-    = ComplexReaderType::New();
+  /** Read one complex image, or two scalar images with the real and the
+   * imaginary part, which are combined directly into the half spectrum.
+   */
+  typename ComplexReaderType::Pointer complexReader = ComplexReaderType::New();
   typename ReaderType::Pointer reader1 = ReaderType::New();
   typename ReaderType::Pointer reader2 = ReaderType::New();
-  typename ComposeComplexImageFilterType::Pointer composer
-    = ComposeComplexImageFilterType::New();
+  const itk::ImageBase< Dimension > * input = 0;
   if ( inputFileNames.size() == 1 )
   {
     complexReader->SetFileName( inputFileNames[ 0 ].c_str() );
-    ifftFilter->SetInput( complexReader->GetOutput() );
+    complexReader->Update();
+    input = complexReader->GetOutput();
   }
-  else if  ( inputFileNames.size() == 2 )
+  else
   {
     reader1->SetFileName( inputFileNames[ 0 ].c_str() );
     reader2->SetFileName( inputFileNames[ 1 ].c_str() );
-    composer->SetInput( 0, reader1->GetOutput() );
-    composer->SetInput( 1, reader2->GetOutput() );
-    ifftFilter->SetInput( composer->GetOutput() );
+    reader1->Update();
+    reader2->Update();
+    input = reader1->GetOutput();
+    if ( reader2->GetOutput()->GetLargestPossibleRegion().GetSize()
+      != input->GetLargestPossibleRegion().GetSize() )
+    {
+      itkGenericExceptionMacro( << "The real and imaginary part differ in size." );
+    }
   }
+  const typename ImageType::SizeType size = input->GetLargestPossibleRegion().GetSize();
+
+  const unsigned int flags = SetUpFFTW< PixelType >( planEffort, wisdomFileName );
+  PlanType plan( size, false, flags );
 
-  /** Setup IFFT filter. 
-  if ( xdim == "odd" )
+  /** Copy the half spectrum; the other half is implied by symmetry. */
+  const std::size_t width = size[ 0 ];
+  const std::size_t halfWidth = plan.GetHalfWidth();
+  ComplexPixelType * half = plan.GetHalf();
+  for ( std::size_t l = 0; l < plan.GetNumberOfLines(); ++l )
   {
-    ifftFilter->SetActualXDimensionIsOdd( true );
+    if ( inputFileNames.size() == 1 )
+    {
+      const ComplexPixelType * line = complexReader->GetOutput()->GetBufferPointer() + l * width;
+      std::copy( line, line + halfWidth, half + l * halfWidth );
+    }
+    else
+    {
+      const PixelType * realLine = reader1->GetOutput()->GetBufferPointer() + l * width;
+      const PixelType * imaginaryLine = reader2->GetOutput()->GetBufferPointer() + l * width;
+      for ( std::size_t x = 0; x < halfWidth; ++x )
+      {
+        half[ l * halfWidth + x ] = ComplexPixelType( realLine[ x ], imaginaryLine[ x ] );
+      }
+    }
   }
-  else
+  plan.Execute();
+
+  /** FFTW does not normalize. */
+  typename ImageType::Pointer output = ImageType::New();
+  output->CopyInformation( input );
+  output->SetRegions( input->GetLargestPossibleRegion() );
+  output->Allocate();
+  const std::size_t numberOfPixels = plan.GetNumberOfLines() * width;
+  const PixelType scale = static_cast< PixelType >( 1.0 / numberOfPixels );
+  const PixelType * real = plan.GetReal();
+  PixelType * out = output->GetBufferPointer();
+  for ( std::size_t k = 0; k < numberOfPixels; ++k )
   {
-    ifftFilter->SetActualXDimensionIsOdd( false );
+    out[ k ] = real[ k ] * scale;
   }
-  */
 
   /** Write the output image. */
   typename WriterType::Pointer writer = WriterType::New();
   writer->SetFileName( outputFileName.c_str() );
-  writer->SetInput( ifftFilter->GetOutput() );
+  writer->SetInput( output );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
+  SaveFFTWWisdom< PixelType >( wisdomFileName );
+
 } // end IFFTImage()
 
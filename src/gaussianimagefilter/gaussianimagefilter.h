@@ -19,6 +19,7 @@
 #define __gaussianimagefilter_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImageFileReader.h"
 #include "itkSmoothingRecursiveGaussianImageFilter2.h"
@@ -195,6 +196,7 @@ ITKToolsGaussian< VDimension, TComponentType >
   /** Read in the input image. */
   typename ReaderType::Pointer reader = ReaderType::New();
   reader->SetFileName( this->m_InputFileName );
+  itktools::ReuseImageIO( reader, this->m_InputFileName );
 
   /** Setup the this->m_Order and this->m_Sigma. */
   OrderType orderFA;
@@ -217,6 +219,7 @@ ITKToolsGaussian< VDimension, TComponentType >
   typename WriterType::Pointer writer = WriterType::New();
   writer->SetFileName( this->m_OutputFileName );
   writer->SetInput( filter->GetOutput() );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end GaussianImageFilter()
@@ -251,6 +254,7 @@ ITKToolsGaussian< VDimension, TComponentType >
   /** Read in the input image. */
   typename ReaderType::Pointer reader = ReaderType::New();
   reader->SetFileName( this->m_InputFileName );
+  itktools::ReuseImageIO( reader, this->m_InputFileName );
 
   /** Setup the this->m_Order and this->m_Sigma. */
   OrderType orderFA;
@@ -277,6 +281,7 @@ ITKToolsGaussian< VDimension, TComponentType >
     smoothingFilter[ i ]->SetNormalizeAcrossScale( false );
     smoothingFilter[ i ]->SetSigma( sigmaFA );
     smoothingFilter[ i ]->SetOrder( order2 );
+    itktools::AddTimingObservers( smoothingFilter[ i ] );
     smoothingFilter[ i ]->Update();
 
     /** Setup composition filter. */
@@ -285,12 +290,14 @@ ITKToolsGaussian< VDimension, TComponentType >
 
   /** Compose vector image and compute magnitude. */
   magnitudeFilter->SetInput( composeFilter->GetOutput() );
+  itktools::AddTimingObservers( magnitudeFilter );
   magnitudeFilter->Update();
 
   /** Write image. */
   typename WriterType::Pointer writer = WriterType::New();
   writer->SetFileName( this->m_OutputFileName );
   writer->SetInput( magnitudeFilter->GetOutput() );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end GaussianImageFilterMagnitude()
@@ -322,6 +329,7 @@ ITKToolsGaussian< VDimension, TComponentType >
   /** Read in the input image. */
   typename ReaderType::Pointer reader = ReaderType::New();
   reader->SetFileName( this->m_InputFileName );
+  itktools::ReuseImageIO( reader, this->m_InputFileName );
 
   /** Setup this->m_Sigma. */
   SigmaType sigmaFA; sigmaFA.Fill( this->m_Sigma[ 0 ] );
@@ -344,6 +352,7 @@ ITKToolsGaussian< VDimension, TComponentType >
     smoothingFilter[ i ]->SetNormalizeAcrossScale( false );
     smoothingFilter[ i ]->SetSigma( sigmaFA );
     smoothingFilter[ i ]->SetOrder( order );
+    itktools::AddTimingObservers( smoothingFilter[ i ] );
     smoothingFilter[ i ]->Update();
   }
 
@@ -381,6 +390,7 @@ ITKToolsGaussian< VDimension, TComponentType >
   typename WriterType::Pointer writer = WriterType::New();
   writer->SetFileName( this->m_OutputFileName );
   writer->SetInput( outputImage );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end GaussianImageFilterLaplacian()
@@ -409,6 +419,7 @@ ITKToolsGaussian< VDimension, TComponentType >
   /** Read in the input image. */
   typename ReaderType::Pointer reader = ReaderType::New();
   reader->SetFileName( this->m_InputFileName );
+  itktools::ReuseImageIO( reader, this->m_InputFileName );
 
   /** Setup this->m_Sigma. */
   SigmaType sigmaFA; sigmaFA.Fill( this->m_Sigma[ 0 ] );
@@ -430,6 +441,7 @@ ITKToolsGaussian< VDimension, TComponentType >
   typename WriterType::Pointer writer = WriterType::New();
   writer->SetFileName( this->m_OutputFileName );
   writer->SetInput( invariantFilter->GetOutput() );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end GaussianImageFilterInvariants()
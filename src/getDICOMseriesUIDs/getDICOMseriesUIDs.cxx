@@ -23,9 +23,9 @@
 
 #include "itkCommandLineArgumentParser.h"
 #include "ITKToolsHelpers.h"
+#include "ITKToolsDICOMIndex.h"
 #include <iostream>
 #include <itksys/SystemTools.hxx>
-#include "itkGDCMSeriesFileNames.h"
 
 
 /**
@@ -95,18 +95,14 @@ int main( int argc, char **argv )
     return EXIT_FAILURE;
   }
 
-  typedef itk::GDCMSeriesFileNames                GDCMNamesGeneratorType;
-  typedef std::vector< std::string >              FileNamesContainerType;
-
   /** Get the seriesUIDs from the DICOM directory. */
-  GDCMNamesGeneratorType::Pointer nameGenerator = GDCMNamesGeneratorType::New();
-  nameGenerator->SetUseSeriesDetails( true );
-  for( unsigned int i = 0; i < restrictions.size(); ++i )
+  std::vector< std::string > seriesNames;
+  if( !itktools::GetDICOMSeriesUIDs( inputDirectoryName, restrictions, seriesNames ) )
   {
-    nameGenerator->AddSeriesRestriction( restrictions[ i ] );
+    std::cerr << "ERROR: could not read directory "
+      << inputDirectoryName << "." << std::endl;
+    return EXIT_FAILURE;
   }
-  nameGenerator->SetInputDirectory( inputDirectoryName.c_str() );
-  FileNamesContainerType seriesNames = nameGenerator->GetSeriesUIDs();
 
   /** Check. */
   if( !seriesNames.size() )
@@ -27,7 +27,7 @@
 #include <itksys/SystemTools.hxx>
 #include "itkImageSeriesReader.h"
 #include "itkGDCMImageIO.h"
-#include "itkGDCMSeriesFileNames.h"
+#include "ITKToolsDICOMIndex.h"
 
 
 /**
@@ -103,31 +103,16 @@ int main( int argc, char **argv )
   typedef itk::Image< short, 3>               ImageType;
   typedef itk::ImageSeriesReader< ImageType > SeriesReaderType;
   typedef itk::GDCMImageIO                    GDCMImageIOType;
-  typedef itk::GDCMSeriesFileNames            GDCMNamesGeneratorType;
   typedef std::vector< std::string >          FileNamesContainerType;
 
-  /** Get the seriesUIDs from the DICOM directory.
-   * With SetUseSeriesDetails( true ) series UIDs are generated that
-   * are unique and therefore extra long.
+  /** Generate the file names corresponding to the series.
+   * The series UIDs are generated as with GDCMSeriesFileNames and
+   * SetUseSeriesDetails( true ), they are unique and therefore extra long.
+   * Without a series number the first series is taken.
    */
-  GDCMNamesGeneratorType::Pointer nameGenerator = GDCMNamesGeneratorType::New();
-  nameGenerator->SetUseSeriesDetails( true );
-  for( unsigned int i = 0; i < restrictions.size(); ++i )
-  {
-    nameGenerator->AddSeriesRestriction( restrictions[ i ] );
-  }
-  nameGenerator->SetInputDirectory( inputDirectoryName.c_str() );
-
-  /** Generate the file names corresponding to the series. */
   FileNamesContainerType fileNames;
-  if( seriesNumber == "" )
-  {
-    fileNames = nameGenerator->GetInputFileNames();
-  }
-  else
-  {
-    fileNames = nameGenerator->GetFileNames( seriesNumber );
-  }
+  itktools::GetDICOMSeriesFileNames(
+    inputDirectoryName, restrictions, seriesNumber, fileNames );
 
   /** Check if there is at least one dicom file in the directory. */
   if( !fileNames.size() )
@@ -19,6 +19,7 @@
 #define __histogramequalizeimage_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImageFileReader.h"
 #include "itkHistogramEqualizationImageFilter.h"
@@ -94,6 +95,7 @@ public:
     /** Try to read input image */
     ReaderPointer reader = ReaderType::New();
     reader->SetFileName( this->m_InputFileName.c_str() );
+    itktools::ReuseImageIO( reader, this->m_InputFileName );
     reader->Update();
 
     /** Try to read mask image */
@@ -113,6 +115,7 @@ public:
     }
     writer->SetInput( enhancer->GetOutput() );
     writer->SetFileName( this->m_OutputFileName.c_str() );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
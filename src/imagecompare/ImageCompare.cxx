@@ -26,6 +26,7 @@
 
 #include "itkCommandLineArgumentParser.h"
 #include "ITKToolsHelpers.h"
+#include "ITKToolsExecutionOptions.h"
 
 #include "itkNumericTraits.h"
 #include "itkImage.h"
@@ -38,6 +39,14 @@
 #include "itkImageSource.h" // This should not be necessary after ITK patch is merged
 #include "itkTestingComparisonImageFilter.h"
 
+#include "itkImageIOFactory.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+
+#include <cstring>
+#include <cmath>
+#include <vector>
+
 
 /**
  * ******************* GetHelpString *******************
@@ -49,8 +58,14 @@ std::string GetHelpString( void )
   ss << "ITKTools v" << itktools::GetITKToolsVersion() << "\n"
     << "Usage:\n"
     << "pximagecompare\n"
-    << "  -test      image filename to test against baseline\n"
-    << "  -base      baseline image filename";
+    << "  -test      image filename(s) to test against baseline\n"
+    << "  -base      baseline image filename(s), one per test image\n"
+    << "  [-tol]     intensity tolerance, pixels that differ more are different, default 0\n"
+    << "  [-full]    count all different pixels and write a difference image\n"
+    << "The images are compared slab by slab, and identical slabs of images\n"
+    << "of the same type are recognized by their bytes. Without -full the\n"
+    << "comparison stops at the first slab that differs. Several image\n"
+    << "pairs are compared in parallel.";
   return ss.str();
 
 } // end GetHelpString()
@@ -61,33 +76,277 @@ std::string GetHelpString( void )
 // must be compared, change this variable.
 static const unsigned int ITK_TEST_DIMENSION_MAX = 6;
 
-int main( int argc, char **argv )
+/** The size of the slabs that are compared at once, per image. */
+static const double SlabSizeInBytes = 64.0 * 1024.0 * 1024.0;
+
+/** The outcome of comparing an image pair. */
+enum ComparisonResultType { Equal, Different, NeedsFullComparison, Failed };
+
+/** An image pair and the outcome of its comparison. */
+struct ImagePairType
 {
-  RegisterMevisDicomTiff();
+  std::string           BaselineFileName;
+  std::string           TestFileName;
+  ComparisonResultType  Result;
+  std::string           Message;
+};
+
+/** The data shared by the comparing threads. */
+struct CompareStruct
+{
+  std::vector<ImagePairType> *  Pairs;
+  double                        Tolerance;
+  unsigned int                  NextPair;
+  itk::SimpleFastMutexLock      Mutex;
+};
 
-  itk::CommandLineArgumentParser::Pointer parser = itk::CommandLineArgumentParser::New();
-  parser->SetCommandLineArguments( argc, argv );
-  parser->SetProgramHelpText( GetHelpString() );
 
-  parser->MarkArgumentAsRequired( "-test", "The input filename." );
-  parser->MarkArgumentAsRequired( "-base", "The baseline image filename." );
+/**
+ * ******************* ConvertToDouble *******************
+ *
+ * Convert a buffer of file components to double.
+ */
 
-  itk::CommandLineArgumentParser::ReturnValue validateArguments = parser->CheckForRequiredArguments();
+template< class T >
+void ConvertToDouble( const char * buffer, const std::size_t n, double * out )
+{
+  T value;
+  for( std::size_t i = 0; i < n; ++i )
+  {
+    std::memcpy( &value, buffer + i * sizeof( T ), sizeof( T ) );
+    out[ i ] = static_cast<double>( value );
+  }
 
-  if( validateArguments == itk::CommandLineArgumentParser::FAILED )
+} // end ConvertToDouble()
+
+
+bool ConvertToDouble( const itk::ImageIOBase::IOComponentType type,
+  const char * buffer, const std::size_t n, double * out )
+{
+  switch( type )
   {
-    return EXIT_FAILURE;
+    case itk::ImageIOBase::UCHAR:  ConvertToDouble<unsigned char>( buffer, n, out ); return true;
+    case itk::ImageIOBase::CHAR:   ConvertToDouble<char>( buffer, n, out ); return true;
+    case itk::ImageIOBase::USHORT: ConvertToDouble<unsigned short>( buffer, n, out ); return true;
+    case itk::ImageIOBase::SHORT:  ConvertToDouble<short>( buffer, n, out ); return true;
+    case itk::ImageIOBase::UINT:   ConvertToDouble<unsigned int>( buffer, n, out ); return true;
+    case itk::ImageIOBase::INT:    ConvertToDouble<int>( buffer, n, out ); return true;
+    case itk::ImageIOBase::ULONG:  ConvertToDouble<unsigned long>( buffer, n, out ); return true;
+    case itk::ImageIOBase::LONG:   ConvertToDouble<long>( buffer, n, out ); return true;
+    case itk::ImageIOBase::FLOAT:  ConvertToDouble<float>( buffer, n, out ); return true;
+    case itk::ImageIOBase::DOUBLE: ConvertToDouble<double>( buffer, n, out ); return true;
+    default: return false;
   }
-  else if( validateArguments == itk::CommandLineArgumentParser::HELPREQUESTED )
+
+} // end ConvertToDouble()
+
+
+/**
+ * ******************* CompareStreamed *******************
+ *
+ * Compare an image pair slab by slab along the last dimension, and stop
+ * at the first slab that differs. Slabs of images with the same type are
+ * first compared byte by byte; only slabs that differ in their bytes are
+ * compared by value, as the ComparisonImageFilter does, so that for
+ * example -0 and 0 are still equal. Images with several components and
+ * different types are left to the full comparison, which converts them
+ * in the same way as before.
+ */
+
+void CompareStreamed( ImagePairType & pair,
+  itk::ImageIOBase * baselineIO, itk::ImageIOBase * testIO, const double tolerance )
+{
+  /** Images of different dimension or number of components may still be
+   * equal after the conversion of the full comparison.
+   */
+  const unsigned int dimension = baselineIO->GetNumberOfDimensions();
+  if( dimension != testIO->GetNumberOfDimensions()
+    || baselineIO->GetNumberOfComponents() != testIO->GetNumberOfComponents() )
   {
-    return EXIT_SUCCESS;
+    pair.Result = NeedsFullComparison;
+    return;
   }
 
-  std::string testImageFileName;
-  parser->GetCommandLineArgument( "-test", testImageFileName );
+  /** The sizes of the baseline and test image must match. */
+  for( unsigned int d = 0; d < dimension; ++d )
+  {
+    if( baselineIO->GetDimensions( d ) != testIO->GetDimensions( d ) )
+    {
+      std::ostringstream message;
+      message << "The size of the Baseline image and Test image do not match!" << std::endl;
+      message << "Baseline image: " << pair.BaselineFileName << " has size [";
+      for( unsigned int k = 0; k < dimension; ++k )
+      {
+        message << ( k > 0 ? ", " : "" ) << baselineIO->GetDimensions( k );
+      }
+      message << "]" << std::endl << "Test image:     " << pair.TestFileName << " has size [";
+      for( unsigned int k = 0; k < dimension; ++k )
+      {
+        message << ( k > 0 ? ", " : "" ) << testIO->GetDimensions( k );
+      }
+      message << "]";
+      pair.Result = Failed;
+      pair.Message = message.str();
+      return;
+    }
+  }
+
+  const bool sameType = baselineIO->GetComponentType() == testIO->GetComponentType()
+    && baselineIO->GetPixelType() == testIO->GetPixelType();
+  const unsigned int numberOfComponents = baselineIO->GetNumberOfComponents();
+  if( !sameType && numberOfComponents > 1 )
+  {
+    pair.Result = NeedsFullComparison;
+    return;
+  }
+
+  /** Determine the slabs. */
+  const unsigned int lastDim = dimension - 1;
+  const std::size_t lines = baselineIO->GetDimensions( lastDim );
+  const std::size_t pixelsPerLine = baselineIO->GetImageSizeInPixels() / std::max<std::size_t>( lines, 1 );
+  const double bytes = static_cast<double>( std::max(
+    baselineIO->GetImageSizeInBytes(), testIO->GetImageSizeInBytes() ) );
+  std::size_t numberOfSlabs = std::max<std::size_t>(
+    itktools::GetNumberOfStreamDivisions( 2.0 * bytes ),
+    static_cast<std::size_t>( std::ceil( bytes / SlabSizeInBytes ) ) );
+  const bool canStream = baselineIO->CanStreamRead() && testIO->CanStreamRead();
+  if( !canStream ) numberOfSlabs = 1;
+  numberOfSlabs = std::min( std::max<std::size_t>( numberOfSlabs, 1 ), std::max<std::size_t>( lines, 1 ) );
+  const std::size_t linesPerSlab = ( lines + numberOfSlabs - 1 ) / numberOfSlabs;
+  baselineIO->SetUseStreamedReading( canStream );
+  testIO->SetUseStreamedReading( canStream );
+
+  std::vector<char> baselineBuffer, testBuffer;
+  std::vector<double> baselineValues, testValues;
+  for( std::size_t first = 0; first < lines; first += linesPerSlab )
+  {
+    const std::size_t slabLines = std::min( linesPerSlab, lines - first );
+    itk::ImageIORegion ioRegion( dimension );
+    for( unsigned int d = 0; d < dimension; ++d )
+    {
+      ioRegion.SetIndex( d, 0 );
+      ioRegion.SetSize( d, baselineIO->GetDimensions( d ) );
+    }
+    ioRegion.SetIndex( lastDim, first );
+    ioRegion.SetSize( lastDim, slabLines );
+
+    const std::size_t n = slabLines * pixelsPerLine * numberOfComponents;
+    baselineIO->SetIORegion( ioRegion );
+    testIO->SetIORegion( ioRegion );
+    baselineBuffer.resize( n * baselineIO->GetComponentSize() );
+    testBuffer.resize( n * testIO->GetComponentSize() );
+    baselineIO->Read( &baselineBuffer[ 0 ] );
+    testIO->Read( &testBuffer[ 0 ] );
+
+    /** Identical bytes, identical values. */
+    if( sameType && std::memcmp( &baselineBuffer[ 0 ], &testBuffer[ 0 ], baselineBuffer.size() ) == 0 )
+    {
+      continue;
+    }
+    if( numberOfComponents > 1 )
+    {
+      pair.Result = NeedsFullComparison;
+      return;
+    }
+
+    baselineValues.resize( n );
+    testValues.resize( n );
+    if( !ConvertToDouble( baselineIO->GetComponentType(), &baselineBuffer[ 0 ], n, &baselineValues[ 0 ] )
+      || !ConvertToDouble( testIO->GetComponentType(), &testBuffer[ 0 ], n, &testValues[ 0 ] ) )
+    {
+      pair.Result = NeedsFullComparison;
+      return;
+    }
+    for( std::size_t i = 0; i < n; ++i )
+    {
+      if( std::abs( testValues[ i ] - baselineValues[ i ] ) > tolerance )
+      {
+        std::ostringstream message;
+        message << "The images differ, first in the slab starting at slice "
+          << first << " of the last dimension.";
+        pair.Result = Different;
+        pair.Message = message.str();
+        return;
+      }
+    }
+  }
+
+  pair.Result = Equal;
+
+} // end CompareStreamed()
 
-  std::string baselineImageFileName;
-  parser->GetCommandLineArgument( "-base", baselineImageFileName );
+
+/**
+ * ******************* CompareThreaderCallback *******************
+ *
+ * Take pairs from the shared counter and compare them.
+ */
+
+ITK_THREAD_RETURN_TYPE CompareThreaderCallback( void * arg )
+{
+  itk::MultiThreader::ThreadInfoStruct * info
+    = static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+  CompareStruct * str = static_cast<CompareStruct *>( info->UserData );
+
+  while( true )
+  {
+    /** The ImageIOs are created under the lock, the object factories
+     * are not thread safe.
+     */
+    itk::ImageIOBase::Pointer baselineIO = 0;
+    itk::ImageIOBase::Pointer testIO = 0;
+    str->Mutex.Lock();
+    const unsigned int i = str->NextPair++;
+    if( i < str->Pairs->size() )
+    {
+      baselineIO = itk::ImageIOFactory::CreateImageIO(
+        ( *str->Pairs )[ i ].BaselineFileName.c_str(), itk::ImageIOFactory::ReadMode );
+      testIO = itk::ImageIOFactory::CreateImageIO(
+        ( *str->Pairs )[ i ].TestFileName.c_str(), itk::ImageIOFactory::ReadMode );
+    }
+    str->Mutex.Unlock();
+    if( i >= str->Pairs->size() ) break;
+
+    ImagePairType & pair = ( *str->Pairs )[ i ];
+    if( baselineIO.IsNull() || testIO.IsNull() )
+    {
+      /** Let the full comparison report the reading error. */
+      pair.Result = NeedsFullComparison;
+      continue;
+    }
+
+    try
+    {
+      baselineIO->SetFileName( pair.BaselineFileName.c_str() );
+      baselineIO->ReadImageInformation();
+      testIO->SetFileName( pair.TestFileName.c_str() );
+      testIO->ReadImageInformation();
+      CompareStreamed( pair, baselineIO, testIO, str->Tolerance );
+    }
+    catch( itk::ExceptionObject & )
+    {
+      pair.Result = NeedsFullComparison;
+    }
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end CompareThreaderCallback()
+
+
+/**
+ * ******************* CompareFull *******************
+ *
+ * Read both images completely, count the different pixels and write a
+ * difference image if there are any.
+ */
+
+void CompareFull( ImagePairType & pair, const double tolerance )
+{
+  const std::string & testImageFileName = pair.TestFileName;
+  const std::string & baselineImageFileName = pair.BaselineFileName;
+  std::ostringstream message;
+  pair.Result = Failed;
 
   // Read images
   typedef itk::Image<double,ITK_TEST_DIMENSION_MAX>           ImageType;
@@ -102,8 +361,9 @@ int main( int argc, char **argv )
   }
   catch( itk::ExceptionObject & excp )
   {
-    std::cerr << "Error during reading baseline image: " << excp << std::endl;
-    return EXIT_FAILURE;
+    message << "Error during reading baseline image: " << excp;
+    pair.Message = message.str();
+    return;
   }
 
   // Read the file to test
@@ -115,8 +375,9 @@ int main( int argc, char **argv )
   }
   catch( itk::ExceptionObject & excp )
   {
-    std::cerr << "Error during reading test image: " << excp << std::endl;
-    return EXIT_FAILURE;
+    message << "Error during reading test image: " << excp;
+    pair.Message = message.str();
+    return;
   }
 
   // The sizes of the baseline and test image must match
@@ -127,12 +388,13 @@ int main( int argc, char **argv )
 
   if( baselineSize != testSize )
   {
-    std::cerr << "The size of the Baseline image and Test image do not match!" << std::endl;
-    std::cerr << "Baseline image: " << baselineImageFileName
+    message << "The size of the Baseline image and Test image do not match!" << std::endl;
+    message << "Baseline image: " << baselineImageFileName
       << " has size " << baselineSize << std::endl;
-    std::cerr << "Test image:     " << testImageFileName
-      << " has size " << testSize << std::endl;
-    return EXIT_FAILURE;
+    message << "Test image:     " << testImageFileName
+      << " has size " << testSize;
+    pair.Message = message.str();
+    return;
   }
 
   // Now compare the two images
@@ -140,21 +402,23 @@ int main( int argc, char **argv )
   ComparisonFilterType::Pointer comparisonFilter = ComparisonFilterType::New();
   comparisonFilter->SetTestInput(testReader->GetOutput());
   comparisonFilter->SetValidInput(baselineReader->GetOutput());
+  comparisonFilter->SetDifferenceThreshold( tolerance );
   try
   {
     comparisonFilter->Update();
   }
   catch( itk::ExceptionObject & excp )
   {
-    std::cerr << "Error during comparing image: " << excp << std::endl;
-    return EXIT_FAILURE;
+    message << "Error during comparing image: " << excp;
+    pair.Message = message.str();
+    return;
   }
 
   itk::SizeValueType numberOfDifferentPixels = comparisonFilter->GetNumberOfPixelsWithDifferences();
 
   if(numberOfDifferentPixels > 0)
   {
-    std::cerr << "There are " << numberOfDifferentPixels << " different pixels!" << std::endl;
+    message << "There are " << numberOfDifferentPixels << " different pixels!";
 
     // Create name for diff image
     std::string diffImageFileName =
@@ -172,14 +436,113 @@ int main( int argc, char **argv )
     }
     catch( itk::ExceptionObject & excp )
     {
-      std::cerr << "Error during writing difference image: " << excp << std::endl;
-      return EXIT_FAILURE;
+      message << std::endl << "Error during writing difference image: " << excp;
     }
 
-    return EXIT_FAILURE;
+    pair.Result = Different;
+    pair.Message = message.str();
+    return;
 
   } // end if discrepancies
 
-  return EXIT_SUCCESS;
+  pair.Result = Equal;
+
+} // end CompareFull()
+
+
+int main( int argc, char **argv )
+{
+  RegisterMevisDicomTiff();
+
+  itk::CommandLineArgumentParser::Pointer parser = itk::CommandLineArgumentParser::New();
+  parser->SetCommandLineArguments( argc, argv );
+  parser->SetProgramHelpText( GetHelpString() );
+
+  parser->MarkArgumentAsRequired( "-test", "The input filename." );
+  parser->MarkArgumentAsRequired( "-base", "The baseline image filename." );
+
+  itk::CommandLineArgumentParser::ReturnValue validateArguments = parser->CheckForRequiredArguments();
+
+  if( validateArguments == itk::CommandLineArgumentParser::FAILED )
+  {
+    return EXIT_FAILURE;
+  }
+  else if( validateArguments == itk::CommandLineArgumentParser::HELPREQUESTED )
+  {
+    return EXIT_SUCCESS;
+  }
+
+  std::vector<std::string> testImageFileNames;
+  parser->GetCommandLineArgument( "-test", testImageFileNames );
+
+  std::vector<std::string> baselineImageFileNames;
+  parser->GetCommandLineArgument( "-base", baselineImageFileNames );
+
+  double tolerance = 0.0;
+  parser->GetCommandLineArgument( "-tol", tolerance );
+
+  const bool fullReport = parser->ArgumentExists( "-full" );
+
+  /** Checks. */
+  if( testImageFileNames.size() != baselineImageFileNames.size() )
+  {
+    std::cerr << "ERROR: the number of test and baseline images should be equal." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if( tolerance < 0.0 )
+  {
+    std::cerr << "ERROR: the tolerance should be positive." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::vector<ImagePairType> pairs( testImageFileNames.size() );
+  for( std::size_t i = 0; i < pairs.size(); ++i )
+  {
+    pairs[ i ].BaselineFileName = baselineImageFileNames[ i ];
+    pairs[ i ].TestFileName = testImageFileNames[ i ];
+    pairs[ i ].Result = NeedsFullComparison;
+  }
+
+  /** Compare the pairs slab by slab, in parallel. */
+  CompareStruct str;
+  str.Pairs = &pairs;
+  str.Tolerance = tolerance;
+  str.NextPair = 0;
+
+  itk::ThreadIdType numberOfThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+  if( numberOfThreads > pairs.size() )
+  {
+    numberOfThreads = static_cast<itk::ThreadIdType>( pairs.size() );
+  }
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads( numberOfThreads );
+  threader->SetSingleMethod( CompareThreaderCallback, &str );
+  threader->SingleMethodExecute();
+
+  /** Compare completely what could not be streamed, and what differs
+   * if a full report is requested.
+   */
+  int returnValue = EXIT_SUCCESS;
+  for( std::size_t i = 0; i < pairs.size(); ++i )
+  {
+    ImagePairType & pair = pairs[ i ];
+    if( pair.Result == NeedsFullComparison || ( pair.Result == Different && fullReport ) )
+    {
+      CompareFull( pair, tolerance );
+    }
+
+    if( pair.Result != Equal )
+    {
+      if( pairs.size() > 1 )
+      {
+        std::cerr << "Baseline image: " << pair.BaselineFileName << std::endl;
+        std::cerr << "Test image:     " << pair.TestFileName << std::endl;
+      }
+      std::cerr << pair.Message << std::endl;
+      returnValue = EXIT_FAILURE;
+    }
+  }
+
+  return returnValue;
 
 } // end main
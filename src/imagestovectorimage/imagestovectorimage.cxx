@@ -41,7 +41,8 @@ std::string GetHelpString( void )
     << "pximagetovectorimage\n"
     << "  -in      inputFilenames, at least 2\n"
     << "  [-out]   outputFilename, default VECTOR.mhd\n"
-    << "  [-s]     number of streams, default 1.\n"
+    << "  [-s]     minimum number of streams, default 1; the output is\n"
+    << "           streamed in slabs of at most 64 MB if its format allows\n"
     << "Supported: 2D, 3D, (unsigned) char, (unsigned) short,\n"
     << "(unsigned) int, (unsigned) long, float, double.\n"
     << "Note: make sure that the input images are of the same type, size, etc.";
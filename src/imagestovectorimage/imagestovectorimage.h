@@ -19,11 +19,16 @@
 #define __imagestovectorimage_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsHelpers.h"
+#include "ITKToolsExecutionOptions.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImageFileReader.h"
-#include "itkComposeImageFilter.h"
 #include "itkImageFileWriter.h"
-#include "itkVectorIndexSelectionCastImageFilter.h"
+#include "itkConcatenateVectorImagesFilter.h"
+
+#include <algorithm>
+#include <cmath>
 
 
 /** \class ITKToolsImagesToVectorImageBase
@@ -56,6 +61,11 @@ public:
  *
  * Templated class that implements the Run() function
  * and the New() function for its creation.
+ *
+ * The output is written in slabs of at most 64 MB, or as set by -s and
+ * -maxmem, if the output format supports streamed writing. The readers
+ * stream as well, so every slab is pulled from all inputs and
+ * interleaved without holding the inputs in memory completely.
  */
 
 template< unsigned int VDimension, class TComponentType >
@@ -76,57 +86,52 @@ public:
     typedef itk::VectorImage< TComponentType, VDimension >    VectorImageType;
     typedef VectorImageType                                   OutputImageType;
     typedef itk::ImageFileReader< VectorImageType >           ReaderType;
-    typedef itk::Image< TComponentType, VDimension >          ScalarImageType;
     typedef itk::ImageFileWriter< VectorImageType >           WriterType;
+    typedef itk::ConcatenateVectorImagesFilter<
+      VectorImageType, OutputImageType >                      ConcatenateFilterType;
+
+    /** Create assembler. */
+    typename ConcatenateFilterType::Pointer concatenateFilter = ConcatenateFilterType::New();
 
-    /** Read in the input images. */
+    /** Setup the streaming readers. Scalar images are read as vector
+     * images with one component.
+     */
+    std::cout << "There are " << this->m_InputFileNames.size() << " input images." << std::endl;
     std::vector<typename ReaderType::Pointer> readers( this->m_InputFileNames.size() );
     for( unsigned int i = 0; i < this->m_InputFileNames.size(); ++i )
     {
       readers[ i ] = ReaderType::New();
       readers[ i ]->SetFileName( this->m_InputFileNames[ i ] );
-      readers[ i ]->Update();
-    }
+      itktools::ReuseImageIO( readers[ i ], this->m_InputFileNames[ i ] );
+      readers[ i ]->UseStreamingOn();
+      readers[ i ]->UpdateOutputInformation();
+      std::cout << "There are " << readers[ i ]->GetOutput()->GetNumberOfComponentsPerPixel()
+        << " components in image " << i << std::endl;
 
-    /** Create assembler. */
-    typedef itk::ComposeImageFilter< ScalarImageType > ImageToVectorImageFilterType;
-    typename ImageToVectorImageFilterType::Pointer imageToVectorImageFilter
-      = ImageToVectorImageFilterType::New();
-
-    // For each input image
-    std::cout << "There are " << this->m_InputFileNames.size() << " input images." << std::endl;
-    unsigned int currentOutputIndex = 0;
-    for( unsigned int inputImageIndex = 0; inputImageIndex < this->m_InputFileNames.size(); ++inputImageIndex )
-    {
-      typedef itk::VectorIndexSelectionCastImageFilter<VectorImageType, ScalarImageType> ComponentExtractionType;
-
-      // For each component of the current image
-      std::cout << "There are " << readers[inputImageIndex]->GetOutput()->GetNumberOfComponentsPerPixel()
-        << " components in image " << inputImageIndex << std::endl;
-      for( unsigned int component = 0;
-        component < readers[inputImageIndex]->GetOutput()->GetNumberOfComponentsPerPixel(); ++component )
-      {
-        typename ComponentExtractionType::Pointer componentExtractionFilter = ComponentExtractionType::New();
-        componentExtractionFilter->SetIndex( component );
-        componentExtractionFilter->SetInput( readers[inputImageIndex]->GetOutput() );
-        componentExtractionFilter->Update();
-
-        imageToVectorImageFilter->SetInput( currentOutputIndex, componentExtractionFilter->GetOutput());
-        currentOutputIndex++;
-      }
+      concatenateFilter->SetInput( i, readers[ i ]->GetOutput() );
     }
+    concatenateFilter->UpdateOutputInformation();
 
-    imageToVectorImageFilter->Update();
-
+    const OutputImageType * output = concatenateFilter->GetOutput();
     std::cout << "Output image has "
-      << imageToVectorImageFilter->GetOutput()->GetNumberOfComponentsPerPixel()
+      << output->GetNumberOfComponentsPerPixel()
       << " components." << std::endl;
 
-    /** Write vector image. */
+    /** The inputs and the output of a slab are in memory at the same time. */
+    const double memoryInBytes = 2.0 * output->GetLargestPossibleRegion().GetNumberOfPixels()
+      * output->GetNumberOfComponentsPerPixel() * sizeof( TComponentType );
+    const unsigned int numberOfStreams = std::max(
+      itktools::GetNumberOfStreamDivisions( memoryInBytes, this->m_NumberOfStreams ),
+      static_cast<unsigned int>( std::ceil( memoryInBytes / ( 64.0 * 1024.0 * 1024.0 ) ) ) );
+
+    /** Write vector image. If the ImageIO can not write streamed, the
+     * writer writes in one piece.
+     */
     typename WriterType::Pointer writer = WriterType::New();
     writer->SetFileName( this->m_OutputFileName );
-    writer->SetInput( imageToVectorImageFilter->GetOutput() );
-    writer->SetNumberOfStreamDivisions( this->m_NumberOfStreams );
+    writer->SetInput( concatenateFilter->GetOutput() );
+    writer->SetNumberOfStreamDivisions( numberOfStreams );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
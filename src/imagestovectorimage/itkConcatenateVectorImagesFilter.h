@@ -0,0 +1,102 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkConcatenateVectorImagesFilter_h_
+#define __itkConcatenateVectorImagesFilter_h_
+
+#include "itkImageToImageFilter.h"
+
+
+namespace itk
+{
+
+/** \class ConcatenateVectorImagesFilter
+ * \brief Concatenates the components of vector images into one vector image.
+ *
+ * The output pixel holds the components of the first input, followed by
+ * those of the second input, and so on. The inputs are VectorImages with
+ * any number of components, so scalar images read as VectorImages with one
+ * component need no separate extraction step.
+ *
+ * Every output line is filled in blocks of BlockSize pixels: for each
+ * input all its components of the block are copied, so that the reads are
+ * contiguous and the written block of the output stays in cache while the
+ * inputs are interleaved into it.
+ *
+ * Only the requested output region is read from the inputs, so the filter
+ * streams.
+ *
+ * \ingroup ImageToImageFilter
+ * \ingroup Multithreaded
+ */
+
+template < typename TInputImage, typename TOutputImage = TInputImage >
+class ITK_EXPORT ConcatenateVectorImagesFilter:
+    public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef ConcatenateVectorImagesFilter                     Self;
+  typedef ImageToImageFilter< TInputImage, TOutputImage >   Superclass;
+  typedef SmartPointer<Self>                                Pointer;
+  typedef SmartPointer<const Self>                          ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( ConcatenateVectorImagesFilter, ImageToImageFilter );
+
+  /** Image dimension. */
+  itkStaticConstMacro( ImageDimension, unsigned int, TInputImage::ImageDimension );
+
+  /** Typedefs. */
+  typedef TInputImage                                     InputImageType;
+  typedef typename InputImageType::InternalPixelType      InputComponentType;
+  typedef TOutputImage                                    OutputImageType;
+  typedef typename OutputImageType::InternalPixelType     OutputComponentType;
+  typedef typename OutputImageType::RegionType            OutputImageRegionType;
+
+  /** The number of pixels that is interleaved at once. */
+  itkStaticConstMacro( BlockSize, unsigned int, 64 );
+
+protected:
+  ConcatenateVectorImagesFilter() {};
+  virtual ~ConcatenateVectorImagesFilter() {};
+
+  /** Set the number of components of the output. */
+  virtual void GenerateOutputInformation( void );
+
+  /** Concatenate the inputs in a region. */
+  virtual void ThreadedGenerateData(
+    const OutputImageRegionType & outputRegionForThread,
+    ThreadIdType threadId );
+
+private:
+  ConcatenateVectorImagesFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );                // purposely not implemented
+
+}; // end class ConcatenateVectorImagesFilter
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkConcatenateVectorImagesFilter.txx"
+#endif
+
+#endif // end #ifndef __itkConcatenateVectorImagesFilter_h_
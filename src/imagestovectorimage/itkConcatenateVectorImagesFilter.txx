@@ -0,0 +1,138 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef _itkConcatenateVectorImagesFilter_txx_
+#define _itkConcatenateVectorImagesFilter_txx_
+
+#include "itkConcatenateVectorImagesFilter.h"
+
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+#include <vector>
+
+
+namespace itk
+{
+
+/**
+ * ******************* GenerateOutputInformation *******************
+ */
+
+template <typename TInputImage, typename TOutputImage>
+void
+ConcatenateVectorImagesFilter<TInputImage, TOutputImage>
+::GenerateOutputInformation( void )
+{
+  Superclass::GenerateOutputInformation();
+
+  unsigned int numberOfComponents = 0;
+  for( unsigned int i = 0; i < this->GetNumberOfInputs(); ++i )
+  {
+    const InputImageType * input = this->GetInput( i );
+    if( !input ) continue;
+    if( input->GetLargestPossibleRegion() != this->GetInput( 0 )->GetLargestPossibleRegion() )
+    {
+      itkExceptionMacro( << "Input " << i << " has region "
+        << input->GetLargestPossibleRegion() << ", different from input 0." );
+    }
+    numberOfComponents += input->GetNumberOfComponentsPerPixel();
+  }
+  this->GetOutput()->SetNumberOfComponentsPerPixel( numberOfComponents );
+
+} // end GenerateOutputInformation()
+
+
+/**
+ * ******************* ThreadedGenerateData *******************
+ */
+
+template <typename TInputImage, typename TOutputImage>
+void
+ConcatenateVectorImagesFilter<TInputImage, TOutputImage>
+::ThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  typedef ImageLinearConstIteratorWithIndex<OutputImageType> LineIteratorType;
+
+  OutputImageType * output = this->GetOutput();
+  const std::size_t numberOfOutputComponents = output->GetNumberOfComponentsPerPixel();
+  const std::size_t lineLength = outputRegionForThread.GetSize()[ 0 ];
+  const std::size_t blockSize = BlockSize;
+
+  /** The inputs that are set, and their number of components. */
+  std::vector<const InputImageType *> inputs;
+  std::vector<std::size_t> numberOfComponents;
+  for( unsigned int i = 0; i < this->GetNumberOfInputs(); ++i )
+  {
+    if( !this->GetInput( i ) ) continue;
+    inputs.push_back( this->GetInput( i ) );
+    numberOfComponents.push_back( this->GetInput( i )->GetNumberOfComponentsPerPixel() );
+  }
+
+  ProgressReporter progress( this, threadId,
+    outputRegionForThread.GetNumberOfPixels() / std::max<std::size_t>( lineLength, 1 ) );
+
+  LineIteratorType it( output, outputRegionForThread );
+  it.SetDirection( 0 );
+  for( it.GoToBegin(); !it.IsAtEnd(); it.NextLine() )
+  {
+    const typename OutputImageType::IndexType & index = it.GetIndex();
+    OutputComponentType * outLine = output->GetBufferPointer()
+      + output->ComputeOffset( index ) * numberOfOutputComponents;
+
+    for( std::size_t begin = 0; begin < lineLength; begin += blockSize )
+    {
+      const std::size_t end = std::min( begin + blockSize, lineLength );
+      std::size_t firstComponent = 0;
+      for( unsigned int i = 0; i < inputs.size(); ++i )
+      {
+        const std::size_t n = numberOfComponents[ i ];
+        const InputComponentType * in = inputs[ i ]->GetBufferPointer()
+          + ( inputs[ i ]->ComputeOffset( index ) + begin ) * n;
+        OutputComponentType * out = outLine + begin * numberOfOutputComponents + firstComponent;
+        if( n == 1 )
+        {
+          for( std::size_t p = begin; p < end; ++p, ++in, out += numberOfOutputComponents )
+          {
+            *out = static_cast<OutputComponentType>( *in );
+          }
+        }
+        else
+        {
+          for( std::size_t p = begin; p < end; ++p, in += n, out += numberOfOutputComponents )
+          {
+            for( std::size_t c = 0; c < n; ++c )
+            {
+              out[ c ] = static_cast<OutputComponentType>( in[ c ] );
+            }
+          }
+        }
+        firstComponent += n;
+      }
+    }
+
+    progress.CompletedPixel();
+  }
+
+} // end ThreadedGenerateData()
+
+} // end namespace itk
+
+#endif // end #ifndef _itkConcatenateVectorImagesFilter_txx_
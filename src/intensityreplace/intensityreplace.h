@@ -19,6 +19,7 @@
 #define __intensityreplace_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImageFileReader.h"
 #include "itkChangeLabelImageFilter.h"
@@ -93,6 +94,7 @@ public:
 
     /** Set up reader */
     reader->SetFileName( this->m_InputFileName );
+    itktools::ReuseImageIO( reader, this->m_InputFileName );
 
     /** Setup the the input and the 'change map' of the replace filter. */
     replaceFilter->SetInput( reader->GetOutput() );
@@ -122,6 +124,7 @@ public:
     /** Set up writer. */
     writer->SetFileName( this->m_OutputFileName );
     writer->SetInput( replaceFilter->GetOutput() );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
@@ -19,6 +19,7 @@
 #define __intensitywindowing_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImage.h"
 #include "itkIntensityWindowingImageFilter.h"
@@ -87,6 +88,7 @@ public:
 
     /** Setup the pipeline. */
     reader->SetFileName( this->m_InputFileName.c_str() );
+    itktools::ReuseImageIO( reader, this->m_InputFileName );
     writer->SetFileName( this->m_OutputFileName.c_str() );
     InputPixelType min = static_cast<InputPixelType>( this->m_Window[ 0 ] );
     InputPixelType max = static_cast<InputPixelType>( this->m_Window[ 1 ] );
@@ -98,6 +100,7 @@ public:
     /** Connect and execute the pipeline. */
     windowfilter->SetInput( reader->GetOutput() );
     writer->SetInput( windowfilter->GetOutput() );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
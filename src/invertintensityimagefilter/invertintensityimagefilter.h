@@ -19,6 +19,8 @@
 #define __invertintensityimagefilter_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsExecutionOptions.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
@@ -28,8 +30,7 @@
 
 // Vector image support
 #include "itkVectorIndexSelectionCastImageFilter.h" // decompose
-#include "itkComposeImageFilter.h" // reassemble
-#include "itkChannelByChannelVectorImageFilter2.h"
+#include "itkChannelByChannelVectorImageFilter.h"
 
 
 /** \class ITKToolsInvertIntensityBase
@@ -91,6 +92,7 @@ public:
     /** Create reader. */
     typename ReaderType::Pointer reader = ReaderType::New();
     reader->SetFileName( this->m_InputFileName.c_str() );
+    itktools::ReuseImageIO( reader, this->m_InputFileName );
 
     // In this case, we must manually disassemble the image rather than use a
     // ChannelByChannel filter because the image is not the output,
@@ -121,23 +123,28 @@ public:
       }
     }
 
-    /** Create invert filter. */
-    typename InvertIntensityFilterType::Pointer invertFilter = InvertIntensityFilterType::New();
-    invertFilter->SetMaximum( max );
-
-    // Setup the filter to apply the invert filter to every channel
-    typedef itk::ChannelByChannelVectorImageFilter2<
-      VectorImageType, InvertIntensityFilterType >        ChannelByChannelInvertType;
+    // Setup the filter to apply an invert filter to every channel, so
+    // that the channels are inverted in parallel, within -maxmem (in MB)
+    typedef itk::ChannelByChannelVectorImageFilter< VectorImageType > ChannelByChannelInvertType;
     typename ChannelByChannelInvertType::Pointer channelByChannelInvertFilter
       = ChannelByChannelInvertType::New();
     channelByChannelInvertFilter->SetInput( reader->GetOutput() );
-    channelByChannelInvertFilter->SetFilter( invertFilter );
+    channelByChannelInvertFilter->SetMaximumMemory(
+      itktools::GetExecutionOptions().MaximumMemory * 1024.0 * 1024.0 );
+    for( unsigned int channel = 0; channel < reader->GetOutput()->GetNumberOfComponentsPerPixel(); channel++ )
+    {
+      /** Create invert filter. */
+      typename InvertIntensityFilterType::Pointer invertFilter = InvertIntensityFilterType::New();
+      invertFilter->SetMaximum( max );
+      channelByChannelInvertFilter->SetFilterForSingleChannel( channel, invertFilter.GetPointer() );
+    }
     channelByChannelInvertFilter->Update();
 
     /** Create writer. */
     typename WriterType::Pointer writer = WriterType::New();
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetInput( channelByChannelInvertFilter->GetOutput() );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
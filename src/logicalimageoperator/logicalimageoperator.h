@@ -18,6 +18,8 @@
 #ifndef __logicalimageoperator_h_
 #define __logicalimageoperator_h_
 
+#include "ITKToolsTiming.h"
+
 #include "itkUnaryFunctorImageFilter.h"
 #include "itkBinaryFunctorImageFilter.h"
 #include "itkUnaryLogicalFunctors.h"
@@ -163,6 +165,7 @@ public:
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetInput( imageToVectorImageFilter->GetOutput() );
     writer->SetUseCompression( this->m_UseCompression );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end RunUnary()
@@ -316,6 +319,7 @@ public:
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetInput( imageToVectorImageFilter->GetOutput() );
     writer->SetUseCompression( this->m_UseCompression );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end RunBinary()
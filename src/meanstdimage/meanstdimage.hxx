@@ -18,6 +18,8 @@
 #ifndef __meanstdimage_hxx_
 #define __meanstdimage_hxx_
 
+#include "ITKToolsTiming.h"
+
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 
@@ -215,6 +217,7 @@ ITKToolsMeanStdImage< VDimension, TComponentType >
     writer_mean->SetFileName( outputFileNameMean.c_str() );
     writer_mean->SetInput( mean );
 	writer_mean->SetUseCompression( use_compression );
+    itktools::AddTimingObservers( writer_mean );
     writer_mean->Update();
   }
 
@@ -223,6 +226,7 @@ ITKToolsMeanStdImage< VDimension, TComponentType >
     writer_std->SetFileName( outputFileNameStd.c_str() );
     writer_std->SetInput( std );
 	writer_std->SetUseCompression( use_compression );
+    itktools::AddTimingObservers( writer_std );
     writer_std->Update();
   }
 
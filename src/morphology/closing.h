@@ -1,4 +1,6 @@
 
+#include "ITKToolsTiming.h"
+
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 
@@ -57,6 +59,7 @@ void closingGrayscale(
   writer->SetFileName( outputFileName.c_str() );
   writer->SetInput( closing->GetOutput() );
   writer->SetUseCompression( useCompression );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end closingGrayscale()
@@ -130,6 +133,7 @@ void closingBinary(
   writer->SetFileName( outputFileName.c_str() );
   writer->SetInput( closing->GetOutput() );
   writer->SetUseCompression( useCompression );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end closingBinary()
@@ -184,6 +188,7 @@ void closingParabolic(
   writer->SetFileName( outputFileName.c_str() );
   writer->SetInput( filter->GetOutput() );
   writer->SetUseCompression( useCompression );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end closingParabolic()
@@ -1,4 +1,6 @@
 
+#include "ITKToolsTiming.h"
+
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 
@@ -80,6 +82,7 @@ void dilationGrayscale(
   writer->SetFileName( outputFileName.c_str() );
   writer->SetInput( dilation->GetOutput() );
   writer->SetUseCompression( useCompression );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end dilationGrayscale()
@@ -157,6 +160,7 @@ void dilationBinary(
   writer->SetFileName( outputFileName.c_str() );
   writer->SetInput( dilation->GetOutput() );
   writer->SetUseCompression( useCompression );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end dilationBinary()
@@ -234,6 +238,7 @@ void dilationBinaryObject(
   /** Write the output image. */
   writer->SetFileName( outputFileName.c_str() );
   writer->SetInput( filter->GetOutput() );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end dilationBinaryObject
@@ -289,6 +294,7 @@ void dilationParabolic(
   writer->SetFileName( outputFileName.c_str() );
   writer->SetInput( filter->GetOutput() );
   writer->SetUseCompression( useCompression );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end dilationParabolic()
@@ -1,4 +1,6 @@
 
+#include "ITKToolsTiming.h"
+
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 
@@ -80,6 +82,7 @@ void erosionGrayscale(
   writer->SetFileName( outputFileName.c_str() );
   writer->SetInput( erosion->GetOutput() );
   writer->SetUseCompression( useCompression );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end erosionGrayscale()
@@ -158,6 +161,7 @@ void erosionBinary(
   writer->SetFileName( outputFileName.c_str() );
   writer->SetInput( erosion->GetOutput() );
   writer->SetUseCompression( useCompression );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end erosionBinary()
@@ -240,6 +244,7 @@ void erosionBinaryObject(
   /** Write the output image. */
   writer->SetFileName( outputFileName.c_str() );
   writer->SetInput( erosion->GetOutput() );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end erosionBinaryObject
@@ -295,6 +300,7 @@ void erosionParabolic(
   writer->SetFileName( outputFileName.c_str() );
   writer->SetInput( erosion->GetOutput() );
   writer->SetUseCompression( useCompression );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end erosionParabolic()
@@ -1,4 +1,6 @@
 
+#include "ITKToolsTiming.h"
+
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 
@@ -56,6 +58,7 @@ void gradient(
   writer->SetFileName( outputFileName.c_str() );
   writer->SetInput( filter->GetOutput() );
   writer->SetUseCompression( useCompression );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end gradient()
@@ -1,4 +1,6 @@
 
+#include "ITKToolsTiming.h"
+
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 
@@ -57,6 +59,7 @@ void openingGrayscale(
   writer->SetFileName( outputFileName.c_str() );
   writer->SetInput( opening->GetOutput() );
   writer->SetUseCompression( useCompression );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end openingGrayscale()
@@ -132,6 +135,7 @@ void openingBinary(
   writer->SetFileName( outputFileName.c_str() );
   writer->SetInput( opening->GetOutput() );
   writer->SetUseCompression( useCompression );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end openingBinary()
@@ -186,6 +190,7 @@ void openingParabolic(
   writer->SetFileName( outputFileName.c_str() );
   writer->SetInput( filter->GetOutput() );
   writer->SetUseCompression( useCompression );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end openingParabolic()
@@ -18,6 +18,8 @@
 #ifndef __naryimageoperator_h_
 #define __naryimageoperator_h_
 
+#include "ITKToolsExecutionOptions.h"
+#include "ITKToolsTiming.h"
 #include "itkImage.h"
 #include "itkNaryFunctors.h"
 #include "itkNaryFunctorImageFilter.h"
@@ -134,7 +136,13 @@ public:
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetInput( naryFilter->GetOutput() );
     writer->SetUseCompression( this->m_UseCompression );
-    writer->SetNumberOfStreamDivisions( this->m_NumberOfStreams );
+    readers[ 0 ]->UpdateOutputInformation();
+    const double memoryInBytes = readers[ 0 ]->GetOutput()->GetLargestPossibleRegion().GetNumberOfPixels()
+      * static_cast<double>( this->m_InputFileNames.size() * sizeof( TInputComponentType )
+      + sizeof( TOutputComponentType ) );
+    writer->SetNumberOfStreamDivisions(
+      itktools::GetNumberOfStreamDivisions( memoryInBytes, this->m_NumberOfStreams ) );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
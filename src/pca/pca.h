@@ -19,6 +19,7 @@
 #define __pca_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include <itksys/SystemTools.hxx>
 #include <sstream>
@@ -143,6 +144,7 @@ public:
       writers[ i ] = WriterType::New();
       writers[ i ]->SetFileName( makeFileName.str().c_str() );
       writers[ i ]->SetInput( pcaEstimator->GetOutput( i ) );
+      itktools::AddTimingObservers( writers[ i ] );
       writers[ i ]->Update();
     }
   } // end Run()
@@ -19,6 +19,7 @@
 #define __reflect_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImageFileReader.h"
 #include "itkFlipImageFilter.h"
@@ -92,6 +93,7 @@ public:
 
     /** Set up pipeline. */
     reader->SetFileName( this->m_InputFileName );
+    itktools::ReuseImageIO( reader, this->m_InputFileName );
 
     itk::FixedArray<bool, Dimension> flipAxes(false);
     flipAxes[m_Direction] = true;
@@ -101,6 +103,7 @@ public:
 
     reflectFilter->SetInput( reader->GetOutput() );
     writer->SetInput( reflectFilter->GetOutput() );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
@@ -19,6 +19,7 @@
 #define __replacevoxel_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
@@ -85,6 +86,7 @@ public:
 
     /** Read input image. */
     reader->SetFileName( this->m_InputFileName );
+    itktools::ReuseImageIO( reader, this->m_InputFileName );
     reader->Update();
     typename ImageType::Pointer image = reader->GetOutput();
 
@@ -109,6 +111,7 @@ public:
     /** Write output image. */
     writer->SetFileName( this->m_OutputFileName );
     writer->SetInput( image );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
@@ -19,6 +19,7 @@
 #define __rescaleintensityimagefilter_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImage.h"
 #include "itkImageFileReader.h"
@@ -103,6 +104,7 @@ public:
 
     /** Read in the inputImage. */
     reader->SetFileName( this->m_InputFileName.c_str() );
+    itktools::ReuseImageIO( reader, this->m_InputFileName );
     reader->Update();
 
     // Setup type to disassemble the components
@@ -182,6 +184,7 @@ public:
 
     /** Write the output image. */
     writer->SetFileName( this->m_OutputFileName.c_str() );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
@@ -19,6 +19,7 @@
 #define __reshape_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImageFileReader.h"
 #include "itkReshapeImageToImageFilter.h"
@@ -89,6 +90,7 @@ public:
     /** Reader. */
     typename ReaderType::Pointer reader = ReaderType::New();
     reader->SetFileName( this->m_InputFileName.c_str() );
+    itktools::ReuseImageIO( reader, this->m_InputFileName );
 
     /** Reshaper. */
     typename ReshapeFilterType::Pointer reshaper = ReshapeFilterType::New();
@@ -100,6 +102,7 @@ public:
     typename WriterType::Pointer writer = WriterType::New();
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetInput( reshaper->GetOutput() );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
@@ -0,0 +1,159 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef __itkSeparableResampleImageFilter_h_
+#define __itkSeparableResampleImageFilter_h_
+
+#include "itkImageToImageFilter.h"
+#include <vector>
+
+
+namespace itk
+{
+
+/** \class SeparableResampleImageFilter
+ * \brief Resamples an image to another size and spacing on the same
+ * origin and direction, one axis at a time.
+ *
+ * The result is that of a ResampleImageFilter with an identity transform
+ * and a nearest neighbor (order 0), linear (order 1) or B-spline (order
+ * 2 to 5) interpolator, but the interpolation weights are computed once
+ * per axis into 1D tables, and applied axis after axis. For B-splines
+ * the coefficients are computed per line, just before the weights are
+ * applied, so no coefficient image is built. Lines are processed in
+ * blocks of neighbouring lines, so that the inner loops run over
+ * contiguous memory and can be vectorized. The axes that shrink most
+ * are processed first, to keep the intermediate images small.
+ *
+ * With Antialiasing on, the kernel of every axis that is downsampled is
+ * widened by the downsampling factor: a box for order 0, a triangle for
+ * order 1 and the B-spline of the given order otherwise, applied to the
+ * samples directly and normalized.
+ *
+ * Samples outside the input are zero.
+ *
+ * \ingroup GeometricTransforms
+ * \ingroup Multithreaded
+ */
+
+template < typename TInputImage, typename TOutputImage = TInputImage >
+class ITK_EXPORT SeparableResampleImageFilter:
+    public ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef SeparableResampleImageFilter                      Self;
+  typedef ImageToImageFilter< TInputImage, TOutputImage >   Superclass;
+  typedef SmartPointer<Self>                                Pointer;
+  typedef SmartPointer<const Self>                          ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( SeparableResampleImageFilter, ImageToImageFilter );
+
+  /** Image dimension. */
+  itkStaticConstMacro( ImageDimension, unsigned int, TInputImage::ImageDimension );
+
+  /** Typedefs. */
+  typedef TInputImage                                 InputImageType;
+  typedef typename InputImageType::PixelType          InputPixelType;
+  typedef TOutputImage                                OutputImageType;
+  typedef typename OutputImageType::PixelType         OutputPixelType;
+  typedef typename OutputImageType::SizeType          SizeType;
+  typedef typename OutputImageType::SpacingType       SpacingType;
+  typedef typename OutputImageType::RegionType        OutputImageRegionType;
+  typedef Image< double, ImageDimension >             InternalImageType;
+
+  /** Set/Get the output size. */
+  itkSetMacro( Size, SizeType );
+  itkGetConstReferenceMacro( Size, SizeType );
+
+  /** Set/Get the output spacing. */
+  itkSetMacro( OutputSpacing, SpacingType );
+  itkGetConstReferenceMacro( OutputSpacing, SpacingType );
+
+  /** Set/Get the interpolation order, 0 to 5. Default 1. */
+  itkSetClampMacro( SplineOrder, unsigned int, 0, 5 );
+  itkGetConstMacro( SplineOrder, unsigned int );
+
+  /** Set/Get antialiasing of downsampled axes. Default off. */
+  itkSetMacro( Antialiasing, bool );
+  itkGetConstMacro( Antialiasing, bool );
+  itkBooleanMacro( Antialiasing );
+
+protected:
+  SeparableResampleImageFilter();
+  virtual ~SeparableResampleImageFilter() {};
+
+  /** PrintSelf. */
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** The output has the input origin and direction, and the set size and spacing. */
+  virtual void GenerateOutputInformation( void );
+
+  /** The whole input is needed, and the whole output is produced. */
+  virtual void GenerateInputRequestedRegion( void );
+  virtual void EnlargeOutputRequestedRegion( DataObject * output );
+
+  /** Resample the axes one after the other. */
+  virtual void GenerateData( void );
+
+  /** The 1D weights of one axis: for output sample i the input samples
+   * Indices[ i * Width + t ] are weighted with Weights[ i * Width + t ].
+   * When Prefilter is set, the input lines are first converted to
+   * B-spline coefficients.
+   */
+  struct AxisWeightsType
+  {
+    unsigned int              Width;
+    std::vector<unsigned int> Indices;
+    std::vector<double>       Weights;
+    bool                      Prefilter;
+  };
+
+  /** Compute the weights of an axis. */
+  void ComputeAxisWeights( unsigned int axis, AxisWeightsType & axisWeights ) const;
+
+  /** Resample the buffer source of size sourceSize along axis into
+   * destination, using all threads.
+   */
+  template< class TSource, class TDestination >
+  void ResampleAlongAxis( const TSource * source, TDestination * destination,
+    const SizeType & sourceSize, unsigned int axis, const AxisWeightsType & axisWeights );
+
+private:
+  SeparableResampleImageFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );               // purposely not implemented
+
+  /** Member variables. */
+  SizeType      m_Size;
+  SpacingType   m_OutputSpacing;
+  unsigned int  m_SplineOrder;
+  bool          m_Antialiasing;
+
+}; // end class SeparableResampleImageFilter
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkSeparableResampleImageFilter.txx"
+#endif
+
+#endif // end #ifndef __itkSeparableResampleImageFilter_h_
@@ -0,0 +1,652 @@
+/*=========================================================================
+*
+* Copyright Marius Staring, Stefan Klein, David Doria. 2011.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0.txt
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*
+*=========================================================================*/
+#ifndef _itkSeparableResampleImageFilter_txx_
+#define _itkSeparableResampleImageFilter_txx_
+
+#include "itkSeparableResampleImageFilter.h"
+
+#include "itkMultiThreader.h"
+#include "itkNumericTraits.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace itk
+{
+
+namespace SeparableResample
+{
+
+/** The number of neighbouring lines that are processed together. */
+const unsigned int BlockSize = 64;
+
+
+/**
+ * ******************* BSpline *******************
+ *
+ * The centered B-spline of order p >= 1 at x.
+ */
+
+inline double BSpline( const unsigned int p, const double x )
+{
+  double factorial = 1.0;
+  for( unsigned int k = 2; k <= p; ++k ) factorial *= k;
+
+  double value = 0.0;
+  double binomial = 1.0;
+  for( unsigned int j = 0; j <= p + 1; ++j )
+  {
+    const double y = x + 0.5 * ( p + 1 ) - j;
+    if( y > 0.0 )
+    {
+      value += ( j % 2 ? -1.0 : 1.0 ) * binomial * std::pow( y, static_cast<double>( p ) );
+    }
+    binomial = binomial * ( p + 1 - j ) / ( j + 1 );
+  }
+
+  return value / factorial;
+
+} // end BSpline()
+
+
+/**
+ * ******************* Kernel *******************
+ *
+ * The antialiasing kernel: box, triangle or B-spline.
+ */
+
+inline double Kernel( const unsigned int p, const double x )
+{
+  const double ax = std::abs( x );
+  if( p == 0 ) return ax < 0.5 ? 1.0 : ( ax == 0.5 ? 0.5 : 0.0 );
+  if( p == 1 ) return ax < 1.0 ? 1.0 - ax : 0.0;
+  return BSpline( p, x );
+
+} // end Kernel()
+
+
+/**
+ * ******************* Mirror *******************
+ *
+ * Mirror boundary conditions, as in BSplineInterpolateImageFunction.
+ */
+
+inline unsigned int Mirror( long k, const long n )
+{
+  if( n == 1 ) return 0;
+  const long period = 2 * n - 2;
+  k %= period;
+  if( k < 0 ) k += period;
+  if( k >= n ) k = period - k;
+  return static_cast<unsigned int>( k );
+
+} // end Mirror()
+
+
+/**
+ * ******************* GetPoles *******************
+ *
+ * The poles of the B-spline prefilter, as in BSplineDecompositionImageFilter.
+ */
+
+inline void GetPoles( const unsigned int p, std::vector<double> & poles )
+{
+  poles.clear();
+  switch( p )
+  {
+    case 2:
+      poles.push_back( std::sqrt( 8.0 ) - 3.0 );
+      break;
+    case 3:
+      poles.push_back( std::sqrt( 3.0 ) - 2.0 );
+      break;
+    case 4:
+      poles.push_back( std::sqrt( 664.0 - std::sqrt( 438976.0 ) ) + std::sqrt( 304.0 ) - 19.0 );
+      poles.push_back( std::sqrt( 664.0 + std::sqrt( 438976.0 ) ) - std::sqrt( 304.0 ) - 19.0 );
+      break;
+    case 5:
+      poles.push_back( std::sqrt( 135.0 / 2.0 - std::sqrt( 17745.0 / 4.0 ) )
+        + std::sqrt( 105.0 / 4.0 ) - 13.0 / 2.0 );
+      poles.push_back( std::sqrt( 135.0 / 2.0 + std::sqrt( 17745.0 / 4.0 ) )
+        - std::sqrt( 105.0 / 4.0 ) - 13.0 / 2.0 );
+      break;
+  }
+
+} // end GetPoles()
+
+
+/**
+ * ******************* Prefilter *******************
+ *
+ * Converts a block of count lines of length n, stored interleaved with
+ * stride B, to B-spline coefficients, as in BSplineDecompositionImageFilter.
+ */
+
+inline void Prefilter( double * c, const unsigned int n, const unsigned int B,
+  const unsigned int count, const std::vector<double> & poles )
+{
+  if( n == 1 ) return;
+
+  double lambda = 1.0;
+  for( unsigned int j = 0; j < poles.size(); ++j )
+  {
+    lambda *= ( 1.0 - poles[ j ] ) * ( 1.0 - 1.0 / poles[ j ] );
+  }
+  for( unsigned int k = 0; k < n * B; ++k ) c[ k ] *= lambda;
+
+  const double tolerance = 1e-10;
+  for( unsigned int j = 0; j < poles.size(); ++j )
+  {
+    const double z = poles[ j ];
+
+    /** The initial causal coefficients. */
+    const long horizon = static_cast<long>(
+      std::ceil( std::log( tolerance ) / std::log( std::abs( z ) ) ) );
+    for( unsigned int b = 0; b < count; ++b )
+    {
+      if( horizon < static_cast<long>( n ) )
+      {
+        double zn = z;
+        double sum = c[ b ];
+        for( long k = 1; k < horizon; ++k )
+        {
+          sum += zn * c[ k * B + b ];
+          zn *= z;
+        }
+        c[ b ] = sum;
+      }
+      else
+      {
+        double zn = z;
+        const double iz = 1.0 / z;
+        double z2n = std::pow( z, static_cast<double>( n - 1 ) );
+        double sum = c[ b ] + z2n * c[ ( n - 1 ) * B + b ];
+        z2n *= z2n * iz;
+        for( unsigned int k = 1; k < n - 1; ++k )
+        {
+          sum += ( zn + z2n ) * c[ k * B + b ];
+          zn *= z;
+          z2n *= iz;
+        }
+        c[ b ] = sum / ( 1.0 - zn * zn );
+      }
+    }
+
+    /** The causal recursion. */
+    for( unsigned int k = 1; k < n; ++k )
+    {
+      double * ck = c + k * B;
+      const double * cp = ck - B;
+      for( unsigned int b = 0; b < count; ++b ) ck[ b ] += z * cp[ b ];
+    }
+
+    /** The anticausal recursion. */
+    double * cl = c + ( n - 1 ) * B;
+    const double * cm = cl - B;
+    for( unsigned int b = 0; b < count; ++b )
+    {
+      cl[ b ] = ( z / ( z * z - 1.0 ) ) * ( z * cm[ b ] + cl[ b ] );
+    }
+    for( long k = static_cast<long>( n ) - 2; k >= 0; --k )
+    {
+      double * ck = c + k * B;
+      const double * cn = ck + B;
+      for( unsigned int b = 0; b < count; ++b ) ck[ b ] = z * ( cn[ b ] - ck[ b ] );
+    }
+  }
+
+} // end Prefilter()
+
+
+/**
+ * ******************* CastPixel *******************
+ *
+ * Cast with clamping to the range of the pixel type, like
+ * ResampleImageFilter does.
+ */
+
+template< class T >
+inline T CastPixel( const double value )
+{
+  const double minimum = static_cast<double>( NumericTraits<T>::NonpositiveMin() );
+  const double maximum = static_cast<double>( NumericTraits<T>::max() );
+  if( value < minimum ) return NumericTraits<T>::NonpositiveMin();
+  if( value > maximum ) return NumericTraits<T>::max();
+  return static_cast<T>( value );
+
+} // end CastPixel()
+
+
+/** The data shared by the threads that resample along an axis. */
+template< class TSource, class TDestination, unsigned int VDimension >
+struct ThreadStruct
+{
+  const TSource *       Source;
+  TDestination *        Destination;
+  unsigned long         SourceSize[ VDimension ];
+  unsigned long         SourceStride[ VDimension ];
+  unsigned long         DestinationStride[ VDimension ];
+  unsigned int          Axis;
+  unsigned int          OutputLength;
+  unsigned int          Width;
+  const unsigned int *  Indices;
+  const double *        Weights;
+  std::vector<double>   Poles;
+};
+
+
+/**
+ * ******************* ThreaderCallback *******************
+ *
+ * The lines along the axis are grouped in blocks of neighbouring lines
+ * along axis 0, which is contiguous in memory; lines along axis 0 are
+ * processed one at a time. Every thread takes a contiguous range of blocks.
+ */
+
+template< class TSource, class TDestination, unsigned int VDimension >
+ITK_THREAD_RETURN_TYPE ThreaderCallback( void * arg )
+{
+  typedef ThreadStruct<TSource, TDestination, VDimension> StructType;
+  MultiThreader::ThreadInfoStruct * info
+    = static_cast<MultiThreader::ThreadInfoStruct *>( arg );
+  const StructType & str = *static_cast<StructType *>( info->UserData );
+
+  const unsigned int axis = str.Axis;
+  const unsigned int n = str.SourceSize[ axis ];
+  const unsigned int m = str.OutputLength;
+  const unsigned int width = str.Width;
+  const unsigned long size0 = axis == 0 ? 1 : str.SourceSize[ 0 ];
+  const unsigned int B = axis == 0 ? 1 : static_cast<unsigned int>(
+    std::min<unsigned long>( BlockSize, size0 ) );
+  const unsigned long blocksPerRow = ( size0 + B - 1 ) / B;
+
+  /** The rows enumerate the axes other than the resampled axis and axis 0. */
+  unsigned long numberOfRows = 1;
+  for( unsigned int k = 1; k < VDimension; ++k )
+  {
+    if( k != axis ) numberOfRows *= str.SourceSize[ k ];
+  }
+  const unsigned long numberOfBlocks = numberOfRows * blocksPerRow;
+  const unsigned long blocksPerThread
+    = ( numberOfBlocks + info->NumberOfThreads - 1 ) / info->NumberOfThreads;
+  const unsigned long firstBlock = info->ThreadID * blocksPerThread;
+  const unsigned long lastBlock = std::min( firstBlock + blocksPerThread, numberOfBlocks );
+
+  std::vector<double> in( n * B );
+  std::vector<double> out( m * B );
+
+  for( unsigned long block = firstBlock; block < lastBlock; ++block )
+  {
+    /** Locate the block. */
+    unsigned long row = block / blocksPerRow;
+    const unsigned long x0 = ( block % blocksPerRow ) * B;
+    const unsigned int count = static_cast<unsigned int>( std::min<unsigned long>( B, size0 - x0 ) );
+    unsigned long sourceBase = x0;
+    unsigned long destinationBase = x0;
+    for( unsigned int k = 1; k < VDimension; ++k )
+    {
+      if( k == axis ) continue;
+      const unsigned long index = row % str.SourceSize[ k ];
+      row /= str.SourceSize[ k ];
+      sourceBase += index * str.SourceStride[ k ];
+      destinationBase += index * str.DestinationStride[ k ];
+    }
+
+    /** Gather the lines. */
+    const TSource * source = str.Source + sourceBase;
+    const unsigned long sourceStride = str.SourceStride[ axis ];
+    for( unsigned int k = 0; k < n; ++k )
+    {
+      const TSource * s = source + k * sourceStride;
+      double * line = &in[ k * B ];
+      for( unsigned int b = 0; b < count; ++b ) line[ b ] = static_cast<double>( s[ b ] );
+    }
+
+    /** Convert to B-spline coefficients. */
+    if( !str.Poles.empty() ) Prefilter( &in[ 0 ], n, B, count, str.Poles );
+
+    /** Apply the weights. */
+    std::fill( out.begin(), out.end(), 0.0 );
+    for( unsigned int i = 0; i < m; ++i )
+    {
+      double * o = &out[ i * B ];
+      const unsigned int * indices = str.Indices + i * width;
+      const double * weights = str.Weights + i * width;
+      for( unsigned int t = 0; t < width; ++t )
+      {
+        const double w = weights[ t ];
+        if( w == 0.0 ) continue;
+        const double * line = &in[ indices[ t ] * B ];
+        for( unsigned int b = 0; b < count; ++b ) o[ b ] += w * line[ b ];
+      }
+    }
+
+    /** Scatter the result. */
+    TDestination * destination = str.Destination + destinationBase;
+    const unsigned long destinationStride = str.DestinationStride[ axis ];
+    for( unsigned int i = 0; i < m; ++i )
+    {
+      TDestination * d = destination + i * destinationStride;
+      const double * o = &out[ i * B ];
+      for( unsigned int b = 0; b < count; ++b ) d[ b ] = CastPixel<TDestination>( o[ b ] );
+    }
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ThreaderCallback()
+
+} // end namespace SeparableResample
+
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template <typename TInputImage, typename TOutputImage>
+SeparableResampleImageFilter<TInputImage, TOutputImage>
+::SeparableResampleImageFilter()
+{
+  this->m_Size.Fill( 0 );
+  this->m_OutputSpacing.Fill( 1.0 );
+  this->m_SplineOrder = 1;
+  this->m_Antialiasing = false;
+
+} // end Constructor
+
+
+/**
+ * ******************* GenerateOutputInformation *******************
+ */
+
+template <typename TInputImage, typename TOutputImage>
+void
+SeparableResampleImageFilter<TInputImage, TOutputImage>
+::GenerateOutputInformation( void )
+{
+  /** Copy the origin and direction. */
+  Superclass::GenerateOutputInformation();
+
+  OutputImageRegionType region;
+  region.SetIndex( this->GetInput()->GetLargestPossibleRegion().GetIndex() );
+  region.SetSize( this->m_Size );
+
+  OutputImageType * output = this->GetOutput();
+  output->SetLargestPossibleRegion( region );
+  output->SetSpacing( this->m_OutputSpacing );
+
+} // end GenerateOutputInformation()
+
+
+/**
+ * ******************* GenerateInputRequestedRegion *******************
+ */
+
+template <typename TInputImage, typename TOutputImage>
+void
+SeparableResampleImageFilter<TInputImage, TOutputImage>
+::GenerateInputRequestedRegion( void )
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType * input = const_cast<InputImageType *>( this->GetInput() );
+  if( input ) input->SetRequestedRegionToLargestPossibleRegion();
+
+} // end GenerateInputRequestedRegion()
+
+
+/**
+ * ******************* EnlargeOutputRequestedRegion *******************
+ */
+
+template <typename TInputImage, typename TOutputImage>
+void
+SeparableResampleImageFilter<TInputImage, TOutputImage>
+::EnlargeOutputRequestedRegion( DataObject * output )
+{
+  Superclass::EnlargeOutputRequestedRegion( output );
+  output->SetRequestedRegionToLargestPossibleRegion();
+
+} // end EnlargeOutputRequestedRegion()
+
+
+/**
+ * ******************* ComputeAxisWeights *******************
+ */
+
+template <typename TInputImage, typename TOutputImage>
+void
+SeparableResampleImageFilter<TInputImage, TOutputImage>
+::ComputeAxisWeights( unsigned int axis, AxisWeightsType & axisWeights ) const
+{
+  const InputImageType * input = this->GetInput();
+  const long n = input->GetLargestPossibleRegion().GetSize()[ axis ];
+  const long start = input->GetLargestPossibleRegion().GetIndex()[ axis ];
+  const unsigned int m = this->m_Size[ axis ];
+  const unsigned int p = this->m_SplineOrder;
+
+  /** The step in input samples per output sample. */
+  const double ratio = this->m_OutputSpacing[ axis ] / input->GetSpacing()[ axis ];
+  const bool antialias = this->m_Antialiasing && ratio > 1.0;
+  const double radius = ( p == 0 ? 0.5 : 0.5 * ( p + 1 ) ) * ratio;
+
+  axisWeights.Prefilter = !antialias && p > 1;
+  if( antialias ) axisWeights.Width = static_cast<unsigned int>( std::floor( 2.0 * radius ) ) + 2;
+  else axisWeights.Width = p + 1;
+  const unsigned int width = axisWeights.Width;
+  axisWeights.Indices.assign( m * width, 0 );
+  axisWeights.Weights.assign( m * width, 0.0 );
+
+  for( unsigned int i = 0; i < m; ++i )
+  {
+    /** The continuous index in the input buffer. Outside, the weights stay zero. */
+    const double x = ( start + i ) * ratio - start;
+    if( x < -0.5 || x >= n - 0.5 ) continue;
+
+    unsigned int * indices = &axisWeights.Indices[ i * width ];
+    double * weights = &axisWeights.Weights[ i * width ];
+    if( antialias )
+    {
+      const long first = static_cast<long>( std::ceil( x - radius ) );
+      const long last = static_cast<long>( std::floor( x + radius ) );
+      double sum = 0.0;
+      for( long k = first, t = 0; k <= last && t < static_cast<long>( width ); ++k, ++t )
+      {
+        indices[ t ] = static_cast<unsigned int>( std::min( std::max( k, 0L ), n - 1 ) );
+        weights[ t ] = SeparableResample::Kernel( p, ( k - x ) / ratio );
+        sum += weights[ t ];
+      }
+      if( sum > 0.0 )
+      {
+        for( unsigned int t = 0; t < width; ++t ) weights[ t ] /= sum;
+      }
+    }
+    else if( p == 0 )
+    {
+      /** Nearest neighbor, rounding half up. */
+      const long k = static_cast<long>( std::floor( x + 0.5 ) );
+      indices[ 0 ] = static_cast<unsigned int>( std::min( std::max( k, 0L ), n - 1 ) );
+      weights[ 0 ] = 1.0;
+    }
+    else if( p == 1 )
+    {
+      /** Linear, with the neighbours clamped to the image. */
+      const long k = static_cast<long>( std::floor( x ) );
+      const double f = x - k;
+      indices[ 0 ] = static_cast<unsigned int>( std::min( std::max( k, 0L ), n - 1 ) );
+      indices[ 1 ] = static_cast<unsigned int>( std::min( std::max( k + 1, 0L ), n - 1 ) );
+      weights[ 0 ] = 1.0 - f;
+      weights[ 1 ] = f;
+    }
+    else
+    {
+      /** B-spline, with mirror boundary conditions. */
+      const long first = static_cast<long>( p % 2 ? std::floor( x ) : std::floor( x + 0.5 ) )
+        - static_cast<long>( p / 2 );
+      for( unsigned int t = 0; t <= p; ++t )
+      {
+        indices[ t ] = SeparableResample::Mirror( first + t, n );
+        weights[ t ] = SeparableResample::BSpline( p, x - ( first + t ) );
+      }
+    }
+  }
+
+} // end ComputeAxisWeights()
+
+
+/**
+ * ******************* ResampleAlongAxis *******************
+ */
+
+template <typename TInputImage, typename TOutputImage>
+template< class TSource, class TDestination >
+void
+SeparableResampleImageFilter<TInputImage, TOutputImage>
+::ResampleAlongAxis( const TSource * source, TDestination * destination,
+  const SizeType & sourceSize, unsigned int axis, const AxisWeightsType & axisWeights )
+{
+  typedef SeparableResample::ThreadStruct<
+    TSource, TDestination, ImageDimension>          StructType;
+
+  StructType str;
+  str.Source = source;
+  str.Destination = destination;
+  str.Axis = axis;
+  str.OutputLength = this->m_Size[ axis ];
+  str.Width = axisWeights.Width;
+  str.Indices = &axisWeights.Indices[ 0 ];
+  str.Weights = &axisWeights.Weights[ 0 ];
+  if( axisWeights.Prefilter ) SeparableResample::GetPoles( this->m_SplineOrder, str.Poles );
+
+  unsigned long sourceStride = 1;
+  unsigned long destinationStride = 1;
+  for( unsigned int k = 0; k < ImageDimension; ++k )
+  {
+    str.SourceSize[ k ] = sourceSize[ k ];
+    str.SourceStride[ k ] = sourceStride;
+    str.DestinationStride[ k ] = destinationStride;
+    sourceStride *= sourceSize[ k ];
+    destinationStride *= k == axis ? this->m_Size[ k ] : sourceSize[ k ];
+  }
+
+  MultiThreader * threader = this->GetMultiThreader();
+  threader->SetNumberOfThreads( this->GetNumberOfThreads() );
+  threader->SetSingleMethod(
+    SeparableResample::ThreaderCallback<TSource, TDestination, ImageDimension>, &str );
+  threader->SingleMethodExecute();
+
+} // end ResampleAlongAxis()
+
+
+/**
+ * ******************* GenerateData *******************
+ */
+
+template <typename TInputImage, typename TOutputImage>
+void
+SeparableResampleImageFilter<TInputImage, TOutputImage>
+::GenerateData( void )
+{
+  this->AllocateOutputs();
+
+  const InputImageType * input = this->GetInput();
+  OutputImageType * output = this->GetOutput();
+  SizeType size = input->GetLargestPossibleRegion().GetSize();
+
+  /** Process the axes that shrink most first. */
+  std::vector< std::pair<double, unsigned int> > order;
+  for( unsigned int k = 0; k < ImageDimension; ++k )
+  {
+    order.push_back( std::make_pair(
+      static_cast<double>( this->m_Size[ k ] ) / size[ k ], k ) );
+  }
+  std::sort( order.begin(), order.end() );
+
+  typename InternalImageType::Pointer current;
+  for( unsigned int pass = 0; pass < ImageDimension; ++pass )
+  {
+    const unsigned int axis = order[ pass ].second;
+    const bool first = pass == 0;
+    const bool last = pass == ImageDimension - 1;
+
+    AxisWeightsType axisWeights;
+    this->ComputeAxisWeights( axis, axisWeights );
+
+    SizeType nextSize = size;
+    nextSize[ axis ] = this->m_Size[ axis ];
+    typename InternalImageType::Pointer next;
+    if( !last )
+    {
+      typename InternalImageType::RegionType region;
+      region.SetSize( nextSize );
+      next = InternalImageType::New();
+      next->SetRegions( region );
+      next->Allocate();
+    }
+
+    if( first && last )
+    {
+      this->ResampleAlongAxis( input->GetBufferPointer(),
+        output->GetBufferPointer(), size, axis, axisWeights );
+    }
+    else if( first )
+    {
+      this->ResampleAlongAxis( input->GetBufferPointer(),
+        next->GetBufferPointer(), size, axis, axisWeights );
+    }
+    else if( last )
+    {
+      this->ResampleAlongAxis( current->GetBufferPointer(),
+        output->GetBufferPointer(), size, axis, axisWeights );
+    }
+    else
+    {
+      this->ResampleAlongAxis( current->GetBufferPointer(),
+        next->GetBufferPointer(), size, axis, axisWeights );
+    }
+
+    current = next;
+    size = nextSize;
+    this->UpdateProgress( static_cast<float>( pass + 1 ) / ImageDimension );
+  }
+
+} // end GenerateData()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template <typename TInputImage, typename TOutputImage>
+void
+SeparableResampleImageFilter<TInputImage, TOutputImage>
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Size: " << this->m_Size << std::endl;
+  os << indent << "OutputSpacing: " << this->m_OutputSpacing << std::endl;
+  os << indent << "SplineOrder: " << this->m_SplineOrder << std::endl;
+  os << indent << "Antialiasing: " << this->m_Antialiasing << std::endl;
+
+} // end PrintSelf()
+
+} // end namespace itk
+
+#endif // end #ifndef _itkSeparableResampleImageFilter_txx_
@@ -44,7 +44,9 @@ std::string GetHelpString( void )
     << "  [-f]     resize factor\n"
     << "  [-sp]    output spacing\n"
     << "  [-sz]    output size\n"
-    << "  [-io]    interpolation order, default 1\n"
+    << "  [-io]    interpolation order, 0 to 5, default 1\n"
+    << "  [-aa]    antialiasing: when downsampling, widen the interpolation kernel\n"
+    << "           by the downsampling factor\n"
     << "One of {-f, -sp, -sz} should be given.\n"
     << "Supported: 2D, 3D, (unsigned) char, (unsigned) short, (unsigned) int, (unsigned) long, float, double.";
 
@@ -102,6 +104,13 @@ int main( int argc, char **argv )
 
   unsigned int interpolationOrder = 1;
   parser->GetCommandLineArgument( "-io", interpolationOrder );
+  if( interpolationOrder > 5 )
+  {
+    std::cout << "ERROR: The interpolation order should be at most 5." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const bool antialiasing = parser->ArgumentExists( "-aa" );
 
   /** Determine image properties. */
   itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
@@ -198,6 +207,7 @@ int main( int argc, char **argv )
     filter->m_OutputSpacing = outputSpacing;
     filter->m_OutputSize = outputSize;
     filter->m_InterpolationOrder = interpolationOrder;
+    filter->m_Antialiasing = antialiasing;
 
     filter->Run();
 
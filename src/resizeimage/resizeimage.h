@@ -19,11 +19,10 @@
 #define __resizeimage_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImage.h"
-#include "itkResampleImageFilter.h"
-#include "itkNearestNeighborInterpolateImageFunction.h"
-#include "itkBSplineInterpolateImageFunction.h"
+#include "itkSeparableResampleImageFilter.h"
 
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
@@ -45,6 +44,7 @@ public:
     this->m_OutputFileName = "";
     this->m_ResizingSpecifiedBy = "";
     this->m_InterpolationOrder = 0;
+    this->m_Antialiasing = false;
   };
   /** Destructor. */
   ~ITKToolsResizeImageBase(){};
@@ -57,6 +57,7 @@ public:
   std::vector<double> m_OutputSpacing;
   std::vector<unsigned int> m_OutputSize;
   unsigned int m_InterpolationOrder;
+  bool m_Antialiasing;
 
 }; // end class ITKToolsResizeImageBase
 
@@ -83,13 +84,10 @@ public:
   {
     /** Typedefs. */
     typedef itk::Image<TComponentType, VDimension>      InputImageType;
-    typedef itk::ResampleImageFilter< InputImageType, InputImageType >  ResamplerType;
+    typedef itk::SeparableResampleImageFilter<
+      InputImageType, InputImageType >                  ResamplerType;
     typedef itk::ImageFileReader< InputImageType >      ReaderType;
     typedef itk::ImageFileWriter< InputImageType >      WriterType;
-    typedef itk::NearestNeighborInterpolateImageFunction<
-      InputImageType, double >                          NNInterpolatorType;
-    typedef itk::BSplineInterpolateImageFunction<
-      InputImageType >                                  BSplineInterpolatorType;
 
     typedef typename InputImageType::SizeType         SizeType;
     typedef typename InputImageType::SpacingType      SpacingType;
@@ -101,13 +99,10 @@ public:
     typename ResamplerType::Pointer resampler = ResamplerType::New();
     typename ReaderType::Pointer reader = ReaderType::New();
     typename WriterType::Pointer writer = WriterType::New();
-    typename NNInterpolatorType::Pointer nnInterpolator
-      = NNInterpolatorType::New();
-    typename BSplineInterpolatorType::Pointer bsInterpolator
-      = BSplineInterpolatorType::New();
 
     /** Read in the inputImage. */
     reader->SetFileName( this->m_InputFileName.c_str() );
+    itktools::ReuseImageIO( reader, this->m_InputFileName );
     inputImage = reader->GetOutput();
     inputImage->Update();
 
@@ -142,31 +137,20 @@ public:
       }
     }
 
-    /** Setup the pipeline. */
+    /** Setup the pipeline. The resampler keeps the origin and direction
+     * and interpolates one axis at a time: nearest neighbor for order 0,
+     * linear for order 1 and B-spline otherwise.
+     */
     resampler->SetInput( inputImage );
     resampler->SetSize( outputSize );
-    resampler->SetDefaultPixelValue( 0 );
-    resampler->SetOutputStartIndex( inputImage->GetLargestPossibleRegion().GetIndex() );
     resampler->SetOutputSpacing( outputSpacing );
-    resampler->SetOutputOrigin( inputImage->GetOrigin() );
-    resampler->SetOutputDirection( inputImage->GetDirection() );
-
-    /* The interpolator: the resampler has by default a
-     * LinearInterpolateImageFunction as interpolator.
-     */
-    if( this->m_InterpolationOrder == 0 )
-    {
-      resampler->SetInterpolator( nnInterpolator );
-    }
-    else if( this->m_InterpolationOrder > 1 )
-    {
-      bsInterpolator->SetSplineOrder( this->m_InterpolationOrder );
-      resampler->SetInterpolator( bsInterpolator );
-    }
+    resampler->SetSplineOrder( this->m_InterpolationOrder );
+    resampler->SetAntialiasing( this->m_Antialiasing );
 
     /** Write the output image. */
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetInput( resampler->GetOutput() );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
@@ -19,6 +19,7 @@
 #define __segmentationdistance_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImage.h"
 #include "itkExceptionObject.h"
@@ -282,7 +283,9 @@ public:
 
       std::cout << "The spherical transforms are skipped and the results are written as:\n\t"
         << outputFileNameDIST << "\n\t"  << outputFileNameEDGE << std::endl;
+      itktools::AddTimingObservers( writerDistCartesian );
       writerDistCartesian->Update();
+      itktools::AddTimingObservers( writerEdgeCartesian );
       writerEdgeCartesian->Update();
 
       return;
@@ -338,6 +341,7 @@ public:
     /** Write the output image. */
     writer->SetInput( extracter->GetOutput() );
     writer->SetFileName( this->m_OutputFileName.c_str() );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
@@ -19,6 +19,7 @@
 #define __splitsegmentation_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImage.h"
 #include "itkImageFileReader.h"
@@ -99,6 +100,7 @@ public:
 
     /** Read in the input segmentation. */
     reader->SetFileName( this->m_InputFileName.c_str() );
+    itktools::ReuseImageIO( reader, this->m_InputFileName );
 
     /** Setup the filter. */
     filter->SetInput( reader->GetOutput() );
@@ -109,6 +111,7 @@ public:
     /** Write the output image. */
     writer->SetInput( filter->GetOutput() );
     writer->SetFileName( this->m_OutputFileName.c_str() );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
@@ -100,6 +100,7 @@ ITKToolsStatisticsOnImage< VDimension, VNumberOfComponents, TComponentType >
     typename InternalScalarReaderType::Pointer reader
       = InternalScalarReaderType::New();
     reader->SetFileName( this->m_InputFileName.c_str() );
+    itktools::ReuseImageIO( reader, this->m_InputFileName );
     reader->Update();
 
     /** Call the generic ComputeStatistics function. */
@@ -120,6 +121,7 @@ ITKToolsStatisticsOnImage< VDimension, VNumberOfComponents, TComponentType >
 
     typename VectorReaderType::Pointer reader = VectorReaderType::New();
     reader->SetFileName( this->m_InputFileName.c_str() );
+    itktools::ReuseImageIO( reader, this->m_InputFileName );
 
     typename MagnitudeFilterType::Pointer magnitudeFilter = MagnitudeFilterType::New();
     magnitudeFilter->SetInput( reader->GetOutput() );
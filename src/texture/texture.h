@@ -19,6 +19,7 @@
 #define __texture_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include <itksys/SystemTools.hxx>
 
@@ -107,6 +108,7 @@ public:
     /** Read the input. */
     typename ReaderType::Pointer reader = ReaderType::New();
     reader->SetFileName( this->m_InputFileName.c_str() );
+    itktools::ReuseImageIO( reader, this->m_InputFileName );
 
     /** Setup the filter filter. */
     typename TextureFilterType::Pointer textureFilter = TextureFilterType::New();
@@ -141,6 +143,7 @@ public:
       typename WriterType::Pointer writer = WriterType::New();
       writer->SetFileName( outputFileNames[ i ].c_str() );
       writer->SetInput( textureFilter->GetOutput( i ) );
+      itktools::AddTimingObservers( writer );
       writer->Update();
     }
   } // end Run()
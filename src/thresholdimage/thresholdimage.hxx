@@ -18,6 +18,8 @@
 #ifndef __thresholdimage_hxx_
 #define __thresholdimage_hxx_
 
+#include "ITKToolsTiming.h"
+
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
 
@@ -79,6 +81,7 @@ ITKToolsThresholdImage< VDimension, TComponentType >
   writer->SetInput( thresholder->GetOutput() );
   writer->SetFileName( outputFileName.c_str() );
   writer->SetUseCompression( useCompression );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end ThresholdImage()
@@ -138,6 +141,7 @@ ITKToolsThresholdImage< VDimension, TComponentType >
   writer->SetInput( thresholder->GetOutput() );
   writer->SetFileName( outputFileName.c_str() );
   writer->SetUseCompression( useCompression );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end OtsuThresholdImage()
@@ -199,6 +203,7 @@ ITKToolsThresholdImage< VDimension, TComponentType >
   writer->SetInput( thresholder->GetOutput() );
   writer->SetFileName( outputFileName.c_str() );
   writer->SetUseCompression( useCompression );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end OtsuMultipleThresholdImage()
@@ -315,6 +320,7 @@ ITKToolsThresholdImage< VDimension, TComponentType >
   writer->SetInput( thresholder->GetOutput() );
   writer->SetFileName( outputFileName.c_str() );
   writer->SetUseCompression( useCompression );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end RobustAutomaticThresholdImage()
@@ -375,6 +381,7 @@ ITKToolsThresholdImage< VDimension, TComponentType >
   writer->SetInput( thresholder->GetOutput() );
   writer->SetFileName( outputFileName.c_str() );
   writer->SetUseCompression( useCompression );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end KappaSigmaThresholdImage()
@@ -427,6 +434,7 @@ ITKToolsThresholdImage< VDimension, TComponentType >
   writer->SetInput( thresholder->GetOutput() );
   writer->SetFileName( outputFileName.c_str() );
   writer->SetUseCompression( useCompression );
+  itktools::AddTimingObservers( writer );
   writer->Update();
 
 } // end MinErrorThresholdImage()
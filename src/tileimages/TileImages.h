@@ -19,10 +19,16 @@
 #define __TileImages_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsExecutionOptions.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImageFileReader.h"
 #include "itkTileImageFilter.h"
+#include "itkChangeInformationImageFilter.h"
+#include "itkConstantPadImageFilter.h"
 #include "itkImageFileWriter.h"
+#include "itkImageIOFactory.h"
+#include "itkImageIORegion.h"
 
 
 /** \class ITKToolsTileImagesBase
@@ -39,6 +45,7 @@ public:
   {
     this->m_OutputFileName = "";
     this->m_Defaultvalue = 0.0;
+    this->m_Stream = false;
   };
   /** Destructor. */
   ~ITKToolsTileImagesBase(){};
@@ -48,6 +55,7 @@ public:
   std::string               m_OutputFileName;
   std::vector<unsigned int> m_Layout;
   double                    m_Defaultvalue;
+  bool                      m_Stream;
 
 }; // end class ITKToolsTileImagesBase
 
@@ -69,14 +77,32 @@ public:
   ITKToolsTileImages(){};
   ~ITKToolsTileImages(){};
 
+  /** Some typedef's. */
+  typedef itk::Image<TComponentType, VDimension>      ImageType;
+  typedef typename ImageType::RegionType              RegionType;
+  typedef typename ImageType::SizeType                SizeType;
+  typedef typename ImageType::IndexType               IndexType;
+  typedef itk::ImageFileReader<ImageType>             ImageReaderType;
+  typedef itk::TileImageFilter<ImageType, ImageType>  TilerType;
+  typedef itk::ImageFileWriter<ImageType>             ImageWriterType;
+
   /** Run function. */
   void Run( void )
   {
-  /** Some typedef's. */
-    typedef itk::Image<TComponentType, VDimension>      ImageType;
-    typedef itk::ImageFileReader<ImageType>             ImageReaderType;
-    typedef itk::TileImageFilter<ImageType, ImageType>  TilerType;
-    typedef itk::ImageFileWriter<ImageType>             ImageWriterType;
+    /** Streaming requires an output format that supports pasting. */
+    if( this->m_Stream )
+    {
+      itk::ImageIOBase::Pointer outputIO = itk::ImageIOFactory::CreateImageIO(
+        this->m_OutputFileName.c_str(), itk::ImageIOFactory::WriteMode );
+      if( outputIO.IsNotNull() && outputIO->CanStreamWrite() )
+      {
+        this->RunStreaming();
+        return;
+      }
+      std::cerr << "WARNING: the format of \"" << this->m_OutputFileName
+        << "\" does not support streamed writing, tiling in memory instead."
+        << std::endl;
+    }
 
     /** Copy layout into a fixed array. */
     itk::FixedArray< unsigned int, VDimension > Layout;
@@ -106,10 +132,195 @@ public:
     typename ImageWriterType::Pointer writer = ImageWriterType::New();
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetInput( tiler->GetOutput() );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   }// end Run()
 
+
+  /** Tile without holding all inputs in memory. The output layout is
+   * computed from the image headers. The first input, padded with the
+   * default value to the output size, is written slice by slice, after
+   * which every other input is read in turn and pasted into its region
+   * of the output file. Peak memory is one input plus one output slice.
+   */
+  void RunStreaming( void )
+  {
+    typedef itk::ChangeInformationImageFilter<ImageType>  ChangeInfoType;
+    typedef itk::ConstantPadImageFilter<ImageType, ImageType> PadderType;
+
+    const unsigned int numberOfInputs = this->m_InputFileNames.size();
+
+    /** Get the tile regions and the output size from the headers. */
+    std::vector<RegionType> tiles;
+    SizeType outputSize;
+    this->ComputeTileRegions( tiles, outputSize );
+
+    /** The output geometry is that of the first input. */
+    typename ImageReaderType::Pointer firstReader = ImageReaderType::New();
+    firstReader->SetFileName( this->m_InputFileNames[ 0 ].c_str() );
+    firstReader->UpdateOutputInformation();
+    const typename ImageType::PointType origin = firstReader->GetOutput()->GetOrigin();
+    const typename ImageType::SpacingType spacing = firstReader->GetOutput()->GetSpacing();
+    const typename ImageType::DirectionType direction = firstReader->GetOutput()->GetDirection();
+
+    const TComponentType defaultValue = static_cast<TComponentType>( this->m_Defaultvalue );
+
+    double outputBytes = sizeof( TComponentType );
+    for( unsigned int d = 0; d < VDimension; ++d ) outputBytes *= outputSize[ d ];
+
+    for( unsigned int i = 0; i < numberOfInputs; ++i )
+    {
+      const SizeType tileSize = tiles[ i ].GetSize();
+      const IndexType tileIndex = tiles[ i ].GetIndex();
+
+      typename ImageReaderType::Pointer reader = ImageReaderType::New();
+      reader->SetFileName( this->m_InputFileNames[ i ].c_str() );
+
+      /** Place the input such that the padded image has the output geometry. */
+      typename ImageType::PointType tileOrigin = origin;
+      for( unsigned int r = 0; r < VDimension; ++r )
+      {
+        for( unsigned int c = 0; c < VDimension; ++c )
+        {
+          tileOrigin[ r ] += direction[ r ][ c ] * spacing[ c ] * tileIndex[ c ];
+        }
+      }
+      typename ChangeInfoType::Pointer changer = ChangeInfoType::New();
+      changer->SetInput( reader->GetOutput() );
+      changer->SetOutputOrigin( tileOrigin );
+      changer->SetOutputSpacing( spacing );
+      changer->SetOutputDirection( direction );
+      changer->ChangeOriginOn();
+      changer->ChangeSpacingOn();
+      changer->ChangeDirectionOn();
+
+      /** Pad to the output size. Only the tile region is requested when
+       * pasting, so the padding is then never generated.
+       */
+      SizeType lowerBound, upperBound;
+      for( unsigned int d = 0; d < VDimension; ++d )
+      {
+        lowerBound[ d ] = tileIndex[ d ];
+        upperBound[ d ] = outputSize[ d ] - tileIndex[ d ] - tileSize[ d ];
+      }
+      typename PadderType::Pointer padder = PadderType::New();
+      padder->SetInput( changer->GetOutput() );
+      padder->SetPadLowerBound( lowerBound );
+      padder->SetPadUpperBound( upperBound );
+      padder->SetConstant( defaultValue );
+
+      typename ImageWriterType::Pointer writer = ImageWriterType::New();
+      writer->SetFileName( this->m_OutputFileName.c_str() );
+      writer->SetInput( padder->GetOutput() );
+      if( i == 0 )
+      {
+        /** Create the output file, filled with the default value. */
+        writer->SetNumberOfStreamDivisions( itktools::GetNumberOfStreamDivisions(
+          outputBytes, outputSize[ VDimension - 1 ] ) );
+      }
+      else
+      {
+        /** Paste into the existing output file. */
+        itk::ImageIORegion ioRegion( VDimension );
+        for( unsigned int d = 0; d < VDimension; ++d )
+        {
+          ioRegion.SetIndex( d, tileIndex[ d ] );
+          ioRegion.SetSize( d, tileSize[ d ] );
+        }
+        writer->SetIORegion( ioRegion );
+      }
+      itktools::AddTimingObservers( writer );
+      writer->Update();
+    }
+
+  } // end RunStreaming()
+
+
+  /** Compute the region of every input in the output, like
+   * itk::TileImageFilter does, but from the image headers only: the
+   * extent of a row of tiles along a dimension is the largest extent of
+   * the inputs in that row. A zero in the layout is replaced by the
+   * number of tiles needed to hold all inputs.
+   */
+  void ComputeTileRegions( std::vector<RegionType> & tiles, SizeType & outputSize )
+  {
+    const unsigned int numberOfInputs = this->m_InputFileNames.size();
+
+    /** Complete the layout. */
+    std::vector<unsigned int> layout( this->m_Layout.begin(),
+      this->m_Layout.begin() + VDimension );
+    unsigned int used = 1;
+    for( unsigned int d = 0; d < VDimension; ++d )
+    {
+      if( layout[ d ] > 0 ) used *= layout[ d ];
+    }
+    for( unsigned int d = 0; d < VDimension; ++d )
+    {
+      if( layout[ d ] == 0 )
+      {
+        layout[ d ] = ( numberOfInputs + used - 1 ) / used;
+        used *= layout[ d ];
+      }
+    }
+    if( used < numberOfInputs )
+    {
+      itkGenericExceptionMacro( << "The layout holds " << used
+        << " images, while " << numberOfInputs << " are given." );
+    }
+
+    /** Read the sizes and find the extent of every row of tiles. */
+    std::vector<SizeType> sizes( numberOfInputs );
+    std::vector<IndexType> positions( numberOfInputs );
+    std::vector< std::vector<unsigned long> > extents( VDimension );
+    for( unsigned int d = 0; d < VDimension; ++d )
+    {
+      extents[ d ].resize( layout[ d ], 0 );
+    }
+    for( unsigned int i = 0; i < numberOfInputs; ++i )
+    {
+      typename ImageReaderType::Pointer reader = ImageReaderType::New();
+      reader->SetFileName( this->m_InputFileNames[ i ].c_str() );
+      reader->UpdateOutputInformation();
+      sizes[ i ] = reader->GetOutput()->GetLargestPossibleRegion().GetSize();
+
+      unsigned int rest = i;
+      for( unsigned int d = 0; d < VDimension; ++d )
+      {
+        positions[ i ][ d ] = rest % layout[ d ];
+        rest /= layout[ d ];
+        unsigned long & extent = extents[ d ][ positions[ i ][ d ] ];
+        if( sizes[ i ][ d ] > extent ) extent = sizes[ i ][ d ];
+      }
+    }
+
+    /** Convert the extents to offsets. */
+    std::vector< std::vector<unsigned long> > offsets( VDimension );
+    for( unsigned int d = 0; d < VDimension; ++d )
+    {
+      offsets[ d ].resize( layout[ d ] + 1, 0 );
+      for( unsigned int t = 0; t < layout[ d ]; ++t )
+      {
+        offsets[ d ][ t + 1 ] = offsets[ d ][ t ] + extents[ d ][ t ];
+      }
+      outputSize[ d ] = offsets[ d ][ layout[ d ] ];
+    }
+
+    /** The regions. */
+    tiles.resize( numberOfInputs );
+    for( unsigned int i = 0; i < numberOfInputs; ++i )
+    {
+      IndexType index;
+      for( unsigned int d = 0; d < VDimension; ++d )
+      {
+        index[ d ] = offsets[ d ][ positions[ i ][ d ] ];
+      }
+      tiles[ i ].SetIndex( index );
+      tiles[ i ].SetSize( sizes[ i ] );
+    }
+
+  } // end ComputeTileRegions()
+
 }; // end class ITKToolsTileImages
 
 #endif
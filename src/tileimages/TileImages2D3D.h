@@ -19,9 +19,19 @@
 #define __TileImages2D3D_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsExecutionOptions.h"
+#include "ITKToolsTiming.h"
 
-#include "itkImageSeriesReader.h"
+#include "itkImageFileReader.h"
+#include "itkConstantPadImageFilter.h"
 #include "itkImageFileWriter.h"
+#include "itkImageIOFactory.h"
+#include "itkImageIORegion.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+
+#include <algorithm>
+#include <cstring>
 
 
 /** \class TileImages2D3DBase
@@ -68,43 +78,282 @@ public:
   ITKToolsTileImages2D3D(){};
   ~ITKToolsTileImages2D3D(){};
 
-  /** Run function. */
+  /** Some typedef's. */
+  typedef itk::Image<TComponentType, VDimension>      ImageType;
+  typedef typename ImageType::Pointer                 ImagePointer;
+  typedef typename ImageType::RegionType              RegionType;
+  typedef typename ImageType::SizeType                SizeType;
+  typedef typename ImageType::IndexType               IndexType;
+  typedef typename ImageType::SpacingType             SpacingType;
+  typedef typename ImageType::PointType               PointType;
+  typedef typename ImageType::DirectionType           DirectionType;
+  typedef itk::ImageFileReader<ImageType>             ImageReaderType;
+  typedef itk::ConstantPadImageFilter<ImageType, ImageType> PadderType;
+  typedef itk::ImageFileWriter<ImageType>             ImageWriterType;
+
+  /** Run function.
+   *
+   * The slices are decoded concurrently, every thread taking the next
+   * slice from a shared counter and copying it directly into its plane
+   * of the output buffer. When -maxmem or -streams asks for more than
+   * one stream division, the stack is processed in slabs of slices that
+   * are pasted into the output file one after the other.
+   */
   void Run( void )
   {
-    /** Some typedef's. */
-    typedef itk::Image<TComponentType, VDimension>      ImageType;
-    typedef typename ImageType::SpacingType             SpacingType;
-    typedef itk::ImageSeriesReader<ImageType>           ImageSeriesReaderType;
-    typedef itk::ImageFileWriter<ImageType>             ImageWriterType;
+    const unsigned int numberOfSlices = this->m_InputFileNames.size();
+    const unsigned int lastDim = VDimension - 1;
+
+    /** Get the output geometry from the headers of the first and last slice,
+     * like itk::ImageSeriesReader does.
+     */
+    typename ImageReaderType::Pointer firstReader = ImageReaderType::New();
+    firstReader->SetFileName( this->m_InputFileNames[ 0 ].c_str() );
+    firstReader->UpdateOutputInformation();
+    typename ImageReaderType::Pointer lastReader = ImageReaderType::New();
+    lastReader->SetFileName( this->m_InputFileNames[ numberOfSlices - 1 ].c_str() );
+    lastReader->UpdateOutputInformation();
 
-    /** Create reader. */
-    typename ImageSeriesReaderType::Pointer reader = ImageSeriesReaderType::New();
-    reader->SetFileNames( this->m_InputFileNames );
+    const ImageType * first = firstReader->GetOutput();
+    SizeType size = first->GetLargestPossibleRegion().GetSize();
+    size[ lastDim ] = numberOfSlices;
+    const PointType origin = first->GetOrigin();
+    SpacingType spacing = first->GetSpacing();
+    DirectionType direction = first->GetDirection();
 
-    /** Update the reader. */
-    reader->Update();
-    typename ImageType::Pointer tiledImage = reader->GetOutput();
+    const PointType lastOrigin = lastReader->GetOutput()->GetOrigin();
+    const typename PointType::VectorType stackDirection = lastOrigin - origin;
+    const double stackLength = stackDirection.GetNorm();
+    spacing[ lastDim ] = 1.0;
+    if( stackLength > 0.0 && numberOfSlices > 1 )
+    {
+      spacing[ lastDim ] = stackLength / ( numberOfSlices - 1 );
+      for( unsigned int d = 0; d < VDimension; ++d )
+      {
+        direction[ d ][ lastDim ] = stackDirection[ d ] / stackLength;
+      }
+    }
 
     /** Get and set the spacing, if it was set by the user. */
     if( this->m_LastSpacing > 0.0 )
     {
-      /** Make sure that changes are not undone. */
-      tiledImage->DisconnectPipeline();
+      spacing[ lastDim ] = this->m_LastSpacing;
+    }
 
-      /** Set the spacing of the last dimension. */
-      SpacingType spacing = tiledImage->GetSpacing();
-      spacing[ VDimension - 1 ] = this->m_LastSpacing;
-      tiledImage->SetSpacing( spacing );
+    /** Divide the stack into slabs that fit in memory. */
+    double sliceBytes = sizeof( TComponentType );
+    for( unsigned int d = 0; d < lastDim; ++d ) sliceBytes *= size[ d ];
+    unsigned int numberOfSlabs = std::min( numberOfSlices,
+      itktools::GetNumberOfStreamDivisions( sliceBytes * numberOfSlices ) );
+    if( numberOfSlabs > 1 )
+    {
+      itk::ImageIOBase::Pointer outputIO = itk::ImageIOFactory::CreateImageIO(
+        this->m_OutputFileName.c_str(), itk::ImageIOFactory::WriteMode );
+      if( outputIO.IsNull() || !outputIO->CanStreamWrite() )
+      {
+        std::cerr << "WARNING: the format of \"" << this->m_OutputFileName
+          << "\" does not support streamed writing, stacking in memory instead."
+          << std::endl;
+        numberOfSlabs = 1;
+      }
     }
+    const unsigned int slicesPerSlab = ( numberOfSlices + numberOfSlabs - 1 ) / numberOfSlabs;
+
+    for( unsigned int firstSlice = 0; firstSlice < numberOfSlices; firstSlice += slicesPerSlab )
+    {
+      const unsigned int slabSlices = std::min( slicesPerSlab, numberOfSlices - firstSlice );
+
+      /** Allocate the slab, positioned at its place in the output. */
+      SizeType slabSize = size;
+      slabSize[ lastDim ] = slabSlices;
+      RegionType slabRegion;
+      slabRegion.SetSize( slabSize );
+      PointType slabOrigin = origin;
+      for( unsigned int d = 0; d < VDimension; ++d )
+      {
+        slabOrigin[ d ] += direction[ d ][ lastDim ] * spacing[ lastDim ] * firstSlice;
+      }
+
+      ImagePointer slab = ImageType::New();
+      slab->SetRegions( slabRegion );
+      slab->SetOrigin( slabOrigin );
+      slab->SetSpacing( spacing );
+      slab->SetDirection( direction );
+      slab->Allocate();
 
-    /** Write to disk. */
-    typename ImageWriterType::Pointer writer = ImageWriterType::New();
-    writer->SetFileName( this->m_OutputFileName.c_str() );
-    writer->SetInput( tiledImage );
-    writer->Update();
+      /** Decode the slices into it. */
+      this->ReadSlices( slab, firstSlice );
+
+      /** Write to disk. */
+      typename ImageWriterType::Pointer writer = ImageWriterType::New();
+      writer->SetFileName( this->m_OutputFileName.c_str() );
+      if( numberOfSlabs == 1 )
+      {
+        writer->SetInput( slab );
+        itktools::AddTimingObservers( writer );
+        writer->Update();
+        break;
+      }
+
+      /** Pad the slab to the output size, so that the writer knows the
+       * output geometry. Only the slab region is requested when pasting,
+       * so the padding is never generated, except for the first slab,
+       * which creates the output file slice by slice.
+       */
+      SizeType lowerBound, upperBound;
+      lowerBound.Fill( 0 );
+      upperBound.Fill( 0 );
+      lowerBound[ lastDim ] = firstSlice;
+      upperBound[ lastDim ] = numberOfSlices - firstSlice - slabSlices;
+      typename PadderType::Pointer padder = PadderType::New();
+      padder->SetInput( slab );
+      padder->SetPadLowerBound( lowerBound );
+      padder->SetPadUpperBound( upperBound );
+      writer->SetInput( padder->GetOutput() );
+      if( firstSlice == 0 )
+      {
+        writer->SetNumberOfStreamDivisions( numberOfSlices );
+      }
+      else
+      {
+        itk::ImageIORegion ioRegion( VDimension );
+        for( unsigned int d = 0; d < VDimension; ++d )
+        {
+          ioRegion.SetSize( d, slabSize[ d ] );
+        }
+        ioRegion.SetIndex( lastDim, firstSlice );
+        writer->SetIORegion( ioRegion );
+      }
+      itktools::AddTimingObservers( writer );
+      writer->Update();
+    }
 
   } // end Run()
 
+protected:
+
+  /** The data shared by the decoding threads. */
+  struct ReadSlicesStruct
+  {
+    const std::vector<std::string> * FileNames;
+    ImageType *                      Slab;
+    unsigned int                     FirstSlice;
+    unsigned int                     NextSlice;
+    itk::SimpleFastMutexLock         Mutex;
+    std::string                      ErrorMessage;
+  };
+
+
+  /** Decode the slices of a slab with all threads. Every thread holds
+   * at most one decoded slice, so memory is bounded by the slab plus
+   * one slice per thread.
+   */
+  void ReadSlices( ImageType * slab, const unsigned int firstSlice )
+  {
+    ReadSlicesStruct str;
+    str.FileNames = &this->m_InputFileNames;
+    str.Slab = slab;
+    str.FirstSlice = firstSlice;
+    str.NextSlice = 0;
+
+    const unsigned int slabSlices = slab->GetLargestPossibleRegion().GetSize()[ VDimension - 1 ];
+    itk::ThreadIdType numberOfThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+    if( numberOfThreads > slabSlices )
+    {
+      numberOfThreads = static_cast<itk::ThreadIdType>( slabSlices );
+    }
+
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetNumberOfThreads( numberOfThreads );
+    threader->SetSingleMethod( ReadSlicesThreaderCallback, &str );
+    threader->SingleMethodExecute();
+
+    if( str.ErrorMessage != "" )
+    {
+      itkGenericExceptionMacro( << str.ErrorMessage );
+    }
+
+  } // end ReadSlices()
+
+
+  /** Take slices from the shared counter until the slab is full. */
+  static ITK_THREAD_RETURN_TYPE ReadSlicesThreaderCallback( void * arg )
+  {
+    itk::MultiThreader::ThreadInfoStruct * info
+      = static_cast<itk::MultiThreader::ThreadInfoStruct *>( arg );
+    ReadSlicesStruct * str = static_cast<ReadSlicesStruct *>( info->UserData );
+
+    const SizeType slabSize = str->Slab->GetLargestPossibleRegion().GetSize();
+    std::size_t pixelsPerSlice = 1;
+    for( unsigned int d = 0; d < VDimension - 1; ++d ) pixelsPerSlice *= slabSize[ d ];
+
+    while( true )
+    {
+      /** Get the next slice, or stop after an error. The reader and its
+       * ImageIO are created under the lock, the object factories are not
+       * thread safe. With the ImageIO set, the reader does not use them.
+       */
+      typename ImageReaderType::Pointer reader = 0;
+      itk::ImageIOBase::Pointer imageIO = 0;
+      str->Mutex.Lock();
+      const unsigned int slice = str->NextSlice++;
+      const bool stop = slice >= slabSize[ VDimension - 1 ] || str->ErrorMessage != "";
+      const std::string fileName = stop ? "" : ( *str->FileNames )[ str->FirstSlice + slice ];
+      if( !stop )
+      {
+        reader = ImageReaderType::New();
+        imageIO = itk::ImageIOFactory::CreateImageIO(
+          fileName.c_str(), itk::ImageIOFactory::ReadMode );
+      }
+      str->Mutex.Unlock();
+      if( stop ) break;
+
+      std::string errorMessage = "";
+      try
+      {
+        if( imageIO.IsNull() )
+        {
+          itkGenericExceptionMacro( << "no ImageIO can read this file." );
+        }
+        reader->SetFileName( fileName.c_str() );
+        reader->SetImageIO( imageIO );
+        reader->Update();
+
+        /** Copy the slice into its plane. */
+        const SizeType sliceSize = reader->GetOutput()->GetLargestPossibleRegion().GetSize();
+        for( unsigned int d = 0; d < VDimension; ++d )
+        {
+          const itk::SizeValueType expected = d < VDimension - 1 ? slabSize[ d ] : 1;
+          if( sliceSize[ d ] != expected )
+          {
+            errorMessage = "The size of \"" + fileName
+              + "\" differs from the size of the first slice.";
+          }
+        }
+        if( errorMessage == "" )
+        {
+          std::memcpy( str->Slab->GetBufferPointer() + slice * pixelsPerSlice,
+            reader->GetOutput()->GetBufferPointer(),
+            pixelsPerSlice * sizeof( TComponentType ) );
+        }
+      }
+      catch( itk::ExceptionObject & excp )
+      {
+        errorMessage = "Could not read \"" + fileName + "\": " + excp.GetDescription();
+      }
+
+      if( errorMessage != "" )
+      {
+        str->Mutex.Lock();
+        if( str->ErrorMessage == "" ) str->ErrorMessage = errorMessage;
+        str->Mutex.Unlock();
+      }
+    }
+
+    return ITK_THREAD_RETURN_VALUE;
+
+  } // end ReadSlicesThreaderCallback()
+
 }; // end class ITKToolsTileImages2D3D
 
 
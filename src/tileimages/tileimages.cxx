@@ -19,7 +19,7 @@
  \brief Either tiles a stack of 2D images into a 3D image, or tiles nD images to form another nD image.
 
  This program tiles a stacks of 2D images into a 3D image.
- This is done by employing an itk::SeriesFileReader.
+ The slices are decoded concurrently into their planes of the 3D image.
  \verbinclude tileimages.help
  */
 
@@ -43,7 +43,8 @@ std::string GetHelpString( void )
     << "pxtileimages EITHER tiles a stack of 2D images into a 3D image,\n"
     << "OR tiles nD images to form another nD image.\n"
     << "In the last case the way to tile is specified by a layout.\n"
-    << "To stack a pile of 2D images an itk::SeriesFileReader is employed.\n"
+    << "To stack a pile of 2D images the slices are decoded in parallel;\n"
+    << "with -maxmem or -streams the stack is written in slabs.\n"
     << "If no layout is specified with \"-ly\" 2D-3D tiling is done,\n"
     << "otherwise 2D-2D or 3D-3D tiling is performed.\n"
     << "Usage:  \npxtileimages\n"
@@ -61,6 +62,11 @@ std::string GetHelpString( void )
     << "           example: in 2D for 4 images \"-ly 4 1\" (or \"-ly 0 1\") results in\n"
     << "             im1 im2 im3 im4\n"
     << "  [-d]     default value, by default 0.\n"
+    << "  [-stream] for nD-nD tiling: read one input at a time and paste it into\n"
+    << "           the output file, instead of holding all inputs in memory;\n"
+    << "           requires an output format that supports streamed writing,\n"
+    << "           which is uncompressed MetaImage (mhd, mha); for other formats\n"
+    << "           the inputs are tiled in memory\n"
     << "Supported pixel types: (unsigned) char, (unsigned) short, float.";
 
   return ss.str();
@@ -119,6 +125,9 @@ int main( int argc, char ** argv )
   double defaultvalue = 0.0;
   parser->GetCommandLineArgument( "-d", defaultvalue );
 
+  /** Tile in a streaming fashion. */
+  const bool stream = parser->ArgumentExists( "-stream" );
+
   /** Determine image properties. */
   itk::ImageIOBase::IOPixelType pixelType = itk::ImageIOBase::UNKNOWNPIXELTYPE;
   itk::ImageIOBase::IOComponentType componentType = itk::ImageIOBase::UNKNOWNCOMPONENTTYPE;
@@ -221,6 +230,7 @@ int main( int argc, char ** argv )
       filter->m_OutputFileName = outputFileName;
       filter->m_Layout = layout;
       filter->m_Defaultvalue = defaultvalue;
+      filter->m_Stream = stream;
 
       filter->Run();
 
@@ -20,6 +20,7 @@
 
 #include "ITKToolsHelpers.h"
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkUnaryFunctorImageFilter.h"
 #include "itkUnaryFunctors.h"
@@ -94,6 +95,7 @@ public:
     /** Read the image. */
     typename ReaderType::Pointer reader = ReaderType::New();
     reader->SetFileName( this->m_InputFileName.c_str() );
+    itktools::ReuseImageIO( reader, this->m_InputFileName );
 
     /** Define a helper map. */
     std::map< std::string, UnaryFunctorEnum> stringToEnumMap;
@@ -145,6 +147,7 @@ public:
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetInput( unaryFilter->GetOutput() );
     writer->SetUseCompression( this->m_UseCompression );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()
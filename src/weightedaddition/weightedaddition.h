@@ -19,6 +19,7 @@
 #define __weightedaddition_h_
 
 #include "ITKToolsBase.h"
+#include "ITKToolsTiming.h"
 
 #include "itkImage.h"
 #include "itkImageFileReader.h"
@@ -115,6 +116,7 @@ public:
     /** Write the output image. */
     writer->SetFileName( this->m_OutputFileName.c_str() );
     writer->SetInput( adder->GetOutput() );
+    itktools::AddTimingObservers( writer );
     writer->Update();
 
   } // end Run()